@@ -0,0 +1,71 @@
+#include "FakeOdbc.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+using FoxBridge::FakeStatement;
+
+static FakeStatement& fake(SQLHSTMT stmt) {
+    return *static_cast<FakeStatement*>(stmt);
+}
+
+// Copies `value` the way the driver does: truncated to fit with a terminator,
+// the full length reported, SQL_SUCCESS_WITH_INFO when truncated
+static SQLRETURN copyOut(std::string_view value, SQLCHAR* buffer, SQLLEN buffer_length) {
+    if (!buffer || buffer_length <= 0) {
+        return SQL_SUCCESS_WITH_INFO;
+    }
+    
+    size_t copied = std::min(value.size(), static_cast<size_t>(buffer_length - 1));
+    std::memcpy(buffer, value.data(), copied);
+    buffer[copied] = '\0';
+    return copied < value.size() ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT stmt, SQLSMALLINT* column_count) {
+    *column_count = static_cast<SQLSMALLINT>(fake(stmt).columns.size());
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT stmt) {
+    FakeStatement& statement = fake(stmt);
+    if (statement.cursor >= statement.row_count) {
+        return SQL_NO_DATA;
+    }
+    ++statement.cursor;
+    statement.part_column = 0;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDescribeCol(SQLHSTMT stmt, SQLUSMALLINT column, SQLCHAR* name,
+                                 SQLSMALLINT name_max, SQLSMALLINT* name_length,
+                                 SQLSMALLINT* data_type, SQLULEN* column_size,
+                                 SQLSMALLINT* decimal_digits, SQLSMALLINT* nullable) {
+    const std::string& column_name = fake(stmt).columns[column - 1];
+    if (name_length) *name_length = static_cast<SQLSMALLINT>(column_name.size());
+    if (data_type) *data_type = SQL_CHAR;
+    if (column_size) *column_size = 254;
+    if (decimal_digits) *decimal_digits = 0;
+    if (nullable) *nullable = SQL_NULLABLE;
+    return copyOut(column_name, name, name_max);
+}
+
+SQLRETURN SQL_API SQLGetData(SQLHSTMT stmt, SQLUSMALLINT column, SQLSMALLINT /*target_type*/,
+                             SQLPOINTER target, SQLLEN buffer_length, SQLLEN* indicator) {
+    FakeStatement& statement = fake(stmt);
+    const std::string& value =
+        statement.cells[(statement.cursor - 1) * statement.columns.size() + (column - 1)];
+    
+    // Repeated calls on one column continue where the last part ended
+    if (column != statement.part_column) {
+        statement.part_column = column;
+        statement.part_offset = 0;
+    } else if (statement.part_offset >= value.size()) {
+        return SQL_NO_DATA;
+    }
+    std::string_view rest = std::string_view(value).substr(statement.part_offset);
+    if (indicator) *indicator = static_cast<SQLLEN>(rest.size());
+    SQLRETURN ret = copyOut(rest, static_cast<SQLCHAR*>(target), buffer_length);
+    statement.part_offset += buffer_length > 0 ? std::min(rest.size(), static_cast<size_t>(buffer_length - 1)) : 0;
+    return ret;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <sql.h>
+#include <sqlext.h>
+
+namespace FoxBridge {
+
+// In-memory stand-in for an executed SELECT. FakeOdbc.cpp defines the ODBC
+// calls DatabaseManager::fetchRows makes (SQLNumResultCols, SQLFetch,
+// SQLDescribeCol, SQLGetData) against it; the bench executable links those
+// ahead of the driver manager, so row conversion runs without a database.
+struct FakeStatement {
+    std::vector<std::string> columns;
+    std::vector<std::string> cells;     // Row-major, columns.size() per row
+    size_t row_count = 0;
+    size_t cursor = 0;                  // Current row, 1-based; 0 before the first fetch
+    
+    // Long values come back in parts, as from the driver
+    SQLUSMALLINT part_column = 0;
+    size_t part_offset = 0;
+    
+    void rewind() { cursor = 0; }
+    SQLHSTMT handle() { return static_cast<SQLHSTMT>(this); }
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,103 @@
+#include "SyntheticTable.h"
+#include <cstdio>
+#include <utility>
+
+namespace FoxBridge {
+
+static const char* const COLUMN_NAMES[] = {"docnum", "docdat", "amount", "cuscod", "descrp", "qty"};
+static constexpr size_t COLUMN_KINDS = sizeof(COLUMN_NAMES) / sizeof(COLUMN_NAMES[0]);
+
+std::string SyntheticTable::columnName(size_t col) {
+    if (col < COLUMN_KINDS) {
+        return COLUMN_NAMES[col];
+    }
+    
+    char name[16];
+    std::snprintf(name, sizeof(name), "fld%03zu", col);
+    return name;
+}
+
+std::string SyntheticTable::cell(size_t row, size_t col) {
+    char value[64];
+    switch (col % COLUMN_KINDS) {
+        case 0:
+            std::snprintf(value, sizeof(value), "HP%07zu", row % 10000000);
+            break;
+        case 1:
+            std::snprintf(value, sizeof(value), "2024-%02zu-%02zu", row % 12 + 1, row % 28 + 1);
+            break;
+        case 2:
+            std::snprintf(value, sizeof(value), "%zu.%02zu", (row * 7919) % 1000000, row % 100);
+            break;
+        case 3:
+            std::snprintf(value, sizeof(value), "C%05zu", (row * 31 + col) % 100000);
+            break;
+        case 4:
+            // Every 16th description carries quotes to exercise CSV escaping
+            if (row % 16 == 0) {
+                std::snprintf(value, sizeof(value), "PVC pipe %zu\" x 4m \"class 8.5\"", row % 12 + 1);
+            } else {
+                std::snprintf(value, sizeof(value), "Item %zu for customer %zu", row, col);
+            }
+            break;
+        default:
+            std::snprintf(value, sizeof(value), "%zu", (row + col) % 1000);
+            break;
+    }
+    return value;
+}
+
+const nlohmann::json& SyntheticTable::rows(size_t cols, size_t row_count) {
+    static std::pair<size_t, size_t> shape{0, 0};
+    static nlohmann::json table;
+    
+    if (shape != std::make_pair(cols, row_count)) {
+        table = nlohmann::json::array();
+        std::vector<std::string> names;
+        for (size_t col = 0; col < cols; ++col) {
+            names.push_back(columnName(col));
+        }
+        for (size_t row = 0; row < row_count; ++row) {
+            nlohmann::json record;
+            for (size_t col = 0; col < cols; ++col) {
+                record[names[col]] = cell(row, col);
+            }
+            table.push_back(std::move(record));
+        }
+        shape = {cols, row_count};
+    }
+    return table;
+}
+
+FakeStatement& SyntheticTable::statement(size_t cols, size_t row_count) {
+    static FakeStatement stmt;
+    
+    if (stmt.columns.size() != cols || stmt.row_count != row_count) {
+        stmt = FakeStatement();
+        for (size_t col = 0; col < cols; ++col) {
+            stmt.columns.push_back(columnName(col));
+        }
+        stmt.cells.reserve(cols * row_count);
+        for (size_t row = 0; row < row_count; ++row) {
+            for (size_t col = 0; col < cols; ++col) {
+                stmt.cells.push_back(cell(row, col));
+            }
+        }
+        stmt.row_count = row_count;
+    }
+    stmt.rewind();
+    return stmt;
+}
+
+void SyntheticTable::shapes(benchmark::internal::Benchmark* bench, size_t max_cells) {
+    bench->ArgNames({"cols", "rows"});
+    for (int64_t cols : {4, 20, 100}) {
+        for (int64_t rows : {10, 1000, 10000, 100000, 1000000}) {
+            if (static_cast<size_t>(cols * rows) <= max_cells) {
+                bench->Args({cols, rows});
+            }
+        }
+    }
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <benchmark/benchmark.h>
+#include "FakeOdbc.h"
+
+namespace FoxBridge {
+
+// Deterministic tables shaped like ExpressD invoice rows. Every value is text,
+// as the VFP driver returns it through SQL_C_CHAR. The column mix repeats
+// docnum, date, amount, customer code, free text (some with quotes) and quantity.
+class SyntheticTable {
+public:
+    static std::string columnName(size_t col);
+    static std::string cell(size_t row, size_t col);
+    
+    // Built on first use and cached until a different shape is requested, so
+    // only one large table is resident at a time
+    static const nlohmann::json& rows(size_t cols, size_t rows);
+    static FakeStatement& statement(size_t cols, size_t rows);
+    
+    // Registers cols x rows arguments from narrow to 100 columns and from 10
+    // to 1M rows, skipping shapes above `max_cells` to bound memory
+    static void shapes(benchmark::internal::Benchmark* bench, size_t max_cells = 4000000);
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,139 @@
+// Request-path helpers in HttpServer: query-string parsing, route dispatch
+// as handleRequest does it, and envelope serialization (JSON, MessagePack,
+// CBOR).
+#include "HttpServer.h"
+#include "DatabaseManager.h"
+#include "Router.h"
+#include "RequestArena.h"
+#include "AllocationCounter.h"
+#include "SyntheticTable.h"
+#include <benchmark/benchmark.h>
+
+using namespace FoxBridge;
+namespace http = boost::beast::http;
+
+namespace {
+
+void BM_ParseQueryString(benchmark::State& state) {
+    std::string query = "q=docnum:HP0001234&limit=100";
+    for (int64_t i = 2; i < state.range(0); ++i) {
+        query += "&" + SyntheticTable::columnName(static_cast<size_t>(i)) + "=" +
+                 SyntheticTable::cell(static_cast<size_t>(i), static_cast<size_t>(i));
+    }
+    
+    for (auto _ : state) {
+        auto params = HttpServer::parseQueryString(query);
+        benchmark::DoNotOptimize(params.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(query.size()));
+}
+
+// A traffic-shaped mix: lookups and exports dominate, with a 404 for good measure
+void BM_RouteMatch(benchmark::State& state) {
+    static const std::pair<std::string, std::string> REQUESTS[] = {
+        {"GET",  "/health"},
+        {"GET",  "/api/dbf/json/ARINV.dbf"},
+        {"GET",  "/api/dbf/json/ARINV.dbf/HP0001234"},
+        {"GET",  "/api/dbf/csv/ARTRN.dbf"},
+        {"GET",  "/api/dbf/search/ARINV.dbf"},
+        {"GET",  "/docnum/HP0001234"},
+        {"GET",  "/HP0001234"},
+        {"POST", "/api/docnum/batch"},
+        {"POST", "/api/dbf/update/ARINV.dbf"},
+        {"GET",  "/api/admin/querystats"},
+        {"GET",  "/favicon.ico"}
+    };
+    constexpr size_t REQUEST_COUNT = sizeof(REQUESTS) / sizeof(REQUESTS[0]);
+    
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [method, path] = REQUESTS[i++ % REQUEST_COUNT];
+        RouteMatch match = Router::match(method, path);
+        benchmark::DoNotOptimize(match.id);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SendJsonResponse(benchmark::State& state) {
+    size_t cols = static_cast<size_t>(state.range(0));
+    size_t rows = static_cast<size_t>(state.range(1));
+    nlohmann::json envelope = {
+        {"status", "success"},
+        {"msg", "Records retrieved"},
+        {"data", SyntheticTable::rows(cols, rows)},
+        {"index", "ok"},
+        {"warnings", nlohmann::json::array()}
+    };
+    
+    size_t bytes = 0;
+    for (auto _ : state) {
+        http::response<http::string_body> res;
+        HttpServer::sendJsonResponse(res, 200, envelope);
+        bytes += res.body().size();
+        benchmark::DoNotOptimize(res.body().data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// What a JSON export request does after SQLExecDirect: fetch the rows, wrap
+// them in the envelope and serialize, under a request arena as the server
+// runs it. allocs_per_row is the figure to watch.
+void exportPath(benchmark::State& state, BodyFormat format) {
+    size_t cols = static_cast<size_t>(state.range(0));
+    size_t rows = static_cast<size_t>(state.range(1));
+    FakeStatement& stmt = SyntheticTable::statement(cols, rows);
+    
+    size_t bytes_fetched = 0;
+    size_t bytes = 0;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        stmt.rewind();
+        RequestArena arena;
+        RequestArena::Scope scope(arena);
+        uint64_t start = AllocationCounter::threadAllocations();
+        
+        QueryResult result{true, "All records exported", nullptr, IndexStatus::OK, {}, {}};
+        DatabaseManager::fetchRows(stmt.handle(), result.rows, bytes_fetched, TextEncoding::CP874);
+        nlohmann::json envelope = {
+            {"status", "success"},
+            {"msg", result.message},
+            {"index", "ok"},
+            {"warnings", result.warnings}
+        };
+        http::response<http::string_body> res;
+        HttpServer::sendJsonResponse(res, 200, envelope, result.rows, format);
+        
+        allocations += AllocationCounter::threadAllocations() - start;
+        bytes += res.body().size();
+        benchmark::DoNotOptimize(res.body().data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.counters["allocs_per_row"] = static_cast<double>(allocations) / (state.iterations() * rows);
+}
+
+void BM_JsonExportPath(benchmark::State& state) {
+    exportPath(state, BodyFormat::JSON);
+}
+
+// The same export for Accept: application/msgpack or application/cbor
+void BM_BinaryExportPath(benchmark::State& state, BodyFormat format) {
+    exportPath(state, format);
+}
+
+} // namespace
+
+BENCHMARK(BM_ParseQueryString)->ArgName("params")->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK(BM_RouteMatch);
+BENCHMARK(BM_SendJsonResponse)->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b, 2000000); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JsonExportPath)->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b, 2000000); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_BinaryExportPath, msgpack, BodyFormat::MSGPACK)
+    ->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b, 2000000); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_BinaryExportPath, cbor, BodyFormat::CBOR)
+    ->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b, 2000000); })
+    ->Unit(benchmark::kMillisecond);
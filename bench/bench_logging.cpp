@@ -0,0 +1,112 @@
+// Per-request logging cost: the synchronous rotating file logger the server
+// used to write "Request: ..." through, the async logger that replaced it, and
+// the batched access log. Each iteration is one simulated request.
+#include "AccessLog.h"
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <filesystem>
+
+using namespace FoxBridge;
+
+namespace {
+
+const std::string METHOD = "GET";
+const std::string TARGET = "/api/json/ARINV?q=docnum:INV000123&limit=100";
+
+std::string benchLogPath(const std::string& name) {
+    auto dir = std::filesystem::temp_directory_path() / "foxbridge_bench";
+    std::filesystem::create_directories(dir);
+    return (dir / name).string();
+}
+
+std::shared_ptr<spdlog::logger> syncLogger() {
+    static auto logger = [] {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            benchLogPath("sync.log"), 1024 * 1024 * 10, 3);
+        return std::make_shared<spdlog::logger>("bench_sync", sink);
+    }();
+    return logger;
+}
+
+std::shared_ptr<spdlog::logger> asyncLogger() {
+    static auto logger = [] {
+        spdlog::init_thread_pool(8192, 1);
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            benchLogPath("async.log"), 1024 * 1024 * 10, 3);
+        return std::make_shared<spdlog::async_logger>(
+            "bench_async", sink, spdlog::thread_pool(), spdlog::async_overflow_policy::block);
+    }();
+    return logger;
+}
+
+AccessLog& accessLog() {
+    static AccessLog log(benchLogPath("access.log"), std::chrono::milliseconds(1000),
+                         65536, 1024 * 1024 * 10, 3);
+    return log;
+}
+
+void BM_SyncFileLogger(benchmark::State& state) {
+    auto logger = syncLogger();
+    for (auto _ : state) {
+        logger->info("Request: {} {}", METHOD, TARGET);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_AsyncFileLogger(benchmark::State& state) {
+    auto logger = asyncLogger();
+    for (auto _ : state) {
+        logger->info("Request: {} {}", METHOD, TARGET);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_AccessLogRecord(benchmark::State& state) {
+    AccessLog& log = accessLog();
+    if (state.thread_index() == 0) {
+        log.start();
+    }
+    for (auto _ : state) {
+        AccessLogEntry entry;
+        entry.time = std::chrono::system_clock::now();
+        entry.method = METHOD;
+        entry.route = "json_all";
+        entry.target = TARGET;
+        entry.status = 200;
+        entry.latency = std::chrono::microseconds(1250);
+        entry.bytes = 48213;
+        log.record(std::move(entry));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        state.counters["dropped"] = static_cast<double>(log.dropped());
+    }
+}
+
+void BM_AccessLogFormat(benchmark::State& state) {
+    AccessLogEntry entry;
+    entry.time = std::chrono::system_clock::now();
+    entry.method = METHOD;
+    entry.route = "json_all";
+    entry.target = TARGET;
+    entry.status = 200;
+    entry.latency = std::chrono::microseconds(1250);
+    entry.bytes = 48213;
+    
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        AccessLog::format(entry, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_SyncFileLogger)->Threads(1)->Threads(8)->UseRealTime();
+BENCHMARK(BM_AsyncFileLogger)->Threads(1)->Threads(8)->UseRealTime();
+BENCHMARK(BM_AccessLogRecord)->Threads(1)->Threads(8)->UseRealTime();
+BENCHMARK(BM_AccessLogFormat);
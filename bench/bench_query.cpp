@@ -0,0 +1,157 @@
+// Query-path helpers in DatabaseManager: WHERE clause building, row
+// conversion from an executed statement into a RowSet (and the JSON objects
+// it replaced), code page transcoding, and CSV export of the rows.
+#include "DatabaseManager.h"
+#include "CsvEncoder.h"
+#include "RequestArena.h"
+#include "AllocationCounter.h"
+#include "SyntheticTable.h"
+#include <benchmark/benchmark.h>
+
+using namespace FoxBridge;
+
+namespace {
+
+void BM_FetchRows(benchmark::State& state) {
+    size_t cols = static_cast<size_t>(state.range(0));
+    size_t rows = static_cast<size_t>(state.range(1));
+    FakeStatement& stmt = SyntheticTable::statement(cols, rows);
+    
+    size_t bytes_fetched = 0;
+    uint64_t allocations = 0;
+    size_t result_bytes = 0;
+    for (auto _ : state) {
+        stmt.rewind();
+        RequestArena arena;
+        RequestArena::Scope scope(arena);
+        uint64_t start = AllocationCounter::threadAllocations();
+        RowSet result;
+        DatabaseManager::fetchRows(stmt.handle(), result, bytes_fetched, TextEncoding::CP874);
+        allocations += AllocationCounter::threadAllocations() - start;
+        result_bytes = result.memoryBytes();
+        benchmark::DoNotOptimize(result.size());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes_fetched));
+    state.counters["allocs_per_row"] = static_cast<double>(allocations) / (state.iterations() * rows);
+    state.counters["result_bytes_per_row"] = static_cast<double>(result_bytes) / rows;
+}
+
+// The rows as JSON objects, as results were held before RowSet: the
+// baseline for BM_FetchRows' result_bytes_per_row (heap bytes counted by
+// the replacement operator new)
+void BM_RowsAsJson(benchmark::State& state) {
+    size_t cols = static_cast<size_t>(state.range(0));
+    size_t rows = static_cast<size_t>(state.range(1));
+    FakeStatement& stmt = SyntheticTable::statement(cols, rows);
+    
+    size_t bytes_fetched = 0;
+    uint64_t result_bytes = 0;
+    for (auto _ : state) {
+        stmt.rewind();
+        RowSet fetched;
+        DatabaseManager::fetchRows(stmt.handle(), fetched, bytes_fetched, TextEncoding::CP874);
+        uint64_t start = AllocationCounter::threadAllocatedBytes();
+        nlohmann::json result = fetched.toJson();
+        result_bytes = AllocationCounter::threadAllocatedBytes() - start;
+        benchmark::DoNotOptimize(result.size());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.counters["result_bytes_per_row"] = static_cast<double>(result_bytes) / rows;
+}
+
+void BM_JsonToCSV(benchmark::State& state) {
+    size_t cols = static_cast<size_t>(state.range(0));
+    size_t rows = static_cast<size_t>(state.range(1));
+    const nlohmann::json& data = SyntheticTable::rows(cols, rows);
+    
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::string csv = StorageBackend::jsonToCSV(data);
+        bytes += csv.size();
+        benchmark::DoNotOptimize(csv.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// The same rows through CsvEncoder, in the default dialect and in Excel's
+// (minimal quoting, CR LF, BOM); compare with BM_JsonToCSV
+void BM_CsvEncoder(benchmark::State& state, CsvDialect dialect) {
+    size_t cols = static_cast<size_t>(state.range(0));
+    size_t rows = static_cast<size_t>(state.range(1));
+    FakeStatement& stmt = SyntheticTable::statement(cols, rows);
+    stmt.rewind();
+    RowSet data;
+    size_t bytes_fetched = 0;
+    DatabaseManager::fetchRows(stmt.handle(), data, bytes_fetched, TextEncoding::UTF8);
+    CsvEncoder encoder(dialect);
+    
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::string csv;
+        encoder.write(data, csv);
+        bytes += csv.size();
+        benchmark::DoNotOptimize(csv.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// CP874 to UTF-8 over a 4KB buffer: 0 = all ASCII, 1 = Thai text with
+// ASCII spaces and digits, as in ExpressD customer names and remarks
+void BM_TranscodeCp874(benchmark::State& state) {
+    std::string text;
+    for (size_t i = 0; text.size() < 4096; ++i) {
+        if (state.range(0) == 0) {
+            text += "Item " + std::to_string(i) + " for customer C" + std::to_string(i * 31 % 100000) + " ";
+        } else {
+            text += "\xBA\xC3\xD4\xC9\xD1\xB7 \xCA\xC2\xD2\xC1 " + std::to_string(i) + " ";
+        }
+    }
+    text.resize(4096);
+    
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        appendUtf8(out, text, TextEncoding::CP874);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+// `filters` conditions, mixing the value types the write endpoints accept
+void BM_BuildWhereClause(benchmark::State& state) {
+    nlohmann::json where = nlohmann::json::object();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        std::string key = SyntheticTable::columnName(static_cast<size_t>(i));
+        switch (i % 3) {
+            case 0: where[key] = SyntheticTable::cell(static_cast<size_t>(i), static_cast<size_t>(i)); break;
+            case 1: where[key] = i * 1000 + 7; break;
+            default: where[key] = (i % 2) == 0; break;
+        }
+    }
+    
+    for (auto _ : state) {
+        std::string clause = DatabaseManager::buildWhereClause(where);
+        benchmark::DoNotOptimize(clause.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_FetchRows)->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RowsAsJson)->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JsonToCSV)->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CsvEncoder, default, CsvDialect{})
+    ->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CsvEncoder, excel, CsvDialect{',', CsvQuoting::MINIMAL, true, true})
+    ->Apply([](benchmark::internal::Benchmark* b) { SyntheticTable::shapes(b); })
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TranscodeCp874)->ArgName("thai")->Arg(0)->Arg(1);
+BENCHMARK(BM_BuildWhereClause)->ArgName("filters")->Arg(1)->Arg(4)->Arg(16)->Arg(64);
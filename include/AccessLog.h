@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <condition_variable>
+
+namespace FoxBridge {
+
+struct AccessLogEntry {
+    std::chrono::system_clock::time_point time;
+    std::string method;
+    std::string route;
+    std::string target;
+    int status = 0;
+    std::chrono::microseconds latency{0};
+    size_t bytes = 0;
+    std::string trace_id;       // Empty unless the request was traced
+};
+
+// Structured access log, one JSON object per line. Request threads only
+// append to an in-memory batch; a writer thread formats and writes each
+// batch with a single write, so file I/O never runs on a request thread.
+// The batch is bounded - entries beyond `max_pending` are counted and dropped.
+class AccessLog {
+public:
+    AccessLog(const std::string& path, std::chrono::milliseconds flush_interval,
+              size_t max_pending, size_t max_file_size, size_t max_files);
+    ~AccessLog();
+    
+    // Disable copy
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+    
+    void start();
+    void stop();
+    
+    void record(AccessLogEntry entry);
+    
+    uint64_t written() const { return written_; }
+    uint64_t dropped() const { return dropped_; }
+    
+    // Appends one formatted line (with trailing newline) to `out`
+    static void format(const AccessLogEntry& entry, std::string& out);
+
+private:
+    std::string path_;
+    std::chrono::milliseconds flush_interval_;
+    size_t max_pending_;
+    size_t max_file_size_;
+    size_t max_files_;
+    
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<AccessLogEntry> pending_;
+    bool running_ = false;
+    
+    std::unique_ptr<std::thread> writer_thread_;
+    std::FILE* file_ = nullptr;
+    size_t file_size_ = 0;
+    
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    
+    void writerLoop();
+    void writeBatch(std::vector<AccessLogEntry>& batch, std::string& buffer);
+    bool openFile();
+    void rotate();
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <nlohmann/json.hpp>
+#include "Config.h"
+
+namespace FoxBridge {
+
+// Route classes in priority order - lower value is admitted first
+enum class RouteClass {
+    HEALTH = 0,
+    LOOKUP,
+    SEARCH,
+    EXPORT,
+    WRITE,
+    MAINTENANCE,
+    COUNT
+};
+
+// Bounded, priority-aware admission in front of the request handlers.
+// Requests either get a slot, wait briefly in a bounded queue, or are shed
+// straight away so the caller can answer 503 instead of piling up latency.
+class AdmissionController {
+public:
+    static constexpr size_t CLASS_COUNT = static_cast<size_t>(RouteClass::COUNT);
+    
+    AdmissionController(int max_concurrent, int max_queued,
+                        std::chrono::milliseconds queue_timeout,
+                        const std::array<RouteClassLimit, CLASS_COUNT>& limits);
+    
+    // Disable copy
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+    
+    // Releases the slot when it goes out of scope
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(AdmissionController* owner, RouteClass route_class)
+            : owner_(owner), route_class_(route_class) {}
+        Ticket(Ticket&& other) noexcept { *this = std::move(other); }
+        Ticket& operator=(Ticket&& other) noexcept;
+        ~Ticket();
+        
+        explicit operator bool() const { return owner_ != nullptr; }
+        
+    private:
+        AdmissionController* owner_ = nullptr;
+        RouteClass route_class_ = RouteClass::HEALTH;
+    };
+    
+    // Blocks until admitted; an empty ticket means the request was shed
+    Ticket admit(RouteClass route_class);
+    
+    // Suggested Retry-After (seconds) for a shed request of this class
+    int retryAfterSeconds(RouteClass route_class) const;
+    
+    nlohmann::json stats();
+    
+    static RouteClass classify(const std::string& path);
+    static const char* className(RouteClass route_class);
+    
+private:
+    struct ClassState {
+        RouteClassLimit limit;
+        int in_flight = 0;
+        std::deque<uint64_t> waiting;    // Ticket numbers in arrival order
+        uint64_t admitted = 0;
+        uint64_t shed_queue_full = 0;
+        uint64_t shed_timeout = 0;
+    };
+    
+    int max_concurrent_;
+    int max_queued_;
+    std::chrono::milliseconds queue_timeout_;
+    
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<ClassState, CLASS_COUNT> classes_;
+    int in_flight_ = 0;
+    int queued_ = 0;
+    uint64_t next_ticket_ = 0;
+    
+    bool hasCapacity(size_t index) const;
+    bool isNextInLine(size_t index, uint64_t ticket) const;
+    void release(RouteClass route_class);
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace FoxBridge {
+
+// Heap allocations (operator new) made by the calling thread. Counted only
+// in builds with FOXBRIDGE_COUNT_ALLOCATIONS, which replace the global
+// operator new; elsewhere enabled() is false and the count stays 0.
+struct AllocationCounter {
+    static bool enabled();
+    static uint64_t threadAllocations();
+    
+    // Bytes requested by those allocations (not net of frees)
+    static uint64_t threadAllocatedBytes();
+};
+
+} // namespace FoxBridge
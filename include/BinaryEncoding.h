@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace FoxBridge {
+
+// Encodings a JSON endpoint can answer in. MessagePack and CBOR carry the
+// same document as the JSON body, so clients decode the same envelope.
+enum class BodyFormat : uint8_t {
+    JSON,
+    MSGPACK,
+    CBOR
+};
+
+// Format preferred by an Accept header: application/msgpack (or
+// application/x-msgpack) and application/cbor by q-value, JSON otherwise
+BodyFormat bodyFormatFromAccept(std::string_view accept);
+
+const char* contentType(BodyFormat format);
+
+// MessagePack / CBOR items for `format` (not JSON), each in its shortest
+// encoding as nlohmann::json::to_msgpack and to_cbor write them
+void appendBinaryMap(std::string& out, BodyFormat format, size_t entries);
+void appendBinaryArray(std::string& out, BodyFormat format, size_t items);
+void appendBinaryString(std::string& out, BodyFormat format, std::string_view text);
+void appendBinaryUnsigned(std::string& out, BodyFormat format, uint64_t value);
+void appendBinaryNull(std::string& out, BodyFormat format);
+void appendBinaryJson(std::string& out, BodyFormat format, const nlohmann::json& value);
+
+} // namespace FoxBridge
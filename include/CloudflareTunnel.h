@@ -4,7 +4,11 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/types.h>
+#endif
 
 namespace FoxBridge {
 
@@ -27,13 +31,18 @@ private:
     std::atomic<bool> running_;
     std::atomic<bool> watchdog_enabled_;
     
+#ifdef _WIN32
     HANDLE process_handle_;
     PROCESS_INFORMATION process_info_;
+#else
+    pid_t process_id_;
+#endif
     
     std::unique_ptr<std::thread> watchdog_thread_;
     
     bool launchCloudflared();
     void killProcess();
+    bool processAlive();
     void watchdogLoop(int interval_seconds);
     std::string findCloudflaredPath();
 };
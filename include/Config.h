@@ -1,22 +1,108 @@
 #pragma once
 
 #include <string>
+#include <algorithm>
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <map>
+#include <vector>
+#include "Platform.h"
+#include "TextEncoding.h"
 
 namespace FoxBridge {
 
+struct RouteClassLimit {
+    int concurrency = 1; // Max requests of this class running at once
+    int queue = 0;       // Max requests of this class waiting for a slot
+};
+
 struct Config {
     std::string database_path;
     std::string api_key;
     int port = 8787;
     std::string cloudflare_token;
     std::string log_level = "info";
-    std::string log_path = "C:\\ProgramData\\FoxBridgeAgent\\logs";
+    std::string log_path = Platform::DEFAULT_LOG_PATH;
+    
+    // Logging runs on a background thread; access.log gets one line per request
+    bool log_async = true;
+    int log_queue_size = 8192;
+    std::string log_overflow_policy = "block";   // block | drop_oldest
+    bool access_log = true;
+    int access_log_flush_ms = 1000;
     std::string index_policy = "auto";  // auto | manual_only
     std::string maintenance_window = "02:00-04:00";
     int max_retry_attempts = 3;
     int connection_timeout = 30;
+    // Streamed responses (memo, Arrow, Parquet, /view, snapshots): once the
+    // headers are out, each write must land within this many seconds
+    // instead of the request finishing within connection_timeout
+    int stream_idle_timeout = 30;
+    int db_pool_size = 4;
+    
+    // Storage: "odbc" goes through the VFP ODBC driver, "dbf" reads the
+    // files directly (read-only, no driver needed)
+    std::string storage_backend = "odbc";
+    std::string odbc_driver = "Microsoft Visual FoxPro Driver";
+    
+    // Code page of text fields when the .dbf header does not name one;
+    // table_encodings overrides it (and the header) per file
+    std::string text_encoding = "cp874";
+    std::map<std::string, std::string> table_encodings;
+    
+    // Memos up to this size are returned inside rows; longer ones (all of
+    // them at 0) as references to GET /api/dbf/memo/{file}/{recno}/{field}
+    int memo_inline_bytes = 0;
+    int http_worker_threads = 16;
+    // Accepted connections waiting for a worker before new ones get 503
+    int accept_queue_limit = 64;
+    bool coalesce_requests = true;
+    
+    // Arrow / Parquet exports: record ranges read concurrently, and the
+    // Parquet codec (zstd | snappy | gzip | none)
+    int export_threads = 4;
+    std::string parquet_compression = "zstd";
+    
+    // Export snapshots: gzip copies of these tables' full CSV / JSON exports
+    // (table -> formats), rebuilt when a table changes and served from disk
+    std::map<std::string, std::vector<std::string>> snapshot_tables;
+    std::string snapshot_path = Platform::DEFAULT_SNAPSHOT_PATH;
+    int snapshot_check_seconds = 60;
+    
+    // CSV exports: delimiter (one character), quoting (all | minimal |
+    // non_numeric), line ending (lf | crlf) and a UTF-8 BOM for Excel
+    std::string csv_delimiter = ",";
+    std::string csv_quoting = "all";
+    std::string csv_line_ending = "lf";
+    bool csv_bom = false;
+    
+    // Write-behind: "sync" applies writes in the request, "async" queues them
+    std::string write_mode = "sync";
+    int write_batch_size = 50;
+    int write_batch_linger_ms = 20;
+    int write_queue_limit = 10000;
+    
+    // Admission control (route classes: lookup, search, export, write, maintenance)
+    int max_concurrent_requests = 8;
+    int admission_queue_limit = 6;
+    int admission_queue_timeout_ms = 2000;
+    std::map<std::string, RouteClassLimit> route_class_limits = {
+        {"lookup",      {6, 8}},
+        {"search",      {3, 4}},
+        {"export",      {2, 2}},
+        {"write",       {2, 4}},
+        {"maintenance", {1, 0}}
+    };
+    
+    // Request tracing: sampled requests are written under <log_path>/traces
+    double trace_sample_rate = 0.0;
+    std::string trace_format = "chrome";   // chrome | otlp
+    int trace_flush_interval_seconds = 10;
+    int trace_buffer_size = 1024;
+    
+    // Query statistics: statements slower than the threshold go to slow_query.log
+    int slow_query_threshold_ms = 1000;
+    int query_stats_max_fingerprints = 1000;
     
     static Config load(const std::string& config_path) {
         Config config;
@@ -33,11 +119,66 @@ struct Config {
         config.port = j.value("port", 8787);
         config.cloudflare_token = j.value("cloudflare_token", "");
         config.log_level = j.value("log_level", "info");
-        config.log_path = j.value("log_path", "C:\\ProgramData\\FoxBridgeAgent\\logs");
+        config.log_path = j.value("log_path", Platform::DEFAULT_LOG_PATH);
+        config.log_async = j.value("log_async", true);
+        config.log_queue_size = j.value("log_queue_size", 8192);
+        config.log_overflow_policy = j.value("log_overflow_policy", "block");
+        config.access_log = j.value("access_log", true);
+        config.access_log_flush_ms = j.value("access_log_flush_ms", 1000);
         config.index_policy = j.value("index_policy", "auto");
         config.maintenance_window = j.value("maintenance_window", "02:00-04:00");
         config.max_retry_attempts = j.value("max_retry_attempts", 3);
         config.connection_timeout = j.value("connection_timeout", 30);
+        config.stream_idle_timeout = j.value("stream_idle_timeout", 30);
+        config.db_pool_size = j.value("db_pool_size", 4);
+        config.storage_backend = j.value("storage_backend", "odbc");
+        config.odbc_driver = j.value("odbc_driver", "Microsoft Visual FoxPro Driver");
+        config.text_encoding = j.value("text_encoding", "cp874");
+        config.memo_inline_bytes = j.value("memo_inline_bytes", 0);
+        config.http_worker_threads = j.value("http_worker_threads", 16);
+        config.accept_queue_limit = j.value("accept_queue_limit", 64);
+        config.coalesce_requests = j.value("coalesce_requests", true);
+        config.export_threads = j.value("export_threads", 4);
+        config.parquet_compression = j.value("parquet_compression", "zstd");
+        config.snapshot_path = j.value("snapshot_path", Platform::DEFAULT_SNAPSHOT_PATH);
+        config.snapshot_check_seconds = j.value("snapshot_check_seconds", 60);
+        config.csv_delimiter = j.value("csv_delimiter", ",");
+        config.csv_quoting = j.value("csv_quoting", "all");
+        config.csv_line_ending = j.value("csv_line_ending", "lf");
+        config.csv_bom = j.value("csv_bom", false);
+        config.write_mode = j.value("write_mode", "sync");
+        config.write_batch_size = j.value("write_batch_size", 50);
+        config.write_batch_linger_ms = j.value("write_batch_linger_ms", 20);
+        config.write_queue_limit = j.value("write_queue_limit", 10000);
+        config.max_concurrent_requests = j.value("max_concurrent_requests", 8);
+        config.admission_queue_limit = j.value("admission_queue_limit", 6);
+        config.admission_queue_timeout_ms = j.value("admission_queue_timeout_ms", 2000);
+        config.trace_sample_rate = j.value("trace_sample_rate", 0.0);
+        config.trace_format = j.value("trace_format", "chrome");
+        config.trace_flush_interval_seconds = j.value("trace_flush_interval_seconds", 10);
+        config.trace_buffer_size = j.value("trace_buffer_size", 1024);
+        config.slow_query_threshold_ms = j.value("slow_query_threshold_ms", 1000);
+        config.query_stats_max_fingerprints = j.value("query_stats_max_fingerprints", 1000);
+        
+        if (j.contains("table_encodings")) {
+            for (auto& [table, encoding] : j["table_encodings"].items()) {
+                config.table_encodings[table] = encoding.get<std::string>();
+            }
+        }
+        
+        if (j.contains("snapshot_tables")) {
+            for (auto& [table, formats] : j["snapshot_tables"].items()) {
+                config.snapshot_tables[table] = formats.get<std::vector<std::string>>();
+            }
+        }
+        
+        if (j.contains("route_class_limits")) {
+            for (auto& [name, limit] : j["route_class_limits"].items()) {
+                auto& target = config.route_class_limits[name];
+                target.concurrency = limit.value("concurrency", target.concurrency);
+                target.queue = limit.value("queue", target.queue);
+            }
+        }
         
         return config;
     }
@@ -52,6 +193,110 @@ struct Config {
         if (port < 1024 || port > 65535) {
             throw std::runtime_error("port must be between 1024 and 65535");
         }
+        if (stream_idle_timeout < 1) {
+            throw std::runtime_error("stream_idle_timeout must be at least 1");
+        }
+        if (db_pool_size < 1 || db_pool_size > 64) {
+            throw std::runtime_error("db_pool_size must be between 1 and 64");
+        }
+        if (storage_backend != "odbc" && storage_backend != "dbf") {
+            throw std::runtime_error("storage_backend must be 'odbc' or 'dbf'");
+        }
+        if (storage_backend == "odbc" && odbc_driver.empty()) {
+            throw std::runtime_error("odbc_driver is required for the odbc storage backend");
+        }
+        TextEncoding encoding;
+        if (!parseTextEncoding(text_encoding, encoding)) {
+            throw std::runtime_error("text_encoding must be 'cp874', 'cp1252' or 'utf-8'");
+        }
+        for (const auto& [table, name] : table_encodings) {
+            if (!parseTextEncoding(name, encoding)) {
+                throw std::runtime_error("table_encodings: unknown encoding '" + name + "' for " + table);
+            }
+        }
+        if (memo_inline_bytes < 0 || memo_inline_bytes > 64 * 1024 * 1024) {
+            throw std::runtime_error("memo_inline_bytes must be between 0 and 67108864");
+        }
+        if (http_worker_threads < 1 || http_worker_threads > 256) {
+            throw std::runtime_error("http_worker_threads must be between 1 and 256");
+        }
+        if (accept_queue_limit < 1 || accept_queue_limit > 4096) {
+            throw std::runtime_error("accept_queue_limit must be between 1 and 4096");
+        }
+        if (export_threads < 1 || export_threads > 64) {
+            throw std::runtime_error("export_threads must be between 1 and 64");
+        }
+        if (parquet_compression != "zstd" && parquet_compression != "snappy" &&
+            parquet_compression != "gzip" && parquet_compression != "none") {
+            throw std::runtime_error("parquet_compression must be 'zstd', 'snappy', 'gzip' or 'none'");
+        }
+        for (const auto& [table, formats] : snapshot_tables) {
+            if (table.size() < 5 || (table.substr(table.size() - 4) != ".dbf" &&
+                                     table.substr(table.size() - 4) != ".DBF")) {
+                throw std::runtime_error("snapshot_tables: '" + table + "' is not a .dbf file");
+            }
+            for (const auto& format : formats) {
+                if (format != "csv" && format != "json") {
+                    throw std::runtime_error("snapshot_tables: format must be 'csv' or 'json' for " + table);
+                }
+            }
+        }
+        if (snapshot_check_seconds < 1) {
+            throw std::runtime_error("snapshot_check_seconds must be at least 1");
+        }
+        if (csv_delimiter.size() != 1 || std::string("\"\r\n").find(csv_delimiter[0]) != std::string::npos) {
+            throw std::runtime_error("csv_delimiter must be one character other than a quote, CR or LF");
+        }
+        if (csv_quoting != "all" && csv_quoting != "minimal" && csv_quoting != "non_numeric") {
+            throw std::runtime_error("csv_quoting must be 'all', 'minimal' or 'non_numeric'");
+        }
+        if (csv_line_ending != "lf" && csv_line_ending != "crlf") {
+            throw std::runtime_error("csv_line_ending must be 'lf' or 'crlf'");
+        }
+        if (log_queue_size < 64) {
+            throw std::runtime_error("log_queue_size must be at least 64");
+        }
+        if (log_overflow_policy != "block" && log_overflow_policy != "drop_oldest") {
+            throw std::runtime_error("log_overflow_policy must be 'block' or 'drop_oldest'");
+        }
+        if (access_log_flush_ms < 10) {
+            throw std::runtime_error("access_log_flush_ms must be at least 10");
+        }
+        if (write_mode != "sync" && write_mode != "async") {
+            throw std::runtime_error("write_mode must be 'sync' or 'async'");
+        }
+        if (trace_sample_rate < 0.0 || trace_sample_rate > 1.0) {
+            throw std::runtime_error("trace_sample_rate must be between 0.0 and 1.0");
+        }
+        if (trace_format != "chrome" && trace_format != "otlp") {
+            throw std::runtime_error("trace_format must be 'chrome' or 'otlp'");
+        }
+        if (trace_flush_interval_seconds < 1 || trace_buffer_size < 1) {
+            throw std::runtime_error("trace_flush_interval_seconds and trace_buffer_size must be positive");
+        }
+        if (slow_query_threshold_ms < 0) {
+            throw std::runtime_error("slow_query_threshold_ms must not be negative");
+        }
+        if (query_stats_max_fingerprints < 16) {
+            throw std::runtime_error("query_stats_max_fingerprints must be at least 16");
+        }
+        static const char* const ROUTE_CLASSES[] = {"lookup", "search", "export", "write", "maintenance"};
+        for (const auto& [name, limit] : route_class_limits) {
+            if (std::find(std::begin(ROUTE_CLASSES), std::end(ROUTE_CLASSES), name) == std::end(ROUTE_CLASSES)) {
+                throw std::runtime_error("route_class_limits: unknown route class '" + name + 
+                                         "' (lookup, search, export, write or maintenance)");
+            }
+            if (limit.concurrency < 1 || limit.queue < 0) {
+                throw std::runtime_error("route_class_limits: " + name + 
+                                         " needs concurrency of at least 1 and a queue of at least 0");
+            }
+        }
+        // Keep idle workers around so /health and 503s are answered under load
+        if (max_concurrent_requests < 1 || 
+            max_concurrent_requests + admission_queue_limit >= http_worker_threads) {
+            throw std::runtime_error("max_concurrent_requests + admission_queue_limit must be "
+                                     "less than http_worker_threads");
+        }
     }
 };
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "RowSet.h"
+
+namespace FoxBridge {
+
+// Which fields are double-quoted. Record numbers never are.
+enum class CsvQuoting {
+    ALL,            // Every field; nulls as ""
+    MINIMAL,        // Only fields holding the delimiter, a quote, CR or LF; nulls empty
+    NON_NUMERIC     // Every field but numbers and logicals, which are quoted as MINIMAL
+};
+
+// The CSV flavour of exports. The defaults are the agent's original output;
+// Excel wants bom = true to read UTF-8 (Thai text) without an import wizard.
+struct CsvDialect {
+    char delimiter = ',';
+    CsvQuoting quoting = CsvQuoting::ALL;
+    bool crlf = false;          // Lines end in CR LF instead of LF
+    bool bom = false;           // UTF-8 byte order mark before the header
+    
+    // Short text that differs between dialects, for cache file names
+    std::string tag() const;
+};
+
+bool parseCsvQuoting(const std::string& name, CsvQuoting& quoting);
+
+// Writes RowSets as CSV. Whether a field needs quoting is found 16 bytes at
+// a time (SSE2) or 8 (elsewhere), and quoted fields are copied in runs
+// between their quotes. Output goes through a cursor into a string sized
+// once for the rows and grown geometrically after that, not byte by byte.
+class CsvEncoder {
+public:
+    explicit CsvEncoder(const CsvDialect& dialect = {});
+    
+    // The BOM (when asked for) and a header of the schema's column names
+    void writeHeader(const RowSchema& schema, std::string& out) const;
+    void writeRows(const RowSet& rows, std::string& out) const;
+    
+    // writeHeader (unless `header` is false) then writeRows; nothing for a
+    // result without columns
+    void write(const RowSet& rows, std::string& out, bool header = true) const;
+    
+    // Index of the first delimiter, '"', CR or LF in `text`, or its size
+    static size_t findSpecial(std::string_view text, char delimiter);
+
+private:
+    CsvDialect dialect_;
+};
+
+} // namespace FoxBridge
@@ -4,87 +4,188 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <sql.h>
 #include <sqlext.h>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
+#include "StorageBackend.h"
+#include "WorkerPool.h"
 
 namespace FoxBridge {
 
-enum class IndexStatus {
-    OK,
-    PENDING,
-    FAILED
+// ODBC failure classes used for retry decisions
+enum class SqlErrorClass {
+    LOCK_CONFLICT,   // Record/file locked by another user - retry with backoff
+    TRANSIENT,       // Connection hiccup - retry
+    FATAL            // Syntax, missing file, cancellation - do not retry
 };
 
-struct QueryResult {
-    bool success;
+struct SqlError {
+    std::string sql_state;
+    SQLINTEGER native_error = 0;
     std::string message;
-    nlohmann::json data;
-    IndexStatus index_status;
-    std::vector<std::string> warnings;
+    SqlErrorClass kind = SqlErrorClass::FATAL;
 };
 
-class DatabaseManager {
+// ODBC storage backend: the Microsoft Visual FoxPro driver through odbc32,
+// or unixODBC with a VFP-capable driver on Linux
+class DatabaseManager : public StorageBackend {
 public:
-    explicit DatabaseManager(const std::string& db_folder_path);
-    ~DatabaseManager();
+    explicit DatabaseManager(const std::string& db_folder_path, 
+                             size_t pool_size = 4,
+                             int connection_timeout = 30,
+                             int max_retry_attempts = 3,
+                             const std::string& odbc_driver = "Microsoft Visual FoxPro Driver");
+    ~DatabaseManager() override;
     
-    // Disable copy
-    DatabaseManager(const DatabaseManager&) = delete;
-    DatabaseManager& operator=(const DatabaseManager&) = delete;
+    std::string name() const override { return "odbc"; }
     
     // DBF file operations
-    QueryResult exportJSON(const std::string& filename, const std::string& docnum = "");
-    QueryResult exportCSV(const std::string& filename, const std::string& docnum = "");
-    QueryResult search(const std::string& filename, const std::map<std::string, std::string>& filters, int limit = 100);
-    QueryResult getAllRecords(const std::string& filename, int limit = 1000);
-    QueryResult findByDocnum(const std::string& docnum);
+    QueryResult exportJSON(const std::string& filename, const std::string& docnum) override;
+    QueryResult search(const std::string& filename, const std::map<std::string, std::string>& filters,
+                       int limit) override;
+    QueryResult getAllRecords(const std::string& filename, int limit) override;
+    QueryResult searchRange(const std::string& filename, const std::map<std::string, std::string>& filters,
+                            uint32_t first, uint32_t last) override;
+    QueryResult findByDocnum(const std::string& docnum, bool first_only,
+                             std::chrono::milliseconds timeout) override;
+    QueryResult findByDocnums(const std::vector<std::string>& docnums) override;
     
     // CRUD operations
-    QueryResult add(const std::string& filename, const nlohmann::json& record);
-    QueryResult update(const std::string& filename, const nlohmann::json& where, const nlohmann::json& updates);
-    QueryResult deleteRecords(const std::string& filename, const nlohmann::json& where);
-    QueryResult undeleteRecords(const std::string& filename, const nlohmann::json& where);
-    QueryResult pack(const std::string& filename);
+    QueryResult add(const std::string& filename, const nlohmann::json& record) override;
+    QueryResult update(const std::string& filename, const nlohmann::json& where,
+                       const nlohmann::json& updates) override;
+    QueryResult deleteRecords(const std::string& filename, const nlohmann::json& where) override;
+    QueryResult undeleteRecords(const std::string& filename, const nlohmann::json& where) override;
+    QueryResult pack(const std::string& filename) override;
     
-    // Index maintenance
-    QueryResult getIndexStatus(const std::string& filename);
-    QueryResult reindex(const std::string& filename);
+    // Group commit: applies all operations on one connection inside one
+    // transaction (when the driver allows it); one result per operation
+    std::vector<QueryResult> applyWriteBatch(const std::string& filename,
+                                             const std::vector<WriteOperation>& operations) override;
     
-    bool isConnected() const { return connected_; }
+    QueryResult reindex(const std::string& filename) override;
+    
+    bool isConnected() const override { return connected_; }
+    
+    // Connection pool utilization
+    size_t poolSize() const override { return connections_.size(); }
+    size_t poolInUse() override;
+    
+    // Pool utilization and lock-retry counters
+    nlohmann::json getStats() override;
+    
+    // Stateless helper on the query path, public so foxbridge_bench can drive it
+    static std::string buildWhereClause(const nlohmann::json& where);
+    
+    // Reads the remaining rows of an executed statement into `rows`, with a
+    // schema from the statement's columns and text converted from `encoding`
+    // to UTF-8; adds the column data size to `bytes_fetched`. Memo columns
+    // follow `memo` when it names a table and the statement selects _recno.
+    // The first `skip` rows are fetched past without reading any data.
+    static void fetchRows(SQLHSTMT stmt, RowSet& rows, size_t& bytes_fetched,
+                          TextEncoding encoding, const MemoPolicy& memo = {}, size_t skip = 0);
     
 private:
-    // Connection
-    std::string db_folder_path_;
+    // Connection pool
+    std::string odbc_driver_;
     SQLHENV henv_;
-    SQLHDBC hdbc_;
-    bool connected_;
+    std::vector<SQLHDBC> connections_;
+    std::vector<SQLHDBC> idle_connections_;
+    std::unordered_set<SQLHDBC> stale_connections_;  // Reconnect failed; retried on acquire
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+    size_t pool_size_;
+    std::chrono::seconds connection_timeout_;
+    std::atomic<bool> connected_;
+    
+    // Lock-conflict retry
+    int max_retry_attempts_;
+    std::atomic<uint64_t> retry_count_{0};
+    std::atomic<uint64_t> lock_conflicts_{0};
+    std::atomic<uint64_t> lock_wait_ms_{0};
+    std::atomic<uint64_t> retries_exhausted_{0};
+    std::atomic<uint64_t> reconnects_{0};
+    
+    // Runs per-table probes concurrently, one pooled connection each
+    std::unique_ptr<WorkerPool> fanout_workers_;
     
     // Helper methods
     bool connect();
     void disconnect();
-    bool executeSQL(const std::string& sql, nlohmann::json& result);
-    bool executeSQLCount(const std::string& sql, int& count);
+    SQLHDBC acquireConnection(std::chrono::steady_clock::time_point deadline);
+    void releaseConnection(SQLHDBC hdbc);
+    // Disconnects a pooled handle that hit a connection error (08xxx) and
+    // connects it again in place
+    bool reopenConnection(SQLHDBC hdbc);
+    // `encoding` is the table's code page: literals in `sql` are converted
+    // to it and fetched text is converted back to UTF-8. The first `skip`
+    // rows of a SELECT are fetched past, not read.
+    bool executeSQL(const std::string& sql, RowSet& result, TextEncoding encoding,
+                    const MemoPolicy& memo = {}, size_t skip = 0);
+    // Same, rows as JSON objects for callers that add fields to them
+    bool executeSQL(const std::string& sql, nlohmann::json& result, TextEncoding encoding,
+                    const MemoPolicy& memo = {});
+    bool executeStatement(const std::string& sql, RowSet& result, size_t& bytes_fetched,
+                          TextEncoding encoding, const MemoPolicy& memo, size_t skip);
+    
+    // page(): COUNT(*) of the matches, then TOP offset + limit of them in
+    // sort order with the first `offset` skipped by SQLFetch alone
+    QueryResult searchPage(const std::string& filename, const PageRequest& request,
+                           size_t& matches) override;
+    
+    // search() and searchRange(): TOP `limit` (none when negative) among
+    // records first..last
+    QueryResult searchRecords(const std::string& filename, const std::map<std::string, std::string>& filters,
+                              int limit, uint32_t first, uint32_t last);
+    
+    // Memo handling for SELECTs from `table`: the configured policy if it
+    // has memo fields, and the column list that goes with it
+    MemoPolicy memoPolicy(const std::string& table);
+    static std::string selectList(const MemoPolicy& memo);
+    // Single-number result of `sql`, such as SELECT COUNT(*)
+    bool executeSQLCount(const std::string& sql, TextEncoding encoding, size_t& count);
     
     // String utilities
-    std::string sanitizeFilename(const std::string& filename);
     std::string sanitizeTableName(const std::string& table);
     std::string getTableNameFromFile(const std::string& filename);
     std::string buildConnectionString();
-    std::string buildWhereClause(const nlohmann::json& where);
-    std::string jsonToCSV(const nlohmann::json& data);
+    std::string buildInList(const std::vector<std::string>& values, size_t begin, size_t end);
+    std::string buildInsertSQL(const std::string& table, const nlohmann::json& record);
+    std::string buildUpdateSQL(const std::string& table, const nlohmann::json& where,
+                               const nlohmann::json& updates);
+    std::string buildSetDeletedSQL(const std::string& table, const nlohmann::json& where, bool deleted);
+    std::string buildWriteSQL(const std::string& table, const WriteOperation& operation);
     
-    // Index utilities
-    IndexStatus checkIndexHealth(const std::string& filename);
+    // Concurrent per-table probes
+    struct FanOutResult {
+        std::vector<std::pair<std::string, nlohmann::json>> completed;  // completion order
+        std::vector<std::string> failed;
+        std::vector<std::string> timed_out;
+    };
+    FanOutResult fanOut(const std::vector<std::string>& tables,
+                        std::function<bool(const std::string&, nlohmann::json&)> probe,
+                        bool stop_on_first_hit,
+                        std::chrono::steady_clock::time_point deadline);
     
     // File utilities
-    bool fileExists(const std::string& filename);
     std::vector<std::string> listDBFFiles();
     
     // Error handling
     void logError(SQLHANDLE handle, SQLSMALLINT type);
+    SqlError readError(SQLHANDLE handle, SQLSMALLINT type);
+    static SqlErrorClass classifyError(const std::string& sql_state, SQLINTEGER native_error);
+    static bool isConnectionError(const SqlError& error);
+    static std::chrono::milliseconds retryBackoff(int attempt);
 };
 
 } // namespace FoxBridge
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "StorageBackend.h"
+
+namespace FoxBridge {
+
+class DbfTable;
+
+// Native storage backend: reads .dbf/.fpt files directly with large
+// sequential reads, no ODBC driver, so the agent can serve from any host
+// that mounts the ExpressD share. Deleted records are skipped, as the VFP
+// driver does by default. Writes are refused - VFP record locking is left
+// to the ODBC backend.
+class DbfBackend : public StorageBackend {
+public:
+    DbfBackend(const std::string& db_folder_path, std::chrono::seconds lookup_timeout);
+    
+    std::string name() const override { return "dbf"; }
+    
+    // DBF file operations
+    QueryResult exportJSON(const std::string& filename, const std::string& docnum) override;
+    QueryResult search(const std::string& filename, const std::map<std::string, std::string>& filters,
+                       int limit) override;
+    QueryResult getAllRecords(const std::string& filename, int limit) override;
+    QueryResult searchRange(const std::string& filename, const std::map<std::string, std::string>& filters,
+                            uint32_t first, uint32_t last) override;
+    QueryResult findByDocnum(const std::string& docnum, bool first_only,
+                             std::chrono::milliseconds timeout) override;
+    QueryResult findByDocnums(const std::vector<std::string>& docnums) override;
+    
+    // CRUD operations - not supported
+    QueryResult add(const std::string& filename, const nlohmann::json& record) override;
+    QueryResult update(const std::string& filename, const nlohmann::json& where,
+                       const nlohmann::json& updates) override;
+    QueryResult deleteRecords(const std::string& filename, const nlohmann::json& where) override;
+    QueryResult undeleteRecords(const std::string& filename, const nlohmann::json& where) override;
+    QueryResult pack(const std::string& filename) override;
+    std::vector<QueryResult> applyWriteBatch(const std::string& filename,
+                                             const std::vector<WriteOperation>& operations) override;
+    QueryResult reindex(const std::string& filename) override;
+    
+    bool isConnected() const override { return true; }
+    
+    // No connection pool; in-use counts running scans
+    size_t poolSize() const override { return 0; }
+    size_t poolInUse() override { return active_scans_; }
+    
+    nlohmann::json getStats() override;
+
+private:
+    std::chrono::seconds lookup_timeout_;
+    
+    std::atomic<uint64_t> scans_{0};
+    std::atomic<uint64_t> records_scanned_{0};
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<size_t> active_scans_{0};
+    
+    // Calls `visit` for each live record numbered first..last of the table
+    // at `path` until it returns false; `visit` appends what it keeps to
+    // `records`. Gives up on the deadline or request cancellation and
+    // returns false then. `statement` stands in for the SQL text in query
+    // statistics.
+    bool scanTable(const std::filesystem::path& path, const std::string& statement,
+                   std::chrono::steady_clock::time_point deadline,
+                   const std::function<bool(DbfTable&, uint32_t, const char*, RowSet&)>& visit,
+                   RowSet& records, uint32_t first = 1, uint32_t last = UINT32_MAX);
+    
+    // page(): one pass keeping the sort keys of the first offset + limit
+    // matches, then only the page's records are read
+    QueryResult searchPage(const std::string& filename, const PageRequest& request,
+                           size_t& matches) override;
+    
+    // search() and searchRange(): up to `limit` matches among records first..last
+    QueryResult searchRecords(const std::string& filename, const std::map<std::string, std::string>& filters,
+                              size_t limit, uint32_t first, uint32_t last);
+    std::chrono::steady_clock::time_point requestDeadline(std::chrono::milliseconds timeout) const;
+    
+    // Code page and memo policy of a table about to be read
+    void prepareTable(DbfTable& table, const std::filesystem::path& path);
+    
+    static QueryResult readOnly(const std::string& operation);
+};
+
+} // namespace FoxBridge
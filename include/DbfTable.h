@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include "TextEncoding.h"
+#include "MemoFile.h"
+#include "RowSet.h"
+
+namespace FoxBridge {
+
+struct DbfColumn {
+    std::string name;           // Lower case, as the VFP ODBC driver reports it
+    char type;                  // C, N, F, D, L, M, I, B, Y, T, ...
+    uint32_t offset;            // Within the record, after the deletion flag
+    uint8_t length;
+    uint8_t decimals;
+    int null_bit = -1;          // Bit in _NullFlags, or -1 if not nullable
+    int varlength_bit = -1;     // V/Q: set when the value is shorter than the field
+};
+
+// Read-only view of a FoxPro / Visual FoxPro table opened straight from its
+// files, no driver involved. Opens with shared access and reads the record
+// count once, so records ExpressD appends mid-scan are left for the next
+// request. Not thread-safe: each request opens its own DbfTable.
+class DbfTable {
+public:
+    explicit DbfTable(const std::filesystem::path& path);
+    ~DbfTable();
+    
+    // Disable copy
+    DbfTable(const DbfTable&) = delete;
+    DbfTable& operator=(const DbfTable&) = delete;
+    
+    const std::vector<DbfColumn>& columns() const { return columns_; }
+    const DbfColumn* column(const std::string& name) const;    // Case-insensitive; null if absent
+    
+    uint32_t recordCount() const { return record_count_; }
+    size_t recordLength() const { return record_length_; }
+    uint8_t codePage() const { return code_page_; }
+    
+    // Code page of C, V and M fields; value() converts them to UTF-8
+    TextEncoding encoding() const { return encoding_; }
+    void setEncoding(TextEncoding encoding) { encoding_ = encoding; }
+    
+    // Calls `visit(recno, record)` for every record numbered first..last in
+    // file order, deleted ones included, until it returns false. `record`
+    // points at the deletion flag and is only valid during the call.
+    // Returns the bytes read.
+    uint64_t scan(const std::function<bool(uint32_t, const char*)>& visit,
+                  uint32_t first = 1, uint32_t last = UINT32_MAX);
+    
+    // Reads record `recno` (1-based) into `record`; false if out of range
+    bool readRecord(uint32_t recno, std::vector<char>& record);
+    
+    static bool isDeleted(const char* record) { return record[0] == '*'; }
+    
+    // Raw field bytes, blank padding included
+    static std::string_view raw(const char* record, const DbfColumn& column) {
+        return std::string_view(record + 1 + column.offset, column.length);
+    }
+    
+    // Field value as the VFP driver returns it through SQL_C_CHAR: padded
+    // UTF-8 text for C, trimmed numbers, YYYY-MM-DD dates, "1"/"0" logicals, memo
+    // text read from the .fpt, null for .NULL. and empty dates
+    nlohmann::json value(const char* record, const DbfColumn& column);
+    
+    // Columns of the rows appendRow() produces: the table's fields in file
+    // order, led by "_recno" for tables with memos when a memo policy is set
+    const std::shared_ptr<const RowSchema>& schema();
+    
+    // Whole record appended to `rows`, which must use schema(). With a memo
+    // policy set, memo fields follow it.
+    void appendRow(RowSet& rows, const char* record, uint32_t recno);
+    
+    bool hasMemo() const { return has_memo_; }
+    void setMemoPolicy(MemoPolicy policy) {
+        memo_policy_ = std::move(policy);
+        schema_.reset();
+    }
+    
+    // Block number a memo field points at in the .fpt; 0 for an empty memo
+    static uint32_t memoBlock(const char* record, const DbfColumn& column);
+    
+    // Memo file, opened on first use; null if the table has none
+    MemoFile* memoFile();
+
+private:
+    std::filesystem::path path_;
+    std::FILE* file_ = nullptr;
+    std::vector<DbfColumn> columns_;
+    uint32_t record_count_ = 0;
+    size_t header_length_ = 0;
+    size_t record_length_ = 0;
+    uint8_t code_page_ = 0;
+    TextEncoding encoding_ = TextEncoding::UTF8;
+    DbfColumn null_flags_{};        // Hidden _NullFlags column; length 0 if none
+    
+    bool has_memo_ = false;
+    MemoPolicy memo_policy_;
+    std::unique_ptr<MemoFile> memo_;
+    bool memo_opened_ = false;
+    
+    std::shared_ptr<const RowSchema> schema_;
+    
+    bool flagSet(const char* record, int bit) const;     // Bit of _NullFlags
+    bool isNull(const char* record, const DbfColumn& column) const;
+    
+    // Appends what value() returns as text to `out`; false for null
+    bool text(const char* record, const DbfColumn& column, std::string& out);
+    std::string readMemo(const char* record, const DbfColumn& column);
+    void appendMemo(RowSet& rows, const char* record, const DbfColumn& column, uint32_t recno);
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include "StorageBackend.h"
+
+namespace FoxBridge {
+
+// A /view page request: ?page=3&size=100&sort=NAME&desc=1. Any other
+// non-empty parameter filters its column by substring, as search does;
+// page, size, sort and desc win over columns of the same name.
+struct ViewQuery {
+    PageRequest request;
+    size_t page = 1;
+    size_t size = DEFAULT_SIZE;
+    
+    static constexpr size_t DEFAULT_SIZE = 100;
+    static constexpr size_t MAX_SIZE = 1000;
+    
+    // Later pages cost more (see API.md); this also keeps the offset small
+    static constexpr size_t MAX_PAGE = 100000;
+};
+
+// Parses the (URL-encoded) query string of a /view request
+ViewQuery parseViewQuery(const std::string& query);
+
+// Appends `text` with &, <, >, " and ' replaced by entities; runs without
+// any of them are copied in one piece
+void appendHtmlEscaped(std::string& out, std::string_view text);
+
+// Writes one page of a table as an HTML document: sortable column headers,
+// a filter form, the rows and page links. Output is handed to `write` in
+// chunks of about CHUNK_BYTES, so its size follows the page, not the table.
+class HtmlViewWriter {
+public:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+    
+    HtmlViewWriter(const std::string& filename, const ViewQuery& query,
+                   std::function<void(const char*, size_t)> write);
+    
+    // `rows` is the page; `matches` counts the records on all pages
+    void writePage(const RowSet& rows, size_t matches);
+    void writeError(const std::string& message);
+
+private:
+    std::string filename_;
+    const ViewQuery& query_;
+    std::function<void(const char*, size_t)> write_;
+    std::string buffer_;
+    
+    void beginDocument(const std::string& title);
+    void endDocument();
+    void writeHeader(const RowSet& rows);
+    void writeFilterRow(const RowSet& rows);
+    void writePageLinks(size_t pages);
+    
+    // Escaped link to this view with the current filters and the given
+    // page and sort
+    void appendLink(size_t page, const std::string& sort, bool descending);
+    void flushIfFull();
+    void flush();
+};
+
+} // namespace FoxBridge
@@ -9,8 +9,18 @@
 #include <boost/beast/http.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <nlohmann/json.hpp>
-#include "DatabaseManager.h"
+#include "StorageBackend.h"
+#include "BinaryEncoding.h"
+#include "RequestCoalescer.h"
+#include "AdmissionController.h"
+#include "RequestContext.h"
+#include "WriteBehindQueue.h"
+#include "Router.h"
+#include "Tracer.h"
+#include "AccessLog.h"
 #include "Config.h"
+#include "TableExport.h"
+#include "SnapshotCache.h"
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -21,56 +31,200 @@ namespace FoxBridge {
 
 class HttpServer {
 public:
-    HttpServer(const Config& config, std::shared_ptr<DatabaseManager> db_manager);
+    HttpServer(const Config& config, std::shared_ptr<StorageBackend> db_manager);
     ~HttpServer();
     
     void start();
     void stop();
     bool isRunning() const { return running_; }
     
+    // Stateless helpers on the request path, public so foxbridge_bench can drive them
+    static std::map<std::string, std::string> parseQueryString(const std::string& queryString);
+    // `json` in `format`: JSON, or the same document as MessagePack / CBOR
+    static void sendJsonResponse(http::response<http::string_body>& res, int status, 
+                                 const nlohmann::json& json, BodyFormat format = BodyFormat::JSON);
+    // `envelope` with `rows` as its "data", serialized straight from the rows
+    static void sendJsonResponse(http::response<http::string_body>& res, int status,
+                                 const nlohmann::json& envelope, const RowSet& rows,
+                                 BodyFormat format = BodyFormat::JSON);
+    
 private:
     Config config_;
-    std::shared_ptr<DatabaseManager> db_manager_;
+    std::shared_ptr<StorageBackend> db_manager_;
     std::atomic<bool> running_;
     std::unique_ptr<std::thread> server_thread_;
+    RequestCoalescer coalescer_;
+    std::unique_ptr<AdmissionController> admission_;
+    std::unique_ptr<WriteBehindQueue> write_queue_;
+    std::unique_ptr<Tracer> tracer_;
+    std::unique_ptr<AccessLog> access_log_;
+    std::shared_ptr<StorageBackend> range_reader_;   // createRangeReader(config_, db_manager_)
+    std::unique_ptr<TableExport> table_export_;
+    std::unique_ptr<SnapshotCache> snapshots_;     // Null without snapshot_tables
+    
+    // In-flight requests checked by the watchdog for deadline expiry and
+    // client disconnects
+    struct WatchedRequest {
+        std::shared_ptr<RequestContext> context;
+        tcp::socket::native_handle_type handle;
+    };
+    std::mutex watch_mutex_;
+    std::map<uint64_t, WatchedRequest> watched_requests_;
+    uint64_t next_watch_id_ = 0;
+    std::unique_ptr<std::thread> watchdog_thread_;
+    
+    // Request line split once per request and matched against the route table
+    struct RequestLine {
+        std::string method;
+        std::string target;
+        std::string path;
+        std::string query;
+        RouteMatch route;
+        bool debug_trace = false;   // X-Debug-Trace: answer with Server-Timing
+        BodyFormat format = BodyFormat::JSON;   // From Accept
+    };
     
     void run();
+    void watchdogLoop();
+    uint64_t watchRequest(std::shared_ptr<RequestContext> context, 
+                          tcp::socket::native_handle_type handle);
+    void unwatchRequest(uint64_t id);
+    
+    // Unwatches the request when it goes out of scope, so a write that
+    // throws on a reset connection cannot leave its handle to the watchdog
+    class WatchGuard {
+    public:
+        WatchGuard(HttpServer& server, uint64_t id) : server_(server), id_(id) {}
+        ~WatchGuard() { server_.unwatchRequest(id_); }
+        
+        WatchGuard(const WatchGuard&) = delete;
+        WatchGuard& operator=(const WatchGuard&) = delete;
+    
+    private:
+        HttpServer& server_;
+        uint64_t id_;
+    };
+    void handleConnection(tcp::socket& socket);
+    
+    // Answers a connection accepted while the worker queue is full with 503
+    // on the accept thread, without reading its request
+    void shedConnection(tcp::socket& socket);
+    std::atomic<uint64_t> accept_shed_{0};
+    
+    // Takes the route class's admission ticket; an empty ticket means `res`
+    // holds the 503 to send instead
+    AdmissionController::Ticket admitRequest(http::response<http::string_body>& res,
+                                             const RequestLine& line);
+    
+    // Authenticates and admits a request that writes its own response; an
+    // empty ticket means `res` holds the error to send instead
+    AdmissionController::Ticket admitStream(const http::request<http::string_body>& req,
+                                            http::response<http::string_body>& res,
+                                            const RequestLine& line);
+    
+    // GET /api/dbf/memo: writes the memo straight to the socket in chunks,
+    // honouring a single Range. False when it only filled `res` with an
+    // error for the caller to send.
+    bool streamMemo(tcp::socket& socket, const http::request<http::string_body>& req,
+                    http::response<http::string_body>& res, const RequestLine& line,
+                    size_t& bytes_sent);
+    
+    // GET /api/dbf/arrow and /api/dbf/parquet: writes the Arrow IPC stream
+    // (one record batch per chunk) or the Parquet file (one row group per
+    // chunk, then the footer) to the socket with chunked encoding. False
+    // when it only filled `res` with an error for the caller to send.
+    bool streamExport(tcp::socket& socket, const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res, const RequestLine& line,
+                      size_t& bytes_sent);
+    
+    // GET /api/dbf/csv and /api/dbf/json of a whole table: sends the gzip
+    // snapshot with sendfile / TransmitFile, honouring If-None-Match and a
+    // single Range. False when no current snapshot answers the request,
+    // which then goes the usual way; otherwise `streamed` tells whether the
+    // response went out or `res` holds an error for the caller to send.
+    bool streamSnapshot(tcp::socket& socket, const http::request<http::string_body>& req,
+                        http::response<http::string_body>& res, const RequestLine& line,
+                        bool& streamed, size_t& bytes_sent);
+    
+    // Export body of `table` for the snapshot cache, as the endpoint sends it
+    bool buildSnapshot(const std::string& table, SnapshotFormat format, std::string& body,
+                       std::string& error);
+    
+    // GET /view: one page of the table as HTML, written to the socket with
+    // chunked encoding as it is rendered. False when it only filled `res`
+    // with an error for the caller to send.
+    bool streamView(tcp::socket& socket, const http::request<http::string_body>& req,
+                    http::response<http::string_body>& res, const RequestLine& line,
+                    size_t& bytes_sent);
+    void logAccess(const RequestLine& line, int status, std::chrono::microseconds latency,
+                   size_t bytes, const std::shared_ptr<RequestTrace>& trace);
     void handleRequest(http::request<http::string_body>& req, 
-                      http::response<http::string_body>& res);
+                      http::response<http::string_body>& res,
+                      RequestCoalescer::SharedResponse& shared,
+                      const RequestLine& line);
+    // Runs an admitted request, answering 504 if it was cancelled meanwhile
+    void routeAdmitted(http::request<http::string_body>& req, 
+                      http::response<http::string_body>& res,
+                      const RequestLine& line);
+    void routeRequest(http::request<http::string_body>& req, 
+                     http::response<http::string_body>& res,
+                     const RequestLine& line);
     
     bool authenticate(const http::request<http::string_body>& req);
     nlohmann::json handleHealth();
     
+    // Metrics
+    void registerMetrics();
+    void unregisterMetrics();
+    std::string handleMetrics();
+    void sendMetricsResponse(http::response<http::string_body>& res, const std::string& text);
+    nlohmann::json handleAdmissionStats();
+    nlohmann::json handleDatabaseStats();
+    nlohmann::json handleTrace(const std::string& trace_id, int& status);
+    nlohmann::json handleQueryStats(const std::string& query, int& status);
+    nlohmann::json handleQueryStatsReset();
+    
     // DBF file operations
-    nlohmann::json handleExportJSON(const std::string& filename, const std::string& docnum = "");
+    // Envelope without "data"; the records are left in `rows`
+    nlohmann::json handleExportJSON(const std::string& filename, const std::string& docnum, RowSet& rows);
     nlohmann::json handleExportCSV(const std::string& filename, const std::string& docnum = "");
-    nlohmann::json handleSearch(const std::string& filename, const std::string& queryParams);
-    std::string handleViewHTML(const std::string& filename);
-    nlohmann::json handleFindDocnum(const std::string& docnum);
+    
+    // One record-number part of a whole-table export (?part=i&parts=n)
+    nlohmann::json handleExportPart(const std::string& filename, const ExportPart& part, RowSet& rows);
+    // Fixes the record count a split export divides: the table's own, or
+    // the client's ?records=N when it still matches. False when it only
+    // filled `res` with an error (412 when the table has changed).
+    bool pinExportPart(const std::string& filename, ExportPart& part,
+                       http::response<http::string_body>& res, BodyFormat format);
+    nlohmann::json handleSearch(const std::string& filename, const std::string& queryParams, RowSet& rows);
+    nlohmann::json handleFindDocnum(const std::string& docnum, bool first_only = false);
+    nlohmann::json handleFindDocnumBatch(const nlohmann::json& body);
     nlohmann::json handleDirectLookup(const std::string& docnum);
     
     // CRUD operations
     nlohmann::json handleAdd(const std::string& filename, const nlohmann::json& body);
     void sendCSVResponse(http::response<http::string_body>& res, const std::string& csv,
                         const std::string& filename);
-    void sendHTMLResponse(http::response<http::string_body>& res, const std::string& html);
     
     std::string extractFilename(const std::string& path);
     std::string sanitizeFilename(const std::string& filename);
-    std::map<std::string, std::string> parseQueryString(const std::string& queryString);
     nlohmann::json handleUpdate(const std::string& filename, const nlohmann::json& body);
     nlohmann::json handleDelete(const std::string& filename, const nlohmann::json& body);
     nlohmann::json handleUndelete(const std::string& filename, const nlohmann::json& body);
     nlohmann::json handlePack(const std::string& filename);
     
+    // Write-behind
+    bool useAsyncWrites(const std::string& query);
+    void enqueueWrite(http::response<http::string_body>& res, const std::string& filename,
+                      WriteOperation operation, BodyFormat format);
+    nlohmann::json handleJobStatus(const std::string& job_id, int& status);
+    
     // Maintenance
     nlohmann::json handleReindex(const std::string& filename);
     nlohmann::json handleIndexStatus(const std::string& filename);
     
-    void sendJsonResponse(http::response<http::string_body>& res, int status, 
-                         const nlohmann::json& json);
     void sendError(http::response<http::string_body>& res, int status, 
-                  const std::string& message);
+                  const std::string& message, BodyFormat format = BodyFormat::JSON);
 };
 
 } // namespace FoxBridge
@@ -8,7 +8,7 @@
 #include <condition_variable>
 #include <memory>
 #include <chrono>
-#include "DatabaseManager.h"
+#include "StorageBackend.h"
 
 namespace FoxBridge {
 
@@ -21,7 +21,7 @@ struct MaintenanceTask {
 
 class IndexMaintenance {
 public:
-    explicit IndexMaintenance(std::shared_ptr<DatabaseManager> db_manager,
+    explicit IndexMaintenance(std::shared_ptr<StorageBackend> db_manager,
                              const std::string& maintenance_window);
     ~IndexMaintenance();
     
@@ -32,9 +32,10 @@ public:
     void queueVerify(const std::string& table);
     
     bool isInMaintenanceWindow() const;
+    size_t queueDepth();
     
 private:
-    std::shared_ptr<DatabaseManager> db_manager_;
+    std::shared_ptr<StorageBackend> db_manager_;
     std::string maintenance_window_;  // Format: "HH:MM-HH:MM"
     
     std::queue<MaintenanceTask> task_queue_;
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+
+namespace FoxBridge {
+
+// One memo in a .fpt file: where its data starts and how long it is
+struct MemoBlock {
+    uint32_t type = 0;          // 0 = picture/binary, 1 = text
+    uint64_t offset = 0;        // Of the first data byte, past the block header
+    uint32_t length = 0;
+};
+
+// How memo fields appear in returned rows. Memos up to `inline_bytes` are
+// inlined; larger ones (all of them when 0) become references to the memo
+// endpoint, so rows stay small and memo data is only read on request.
+struct MemoPolicy {
+    std::string table;          // File name used in references
+    size_t inline_bytes = 0;
+};
+
+// Read-only FoxPro / VFP memo file (.fpt) read by block number, no driver
+// involved. Memo data is read in caller-sized pieces, so a large memo is
+// never held in memory whole. Not thread-safe: one MemoFile per reader.
+class MemoFile {
+public:
+    explicit MemoFile(const std::filesystem::path& path);
+    ~MemoFile();
+    
+    // Disable copy
+    MemoFile(const MemoFile&) = delete;
+    MemoFile& operator=(const MemoFile&) = delete;
+    
+    // The .fpt next to a .dbf (either case of extension); empty if none
+    static std::filesystem::path pathFor(const std::filesystem::path& table_path);
+    
+    uint32_t blockSize() const { return block_size_; }
+    
+    // Reads the block header; false for block 0, out-of-range blocks and
+    // damaged headers
+    bool locate(uint32_t block, MemoBlock& memo);
+    
+    // Up to `size` bytes of the memo starting `offset` bytes into it;
+    // returns the count read, 0 past the end
+    size_t read(const MemoBlock& memo, uint64_t offset, char* buffer, size_t size);
+    
+    // Whole memo, for inlining
+    std::string readAll(const MemoBlock& memo);
+
+private:
+    std::filesystem::path path_;
+    std::FILE* file_ = nullptr;
+    uint32_t block_size_ = 0;
+    uint64_t file_size_ = 0;
+};
+
+} // namespace FoxBridge
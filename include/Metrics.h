@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include "Router.h"
+
+namespace FoxBridge {
+
+// Process-wide metrics rendered in Prometheus text format.
+//
+// Hot-path counters live in per-thread shards: each thread only ever writes
+// its own shard (plain load/store, no locked instructions, no shared cache
+// lines), and a scrape sums all shards. Values read from other objects
+// (pool usage, queue depths) are registered as callbacks evaluated at scrape
+// time instead of being pushed on every change.
+class Metrics {
+public:
+    // Latency bucket upper bounds in seconds, shared by all histograms
+    static constexpr std::array<double, 14> LATENCY_BUCKETS = {
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+        0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0
+    };
+    static constexpr size_t BUCKET_COUNT = LATENCY_BUCKETS.size() + 1;   // + "+Inf"
+    static constexpr size_t STATUS_CLASSES = 5;                         // 1xx..5xx
+    
+    enum class CallbackType { GAUGE, COUNTER };
+    using Callback = std::function<double()>;
+    
+    static Metrics& instance();
+    
+    // Disable copy
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+    
+    void recordRequest(RouteId route, int status, std::chrono::microseconds latency,
+                       size_t response_bytes);
+    
+    // Memory one request used: heap allocations on its thread (0 unless
+    // built with FOXBRIDGE_COUNT_ALLOCATIONS) and bytes from its arena
+    void recordRequestMemory(RouteId route, uint64_t heap_allocations, uint64_t arena_bytes);
+    void recordOdbcExecute(std::chrono::microseconds elapsed);
+    void recordOdbcFetch(std::chrono::microseconds elapsed, size_t rows, size_t bytes);
+    
+    // Callbacks must stay valid until unregistered; registering an existing
+    // name replaces it
+    void registerCallback(const std::string& name, const std::string& help,
+                          CallbackType type, Callback callback);
+    void unregisterCallback(const std::string& name);
+    
+    std::string renderPrometheus();
+
+private:
+    Metrics() = default;
+    
+    struct Histogram {
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};   // Non-cumulative
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_us{0};
+        
+        void observe(std::chrono::microseconds elapsed);
+    };
+    
+    // Written by its owning thread only, read by scrapes
+    struct alignas(64) Shard {
+        std::array<std::array<std::atomic<uint64_t>, STATUS_CLASSES>, Router::ROUTE_COUNT> requests{};
+        std::array<std::atomic<uint64_t>, Router::ROUTE_COUNT> response_bytes{};
+        std::array<std::atomic<uint64_t>, Router::ROUTE_COUNT> heap_allocations{};
+        std::array<std::atomic<uint64_t>, Router::ROUTE_COUNT> arena_bytes{};
+        std::array<Histogram, Router::ROUTE_COUNT> request_latency;
+        Histogram odbc_execute;
+        Histogram odbc_fetch;
+        std::atomic<uint64_t> rows_fetched{0};
+        std::atomic<uint64_t> bytes_fetched{0};
+    };
+    
+    struct CallbackEntry {
+        std::string name;
+        std::string help;
+        CallbackType type;
+        Callback callback;
+    };
+    
+    // Shards outlive their threads so counts from finished threads are kept;
+    // the server's threads are pooled, so this stays bounded
+    std::mutex shards_mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    
+    std::mutex callbacks_mutex_;
+    std::vector<CallbackEntry> callbacks_;
+    
+    Shard& localShard();
+};
+
+} // namespace FoxBridge
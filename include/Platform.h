@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace FoxBridge {
+namespace Platform {
+
+// Where logs go when config.json does not say
+#ifdef _WIN32
+inline constexpr const char* DEFAULT_LOG_PATH = "C:\\ProgramData\\FoxBridgeAgent\\logs";
+#else
+inline constexpr const char* DEFAULT_LOG_PATH = "/var/log/foxbridge";
+#endif
+
+// Where export snapshots are cached when config.json does not say
+#ifdef _WIN32
+inline constexpr const char* DEFAULT_SNAPSHOT_PATH = "C:\\ProgramData\\FoxBridgeAgent\\snapshots";
+#else
+inline constexpr const char* DEFAULT_SNAPSHOT_PATH = "/var/cache/foxbridge/snapshots";
+#endif
+
+// Native socket handle (SOCKET on Windows, a file descriptor elsewhere)
+#ifdef _WIN32
+using SocketHandle = uintptr_t;
+#else
+using SocketHandle = int;
+#endif
+
+// config.json locations, in order of priority
+std::vector<std::string> configSearchPaths();
+
+// Full path of the running executable
+std::string executablePath();
+
+// Blocks until Ctrl+C (console) or SIGINT/SIGTERM
+void waitForShutdown();
+
+// Service control. Windows registers with the service control manager;
+// elsewhere these report failure and the agent is run under systemd.
+bool runService(const std::string& service_name,
+                std::function<void()> start_callback,
+                std::function<void()> stop_callback);
+bool installService(const std::string& service_name,
+                    const std::string& display_name,
+                    const std::string& command_line);
+bool uninstallService(const std::string& service_name);
+bool startService(const std::string& service_name);
+bool stopService(const std::string& service_name);
+
+// A file sent to a socket by the kernel, without copying it through user
+// space: sendfile on Linux, TransmitFile on Windows. The file stays
+// readable if it is replaced or deleted while open.
+class FileSender {
+public:
+    explicit FileSender(const std::string& path);
+    ~FileSender();
+    
+    // Disable copy
+    FileSender(const FileSender&) = delete;
+    FileSender& operator=(const FileSender&) = delete;
+    
+    bool isOpen() const { return handle_ != -1; }
+    
+    // Sends bytes offset..offset+length-1 to a blocking socket; false when
+    // the peer goes away or the file cannot be read. `sent` counts what got out.
+    bool send(SocketHandle socket, uint64_t offset, uint64_t length, uint64_t& sent);
+
+private:
+    intptr_t handle_ = -1;
+};
+
+} // namespace Platform
+} // namespace FoxBridge
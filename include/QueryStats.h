@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <array>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace spdlog {
+class logger;
+}
+
+namespace FoxBridge {
+
+// Per-statement statistics keyed by a normalized fingerprint (literals
+// replaced by '?', IN lists collapsed, whitespace folded), plus a dedicated
+// slow-query log carrying the full SQL text and the request it came from.
+// Fingerprints are spread over independently locked shards so recording a
+// statement does not serialize the connection pool.
+class QueryStats {
+public:
+    static QueryStats& instance();
+    
+    // Disable copy
+    QueryStats(const QueryStats&) = delete;
+    QueryStats& operator=(const QueryStats&) = delete;
+    
+    // Called once at startup, before any statement is recorded. A zero
+    // threshold disables the slow log; the logger may be null.
+    void configure(std::chrono::milliseconds slow_threshold,
+                   std::shared_ptr<spdlog::logger> slow_log,
+                   size_t max_fingerprints);
+    
+    // `origin` is the request that issued the statement ("GET /api/...")
+    void record(const std::string& sql, std::chrono::microseconds elapsed,
+                bool success, size_t rows, size_t bytes,
+                const std::string& origin, const std::string& route);
+    
+    // Fingerprints ordered by `sort_by` (total_ms | count | p99_ms | rows | bytes), descending
+    nlohmann::json snapshot(const std::string& sort_by, size_t limit);
+    void reset();
+    
+    static std::string fingerprint(const std::string& sql);
+
+private:
+    QueryStats() = default;
+    
+    // Log-linear latency histogram: 4 sub-buckets per power of two of
+    // microseconds, enough for p50/p99 within ~20%
+    static constexpr size_t SUB_BUCKETS = 4;
+    static constexpr size_t LATENCY_BUCKETS = 40 * SUB_BUCKETS;
+    
+    // Per-fingerprint route counts are capped to keep entries small
+    static constexpr size_t MAX_ROUTES_PER_FINGERPRINT = 8;
+    
+    struct Entry {
+        std::string sample_sql;     // First statement seen with this fingerprint
+        uint64_t count = 0;
+        uint64_t errors = 0;
+        uint64_t total_us = 0;
+        uint64_t max_us = 0;
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+        uint64_t slow = 0;
+        std::array<uint32_t, LATENCY_BUCKETS> latency{};
+        std::unordered_map<std::string, uint64_t> routes;
+    };
+    
+    static constexpr size_t SHARD_COUNT = 16;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+    };
+    std::array<Shard, SHARD_COUNT> shards_;
+    
+    std::chrono::milliseconds slow_threshold_{0};
+    std::shared_ptr<spdlog::logger> slow_log_;
+    size_t max_fingerprints_per_shard_ = 1000 / SHARD_COUNT;
+    
+    static size_t latencyBucket(uint64_t micros);
+    static uint64_t bucketUpperBound(size_t bucket);
+    static double percentile(const Entry& entry, double fraction);
+};
+
+} // namespace FoxBridge
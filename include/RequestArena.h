@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace FoxBridge {
+
+// Request-scoped bump allocator. HttpServer installs one per request on the
+// handling thread; request-path code takes scratch memory (fetch buffers,
+// column tables, CSV/HTML text) from RequestArena::resource() and never
+// frees it piece by piece - the whole arena goes back in one step when the
+// response has been written. Not thread-safe: threads without an arena
+// installed (fan-out workers, background jobs) get the heap instead.
+class RequestArena : public std::pmr::memory_resource {
+public:
+    // Served from inside the object before any heap block is needed
+    static constexpr size_t INLINE_BYTES = 16 * 1024;
+
+    RequestArena();
+
+    // Disable copy
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    // Allocations served and bytes handed out, for metrics
+    uint64_t allocations() const { return allocations_; }
+    uint64_t bytes() const { return bytes_; }
+
+    // Arena installed on this thread, or null
+    static RequestArena* current();
+
+    // current(), or the heap resource when there is none
+    static std::pmr::memory_resource* resource();
+
+    // Installs an arena on the current thread for the lifetime of the scope
+    class Scope {
+    public:
+        explicit Scope(RequestArena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        RequestArena* previous_;
+    };
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    alignas(std::max_align_t) std::byte inline_[INLINE_BYTES];
+    std::pmr::monotonic_buffer_resource buffer_;
+    uint64_t allocations_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+// Containers backed by the current request's arena
+using ArenaString = std::pmr::string;
+template <typename T>
+using ArenaVector = std::pmr::vector<T>;
+
+} // namespace FoxBridge
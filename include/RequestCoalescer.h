@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <unordered_map>
+#include <boost/beast/http.hpp>
+
+namespace FoxBridge {
+
+// Single-flight execution for identical in-flight requests: the first caller
+// for a key runs the producer, concurrent callers with the same key wait for
+// and share its serialized response. A response the producer marks as not
+// shareable (its own request was cancelled) goes only to its caller; the
+// waiters then run the producer again themselves.
+class RequestCoalescer {
+public:
+    using Response = boost::beast::http::response<boost::beast::http::string_body>;
+    using SharedResponse = std::shared_ptr<const Response>;
+    using Producer = std::function<SharedResponse(bool& shareable)>;
+    using Clock = std::chrono::steady_clock;
+    
+    // Returns the shared response; `coalesced` is set when another caller ran
+    // the producer. Null when `deadline` passed while waiting for it.
+    SharedResponse run(const std::string& key, const Producer& producer, bool& coalesced,
+                       Clock::time_point deadline = Clock::time_point::max());
+    
+    // Normalized key: method, path, sorted query parameters, auth scope and
+    // the negotiated content type
+    static std::string makeKey(const std::string& method, 
+                               const std::string& path,
+                               const std::map<std::string, std::string>& params,
+                               const std::string& auth_scope,
+                               unsigned http_version,
+                               const std::string& content_type);
+    
+    uint64_t executions() const { return executions_; }
+    uint64_t coalescedCount() const { return coalesced_; }
+    
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_future<SharedResponse>> in_flight_;
+    
+    std::atomic<uint64_t> executions_{0};
+    std::atomic<uint64_t> coalesced_{0};
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+
+namespace FoxBridge {
+
+// Per-request deadline and cancellation state. HttpServer creates one per
+// request and installs it on the handling thread; DatabaseManager reads it to
+// bound query time and registers hooks (SQLCancel) that run on cancellation.
+class RequestContext {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    explicit RequestContext(Clock::time_point deadline);
+    
+    // Disable copy
+    RequestContext(const RequestContext&) = delete;
+    RequestContext& operator=(const RequestContext&) = delete;
+    
+    // Request that owns this context, for logs and query statistics. Set
+    // before the context is shared with other threads.
+    void setOrigin(std::string origin, std::string route) {
+        origin_ = std::move(origin);
+        route_ = std::move(route);
+    }
+    const std::string& origin() const { return origin_; }
+    const std::string& route() const { return route_; }
+    
+    Clock::time_point deadline() const { return deadline_; }
+    std::chrono::milliseconds remaining() const;
+    bool expired() const { return Clock::now() >= deadline_.load(); }
+    
+    // Moves the deadline; a streamed response renews it per write once its
+    // headers are out
+    void setDeadline(Clock::time_point deadline) { deadline_ = deadline; }
+    
+    bool cancelled() const { return cancelled_; }
+    std::string cancelReason();
+    
+    // Marks the request cancelled and runs every registered hook once
+    void cancel(const std::string& reason);
+    
+    // Sleeps up to `duration`, waking early on cancellation; false if cancelled
+    bool sleepFor(std::chrono::milliseconds duration);
+    
+    // Hooks registered after cancellation run immediately
+    uint64_t addCancelHook(std::function<void()> hook);
+    void removeCancelHook(uint64_t id);
+    
+    // Context of the request being handled on this thread (may be null)
+    static std::shared_ptr<RequestContext> current();
+    
+    // Installs a context on the current thread for the lifetime of the scope
+    class Scope {
+    public:
+        explicit Scope(std::shared_ptr<RequestContext> context);
+        ~Scope();
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+    private:
+        std::shared_ptr<RequestContext> previous_;
+    };
+    
+private:
+    std::atomic<Clock::time_point> deadline_;
+    std::atomic<bool> cancelled_;
+    std::string origin_;
+    std::string route_;
+    
+    std::mutex mutex_;
+    std::condition_variable cancel_cv_;
+    std::string cancel_reason_;
+    std::map<uint64_t, std::function<void()>> hooks_;
+    uint64_t next_hook_id_;
+};
+
+} // namespace FoxBridge
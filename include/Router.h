@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace FoxBridge {
+
+// Every endpoint the server answers, used for dispatch and as the "route"
+// label on metrics. NOT_FOUND covers anything that matched no pattern.
+enum class RouteId {
+    HEALTH = 0,
+    METRICS,
+    JSON_ALL,
+    JSON_DOCNUM,
+    CSV_ALL,
+    CSV_DOCNUM,
+    ARROW,
+    PARQUET,
+    SEARCH,
+    VIEW,
+    MEMO,
+    DOCNUM,
+    DOCNUM_BATCH,
+    DIRECT_LOOKUP,
+    ADD,
+    UPDATE,
+    DELETE,
+    UNDELETE,
+    JOB_STATUS,
+    PACK,
+    REINDEX,
+    INDEX_STATUS,
+    ADMIN_ADMISSION,
+    ADMIN_DBSTATS,
+    ADMIN_TRACE,
+    ADMIN_QUERYSTATS,
+    ADMIN_QUERYSTATS_RESET,
+    NOT_FOUND,
+    COUNT
+};
+
+struct RouteMatch {
+    RouteId id = RouteId::NOT_FOUND;
+    std::vector<std::string> params;    // Capture groups in pattern order
+};
+
+// Route table compiled once on first use; matching is done on the path only,
+// the query string is never part of a route pattern
+class Router {
+public:
+    static constexpr size_t ROUTE_COUNT = static_cast<size_t>(RouteId::COUNT);
+    
+    static RouteMatch match(const std::string& method, const std::string& path);
+    static const char* routeName(RouteId id);
+};
+
+} // namespace FoxBridge
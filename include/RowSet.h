@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "TextEncoding.h"
+#include "BinaryEncoding.h"
+
+namespace FoxBridge {
+
+// What a column holds. Values are text as the VFP driver returns it through
+// SQL_C_CHAR whatever the type; the type is for formats that care (CSV and
+// JSON do not, binary formats do).
+enum class ColumnType : uint8_t {
+    TEXT,       // C, V
+    NUMERIC,    // N, F, Y: decimal text
+    INTEGER,    // I
+    DOUBLE,     // B
+    DATE,       // D: YYYY-MM-DD
+    DATETIME,   // T: YYYY-MM-DD hh:mm:ss
+    LOGICAL,    // L: "1" / "0"
+    MEMO,       // M: text, or a reference to the memo endpoint
+    RECNO,      // _recno: record number, written as a JSON number
+    OTHER       // General, blob, varbinary: always null
+};
+
+struct RowColumn {
+    std::string name;           // Lower case, as the VFP ODBC driver reports it
+    ColumnType type = ColumnType::TEXT;
+    uint32_t size = 0;          // Field width in bytes; 0 if unknown
+    uint8_t decimals = 0;
+};
+
+// Column names and types, shared by every row of a result
+struct RowSchema {
+    std::vector<RowColumn> columns;
+
+    // Index of `name`, or -1
+    int find(std::string_view name) const;
+};
+
+// Query result rows in a compact form: one shared schema, all cell text back
+// to back in one buffer, and a fixed-size slot per cell pointing into it.
+// Replaces an array of JSON objects, which repeats every column name in
+// every row and allocates per cell. Serialized straight to JSON and CSV.
+// Built by one thread, then read-only.
+class RowSet {
+public:
+    enum class CellKind : uint8_t {
+        NULL_VALUE,
+        VALUE,
+        MEMO_REF        // Text is the memo endpoint path; JSON {"memo_ref": path, "length": n}
+    };
+
+    // One cell as seen by readers; `text` points into the RowSet
+    struct CellView {
+        CellKind kind;
+        std::string_view text;
+        int64_t memo_length;    // MEMO_REF only; -1 when not known
+    };
+
+    RowSet() = default;
+    explicit RowSet(std::shared_ptr<const RowSchema> schema);
+
+    const RowSchema& schema() const;
+    const std::shared_ptr<const RowSchema>& schemaPtr() const { return schema_; }
+    size_t columnCount() const { return schema_ ? schema_->columns.size() : 0; }
+
+    size_t size() const { return row_count_; }
+    bool empty() const { return row_count_ == 0; }
+
+    CellView cell(size_t row, size_t column) const;
+
+    // Cells are added left to right; a row is complete once it has one per
+    // column. Text must already be UTF-8 unless an encoding is given.
+    void addNull();
+    void addText(std::string_view text);
+    void addText(std::string_view text, TextEncoding encoding);
+    void addRecno(uint32_t recno);
+    void addMemoRef(std::string_view table, uint32_t recno, std::string_view field, int64_t length = -1);
+
+    // Appends a value cell whose UTF-8 text `write(std::string& buffer)`
+    // appends straight to the shared buffer; `write` returns false for null
+    template <typename Write>
+    void addValue(Write&& write) {
+        size_t offset = buffer_.size();
+        if (write(buffer_)) {
+            pushCell(CellKind::VALUE, offset, buffer_.size() - offset);
+        } else {
+            buffer_.resize(offset);
+            addNull();
+        }
+    }
+
+    // Takes the rows of `other`, which must have the same columns
+    void append(const RowSet& other);
+    // Same for `count` rows of `other` from row `first`
+    void append(const RowSet& other, size_t first, size_t count);
+
+    void reserve(size_t rows, size_t text_bytes);
+
+    // Bytes held by cells and text, for benchmarks and metrics
+    size_t memoryBytes() const;
+
+    // Bytes of cell text, memo paths included
+    size_t textBytes() const { return buffer_.size(); }
+
+    // Array of objects keyed by column name, as results looked before
+    // RowSet; for callers that add fields to rows
+    nlohmann::json toJson() const;
+    nlohmann::json rowJson(size_t row) const;
+
+    // Appends the rows as a JSON array, laid out like nlohmann::json::dump:
+    // compact for indent < 0, else `indent` spaces per level starting at
+    // `level` levels in. Keys come in schema order.
+    void writeJson(std::string& out, int indent = -1, int level = 0) const;
+
+    // Appends writeJson's array in MessagePack or CBOR (`format` is not
+    // JSON): the same maps and strings, record numbers as unsigned integers
+    void writeBinary(std::string& out, BodyFormat format) const;
+
+private:
+    struct Cell {
+        uint64_t offset;
+        uint32_t length;
+        CellKind kind;
+        bool sized;             // MEMO_REF followed by an int64_t length
+    };
+
+    std::shared_ptr<const RowSchema> schema_;
+    std::string buffer_;
+    std::vector<Cell> cells_;   // Row-major, columnCount() per row
+    size_t row_count_ = 0;
+
+    void pushCell(CellKind kind, size_t offset, size_t length, bool sized = false);
+};
+
+// Appends `text` as a quoted JSON string, escaping as nlohmann::json does
+void appendJsonString(std::string& out, std::string_view text);
+
+} // namespace FoxBridge
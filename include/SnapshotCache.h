@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include "StorageBackend.h"
+
+namespace FoxBridge {
+
+// A table export kept on disk
+enum class SnapshotFormat {
+    CSV,
+    JSON
+};
+
+struct SnapshotJob {
+    std::string table;
+    std::vector<SnapshotFormat> formats;
+};
+
+// One snapshot as served: the gzip file and its strong validator
+struct SnapshotFile {
+    std::filesystem::path path;
+    uint64_t size = 0;
+    std::string etag;           // Quoted, as sent in ETag
+};
+
+// Gzip copies of full-table exports, rebuilt once per table change. A
+// background thread checks each job's table every `check_interval` and,
+// when StorageBackend::tableVersion has moved on, builds the export with
+// `build` and writes it to `cache_dir` as
+// <table>.<version>[-<variant>].<hash>.<format>.gz, replacing the previous
+// one. Files that still match their table (and `variant`, the settings the
+// export depends on: CSV dialect, code pages, memo inlining and backend) are
+// adopted at startup. find() only returns
+// a snapshot of the table as it is now, so a table changed between checks
+// falls back to a live export.
+class SnapshotCache {
+public:
+    // Export body of `table` in `format`, exactly as the endpoint would send
+    // it; false (with a reason in `error`) when the export failed
+    using Builder = std::function<bool(const std::string& table, SnapshotFormat format,
+                                       std::string& body, std::string& error)>;
+    
+    SnapshotCache(std::shared_ptr<StorageBackend> backend, const std::string& cache_dir,
+                  std::vector<SnapshotJob> jobs, std::chrono::seconds check_interval, Builder build,
+                  std::string variant = "");
+    ~SnapshotCache();
+    
+    // Disable copy
+    SnapshotCache(const SnapshotCache&) = delete;
+    SnapshotCache& operator=(const SnapshotCache&) = delete;
+    
+    void start();
+    void stop();
+    
+    // The snapshot of `table` in `format`, when there is one for the table's
+    // current version
+    bool find(const std::string& table, SnapshotFormat format, SnapshotFile& file);
+    
+    static bool parseFormat(const std::string& name, SnapshotFormat& format);
+    static const char* formatName(SnapshotFormat format);
+    
+    // `body` as a single-member gzip file (RFC 1952) at `path`
+    static bool writeGzip(const std::filesystem::path& path, const std::string& body);
+
+private:
+    struct Snapshot {
+        std::string version;
+        SnapshotFile file;
+    };
+    
+    std::shared_ptr<StorageBackend> backend_;
+    std::filesystem::path cache_dir_;
+    std::vector<SnapshotJob> jobs_;
+    std::chrono::seconds check_interval_;
+    Builder build_;
+    std::string variant_;
+    
+    std::mutex mutex_;
+    std::map<std::string, Snapshot> snapshots_;     // By lower-case table + "." + format
+    
+    std::atomic<bool> running_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::unique_ptr<std::thread> worker_thread_;
+    
+    void workerLoop();
+    void refresh(const std::string& table, SnapshotFormat format);
+    
+    // Adopts a file left by an earlier run when it matches `version`, and
+    // deletes the table's other snapshot files in `format`
+    bool adopt(const std::string& table, SnapshotFormat format, const std::string& version);
+    void removeStale(const std::string& table, SnapshotFormat format, const std::filesystem::path& keep);
+    static std::string key(const std::string& table, SnapshotFormat format);
+    
+    // `version` as it appears in file names
+    std::string fileVersion(const std::string& version) const;
+};
+
+} // namespace FoxBridge
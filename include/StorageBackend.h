@@ -0,0 +1,228 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include "TextEncoding.h"
+#include "MemoFile.h"
+#include "RowSet.h"
+#include "CsvEncoder.h"
+
+namespace FoxBridge {
+
+struct Config;
+
+// A memo opened for GET /api/dbf/memo, read from the .fpt in pieces
+struct MemoReader {
+    std::unique_ptr<MemoFile> file;
+    MemoBlock memo;
+    TextEncoding encoding = TextEncoding::CP874;
+};
+
+enum class IndexStatus {
+    OK,
+    PENDING,
+    FAILED
+};
+
+// Table reads (exportJSON, search, searchRange, getAllRecords) return their records in
+// `rows`; everything else puts its payload in `data`
+struct QueryResult {
+    bool success;
+    std::string message;
+    nlohmann::json data;
+    IndexStatus index_status;
+    std::vector<std::string> warnings;
+    RowSet rows;
+};
+
+// A single queued write, applied later by WriteBehindQueue
+struct WriteOperation {
+    enum class Type {
+        ADD,
+        UPDATE,
+        DELETE,
+        UNDELETE
+    };
+    
+    Type type;
+    nlohmann::json record;     // ADD
+    nlohmann::json where;      // UPDATE, DELETE, UNDELETE
+    nlohmann::json updates;    // UPDATE
+};
+
+// One page of a table, as GET /view shows it
+struct PageRequest {
+    std::map<std::string, std::string> filters;    // Matched as search() matches them
+    std::string sort;                               // Column; empty for record order
+    bool descending = false;
+    size_t offset = 0;
+    size_t limit = 100;
+};
+
+// What HttpServer, WriteBehindQueue and IndexMaintenance talk to. Two
+// implementations: DatabaseManager goes through the VFP ODBC driver (odbc32
+// on Windows, unixODBC elsewhere); DbfBackend reads the table files directly
+// and serves reads only. Records come back in the same shape from both:
+// lower-case column names, values as driver text.
+class StorageBackend {
+public:
+    explicit StorageBackend(const std::string& db_folder_path);
+    virtual ~StorageBackend() = default;
+    
+    // Disable copy
+    StorageBackend(const StorageBackend&) = delete;
+    StorageBackend& operator=(const StorageBackend&) = delete;
+    
+    // "odbc" or "dbf", as configured by storage_backend
+    virtual std::string name() const = 0;
+    
+    // DBF file operations
+    virtual QueryResult exportJSON(const std::string& filename, const std::string& docnum = "") = 0;
+    QueryResult exportCSV(const std::string& filename, const std::string& docnum = "");
+    virtual QueryResult search(const std::string& filename, const std::map<std::string, std::string>& filters,
+                               int limit = 100) = 0;
+    virtual QueryResult getAllRecords(const std::string& filename, int limit = 1000) = 0;
+    
+    // Records numbered first..last (1-based, inclusive) that match `filters`
+    // the way search() matches them, in record order and without a limit
+    virtual QueryResult searchRange(const std::string& filename,
+                                    const std::map<std::string, std::string>& filters,
+                                    uint32_t first, uint32_t last) = 0;
+    
+    // The records of `request` and, in `matches`, how many records match in
+    // all. Unfiltered pages in record order are searchRange calls, with the
+    // header's record count (deleted records leave such a page short), so
+    // call it on a createRangeReader backend for those to skip the scan;
+    // sorted or filtered pages read the whole table.
+    QueryResult page(const std::string& filename, const PageRequest& request, size_t& matches);
+    
+    virtual QueryResult findByDocnum(const std::string& docnum, bool first_only = false,
+                                     std::chrono::milliseconds timeout = std::chrono::seconds(30)) = 0;
+    virtual QueryResult findByDocnums(const std::vector<std::string>& docnums) = 0;
+    
+    // CRUD operations
+    virtual QueryResult add(const std::string& filename, const nlohmann::json& record) = 0;
+    virtual QueryResult update(const std::string& filename, const nlohmann::json& where,
+                               const nlohmann::json& updates) = 0;
+    virtual QueryResult deleteRecords(const std::string& filename, const nlohmann::json& where) = 0;
+    virtual QueryResult undeleteRecords(const std::string& filename, const nlohmann::json& where) = 0;
+    virtual QueryResult pack(const std::string& filename) = 0;
+    
+    // Group commit: one result per operation
+    virtual std::vector<QueryResult> applyWriteBatch(const std::string& filename,
+                                                     const std::vector<WriteOperation>& operations) = 0;
+    
+    // Index maintenance
+    QueryResult getIndexStatus(const std::string& filename);
+    virtual QueryResult reindex(const std::string& filename) = 0;
+    
+    virtual bool isConnected() const = 0;
+    
+    // Connection pool utilization; zero for backends without a pool
+    virtual size_t poolSize() const = 0;
+    virtual size_t poolInUse() = 0;
+    
+    virtual nlohmann::json getStats() = 0;
+    
+    // Code page used when a table's header names none, and per-file
+    // overrides keyed by lower-case file name
+    void setTextEncodings(TextEncoding fallback, std::map<std::string, TextEncoding> overrides);
+    
+    // Memos up to this many bytes are inlined in returned rows; longer
+    // ones, and all of them when 0, come back as memo references
+    void setMemoInlineBytes(size_t bytes) { memo_inline_bytes_ = bytes; }
+    size_t memoInlineBytes() const { return memo_inline_bytes_; }
+    
+    // Delimiter, quoting, line ending and BOM of CSV exports
+    void setCsvDialect(const CsvDialect& dialect) { csv_dialect_ = dialect; }
+    const CsvDialect& csvDialect() const { return csv_dialect_; }
+    
+    // Memo field `field` of record `recno`, straight from the table files
+    // with either backend. Throws std::runtime_error for bad names, missing
+    // or deleted records and fields that are not memos.
+    MemoReader openMemo(const std::string& filename, uint32_t recno, const std::string& field);
+    
+    // Record count in the table header, deleted records included. Throws
+    // std::runtime_error for bad names and missing or unreadable files.
+    uint32_t recordCount(const std::string& filename);
+    
+    // Changes whenever the table's .dbf, .fpt or .cdx is rewritten: a hash
+    // of their sizes and modification times and of the .dbf header's
+    // last-update date and record count. Empty for bad names and missing files.
+    std::string tableVersion(const std::string& filename);
+    
+    // Every setting that shapes an export body: CSV dialect, code pages,
+    // memo inlining and backend name, for telling stored snapshots apart
+    std::string exportVariant();
+    
+    // Public so foxbridge_bench can drive it
+    static std::string jsonToCSV(const nlohmann::json& data);
+
+protected:
+    std::string db_folder_path_;
+    
+    // page() for sorted or filtered requests
+    virtual QueryResult searchPage(const std::string& filename, const PageRequest& request,
+                                   size_t& matches) = 0;
+    
+    // Common DBF files that hold document numbers
+    static const std::vector<std::string>& docnumTables();
+    
+    // Upper bound for a single batched lookup request
+    static constexpr size_t DOCNUM_BATCH_MAX = 1000;
+    
+    // Rejects path traversal and anything but a .dbf name
+    static std::string sanitizeFilename(const std::string& filename);
+    
+    // Path of `filename` in the database folder, matched case-insensitively
+    // (ExpressD files are upper case, requests are not); empty if missing
+    std::filesystem::path resolvePath(const std::string& filename);
+    bool fileExists(const std::string& filename) { return !resolvePath(filename).empty(); }
+    
+    IndexStatus checkIndexHealth(const std::string& filename);
+    
+    // Code page of `filename`'s text fields: the per-file override, else
+    // the language-driver byte of its header, else the fallback
+    TextEncoding tableEncoding(const std::string& filename);
+    TextEncoding tableEncoding(const std::string& filename, uint8_t language_driver);
+    
+    // Whether `filename` has memo fields; read with the code page, once per file
+    bool tableHasMemo(const std::string& filename);
+
+private:
+    // Lower-case name -> file, for folders on case-sensitive file systems
+    std::mutex names_mutex_;
+    std::map<std::string, std::filesystem::path> names_;
+    
+    std::mutex encodings_mutex_;
+    TextEncoding fallback_encoding_ = TextEncoding::CP874;
+    std::map<std::string, TextEncoding> encoding_overrides_;
+    
+    // What the header says about a table, by lower-case file name
+    struct TableInfo {
+        TextEncoding encoding;
+        bool has_memo;
+    };
+    std::map<std::string, TableInfo> tables_;
+    TableInfo tableInfo(const std::string& filename);
+    
+    size_t memo_inline_bytes_ = 0;
+    CsvDialect csv_dialect_;
+};
+
+// Builds the backend selected by config.storage_backend
+std::shared_ptr<StorageBackend> createStorageBackend(const Config& config);
+
+// Backend for reading record-number ranges (searchRange): `backend` when it
+// reads the files itself, otherwise a native one over the same folder. The
+// VFP driver cannot use an index for WHERE RECNO() BETWEEN, so through ODBC
+// every range of an export would scan the whole table again.
+std::shared_ptr<StorageBackend> createRangeReader(const Config& config, std::shared_ptr<StorageBackend> backend);
+
+} // namespace FoxBridge
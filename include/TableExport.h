@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <functional>
+#include "StorageBackend.h"
+#include "WorkerPool.h"
+
+namespace FoxBridge {
+
+// A run of record numbers, 1-based and inclusive
+struct RecordRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// One of `count` shares of a table's record numbers, as ?part=i&parts=n
+// asks for; parts can be fetched concurrently and concatenated. The split
+// is over `records` records when set, so every part of one export divides
+// the same table size even if records are appended between requests.
+struct ExportPart {
+    uint32_t index = 0;
+    uint32_t count = 1;
+    std::optional<uint32_t> records;    // The table's record count by default
+    
+    bool first() const { return index == 0; }
+    bool last() const { return index + 1 == count; }
+};
+
+// Whole-table exports in columnar formats. The table is split into record
+// ranges that are read through StorageBackend::searchRange on a pool of
+// export threads, a few ranges ahead of the writer, and each range becomes
+// one Arrow record batch or Parquet row group. `backend` should come from
+// createRangeReader, which seeks to each range in the .dbf directly. Column
+// types come from the row schema (the DBF field descriptors).
+// The Arrow formats need a build with FOXBRIDGE_WITH_ARROW.
+class TableExport {
+public:
+    TableExport(std::shared_ptr<StorageBackend> backend, size_t threads,
+                const std::string& parquet_compression);
+    
+    // Disable copy
+    TableExport(const TableExport&) = delete;
+    TableExport& operator=(const TableExport&) = delete;
+    
+    // Whether this build can write Arrow IPC and Parquet
+    static bool arrowAvailable();
+    
+    // Arrow IPC stream of the records matching `filters`, handed to `write`
+    // one record batch at a time as each range is ready. Nothing is written
+    // when the first range fails, so the caller can still send an error.
+    // Of a partial export only the first part carries the schema and only
+    // the last the end-of-stream marker, so the parts concatenate into one
+    // stream.
+    QueryResult writeArrow(const std::string& filename, const std::map<std::string, std::string>& filters,
+                           const std::function<void(const char*, size_t)>& write,
+                           const ExportPart& part = {});
+    
+    // Parquet file of the records matching `filters`, handed to `write` one
+    // row group at a time and then the footer, so only one range is held.
+    // Nothing is written when the first range fails. Each part is a
+    // complete file of its own.
+    QueryResult writeParquet(const std::string& filename, const std::map<std::string, std::string>& filters,
+                             const std::function<void(const char*, size_t)>& write,
+                             const ExportPart& part = {});
+    
+    // The records of one part, read in a single range (CSV and JSON parts)
+    QueryResult readPart(const std::string& filename, const ExportPart& part);
+    
+    // Records in `filename` as the range reader sees them, deleted ones
+    // included; throws when the table cannot be read
+    uint32_t recordCount(const std::string& filename);
+    
+    // Records first..last as consecutive ranges of `range_records`; an empty
+    // span still gets one (empty) range so its columns are known
+    static std::vector<RecordRange> splitRecords(RecordRange span, uint32_t range_records);
+    
+    // Share `part` of `count` records; shares differ by at most one record
+    static RecordRange partRange(uint32_t count, const ExportPart& part);
+
+private:
+    std::shared_ptr<StorageBackend> backend_;
+    std::string parquet_compression_;
+    WorkerPool workers_;
+    
+    // The record numbers of `part`, split over part.records or the live count
+    RecordRange partSpan(const std::string& filename, const ExportPart& part);
+    
+    // Reads the ranges of `part` of `filename` on the export threads; `convert` runs
+    // there, `consume` on the caller in record order. Returns once no range
+    // is still being read, with the first failure or success.
+    template <typename Batch>
+    QueryResult scanRanges(const std::string& filename, const std::map<std::string, std::string>& filters,
+                           const ExportPart& part, const std::function<Batch(RowSet&)>& convert,
+                           const std::function<void(Batch&)>& consume);
+};
+
+} // namespace FoxBridge
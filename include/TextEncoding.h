@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace FoxBridge {
+
+// Code pages found in ExpressD tables. Text is converted to UTF-8 as it is
+// decoded, so every output format (JSON, CSV, HTML) sees valid UTF-8.
+enum class TextEncoding {
+    UTF8,       // Passed through unchanged
+    CP874,      // Thai: Windows-874, a superset of TIS-620
+    CP1252      // Western European ANSI
+};
+
+// Encoding named by the language-driver byte at offset 29 of a .dbf header;
+// false for 0 (not set) and code pages we do not convert
+bool encodingFromLanguageDriver(uint8_t language_driver, TextEncoding& encoding);
+
+// "cp874" / "tis-620" / "windows-874", "cp1252" / "windows-1252", "utf-8"
+bool parseTextEncoding(const std::string& name, TextEncoding& encoding);
+const char* textEncodingName(TextEncoding encoding);
+
+// Appends `text` converted to UTF-8. Bytes the code page leaves undefined
+// become U+FFFD. ASCII runs are copied 16/32 bytes at a time.
+void appendUtf8(std::string& out, std::string_view text, TextEncoding encoding);
+
+inline std::string toUtf8(std::string_view text, TextEncoding encoding) {
+    std::string out;
+    appendUtf8(out, text, encoding);
+    return out;
+}
+
+// UTF-8 back to the table's code page, for literals sent to the table
+// (filters, inserted values). Characters it cannot hold become '?'.
+std::string fromUtf8(std::string_view text, TextEncoding encoding);
+
+} // namespace FoxBridge
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <nlohmann/json.hpp>
+
+namespace FoxBridge {
+
+struct SpanRecord {
+    std::string name;
+    std::string detail;         // Optional annotation (table name, ...)
+    uint64_t span_id = 0;
+    uint64_t parent_id = 0;     // 0 for the request's root span
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+    uint64_t thread_id = 0;
+};
+
+// Spans collected for one sampled request. Phases running on other threads
+// (fan-out probes) append to the same trace, so appends take a per-trace
+// lock - never a global one.
+class RequestTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    RequestTrace(std::string name, Clock::time_point start);
+    
+    // Disable copy
+    RequestTrace(const RequestTrace&) = delete;
+    RequestTrace& operator=(const RequestTrace&) = delete;
+    
+    // 32 hex digits, usable as an OTLP trace id
+    const std::string& traceId() const { return trace_id_; }
+    const std::string& name() const { return name_; }
+    
+    uint64_t nextSpanId() { return ++last_span_id_; }
+    static constexpr uint64_t ROOT_SPAN_ID = 1;
+    
+    // Records a phase that was timed without a TraceSpan (e.g. before the
+    // trace existed); it is parented to the root span
+    void addSpan(const std::string& name, Clock::time_point start, Clock::time_point end);
+    void addSpan(SpanRecord span);
+    
+    // Closes the root span
+    void finish();
+    
+    std::vector<SpanRecord> spans();
+    
+    // Server-Timing header value: total time per phase name, in milliseconds
+    std::string serverTiming();
+    
+    // Trace and enclosing span of the request handled on this thread (may be null)
+    static std::shared_ptr<RequestTrace> current();
+    static uint64_t currentSpanId();
+    
+    // Installs a trace on the current thread for the lifetime of the scope
+    class Scope {
+    public:
+        Scope(std::shared_ptr<RequestTrace> trace, uint64_t parent_span_id = ROOT_SPAN_ID);
+        ~Scope();
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    
+    private:
+        std::shared_ptr<RequestTrace> previous_;
+        uint64_t previous_span_id_;
+    };
+
+private:
+    std::string name_;
+    std::string trace_id_;
+    std::atomic<uint64_t> last_span_id_{ROOT_SPAN_ID};
+    
+    std::mutex mutex_;
+    std::vector<SpanRecord> spans_;
+};
+
+// Times one phase of the current request. A no-op (one thread-local read)
+// when the request is not being traced.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::string detail = {});
+    ~TraceSpan() { end(); }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    
+    // Ends the span early; later calls (and the destructor) do nothing
+    void end();
+
+private:
+    RequestTrace* trace_;
+    const char* name_;
+    std::string detail_;
+    uint64_t span_id_ = 0;
+    uint64_t parent_id_ = 0;
+    RequestTrace::Clock::time_point start_;
+};
+
+// Samples requests for tracing and keeps finished traces in a fixed-size
+// ring. A background thread periodically writes the traces finished since
+// the last flush as Chrome trace JSON (chrome://tracing, Perfetto) or
+// OTLP-JSON; traces overwritten before a flush are counted as dropped.
+class Tracer {
+public:
+    Tracer(double sample_rate, const std::string& output_dir, const std::string& format,
+           std::chrono::seconds flush_interval, size_t capacity);
+    ~Tracer();
+    
+    // Disable copy
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    
+    void start();
+    void stop();
+    
+    // Null when the request is not sampled; `force` bypasses sampling
+    std::shared_ptr<RequestTrace> begin(const std::string& name,
+                                        RequestTrace::Clock::time_point start, bool force);
+    void finish(std::shared_ptr<RequestTrace> trace);
+    
+    // A single finished trace still in the ring, as Chrome trace JSON
+    bool find(const std::string& trace_id, nlohmann::json& chrome_trace);
+    
+    nlohmann::json stats();
+    
+    static nlohmann::json toChromeTrace(const std::vector<std::shared_ptr<RequestTrace>>& traces);
+    static nlohmann::json toOtlp(const std::vector<std::shared_ptr<RequestTrace>>& traces);
+
+private:
+    double sample_rate_;
+    std::string output_dir_;
+    std::string format_;
+    std::chrono::seconds flush_interval_;
+    
+    std::mutex ring_mutex_;
+    std::vector<std::shared_ptr<RequestTrace>> ring_;
+    uint64_t pushed_ = 0;       // Total traces finished
+    uint64_t flushed_ = 0;      // Total traces written or dropped
+    uint64_t dropped_ = 0;
+    uint64_t files_written_ = 0;
+    
+    std::atomic<bool> running_;
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    std::unique_ptr<std::thread> flush_thread_;
+    
+    void flushLoop();
+    void flush();
+};
+
+} // namespace FoxBridge
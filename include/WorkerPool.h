@@ -0,0 +1,40 @@
+#pragma once
+
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+namespace FoxBridge {
+
+// Fixed-size pool of threads draining a shared FIFO task queue
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t thread_count);
+    ~WorkerPool();
+    
+    // Disable copy
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    void submit(std::function<void()> task);
+    void stop();
+    
+    size_t threadCount() const { return threads_.size(); }
+    size_t queueDepth();
+    
+private:
+    std::queue<std::function<void()>> task_queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    
+    std::atomic<bool> running_;
+    std::vector<std::thread> threads_;
+    
+    void workerLoop();
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "StorageBackend.h"
+
+namespace FoxBridge {
+
+enum class WriteJobState {
+    QUEUED,
+    RUNNING,
+    SUCCEEDED,
+    FAILED
+};
+
+struct WriteJob {
+    std::string id;
+    std::string table;
+    WriteOperation operation;
+    uint64_t sequence = 0;      // Order of arrival across all tables
+};
+
+struct WriteJobStatus {
+    std::string table;
+    std::string operation;
+    WriteJobState state = WriteJobState::QUEUED;
+    std::string message;
+    nlohmann::json data;
+    size_t batch_size = 0;
+    std::chrono::system_clock::time_point submitted_at;
+    std::chrono::system_clock::time_point finished_at;
+};
+
+// Optional asynchronous write path: writes are queued per table and a
+// writer thread applies each table's queue in batches through
+// StorageBackend::applyWriteBatch, keeping the lock window short.
+class WriteBehindQueue {
+public:
+    WriteBehindQueue(std::shared_ptr<StorageBackend> db_manager,
+                     size_t batch_size,
+                     std::chrono::milliseconds linger,
+                     size_t max_pending);
+    ~WriteBehindQueue();
+    
+    void start();
+    void stop();
+    
+    // Returns the job id, or an empty string when the queue is full
+    std::string enqueue(const std::string& table, WriteOperation operation);
+    
+    // False when the job id is unknown (or already pruned)
+    bool getStatus(const std::string& job_id, nlohmann::json& status);
+    
+    nlohmann::json stats();
+    
+private:
+    std::shared_ptr<StorageBackend> db_manager_;
+    size_t batch_size_;
+    std::chrono::milliseconds linger_;
+    size_t max_pending_;
+    
+    std::map<std::string, std::deque<WriteJob>> table_queues_;
+    size_t pending_count_ = 0;
+    std::unordered_map<std::string, WriteJobStatus> jobs_;
+    std::deque<std::string> finished_jobs_;     // Oldest first, for pruning
+    uint64_t next_job_ = 0;
+    
+    uint64_t batches_applied_ = 0;
+    uint64_t jobs_succeeded_ = 0;
+    uint64_t jobs_failed_ = 0;
+    
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    
+    std::atomic<bool> running_;
+    std::unique_ptr<std::thread> worker_thread_;
+    
+    void workerLoop();
+    void applyBatch(const std::string& table, std::vector<WriteJob>& batch);
+    
+    static const char* operationName(WriteOperation::Type type);
+    static const char* stateName(WriteJobState state);
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,197 @@
+#include "AccessLog.h"
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <filesystem>
+#include <iterator>
+#include <ctime>
+
+namespace FoxBridge {
+
+// JSON string escaping for request targets, which are client-controlled
+static void appendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+AccessLog::AccessLog(const std::string& path, std::chrono::milliseconds flush_interval,
+                     size_t max_pending, size_t max_file_size, size_t max_files)
+    : path_(path)
+    , flush_interval_(flush_interval)
+    , max_pending_(max_pending > 0 ? max_pending : 1)
+    , max_file_size_(max_file_size)
+    , max_files_(max_files) {
+    pending_.reserve(max_pending_);
+}
+
+AccessLog::~AccessLog() {
+    stop();
+}
+
+void AccessLog::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    
+    running_ = true;
+    writer_thread_ = std::make_unique<std::thread>(&AccessLog::writerLoop, this);
+}
+
+void AccessLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    
+    if (writer_thread_ && writer_thread_->joinable()) {
+        writer_thread_->join();
+    }
+    
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void AccessLog::record(AccessLogEntry entry) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= max_pending_) {
+            ++dropped_;
+            return;
+        }
+        pending_.push_back(std::move(entry));
+        
+        // Flush early once a quarter full rather than waiting out the interval
+        wake = pending_.size() == max_pending_ / 4;
+    }
+    
+    if (wake) {
+        cv_.notify_one();
+    }
+}
+
+void AccessLog::format(const AccessLogEntry& entry, std::string& out) {
+    auto since_epoch = entry.time.time_since_epoch();
+    std::time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count();
+    int millis = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000);
+    
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    
+    fmt::format_to(std::back_inserter(out), "{{\"ts\":\"{}.{:03d}Z\",\"method\":\"", timestamp, millis);
+    appendEscaped(out, entry.method);
+    out += "\",\"route\":\"";
+    appendEscaped(out, entry.route);
+    out += "\",\"target\":\"";
+    appendEscaped(out, entry.target);
+    fmt::format_to(std::back_inserter(out), "\",\"status\":{},\"latency_ms\":{:.3f},\"bytes\":{}",
+                   entry.status, entry.latency.count() / 1000.0, entry.bytes);
+    if (!entry.trace_id.empty()) {
+        fmt::format_to(std::back_inserter(out), ",\"trace_id\":\"{}\"", entry.trace_id);
+    }
+    out += "}\n";
+}
+
+void AccessLog::writerLoop() {
+    std::vector<AccessLogEntry> batch;
+    batch.reserve(max_pending_);
+    std::string buffer;
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait_for(lock, flush_interval_, [this] {
+            return !running_ || pending_.size() >= max_pending_ / 4;
+        });
+        
+        batch.swap(pending_);
+        bool stopping = !running_;
+        lock.unlock();
+        
+        writeBatch(batch, buffer);
+        batch.clear();
+        
+        lock.lock();
+        if (stopping && pending_.empty()) {
+            break;
+        }
+    }
+}
+
+void AccessLog::writeBatch(std::vector<AccessLogEntry>& batch, std::string& buffer) {
+    if (batch.empty()) {
+        return;
+    }
+    
+    buffer.clear();
+    for (const auto& entry : batch) {
+        format(entry, buffer);
+    }
+    
+    if (max_file_size_ > 0 && file_ && file_size_ + buffer.size() > max_file_size_) {
+        rotate();
+    }
+    if (!file_ && !openFile()) {
+        dropped_ += batch.size();
+        return;
+    }
+    
+    std::fwrite(buffer.data(), 1, buffer.size(), file_);
+    std::fflush(file_);
+    file_size_ += buffer.size();
+    written_ += batch.size();
+}
+
+bool AccessLog::openFile() {
+    file_ = std::fopen(path_.c_str(), "ab");
+    if (!file_) {
+        spdlog::warn("Cannot open access log: {}", path_);
+        return false;
+    }
+    
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path_, ec);
+    file_size_ = ec ? 0 : static_cast<size_t>(size);
+    return true;
+}
+
+// access.log -> access.log.1 -> ... -> access.log.<max_files>, oldest removed
+void AccessLog::rotate() {
+    std::fclose(file_);
+    file_ = nullptr;
+    
+    std::error_code ec;
+    std::filesystem::remove(path_ + "." + std::to_string(max_files_), ec);
+    for (size_t i = max_files_; i > 1; --i) {
+        std::filesystem::rename(path_ + "." + std::to_string(i - 1),
+                                path_ + "." + std::to_string(i), ec);
+    }
+    std::filesystem::rename(path_, path_ + ".1", ec);
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,205 @@
+#include "AdmissionController.h"
+#include <algorithm>
+
+namespace FoxBridge {
+
+AdmissionController::AdmissionController(int max_concurrent, int max_queued,
+                                         std::chrono::milliseconds queue_timeout,
+                                         const std::array<RouteClassLimit, CLASS_COUNT>& limits)
+    : max_concurrent_(std::max(max_concurrent, 1))
+    , max_queued_(std::max(max_queued, 0))
+    , queue_timeout_(queue_timeout) {
+    
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        classes_[i].limit = limits[i];
+    }
+}
+
+AdmissionController::Ticket& AdmissionController::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        if (owner_) {
+            owner_->release(route_class_);
+        }
+        owner_ = other.owner_;
+        route_class_ = other.route_class_;
+        other.owner_ = nullptr;
+    }
+    return *this;
+}
+
+AdmissionController::Ticket::~Ticket() {
+    if (owner_) {
+        owner_->release(route_class_);
+    }
+}
+
+bool AdmissionController::hasCapacity(size_t index) const {
+    const auto& state = classes_[index];
+    return state.in_flight < state.limit.concurrency && in_flight_ < max_concurrent_;
+}
+
+bool AdmissionController::isNextInLine(size_t index, uint64_t ticket) const {
+    if (classes_[index].waiting.empty() || classes_[index].waiting.front() != ticket) {
+        return false;
+    }
+    
+    // Higher-priority waiters that could run right now go first
+    for (size_t j = 0; j < index; ++j) {
+        if (!classes_[j].waiting.empty() && hasCapacity(j)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AdmissionController::Ticket AdmissionController::admit(RouteClass route_class) {
+    size_t index = static_cast<size_t>(route_class);
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& state = classes_[index];
+    
+    // Health checks are never queued or shed and do not take a shared slot
+    if (route_class == RouteClass::HEALTH) {
+        ++state.in_flight;
+        ++state.admitted;
+        return Ticket(this, route_class);
+    }
+    
+    uint64_t ticket = next_ticket_++;
+    state.waiting.push_back(ticket);
+    
+    bool admissible = isNextInLine(index, ticket) && hasCapacity(index);
+    if (!admissible && 
+        (static_cast<int>(state.waiting.size()) > state.limit.queue || queued_ >= max_queued_)) {
+        state.waiting.pop_back();
+        ++state.shed_queue_full;
+        return Ticket();
+    }
+    
+    ++queued_;
+    if (!admissible) {
+        admissible = cv_.wait_for(lock, queue_timeout_, [&] {
+            return isNextInLine(index, ticket) && hasCapacity(index);
+        });
+    }
+    
+    state.waiting.erase(std::find(state.waiting.begin(), state.waiting.end(), ticket));
+    --queued_;
+    
+    if (!admissible) {
+        ++state.shed_timeout;
+        // The head of this class may have changed
+        cv_.notify_all();
+        return Ticket();
+    }
+    
+    ++state.in_flight;
+    ++state.admitted;
+    ++in_flight_;
+    
+    // Remaining capacity may admit the next waiter
+    cv_.notify_all();
+    return Ticket(this, route_class);
+}
+
+void AdmissionController::release(RouteClass route_class) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --classes_[static_cast<size_t>(route_class)].in_flight;
+        if (route_class != RouteClass::HEALTH) {
+            --in_flight_;
+        }
+    }
+    cv_.notify_all();
+}
+
+int AdmissionController::retryAfterSeconds(RouteClass route_class) const {
+    switch (route_class) {
+        case RouteClass::HEALTH:
+        case RouteClass::LOOKUP:
+        case RouteClass::SEARCH:
+            return 1;
+        case RouteClass::WRITE:
+            return 2;
+        case RouteClass::EXPORT:
+            return 10;
+        case RouteClass::MAINTENANCE:
+        default:
+            return 30;
+    }
+}
+
+nlohmann::json AdmissionController::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    nlohmann::json classes = nlohmann::json::object();
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        const auto& state = classes_[i];
+        classes[className(static_cast<RouteClass>(i))] = {
+            {"in_flight", state.in_flight},
+            {"queued", state.waiting.size()},
+            {"concurrency_limit", state.limit.concurrency},
+            {"queue_limit", state.limit.queue},
+            {"admitted", state.admitted},
+            {"shed_queue_full", state.shed_queue_full},
+            {"shed_timeout", state.shed_timeout}
+        };
+    }
+    
+    return {
+        {"in_flight", in_flight_},
+        {"queued", queued_},
+        {"max_concurrent", max_concurrent_},
+        {"max_queued", max_queued_},
+        {"queue_timeout_ms", queue_timeout_.count()},
+        {"classes", classes}
+    };
+}
+
+RouteClass AdmissionController::classify(const std::string& path) {
+    auto starts_with = [&path](const char* prefix) {
+        return path.rfind(prefix, 0) == 0;
+    };
+    
+    if (path == "/health" || path == "/metrics" || starts_with("/api/admin/")) {
+        return RouteClass::HEALTH;
+    }
+    if (starts_with("/api/dbf/maintenance/") || starts_with("/api/dbf/pack/")) {
+        return RouteClass::MAINTENANCE;
+    }
+    if (starts_with("/api/dbf/add/") || starts_with("/api/dbf/update/") ||
+        starts_with("/api/dbf/delete/") || starts_with("/api/dbf/undelete/")) {
+        return RouteClass::WRITE;
+    }
+    if (starts_with("/api/dbf/search/")) {
+        return RouteClass::SEARCH;
+    }
+    
+    // /api/dbf/json/file.dbf exports the table, /api/dbf/json/file.dbf/DOCNUM is a lookup
+    for (const char* prefix : {"/api/dbf/json/", "/api/dbf/csv/"}) {
+        if (starts_with(prefix)) {
+            return path.find('/', std::string(prefix).size()) == std::string::npos ?
+                   RouteClass::EXPORT : RouteClass::LOOKUP;
+        }
+    }
+    if (starts_with("/view/") || starts_with("/api/dbf/memo/") ||
+        starts_with("/api/dbf/arrow/") || starts_with("/api/dbf/parquet/")) {
+        return RouteClass::EXPORT;
+    }
+    
+    // /docnum/..., /api/docnum/batch, direct /HP0000001 lookups and unknown routes
+    return RouteClass::LOOKUP;
+}
+
+const char* AdmissionController::className(RouteClass route_class) {
+    switch (route_class) {
+        case RouteClass::HEALTH:      return "health";
+        case RouteClass::LOOKUP:      return "lookup";
+        case RouteClass::SEARCH:      return "search";
+        case RouteClass::EXPORT:      return "export";
+        case RouteClass::WRITE:       return "write";
+        case RouteClass::MAINTENANCE: return "maintenance";
+        default:                      return "unknown";
+    }
+}
+
+} // namespace FoxBridge
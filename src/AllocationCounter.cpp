@@ -0,0 +1,82 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local uint64_t t_allocations = 0;
+thread_local uint64_t t_allocated_bytes = 0;
+}
+
+namespace FoxBridge {
+
+bool AllocationCounter::enabled() {
+#ifdef FOXBRIDGE_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t AllocationCounter::threadAllocations() {
+    return t_allocations;
+}
+
+uint64_t AllocationCounter::threadAllocatedBytes() {
+    return t_allocated_bytes;
+}
+
+} // namespace FoxBridge
+
+#ifdef FOXBRIDGE_COUNT_ALLOCATIONS
+
+// Replacement global operator new/delete: malloc plus a per-thread count.
+// Aligned and nothrow forms fall through to these or to the library's own
+// matching pairs, so every pointer is freed by the allocator it came from.
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    t_allocated_bytes += size;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++t_allocations;
+    t_allocated_bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,182 @@
+#include "BinaryEncoding.h"
+#include <cctype>
+#include <cstdlib>
+
+namespace FoxBridge {
+
+static std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BodyFormat bodyFormatFromAccept(std::string_view accept) {
+    // Highest q wins. On a tie a binary format beats JSON, as clients list
+    // them only when they can decode them; wildcards mean JSON, so browsers
+    // and curl keep getting JSON
+    BodyFormat best = BodyFormat::JSON;
+    double best_q = -1.0;
+    while (!accept.empty()) {
+        size_t comma = accept.find(',');
+        std::string_view range = accept.substr(0, comma);
+        accept = comma == std::string_view::npos ? std::string_view() : accept.substr(comma + 1);
+        
+        size_t semicolon = range.find(';');
+        std::string_view type = trim(range.substr(0, semicolon));
+        double q = 1.0;
+        while (semicolon != std::string_view::npos) {
+            range = range.substr(semicolon + 1);
+            semicolon = range.find(';');
+            std::string_view param = trim(range.substr(0, semicolon));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = std::strtod(std::string(param.substr(2)).c_str(), nullptr);
+            }
+        }
+        
+        BodyFormat format;
+        if (equalsIgnoreCase(type, "application/msgpack") || equalsIgnoreCase(type, "application/x-msgpack")) {
+            format = BodyFormat::MSGPACK;
+        } else if (equalsIgnoreCase(type, "application/cbor")) {
+            format = BodyFormat::CBOR;
+        } else if (equalsIgnoreCase(type, "application/json") || type == "*/*" ||
+                   equalsIgnoreCase(type, "application/*")) {
+            format = BodyFormat::JSON;
+        } else {
+            continue;
+        }
+        if (q > 0 && (q > best_q || (q == best_q && best == BodyFormat::JSON))) {
+            best = format;
+            best_q = q;
+        }
+    }
+    return best;
+}
+
+const char* contentType(BodyFormat format) {
+    switch (format) {
+        case BodyFormat::MSGPACK: return "application/msgpack";
+        case BodyFormat::CBOR: return "application/cbor";
+        case BodyFormat::JSON:
+        default: return "application/json";
+    }
+}
+
+// Big-endian, `bytes` wide
+static void appendBigEndian(std::string& out, uint64_t value, int bytes) {
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+// CBOR head: major type plus the argument inline or in 1, 2, 4 or 8 bytes
+static void appendCborHead(std::string& out, uint8_t major, uint64_t argument) {
+    uint8_t type = static_cast<uint8_t>(major << 5);
+    if (argument < 24) {
+        out += static_cast<char>(type | argument);
+    } else if (argument <= 0xFF) {
+        out += static_cast<char>(type | 24);
+        appendBigEndian(out, argument, 1);
+    } else if (argument <= 0xFFFF) {
+        out += static_cast<char>(type | 25);
+        appendBigEndian(out, argument, 2);
+    } else if (argument <= 0xFFFFFFFF) {
+        out += static_cast<char>(type | 26);
+        appendBigEndian(out, argument, 4);
+    } else {
+        out += static_cast<char>(type | 27);
+        appendBigEndian(out, argument, 8);
+    }
+}
+
+// MessagePack container / string head: fix form when `size` fits under
+// `fix_limit`, else the 8- (strings only), 16- or 32-bit form
+static void appendMsgpackHead(std::string& out, uint8_t fix, size_t fix_limit, uint8_t head8,
+                              uint8_t head16, uint8_t head32, size_t size) {
+    if (size <= fix_limit) {
+        out += static_cast<char>(fix | size);
+    } else if (head8 != 0 && size <= 0xFF) {
+        out += static_cast<char>(head8);
+        appendBigEndian(out, size, 1);
+    } else if (size <= 0xFFFF) {
+        out += static_cast<char>(head16);
+        appendBigEndian(out, size, 2);
+    } else {
+        out += static_cast<char>(head32);
+        appendBigEndian(out, size, 4);
+    }
+}
+
+void appendBinaryMap(std::string& out, BodyFormat format, size_t entries) {
+    if (format == BodyFormat::CBOR) {
+        appendCborHead(out, 5, entries);
+    } else {
+        appendMsgpackHead(out, 0x80, 15, 0, 0xDE, 0xDF, entries);
+    }
+}
+
+void appendBinaryArray(std::string& out, BodyFormat format, size_t items) {
+    if (format == BodyFormat::CBOR) {
+        appendCborHead(out, 4, items);
+    } else {
+        appendMsgpackHead(out, 0x90, 15, 0, 0xDC, 0xDD, items);
+    }
+}
+
+void appendBinaryString(std::string& out, BodyFormat format, std::string_view text) {
+    if (format == BodyFormat::CBOR) {
+        appendCborHead(out, 3, text.size());
+    } else {
+        appendMsgpackHead(out, 0xA0, 31, 0xD9, 0xDA, 0xDB, text.size());
+    }
+    out.append(text);
+}
+
+void appendBinaryUnsigned(std::string& out, BodyFormat format, uint64_t value) {
+    if (format == BodyFormat::CBOR) {
+        appendCborHead(out, 0, value);
+    } else if (value < 0x80) {
+        out += static_cast<char>(value);
+    } else if (value <= 0xFF) {
+        out += static_cast<char>(0xCC);
+        appendBigEndian(out, value, 1);
+    } else if (value <= 0xFFFF) {
+        out += static_cast<char>(0xCD);
+        appendBigEndian(out, value, 2);
+    } else if (value <= 0xFFFFFFFF) {
+        out += static_cast<char>(0xCE);
+        appendBigEndian(out, value, 4);
+    } else {
+        out += static_cast<char>(0xCF);
+        appendBigEndian(out, value, 8);
+    }
+}
+
+void appendBinaryNull(std::string& out, BodyFormat format) {
+    out += static_cast<char>(format == BodyFormat::CBOR ? 0xF6 : 0xC0);
+}
+
+void appendBinaryJson(std::string& out, BodyFormat format, const nlohmann::json& value) {
+    if (format == BodyFormat::CBOR) {
+        nlohmann::json::to_cbor(value, out);
+    } else {
+        nlohmann::json::to_msgpack(value, out);
+    }
+}
+
+} // namespace FoxBridge
@@ -1,6 +1,17 @@
 #include "CloudflareTunnel.h"
 #include <spdlog/spdlog.h>
 #include <sstream>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#ifndef _WIN32
+#include <spawn.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
 
 namespace FoxBridge {
 
@@ -9,9 +20,13 @@ CloudflareTunnel::CloudflareTunnel(const std::string& token, int local_port)
     , local_port_(local_port)
     , running_(false)
     , watchdog_enabled_(false)
+#ifdef _WIN32
     , process_handle_(nullptr) {
     
     ZeroMemory(&process_info_, sizeof(process_info_));
+#else
+    , process_id_(-1) {
+#endif
 }
 
 CloudflareTunnel::~CloudflareTunnel() {
@@ -47,10 +62,11 @@ void CloudflareTunnel::stop() {
 bool CloudflareTunnel::launchCloudflared() {
     std::string cloudflared_path = findCloudflaredPath();
     if (cloudflared_path.empty()) {
-        spdlog::error("cloudflared.exe not found in PATH");
+        spdlog::error("cloudflared not found in PATH");
         return false;
     }
-    
+
+#ifdef _WIN32
     // Build command line
     std::ostringstream cmd;
     cmd << "\"" << cloudflared_path << "\" tunnel"
@@ -84,9 +100,32 @@ bool CloudflareTunnel::launchCloudflared() {
     process_handle_ = process_info_.hProcess;
     spdlog::info("cloudflared process started (PID: {})", process_info_.dwProcessId);
     return true;
+#else
+    std::string url = "http://127.0.0.1:" + std::to_string(local_port_);
+    std::vector<std::string> args = {
+        cloudflared_path, "tunnel", "--url", url, "run", "--token", token_
+    };
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+    
+    pid_t pid;
+    int error = posix_spawn(&pid, cloudflared_path.c_str(), nullptr, nullptr, argv.data(), environ);
+    if (error != 0) {
+        spdlog::error("Failed to start cloudflared: {}", error);
+        return false;
+    }
+    
+    process_id_ = pid;
+    spdlog::info("cloudflared process started (PID: {})", pid);
+    return true;
+#endif
 }
 
 void CloudflareTunnel::killProcess() {
+#ifdef _WIN32
     if (process_handle_) {
         TerminateProcess(process_handle_, 0);
         WaitForSingleObject(process_handle_, 5000);
@@ -94,6 +133,42 @@ void CloudflareTunnel::killProcess() {
         CloseHandle(process_info_.hProcess);
         process_handle_ = nullptr;
     }
+#else
+    if (process_id_ > 0) {
+        // SIGTERM first so cloudflared can unregister its connections
+        kill(process_id_, SIGTERM);
+        int waited_ms = 0;
+        while (waitpid(process_id_, nullptr, WNOHANG) == 0 && waited_ms < 5000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            waited_ms += 100;
+        }
+        if (waited_ms >= 5000) {
+            kill(process_id_, SIGKILL);
+            waitpid(process_id_, nullptr, 0);
+        }
+        process_id_ = -1;
+    }
+#endif
+}
+
+bool CloudflareTunnel::processAlive() {
+#ifdef _WIN32
+    DWORD exit_code;
+    if (GetExitCodeProcess(process_handle_, &exit_code) && exit_code != STILL_ACTIVE) {
+        spdlog::warn("Cloudflare Tunnel process died (exit code: {}), restarting...", exit_code);
+        return false;
+    }
+    return true;
+#else
+    int status = 0;
+    if (process_id_ > 0 && waitpid(process_id_, &status, WNOHANG) == process_id_) {
+        spdlog::warn("Cloudflare Tunnel process died (exit code: {}), restarting...",
+                     WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status));
+        process_id_ = -1;   // Already reaped
+        return false;
+    }
+    return true;
+#endif
 }
 
 void CloudflareTunnel::enableWatchdog(int check_interval_seconds) {
@@ -121,26 +196,23 @@ void CloudflareTunnel::disableWatchdog() {
 
 void CloudflareTunnel::watchdogLoop(int interval_seconds) {
     while (watchdog_enabled_ && running_) {
-        Sleep(interval_seconds * 1000);
+        std::this_thread::sleep_for(std::chrono::seconds(interval_seconds));
         
         if (!running_) {
             break;
         }
         
         // Check if process is still alive
-        DWORD exit_code;
-        if (GetExitCodeProcess(process_handle_, &exit_code)) {
-            if (exit_code != STILL_ACTIVE) {
-                spdlog::warn("Cloudflare Tunnel process died (exit code: {}), restarting...", exit_code);
-                killProcess();
-                Sleep(2000);  // Wait before restart
-                launchCloudflared();
-            }
+        if (!processAlive()) {
+            killProcess();
+            std::this_thread::sleep_for(std::chrono::seconds(2));  // Wait before restart
+            launchCloudflared();
         }
     }
 }
 
 std::string CloudflareTunnel::findCloudflaredPath() {
+#ifdef _WIN32
     // Try common locations
     const char* paths[] = {
         "cloudflared.exe",
@@ -162,6 +234,30 @@ std::string CloudflareTunnel::findCloudflaredPath() {
     }
     
     return "";
+#else
+    // Try common locations, then PATH
+    std::vector<std::string> candidates = {
+        "/usr/local/bin/cloudflared",
+        "/usr/bin/cloudflared"
+    };
+    if (const char* path_env = std::getenv("PATH")) {
+        std::istringstream dirs(path_env);
+        std::string dir;
+        while (std::getline(dirs, dir, ':')) {
+            if (!dir.empty()) {
+                candidates.push_back(dir + "/cloudflared");
+            }
+        }
+    }
+    
+    for (const auto& path : candidates) {
+        if (access(path.c_str(), X_OK) == 0) {
+            return path;
+        }
+    }
+    
+    return "";
+#endif
 }
 
 } // namespace FoxBridge
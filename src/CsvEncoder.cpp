@@ -0,0 +1,271 @@
+#include "CsvEncoder.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FOXBRIDGE_SSE2 1
+#endif
+
+namespace FoxBridge {
+
+namespace {
+
+// Cursor over the end of a std::string. Room is made in doubling steps
+// ahead of each field, so the copies below are plain memcpy through a raw
+// pointer; the string is cut back to what was written when the cursor goes
+// away.
+class CsvOutput {
+public:
+    explicit CsvOutput(std::string& out)
+        : out_(out)
+        , pos_(out.data() + out.size())
+        , end_(pos_) {}
+    
+    ~CsvOutput() {
+        out_.resize(static_cast<size_t>(pos_ - out_.data()));
+    }
+    
+    CsvOutput(const CsvOutput&) = delete;
+    CsvOutput& operator=(const CsvOutput&) = delete;
+    
+    // Room for at least `bytes` more
+    void reserve(size_t bytes) {
+        if (static_cast<size_t>(end_ - pos_) < bytes) {
+            grow(bytes);
+        }
+    }
+    
+    // Only into room made by reserve()
+    void put(char c) {
+        *pos_++ = c;
+    }
+    
+    void put(const char* data, size_t size) {
+        std::memcpy(pos_, data, size);
+        pos_ += size;
+    }
+
+private:
+    std::string& out_;
+    char* pos_;
+    char* end_;
+    
+    void grow(size_t bytes) {
+        size_t used = static_cast<size_t>(pos_ - out_.data());
+        out_.resize(std::max(out_.size() * 2, used + bytes + 4096));
+        pos_ = out_.data() + used;
+        end_ = out_.data() + out_.size();
+    }
+};
+
+// Numbers and logicals cannot hold a quote, CR or LF; only the delimiter
+// could make them need quoting
+bool isNumeric(ColumnType type) {
+    switch (type) {
+        case ColumnType::NUMERIC:
+        case ColumnType::INTEGER:
+        case ColumnType::DOUBLE:
+        case ColumnType::LOGICAL:
+        case ColumnType::RECNO:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+// First byte of data[0..size) equal to a, b, c or d, or size
+static size_t findAny(const char* data, size_t size, char a, char b, char c, char d) {
+    size_t i = 0;
+#ifdef FOXBRIDGE_SSE2
+    if (size >= 16) {
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        const __m128i vc = _mm_set1_epi8(c);
+        const __m128i vd = _mm_set1_epi8(d);
+        auto matches = [&](size_t at) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + at));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+            return static_cast<unsigned>(_mm_movemask_epi8(hits));
+        };
+        for (; i + 16 <= size; i += 16) {
+            if (unsigned mask = matches(i)) {
+                return i + static_cast<size_t>(std::countr_zero(mask));
+            }
+        }
+        // The last bytes as the final 16, overlapping what was checked
+        if (i < size) {
+            unsigned mask = matches(size - 16) >> (i - (size - 16));
+            return mask ? i + static_cast<size_t>(std::countr_zero(mask)) : size;
+        }
+        return size;
+    }
+#else
+    // Eight bytes per step without SSE2: a byte of `word ^ pattern` is zero
+    // where the byte matched
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+    auto hasZeroByte = [](uint64_t v) { return ((v - ONES) & ~v & HIGHS) != 0; };
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (hasZeroByte(word ^ (ONES * static_cast<unsigned char>(a))) ||
+            hasZeroByte(word ^ (ONES * static_cast<unsigned char>(b))) ||
+            hasZeroByte(word ^ (ONES * static_cast<unsigned char>(c))) ||
+            hasZeroByte(word ^ (ONES * static_cast<unsigned char>(d)))) {
+            break;
+        }
+    }
+#endif
+    // Short fields, and the rest after a hit in a word
+    for (; i < size; ++i) {
+        char ch = data[i];
+        if (ch == a || ch == b || ch == c || ch == d) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// Double-quoted, embedded quotes doubled; room for the worst case (every
+// byte a quote) is made up front
+static void putQuoted(CsvOutput& out, std::string_view text) {
+    out.reserve(text.size() * 2 + 2);
+    out.put('"');
+    const char* data = text.data();
+    size_t size = text.size();
+    for (;;) {
+        // One character: the C library's memchr is vectorised already
+        const char* quote = static_cast<const char*>(std::memchr(data, '"', size));
+        if (!quote) {
+            out.put(data, size);
+            break;
+        }
+        size_t run = static_cast<size_t>(quote - data) + 1;
+        out.put(data, run);
+        out.put('"');
+        data += run;
+        size -= run;
+    }
+    out.put('"');
+}
+
+static void putPlain(CsvOutput& out, std::string_view text) {
+    out.reserve(text.size());
+    out.put(text.data(), text.size());
+}
+
+std::string CsvDialect::tag() const {
+    static const char* const QUOTING[] = {"all", "minimal", "nonnumeric"};
+    char tag[48];
+    std::snprintf(tag, sizeof(tag), "%02x-%s-%s%s", static_cast<unsigned char>(delimiter),
+                  QUOTING[static_cast<int>(quoting)], crlf ? "crlf" : "lf", bom ? "-bom" : "");
+    return tag;
+}
+
+bool parseCsvQuoting(const std::string& name, CsvQuoting& quoting) {
+    if (name == "all") {
+        quoting = CsvQuoting::ALL;
+    } else if (name == "minimal") {
+        quoting = CsvQuoting::MINIMAL;
+    } else if (name == "non_numeric") {
+        quoting = CsvQuoting::NON_NUMERIC;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+CsvEncoder::CsvEncoder(const CsvDialect& dialect)
+    : dialect_(dialect) {}
+
+size_t CsvEncoder::findSpecial(std::string_view text, char delimiter) {
+    return findAny(text.data(), text.size(), delimiter, '"', '\r', '\n');
+}
+
+void CsvEncoder::writeHeader(const RowSchema& schema, std::string& out) const {
+    CsvOutput output(out);
+    if (dialect_.bom) {
+        output.reserve(3);
+        output.put("\xEF\xBB\xBF", 3);
+    }
+    for (size_t column = 0; column < schema.columns.size(); ++column) {
+        if (column > 0) {
+            output.reserve(1);
+            output.put(dialect_.delimiter);
+        }
+        const std::string& name = schema.columns[column].name;
+        if (dialect_.quoting == CsvQuoting::MINIMAL && findSpecial(name, dialect_.delimiter) == name.size()) {
+            putPlain(output, name);
+        } else {
+            putQuoted(output, name);
+        }
+    }
+    output.reserve(2);
+    if (dialect_.crlf) {
+        output.put('\r');
+    }
+    output.put('\n');
+}
+
+void CsvEncoder::writeRows(const RowSet& rows, std::string& out) const {
+    const RowSchema& schema = rows.schema();
+    size_t columns = schema.columns.size();
+    if (columns == 0) {
+        return;
+    }
+    
+    // Per column: whether its values are quoted whatever they hold
+    std::vector<bool> always(columns);
+    for (size_t column = 0; column < columns; ++column) {
+        ColumnType type = schema.columns[column].type;
+        always[column] = type != ColumnType::RECNO &&
+                         (dialect_.quoting == CsvQuoting::ALL ||
+                          (dialect_.quoting == CsvQuoting::NON_NUMERIC && !isNumeric(type)));
+    }
+    const char* line_end = dialect_.crlf ? "\r\n" : "\n";
+    size_t line_end_size = dialect_.crlf ? 2 : 1;
+    const char delimiter = dialect_.delimiter;
+    bool quoted_nulls = dialect_.quoting != CsvQuoting::MINIMAL;
+    
+    // Sized once for the usual case: every field quoted, no quotes inside
+    CsvOutput output(out);
+    output.reserve(rows.textBytes() + rows.size() * (columns * 3 + line_end_size));
+    for (size_t row = 0; row < rows.size(); ++row) {
+        for (size_t column = 0; column < columns; ++column) {
+            output.reserve(3);
+            if (column > 0) {
+                output.put(delimiter);
+            }
+            RowSet::CellView value = rows.cell(row, column);
+            if (value.kind == RowSet::CellKind::NULL_VALUE) {
+                if (quoted_nulls) {
+                    output.put("\"\"", 2);
+                }
+            } else if (always[column] || findSpecial(value.text, delimiter) != value.text.size()) {
+                putQuoted(output, value.text);
+            } else {
+                putPlain(output, value.text);
+            }
+        }
+        output.reserve(line_end_size);
+        output.put(line_end, line_end_size);
+    }
+}
+
+void CsvEncoder::write(const RowSet& rows, std::string& out, bool header) const {
+    if (rows.columnCount() == 0) {
+        return;
+    }
+    if (header) {
+        writeHeader(rows.schema(), out);
+    }
+    writeRows(rows, out);
+}
+
+} // namespace FoxBridge
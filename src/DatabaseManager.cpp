@@ -1,24 +1,52 @@
 #include "DatabaseManager.h"
+#include "RequestContext.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "QueryStats.h"
+#include "RequestArena.h"
 #include <sstream>
 #include <algorithm>
 #include <filesystem>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <charconv>
+#include <thread>
 
 namespace FoxBridge {
 
-DatabaseManager::DatabaseManager(const std::string& db_folder_path)
-    : db_folder_path_(db_folder_path)
+// The VFP driver rejects very long IN lists (SYS(3055) complexity limit),
+// so batched lookups are split into chunks of this size
+static constexpr size_t DOCNUM_IN_LIST_CHUNK = 50;
+
+// Backoff between lock-conflict retries: base * 2^attempt, capped, with jitter
+static constexpr std::chrono::milliseconds RETRY_BACKOFF_BASE{50};
+static constexpr std::chrono::milliseconds RETRY_BACKOFF_CAP{2000};
+
+DatabaseManager::DatabaseManager(const std::string& db_folder_path, 
+                                 size_t pool_size,
+                                 int connection_timeout,
+                                 int max_retry_attempts,
+                                 const std::string& odbc_driver)
+    : StorageBackend(db_folder_path)
+    , odbc_driver_(odbc_driver)
     , henv_(SQL_NULL_HENV)
-    , hdbc_(SQL_NULL_HDBC)
-    , connected_(false) {
-    
-    if (!std::filesystem::exists(db_folder_path_)) {
-        throw std::runtime_error("Database folder does not exist: " + db_folder_path_);
-    }
+    , pool_size_(std::max<size_t>(pool_size, 1))
+    , connection_timeout_(std::max(connection_timeout, 1))
+    , connected_(false)
+    , max_retry_attempts_(std::max(max_retry_attempts, 0)) {
     
     connect();
+    
+    fanout_workers_ = std::make_unique<WorkerPool>(pool_size_);
 }
 
 DatabaseManager::~DatabaseManager() {
+    // Outstanding probes hold pooled connections - drain them first
+    if (fanout_workers_) {
+        fanout_workers_->stop();
+    }
     disconnect();
 }
 
@@ -37,47 +65,72 @@ bool DatabaseManager::connect() {
     if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
         spdlog::error("Failed to set ODBC version");
         SQLFreeHandle(SQL_HANDLE_ENV, henv_);
-        return false;
-    }
-    
-    // Allocate connection handle
-    ret = SQLAllocHandle(SQL_HANDLE_DBC, henv_, &hdbc_);
-    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
-        spdlog::error("Failed to allocate ODBC connection handle");
-        SQLFreeHandle(SQL_HANDLE_ENV, henv_);
+        henv_ = SQL_NULL_HENV;
         return false;
     }
     
     // Build connection string for VFP ODBC
     std::string conn_str = buildConnectionString();
     
-    SQLWCHAR out_conn_str[1024];
-    SQLSMALLINT out_conn_str_len;
-    
-    // Connect to database
-    ret = SQLDriverConnectA(hdbc_, NULL, 
-                           (SQLCHAR*)conn_str.c_str(), SQL_NTS,
-                           (SQLCHAR*)out_conn_str, sizeof(out_conn_str),
-                           &out_conn_str_len, SQL_DRIVER_NOPROMPT);
+    for (size_t i = 0; i < pool_size_; ++i) {
+        SQLHDBC hdbc = SQL_NULL_HDBC;
+        
+        // Allocate connection handle
+        ret = SQLAllocHandle(SQL_HANDLE_DBC, henv_, &hdbc);
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            spdlog::error("Failed to allocate ODBC connection handle");
+            break;
+        }
+        
+        SQLSetConnectAttr(hdbc, SQL_ATTR_LOGIN_TIMEOUT, 
+                          (SQLPOINTER)(SQLULEN)connection_timeout_.count(), 0);
+        
+        SQLCHAR out_conn_str[1024];
+        SQLSMALLINT out_conn_str_len;
+        
+        // Connect to database
+        ret = SQLDriverConnect(hdbc, NULL, 
+                              (SQLCHAR*)conn_str.c_str(), SQL_NTS,
+                              out_conn_str, sizeof(out_conn_str),
+                              &out_conn_str_len, SQL_DRIVER_NOPROMPT);
+        
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            spdlog::error("Failed to connect to database");
+            logError(hdbc, SQL_HANDLE_DBC);
+            SQLFreeHandle(SQL_HANDLE_DBC, hdbc);
+            break;
+        }
+        
+        connections_.push_back(hdbc);
+        idle_connections_.push_back(hdbc);
+    }
     
-    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
-        spdlog::error("Failed to connect to database");
-        logError(hdbc_, SQL_HANDLE_DBC);
-        SQLFreeHandle(SQL_HANDLE_DBC, hdbc_);
+    if (connections_.empty()) {
         SQLFreeHandle(SQL_HANDLE_ENV, henv_);
+        henv_ = SQL_NULL_HENV;
         return false;
     }
     
+    if (connections_.size() < pool_size_) {
+        spdlog::warn("Connection pool opened {} of {} connections", connections_.size(), pool_size_);
+    }
+    
     connected_ = true;
-    spdlog::info("Connected to VFP database at: {}", db_folder_path_);
+    spdlog::info("Connected to VFP database at: {} ({} pooled connections)", 
+                 db_folder_path_, connections_.size());
     return true;
 }
 
 void DatabaseManager::disconnect() {
-    if (hdbc_ != SQL_NULL_HDBC) {
-        SQLDisconnect(hdbc_);
-        SQLFreeHandle(SQL_HANDLE_DBC, hdbc_);
-        hdbc_ = SQL_NULL_HDBC;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (SQLHDBC hdbc : connections_) {
+            SQLDisconnect(hdbc);
+            SQLFreeHandle(SQL_HANDLE_DBC, hdbc);
+        }
+        connections_.clear();
+        idle_connections_.clear();
+        stale_connections_.clear();
     }
     if (henv_ != SQL_NULL_HENV) {
         SQLFreeHandle(SQL_HANDLE_ENV, henv_);
@@ -87,11 +140,66 @@ void DatabaseManager::disconnect() {
     spdlog::info("Disconnected from database");
 }
 
+SQLHDBC DatabaseManager::acquireConnection(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    
+    if (!pool_cv_.wait_until(lock, deadline, [this] { return !idle_connections_.empty(); })) {
+        return SQL_NULL_HDBC;
+    }
+    
+    SQLHDBC hdbc = idle_connections_.back();
+    idle_connections_.pop_back();
+    
+    // A handle whose reconnect failed earlier gets another try; if the
+    // server is still unreachable the caller sees the failure on it
+    if (stale_connections_.erase(hdbc) > 0) {
+        lock.unlock();
+        reopenConnection(hdbc);
+    }
+    return hdbc;
+}
+
+void DatabaseManager::releaseConnection(SQLHDBC hdbc) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        idle_connections_.push_back(hdbc);
+    }
+    pool_cv_.notify_one();
+}
+
+bool DatabaseManager::reopenConnection(SQLHDBC hdbc) {
+    SQLDisconnect(hdbc);
+    
+    std::string conn_str = buildConnectionString();
+    SQLCHAR out_conn_str[1024];
+    SQLSMALLINT out_conn_str_len;
+    SQLRETURN ret = SQLDriverConnect(hdbc, NULL, 
+                                     (SQLCHAR*)conn_str.c_str(), SQL_NTS,
+                                     out_conn_str, sizeof(out_conn_str),
+                                     &out_conn_str_len, SQL_DRIVER_NOPROMPT);
+    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+        spdlog::error("Failed to reopen pooled connection");
+        logError(hdbc, SQL_HANDLE_DBC);
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        stale_connections_.insert(hdbc);
+        return false;
+    }
+    
+    ++reconnects_;
+    spdlog::info("Reopened pooled connection after a connection error");
+    return true;
+}
+
+size_t DatabaseManager::poolInUse() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    return connections_.size() - idle_connections_.size();
+}
+
 std::string DatabaseManager::buildConnectionString() {
     // Visual FoxPro ODBC connection string
     // CRITICAL: Uses SourceType=DBF for multi-user shared access
     std::ostringstream oss;
-    oss << "Driver={Microsoft Visual FoxPro Driver};"
+    oss << "Driver={" << odbc_driver_ << "};"
         << "SourceType=DBF;"  // DBF mode - supports multi-user
         << "SourceDB=" << db_folder_path_ << ";"
         << "Exclusive=No;"    // CRITICAL: Never exclusive
@@ -100,30 +208,6 @@ std::string DatabaseManager::buildConnectionString() {
     return oss.str();
 }
 
-std::string DatabaseManager::sanitizeFilename(const std::string& filename) {
-    // Prevent path traversal and SQL injection
-    std::string sanitized = filename;
-    
-    // Remove dangerous characters but keep .dbf extension
-    if (sanitized.find("..") != std::string::npos || 
-        sanitized.find("/") != std::string::npos || 
-        sanitized.find("\\") != std::string::npos) {
-        throw std::runtime_error("Invalid filename - path traversal detected");
-    }
-    
-    // Ensure it's a .dbf file
-    if (sanitized.length() < 4 || sanitized.substr(sanitized.length() - 4) != ".dbf") {
-        throw std::runtime_error("Invalid filename - must be .dbf file");
-    }
-    
-    return sanitized;
-}
-
-bool DatabaseManager::fileExists(const std::string& filename) {
-    std::filesystem::path dbf_path = std::filesystem::path(db_folder_path_) / filename;
-    return std::filesystem::exists(dbf_path);
-}
-
 std::vector<std::string> DatabaseManager::listDBFFiles() {
     std::vector<std::string> files;
     
@@ -136,77 +220,146 @@ std::vector<std::string> DatabaseManager::listDBFFiles() {
     return files;
 }
 
-std::string DatabaseManager::buildWhereClause(const nlohmann::json& filters) {
-    if (filters.is_null() || filters.empty()) {
-        return "";
-    }
-    
-    std::ostringstream where;
+// Statement text is assembled in the request arena and copied out once
+static void appendWhereClause(ArenaString& sql, const nlohmann::json& filters) {
     bool first = true;
-    
     for (auto& [key, value] : filters.items()) {
-        if (!first) where << " AND ";
-        where << key << " = ";
+        if (!first) sql += " AND ";
+        sql += key;
+        sql += " = ";
         
         if (value.is_string()) {
-            where << "'" << value.get<std::string>() << "'";
+            sql += '\'';
+            sql += value.get_ref<const std::string&>();
+            sql += '\'';
         } else if (value.is_number()) {
-            where << value.dump();
+            sql += value.dump();
         } else if (value.is_boolean()) {
-            where << (value.get<bool>() ? ".T." : ".F.");
+            sql += value.get<bool>() ? ".T." : ".F.";
         } else {
-            where << "NULL";
+            sql += "NULL";
         }
         
         first = false;
     }
-    
-    return where.str();
 }
 
-std::string DatabaseManager::jsonToCSV(const nlohmann::json& data) {
-    if (!data.is_array() || data.empty()) {
+std::string DatabaseManager::buildWhereClause(const nlohmann::json& filters) {
+    if (filters.is_null() || filters.empty()) {
         return "";
     }
     
-    std::ostringstream csv;
+    ArenaString where(RequestArena::resource());
+    appendWhereClause(where, filters);
+    return std::string(where);
+}
+
+std::string DatabaseManager::buildInList(const std::vector<std::string>& values,
+                                         size_t begin, size_t end) {
+    ArenaString list(RequestArena::resource());
+    list += '(';
+    for (size_t i = begin; i < end; ++i) {
+        if (i > begin) list += ", ";
+        list += '\'';
+        list += values[i];
+        list += '\'';
+    }
+    list += ')';
+    return std::string(list);
+}
+
+// Literal for INSERT values and SET assignments
+static void appendLiteral(ArenaString& sql, const nlohmann::json& value) {
+    if (value.is_string()) {
+        sql += '\'';
+        sql += value.get_ref<const std::string&>();
+        sql += '\'';
+    } else if (value.is_boolean()) {
+        sql += value.get<bool>() ? ".T." : ".F.";
+    } else {
+        sql += value.dump();
+    }
+}
+
+std::string DatabaseManager::buildInsertSQL(const std::string& table, const nlohmann::json& record) {
+    ArenaString columns(RequestArena::resource());
+    ArenaString values(RequestArena::resource());
     
-    // Header row
     bool first = true;
-    for (auto& [key, value] : data[0].items()) {
-        if (!first) csv << ",";
-        csv << "\"" << key << "\"";
+    for (auto& [key, value] : record.items()) {
+        if (!first) {
+            columns += ", ";
+            values += ", ";
+        }
+        columns += key;
+        appendLiteral(values, value);
         first = false;
     }
-    csv << "\n";
     
-    // Data rows
-    for (auto& record : data) {
-        first = true;
-        for (auto& [key, value] : record.items()) {
-            if (!first) csv << ",";
-            
-            if (value.is_string()) {
-                std::string str = value.get<std::string>();
-                // Escape quotes
-                size_t pos = 0;
-                while ((pos = str.find("\"", pos)) != std::string::npos) {
-                    str.replace(pos, 1, "\"\"");
-                    pos += 2;
-                }
-                csv << "\"" << str << "\"";
-            } else if (value.is_null()) {
-                csv << "\"\"";
-            } else {
-                csv << value.dump();
-            }
-            
-            first = false;
-        }
-        csv << "\n";
+    ArenaString sql(RequestArena::resource());
+    sql.reserve(table.size() + columns.size() + values.size() + 32);
+    sql += "INSERT INTO ";
+    sql += table;
+    sql += " (";
+    sql += columns;
+    sql += ") VALUES (";
+    sql += values;
+    sql += ')';
+    return std::string(sql);
+}
+
+std::string DatabaseManager::buildUpdateSQL(const std::string& table, const nlohmann::json& where,
+                                            const nlohmann::json& updates) {
+    ArenaString sql(RequestArena::resource());
+    sql += "UPDATE ";
+    sql += table;
+    sql += " SET ";
+    
+    bool first = true;
+    for (auto& [key, value] : updates.items()) {
+        if (!first) sql += ", ";
+        sql += key;
+        sql += " = ";
+        appendLiteral(sql, value);
+        first = false;
+    }
+    
+    if (!where.is_null() && !where.empty()) {
+        sql += " WHERE ";
+        appendWhereClause(sql, where);
+    }
+    
+    return std::string(sql);
+}
+
+std::string DatabaseManager::buildSetDeletedSQL(const std::string& table, const nlohmann::json& where,
+                                                bool deleted) {
+    ArenaString sql(RequestArena::resource());
+    sql += "UPDATE ";
+    sql += table;
+    sql += " SET deleted = ";
+    sql += deleted ? ".T." : ".F.";
+    
+    if (!where.is_null() && !where.empty()) {
+        sql += " WHERE ";
+        appendWhereClause(sql, where);
     }
     
-    return csv.str();
+    return std::string(sql);
+}
+
+std::string DatabaseManager::buildWriteSQL(const std::string& table, const WriteOperation& operation) {
+    switch (operation.type) {
+        case WriteOperation::Type::ADD:
+            return buildInsertSQL(table, operation.record);
+        case WriteOperation::Type::UPDATE:
+            return buildUpdateSQL(table, operation.where, operation.updates);
+        case WriteOperation::Type::DELETE:
+            return buildSetDeletedSQL(table, operation.where, true);
+        case WriteOperation::Type::UNDELETE:
+        default:
+            return buildSetDeletedSQL(table, operation.where, false);
+    }
 }
 
 // New file-based operations
@@ -217,6 +370,7 @@ QueryResult DatabaseManager::exportJSON(const std::string& filename, const std::
     result.index_status = IndexStatus::OK;
     
     try {
+        TraceSpan build_span("sql.build");
         std::string safe_filename = sanitizeFilename(filename);
         
         if (!fileExists(safe_filename)) {
@@ -224,14 +378,16 @@ QueryResult DatabaseManager::exportJSON(const std::string& filename, const std::
             return result;
         }
         
+        MemoPolicy memo = memoPolicy(safe_filename);
         std::ostringstream sql;
-        sql << "SELECT * FROM " << safe_filename;
+        sql << "SELECT " << selectList(memo) << " FROM " << safe_filename;
         
         if (!docnum.empty()) {
             sql << " WHERE docnum = '" << docnum << "'";
         }
+        build_span.end();
         
-        if (executeSQL(sql.str(), result.data)) {
+        if (executeSQL(sql.str(), result.rows, tableEncoding(safe_filename), memo)) {
             result.success = true;
             result.message = docnum.empty() ? "All records exported" : "Record found";
         } else {
@@ -245,48 +401,127 @@ QueryResult DatabaseManager::exportJSON(const std::string& filename, const std::
     return result;
 }
 
-QueryResult DatabaseManager::exportCSV(const std::string& filename, const std::string& docnum) {
-    QueryResult result = exportJSON(filename, docnum);
+QueryResult DatabaseManager::search(const std::string& filename, 
+                                    const std::map<std::string, std::string>& filters, 
+                                    int limit) {
+    return searchRecords(filename, filters, limit, 1, UINT32_MAX);
+}
+
+QueryResult DatabaseManager::searchRange(const std::string& filename,
+                                         const std::map<std::string, std::string>& filters,
+                                         uint32_t first, uint32_t last) {
+    return searchRecords(filename, filters, -1, first, last);
+}
+
+QueryResult DatabaseManager::searchRecords(const std::string& filename,
+                                           const std::map<std::string, std::string>& filters,
+                                           int limit, uint32_t first, uint32_t last) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
     
-    if (result.success && result.data.is_array()) {
-        std::string csv = jsonToCSV(result.data);
-        result.data = csv;
+    try {
+        TraceSpan build_span("sql.build");
+        std::string safe_filename = sanitizeFilename(filename);
+        
+        if (!fileExists(safe_filename)) {
+            result.message = "File not found: " + safe_filename;
+            return result;
+        }
+        
+        MemoPolicy memo = memoPolicy(safe_filename);
+        std::ostringstream sql;
+        sql << "SELECT ";
+        if (limit >= 0) {
+            sql << "TOP " << limit << " ";
+        }
+        sql << selectList(memo) << " FROM " << safe_filename;
+        
+        const char* keyword = " WHERE ";
+        if (first != 1 || last != UINT32_MAX) {
+            sql << keyword << "RECNO() BETWEEN " << first << " AND " << last;
+            keyword = " AND ";
+        }
+        for (auto& [key, value] : filters) {
+            sql << keyword << key << " LIKE '%" << value << "%'";
+            keyword = " AND ";
+        }
+        build_span.end();
+        
+        if (executeSQL(sql.str(), result.rows, tableEncoding(safe_filename), memo)) {
+            result.success = true;
+            result.message = "Search completed";
+        } else {
+            result.message = "Search failed";
+        }
+        
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
     }
     
     return result;
 }
 
-QueryResult DatabaseManager::search(const std::string& filename, 
-                                    const std::map<std::string, std::string>& filters, 
-                                    int limit) {
+// Sort and filter columns go into the statement as they are, so only
+// plain names pass
+static bool isColumnName(const std::string& name) {
+    return !name.empty() && std::all_of(name.begin(), name.end(), [](unsigned char c) {
+        return std::isalnum(c) || c == '_';
+    });
+}
+
+QueryResult DatabaseManager::searchPage(const std::string& filename, const PageRequest& request,
+                                        size_t& matches) {
     QueryResult result;
     result.success = false;
     result.index_status = IndexStatus::OK;
     
     try {
+        TraceSpan build_span("sql.build");
         std::string safe_filename = sanitizeFilename(filename);
         
         if (!fileExists(safe_filename)) {
             result.message = "File not found: " + safe_filename;
             return result;
         }
+        if (!request.sort.empty() && !isColumnName(request.sort)) {
+            result.message = "Invalid sort column: " + request.sort;
+            return result;
+        }
         
-        std::ostringstream sql;
-        sql << "SELECT TOP " << limit << " * FROM " << safe_filename;
-        
-        if (!filters.empty()) {
-            sql << " WHERE ";
-            bool first = true;
-            for (auto& [key, value] : filters) {
-                if (!first) sql << " AND ";
-                sql << key << " LIKE '%" << value << "%'";
-                first = false;
+        // Filters come from the /view URL: a value could only end its
+        // literal with a quote, which VFP has no escape for
+        std::ostringstream where;
+        const char* keyword = " WHERE ";
+        for (auto& [key, value] : request.filters) {
+            if (!isColumnName(key)) {
+                result.message = "Invalid filter column: " + key;
+                return result;
+            }
+            if (value.find('\'') != std::string::npos) {
+                result.message = "Invalid filter value for " + key + ": quotes are not allowed";
+                return result;
             }
+            where << keyword << key << " LIKE '%" << value << "%'";
+            keyword = " AND ";
+        }
+        
+        MemoPolicy memo = memoPolicy(safe_filename);
+        std::ostringstream sql;
+        sql << "SELECT TOP " << std::max<size_t>(request.offset + request.limit, 1) << " "
+            << selectList(memo) << " FROM " << safe_filename << where.str();
+        if (!request.sort.empty()) {
+            sql << " ORDER BY " << request.sort << (request.descending ? " DESC" : "");
         }
+        build_span.end();
         
-        if (executeSQL(sql.str(), result.data)) {
+        // Only the page's rows are read and held; the ones before it are
+        // fetched past
+        TextEncoding encoding = tableEncoding(safe_filename);
+        if (executeSQLCount("SELECT COUNT(*) FROM " + safe_filename + where.str(), encoding, matches) &&
+            executeSQL(sql.str(), result.rows, encoding, memo, request.offset)) {
             result.success = true;
-            result.message = "Search completed";
+            result.message = "Page retrieved";
         } else {
             result.message = "Search failed";
         }
@@ -311,10 +546,11 @@ QueryResult DatabaseManager::getAllRecords(const std::string& filename, int limi
             return result;
         }
         
+        MemoPolicy memo = memoPolicy(safe_filename);
         std::ostringstream sql;
-        sql << "SELECT TOP " << limit << " * FROM " << safe_filename;
+        sql << "SELECT TOP " << limit << " " << selectList(memo) << " FROM " << safe_filename;
         
-        if (executeSQL(sql.str(), result.data)) {
+        if (executeSQL(sql.str(), result.rows, tableEncoding(safe_filename), memo)) {
             result.success = true;
             result.message = "Records retrieved";
         } else {
@@ -328,37 +564,157 @@ QueryResult DatabaseManager::getAllRecords(const std::string& filename, int limi
     return result;
 }
 
-QueryResult DatabaseManager::findByDocnum(const std::string& docnum) {
+DatabaseManager::FanOutResult DatabaseManager::fanOut(
+        const std::vector<std::string>& tables,
+        std::function<bool(const std::string&, nlohmann::json&)> probe,
+        bool stop_on_first_hit,
+        std::chrono::steady_clock::time_point deadline) {
+    
+    // Shared with the probes so that stragglers can outlive this call
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t pending = 0;
+        bool hit = false;
+        std::atomic<bool> abandoned{false};
+        std::vector<bool> done;
+        FanOutResult result;
+    };
+    auto state = std::make_shared<State>();
+    state->pending = tables.size();
+    state->done.assign(tables.size(), false);
+    
+    // Probes run on pool threads under their own context, bounded by the
+    // fan-out deadline and cancelled along with the caller's request
+    auto parent = RequestContext::current();
+    if (parent) {
+        deadline = std::min(deadline, parent->deadline());
+    }
+    auto probe_context = std::make_shared<RequestContext>(deadline);
+    if (parent) {
+        probe_context->setOrigin(parent->origin(), parent->route());
+    }
+    uint64_t parent_hook = 0;
+    if (parent) {
+        parent_hook = parent->addCancelHook([probe_context] {
+            probe_context->cancel("request cancelled");
+        });
+    }
+    
+    // Probe spans join the caller's trace, nested under its current span
+    auto trace = RequestTrace::current();
+    uint64_t parent_span = RequestTrace::currentSpanId();
+    
+    for (size_t i = 0; i < tables.size(); ++i) {
+        fanout_workers_->submit([state, probe, probe_context, trace, parent_span, table = tables[i], i] {
+            RequestContext::Scope scope(probe_context);
+            RequestTrace::Scope trace_scope(trace, parent_span);
+            TraceSpan probe_span("fanout.probe", table);
+            nlohmann::json records;
+            bool ok = false;
+            
+            // Skip probes nobody is waiting for any more
+            if (!state->abandoned) {
+                ok = probe(table, records);
+            }
+            probe_span.end();
+            
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done[i] = true;
+            if (ok) {
+                if (records.is_array() && !records.empty()) {
+                    state->hit = true;
+                }
+                state->result.completed.emplace_back(table, std::move(records));
+            } else if (!state->abandoned) {
+                state->result.failed.push_back(table);
+            }
+            --state->pending;
+            state->cv.notify_all();
+        });
+    }
+    
+    FanOutResult result;
+    bool stragglers = false;
+    bool early_hit = false;
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait_until(lock, deadline, [&] {
+            return state->pending == 0 || (stop_on_first_hit && state->hit);
+        });
+        state->abandoned = true;
+        
+        result = std::move(state->result);
+        state->result = FanOutResult{};
+        
+        stragglers = state->pending > 0;
+        early_hit = stop_on_first_hit && state->hit;
+        if (stragglers && !early_hit) {
+            for (size_t i = 0; i < tables.size(); ++i) {
+                if (!state->done[i]) {
+                    result.timed_out.push_back(tables[i]);
+                }
+            }
+        }
+    }
+    
+    // Give the stragglers' connections back instead of letting them run on
+    if (stragglers) {
+        probe_context->cancel(early_hit ? "first hit found" : "lookup deadline");
+    }
+    if (parent) {
+        parent->removeCancelHook(parent_hook);
+    }
+    
+    return result;
+}
+
+QueryResult DatabaseManager::findByDocnum(const std::string& docnum, bool first_only,
+                                          std::chrono::milliseconds timeout) {
     QueryResult result;
     result.success = false;
     result.index_status = IndexStatus::OK;
     
     try {
-        // Common DBF files to search
-        std::vector<std::string> tables = {
-            "invoice.dbf", "receipt.dbf", "order.dbf", 
-            "quotation.dbf", "payment.dbf", "delivery.dbf"
-        };
-        
         result.data = nlohmann::json::array();
         
-        for (const auto& table : tables) {
+        std::vector<std::string> tables;
+        for (const auto& table : docnumTables()) {
             if (fileExists(table)) {
-                std::ostringstream sql;
-                sql << "SELECT * FROM " << table << " WHERE docnum = '" << docnum << "'";
-                
-                nlohmann::json temp_result;
-                if (executeSQL(sql.str(), temp_result)) {
-                    if (temp_result.is_array()) {
-                        for (auto& record : temp_result) {
-                            record["_source_file"] = table;
-                            result.data.push_back(record);
-                        }
-                    }
-                }
+                tables.push_back(table);
             }
         }
         
+        auto probe = [this, docnum](const std::string& table, nlohmann::json& records) {
+            MemoPolicy memo = memoPolicy(table);
+            std::ostringstream sql;
+            sql << "SELECT " << selectList(memo) << " FROM " << table << " WHERE docnum = '" << docnum << "'";
+            return executeSQL(sql.str(), records, tableEncoding(table), memo);
+        };
+        
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        auto fanout = fanOut(tables, probe, first_only, deadline);
+        
+        for (auto& [table, records] : fanout.completed) {
+            if (!records.is_array()) {
+                continue;
+            }
+            for (auto& record : records) {
+                record["_source_file"] = table;
+                result.data.push_back(std::move(record));
+            }
+            if (first_only && !result.data.empty()) {
+                break;
+            }
+        }
+        
+        for (const auto& table : fanout.failed) {
+            result.warnings.push_back("Lookup failed in " + table);
+        }
+        for (const auto& table : fanout.timed_out) {
+            result.warnings.push_back("Lookup timed out in " + table);
+        }
+        
         if (!result.data.empty()) {
             result.success = true;
             result.message = "Document found in " + std::to_string(result.data.size()) + " table(s)";
@@ -373,49 +729,131 @@ QueryResult DatabaseManager::findByDocnum(const std::string& docnum) {
     return result;
 }
 
-QueryResult DatabaseManager::add(const std::string& filename, const nlohmann::json& record) {
+QueryResult DatabaseManager::findByDocnums(const std::vector<std::string>& docnums) {
     QueryResult result;
     result.success = false;
     result.index_status = IndexStatus::OK;
     
     try {
-        std::string safe_filename = sanitizeFilename(filename);
-        
-        if (!fileExists(safe_filename)) {
-            result.message = "File not found: " + safe_filename;
+        if (docnums.empty()) {
+            result.message = "No document numbers given";
+            return result;
+        }
+        if (docnums.size() > DOCNUM_BATCH_MAX) {
+            result.message = "Too many document numbers (max " + std::to_string(DOCNUM_BATCH_MAX) + ")";
             return result;
         }
         
-        // Build INSERT statement
-        std::ostringstream sql;
-        std::vector<std::string> columns;
-        std::vector<std::string> values;
-        
-        for (auto& [key, value] : record.items()) {
-            columns.push_back(key);
-            if (value.is_string()) {
-                values.push_back("'" + value.get<std::string>() + "'");
-            } else if (value.is_boolean()) {
-                values.push_back(value.get<bool>() ? ".T." : ".F.");
-            } else {
-                values.push_back(value.dump());
+        // De-duplicate; `unique` keeps request order for the IN lists, while the
+        // response object (a std::map) comes back sorted by docnum
+        std::vector<std::string> unique;
+        result.data = nlohmann::json::object();
+        for (const auto& docnum : docnums) {
+            // VFP string literals cannot escape quotes, so reject them outright
+            if (docnum.empty() || docnum.find_first_of("'\"[]") != std::string::npos) {
+                result.message = "Invalid document number: " + docnum;
+                result.data = nullptr;
+                return result;
+            }
+            if (!result.data.contains(docnum)) {
+                result.data[docnum] = nlohmann::json::array();
+                unique.push_back(docnum);
+            }
+        }
+        
+        std::vector<std::string> tables;
+        for (const auto& table : docnumTables()) {
+            if (fileExists(table)) {
+                tables.push_back(table);
+            }
+        }
+        
+        // One pass per table, tables probed concurrently: each chunk resolves
+        // up to DOCNUM_IN_LIST_CHUNK docnums
+        auto probe = [this, unique](const std::string& table, nlohmann::json& records) {
+            records = nlohmann::json::array();
+            MemoPolicy memo = memoPolicy(table);
+            for (size_t begin = 0; begin < unique.size(); begin += DOCNUM_IN_LIST_CHUNK) {
+                size_t end = std::min(begin + DOCNUM_IN_LIST_CHUNK, unique.size());
+                
+                std::ostringstream sql;
+                sql << "SELECT " << selectList(memo) << " FROM " << table << " WHERE docnum IN " 
+                    << buildInList(unique, begin, end);
+                
+                nlohmann::json chunk;
+                if (!executeSQL(sql.str(), chunk, tableEncoding(table), memo) || !chunk.is_array()) {
+                    return false;
+                }
+                for (auto& record : chunk) {
+                    records.push_back(std::move(record));
+                }
+            }
+            return true;
+        };
+        
+        auto deadline = std::chrono::steady_clock::now() + connection_timeout_;
+        auto fanout = fanOut(tables, probe, false, deadline);
+        
+        size_t matched_records = 0;
+        for (auto& [table, records] : fanout.completed) {
+            for (auto& record : records) {
+                // CHAR columns come back blank-padded
+                std::string key;
+                if (record.contains("docnum") && record["docnum"].is_string()) {
+                    key = record["docnum"].get<std::string>();
+                }
+                key.erase(key.find_last_not_of(' ') + 1);
+                
+                if (!result.data.contains(key)) {
+                    continue;
+                }
+                record["_source_file"] = table;
+                result.data[key].push_back(std::move(record));
+                ++matched_records;
             }
         }
         
-        sql << "INSERT INTO " << safe_filename << " (";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            if (i > 0) sql << ", ";
-            sql << columns[i];
+        for (const auto& table : fanout.failed) {
+            result.warnings.push_back("Lookup failed in " + table);
         }
-        sql << ") VALUES (";
-        for (size_t i = 0; i < values.size(); ++i) {
-            if (i > 0) sql << ", ";
-            sql << values[i];
+        for (const auto& table : fanout.timed_out) {
+            result.warnings.push_back("Lookup timed out in " + table);
         }
-        sql << ")";
+        
+        size_t resolved = 0;
+        for (auto& [key, records] : result.data.items()) {
+            if (!records.empty()) ++resolved;
+        }
+        
+        result.success = true;
+        result.message = "Resolved " + std::to_string(resolved) + " of " + 
+                         std::to_string(unique.size()) + " document(s), " +
+                         std::to_string(matched_records) + " record(s)";
+        
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DatabaseManager::add(const std::string& filename, const nlohmann::json& record) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        
+        if (!fileExists(safe_filename)) {
+            result.message = "File not found: " + safe_filename;
+            return result;
+        }
+        
+        std::string sql = buildInsertSQL(safe_filename, record);
         
         nlohmann::json exec_result;
-        if (executeSQL(sql.str(), exec_result)) {
+        if (executeSQL(sql, exec_result, tableEncoding(safe_filename))) {
             result.success = true;
             result.message = "Record added successfully";
             result.data = record;
@@ -447,31 +885,10 @@ QueryResult DatabaseManager::update(const std::string& filename, const nlohmann:
             return result;
         }
         
-        // Build UPDATE statement
-        std::ostringstream sql;
-        sql << "UPDATE " << safe_filename << " SET ";
-        
-        bool first = true;
-        for (auto& [key, value] : updates.items()) {
-            if (!first) sql << ", ";
-            sql << key << " = ";
-            if (value.is_string()) {
-                sql << "'" << value.get<std::string>() << "'";
-            } else if (value.is_boolean()) {
-                sql << (value.get<bool>() ? ".T." : ".F.");
-            } else {
-                sql << value.dump();
-            }
-            first = false;
-        }
-        
-        std::string where_clause = buildWhereClause(where);
-        if (!where_clause.empty()) {
-            sql << " WHERE " << where_clause;
-        }
+        std::string sql = buildUpdateSQL(safe_filename, where, updates);
         
         nlohmann::json exec_result;
-        if (executeSQL(sql.str(), exec_result)) {
+        if (executeSQL(sql, exec_result, tableEncoding(safe_filename))) {
             result.success = true;
             result.message = "Record(s) updated successfully";
             result.data = updates;
@@ -503,16 +920,10 @@ QueryResult DatabaseManager::deleteRecords(const std::string& filename, const nl
         }
         
         // Soft delete - mark as deleted
-        std::ostringstream sql;
-        sql << "UPDATE " << safe_filename << " SET deleted = .T.";
-        
-        std::string where_clause = buildWhereClause(where);
-        if (!where_clause.empty()) {
-            sql << " WHERE " << where_clause;
-        }
+        std::string sql = buildSetDeletedSQL(safe_filename, where, true);
         
         nlohmann::json exec_result;
-        if (executeSQL(sql.str(), exec_result)) {
+        if (executeSQL(sql, exec_result, tableEncoding(safe_filename))) {
             result.success = true;
             result.message = "Record(s) marked as deleted";
             result.index_status = IndexStatus::OK;
@@ -543,16 +954,10 @@ QueryResult DatabaseManager::undeleteRecords(const std::string& filename, const
         }
         
         // Undelete - unmark as deleted
-        std::ostringstream sql;
-        sql << "UPDATE " << safe_filename << " SET deleted = .F.";
-        
-        std::string where_clause = buildWhereClause(where);
-        if (!where_clause.empty()) {
-            sql << " WHERE " << where_clause;
-        }
+        std::string sql = buildSetDeletedSQL(safe_filename, where, false);
         
         nlohmann::json exec_result;
-        if (executeSQL(sql.str(), exec_result)) {
+        if (executeSQL(sql, exec_result, tableEncoding(safe_filename))) {
             result.success = true;
             result.message = "Record(s) restored";
             result.index_status = IndexStatus::OK;
@@ -599,77 +1004,561 @@ QueryResult DatabaseManager::pack(const std::string& filename) {
     return result;
 }
 
-bool DatabaseManager::executeSQL(const std::string& sql, nlohmann::json& result) {
+std::vector<QueryResult> DatabaseManager::applyWriteBatch(const std::string& filename,
+                                                         const std::vector<WriteOperation>& operations) {
+    std::vector<QueryResult> results(operations.size());
+    for (auto& result : results) {
+        result.success = false;
+        result.index_status = IndexStatus::OK;
+    }
+    
+    auto fail = [&results](size_t index, const std::string& message) {
+        results[index].message = message;
+        results[index].index_status = IndexStatus::PENDING;
+    };
+    
+    std::vector<std::string> statements;
+    TextEncoding encoding = TextEncoding::UTF8;
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        
+        if (!fileExists(safe_filename)) {
+            for (size_t i = 0; i < operations.size(); ++i) {
+                results[i].message = "File not found: " + safe_filename;
+            }
+            return results;
+        }
+        
+        for (const auto& operation : operations) {
+            statements.push_back(buildWriteSQL(safe_filename, operation));
+        }
+        encoding = tableEncoding(safe_filename);
+    } catch (const std::exception& e) {
+        for (auto& result : results) {
+            result.message = std::string("Error: ") + e.what();
+            result.index_status = IndexStatus::FAILED;
+        }
+        return results;
+    }
+    
+    auto succeed = [&](size_t index) {
+        const auto& operation = operations[index];
+        auto& result = results[index];
+        result.success = true;
+        switch (operation.type) {
+            case WriteOperation::Type::ADD:
+                result.message = "Record added successfully";
+                result.data = operation.record;
+                break;
+            case WriteOperation::Type::UPDATE:
+                result.message = "Record(s) updated successfully";
+                result.data = operation.updates;
+                break;
+            case WriteOperation::Type::DELETE:
+                result.message = "Record(s) marked as deleted";
+                break;
+            case WriteOperation::Type::UNDELETE:
+                result.message = "Record(s) restored";
+                break;
+        }
+    };
+    
+    // Operations still to apply, in submission order
+    std::vector<size_t> pending(operations.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        pending[i] = i;
+    }
+    
+    int attempt = 0;
+    while (!pending.empty()) {
+        SQLHDBC hdbc = acquireConnection(std::chrono::steady_clock::now() + connection_timeout_);
+        if (hdbc == SQL_NULL_HDBC) {
+            for (size_t index : pending) {
+                fail(index, "Timed out waiting for a pooled connection");
+            }
+            break;
+        }
+        
+        // Free tables may not support manual commit; then each statement
+        // commits on its own and only the connection is shared
+        SQLRETURN ret = SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, 
+                                          (SQLPOINTER)SQL_AUTOCOMMIT_OFF, SQL_IS_UINTEGER);
+        bool transactional = (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO);
+        
+        size_t failed_at = pending.size();
+        SqlError error;
+        
+        for (size_t k = 0; k < pending.size(); ++k) {
+            SQLHSTMT stmt;
+            ret = SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &stmt);
+            if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+                error.message = "Failed to allocate statement handle";
+                failed_at = k;
+                break;
+            }
+            
+            const std::string& sql = statements[pending[k]];
+            auto start = std::chrono::steady_clock::now();
+            std::string driver_sql = fromUtf8(sql, encoding);
+            ret = SQLExecDirect(stmt, (SQLCHAR*)driver_sql.c_str(), SQL_NTS);
+            QueryStats::instance().record(sql,
+                                          std::chrono::duration_cast<std::chrono::microseconds>(
+                                              std::chrono::steady_clock::now() - start),
+                                          ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO,
+                                          0, 0, "write-behind " + filename, "write_behind");
+            if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+                error = readError(stmt, SQL_HANDLE_STMT);
+                SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+                failed_at = k;
+                break;
+            }
+            SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        }
+        
+        if (failed_at == pending.size() && transactional) {
+            ret = SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_COMMIT);
+            if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+                error = readError(hdbc, SQL_HANDLE_DBC);
+                failed_at = 0;
+            }
+        }
+        
+        size_t applied = 0;
+        if (failed_at < pending.size() && transactional) {
+            SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_ROLLBACK);
+        } else {
+            // Without a transaction the statements before the failure stuck
+            applied = failed_at;
+        }
+        
+        if (transactional) {
+            SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_ON, SQL_IS_UINTEGER);
+        }
+        if (isConnectionError(error)) {
+            reopenConnection(hdbc);
+        }
+        releaseConnection(hdbc);
+        
+        for (size_t k = 0; k < applied; ++k) {
+            succeed(pending[k]);
+        }
+        pending.erase(pending.begin(), pending.begin() + applied);
+        
+        if (pending.empty()) {
+            break;
+        }
+        
+        // Lock conflicts roll the whole batch back and retry it after a backoff
+        if (error.kind == SqlErrorClass::LOCK_CONFLICT && attempt < max_retry_attempts_) {
+            ++lock_conflicts_;
+            auto backoff = retryBackoff(attempt++);
+            spdlog::warn("Write batch on {} hit a lock conflict ({} - {}), retrying {} operation(s) in {}ms",
+                         filename, error.sql_state, error.message, pending.size(), backoff.count());
+            ++retry_count_;
+            std::this_thread::sleep_for(backoff);
+            lock_wait_ms_ += backoff.count();
+            continue;
+        }
+        
+        if (error.kind == SqlErrorClass::LOCK_CONFLICT) {
+            // Retries exhausted - everything still pending fails with the lock error
+            ++retries_exhausted_;
+            for (size_t index : pending) {
+                fail(index, "Write failed: " + error.message);
+            }
+            break;
+        }
+        
+        if (error.kind == SqlErrorClass::TRANSIENT) {
+            // A write cut off by a connection error may or may not have
+            // reached the table; running it again could apply it twice
+            spdlog::error("Write batch on {} lost its connection ({} - {}), {} operation(s) not retried",
+                          filename, error.sql_state, error.message, pending.size());
+            for (size_t index : pending) {
+                fail(index, "Write failed, outcome unknown: " + error.message);
+            }
+            break;
+        }
+        
+        // A bad statement fails alone; the rest of the batch is re-applied
+        size_t bad = pending[failed_at - applied];
+        spdlog::error("SQL execution failed: {}", statements[bad]);
+        spdlog::error("ODBC Error: {} ({}) - {}", error.sql_state, error.native_error, error.message);
+        fail(bad, "Write failed: " + error.message);
+        pending.erase(pending.begin() + (failed_at - applied));
+    }
+    
+    return results;
+}
+
+bool DatabaseManager::executeSQL(const std::string& sql, nlohmann::json& result, TextEncoding encoding,
+                                 const MemoPolicy& memo) {
+    RowSet rows;
+    if (!executeSQL(sql, rows, encoding, memo)) {
+        return false;
+    }
+    if (rows.columnCount() > 0) {
+        result = rows.toJson();
+    }
+    return true;
+}
+
+bool DatabaseManager::executeSQL(const std::string& sql, RowSet& result, TextEncoding encoding,
+                                 const MemoPolicy& memo, size_t skip) {
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes_fetched = 0;
+    bool success = executeStatement(sql, result, bytes_fetched, encoding, memo, skip);
+    
+    // Every statement feeds the per-fingerprint statistics and the slow log
+    auto context = RequestContext::current();
+    QueryStats::instance().record(sql, 
+                                  std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now() - start),
+                                  success,
+                                  success ? result.size() : 0,
+                                  bytes_fetched,
+                                  context ? context->origin() : "",
+                                  context ? context->route() : "");
+    return success;
+}
+
+bool DatabaseManager::executeSQLCount(const std::string& sql, TextEncoding encoding, size_t& count) {
+    RowSet rows;
+    if (!executeSQL(sql, rows, encoding) || rows.empty() || rows.columnCount() == 0) {
+        return false;
+    }
+    
+    // The driver returns COUNT(*) as numeric text, possibly blank-padded
+    std::string_view text = rows.cell(0, 0).text;
+    size_t begin = text.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        return false;
+    }
+    text.remove_prefix(begin);
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+    return error == std::errc();
+}
+
+bool DatabaseManager::executeStatement(const std::string& sql, RowSet& result,
+                                       size_t& bytes_fetched, TextEncoding encoding,
+                                       const MemoPolicy& memo, size_t skip) {
     if (!connected_) {
         spdlog::error("Not connected to database");
         return false;
     }
     
-    SQLHSTMT stmt;
+    // Bound the statement by the request deadline when called from a request
+    auto context = RequestContext::current();
+    auto deadline = std::chrono::steady_clock::now() + connection_timeout_;
+    if (context) {
+        if (context->cancelled() || context->expired()) {
+            spdlog::warn("Skipping query for cancelled request: {}", sql);
+            return false;
+        }
+        deadline = std::min(deadline, context->deadline());
+    }
+    
+    SQLHDBC hdbc = SQL_NULL_HDBC;
+    SQLHSTMT stmt = SQL_NULL_HSTMT;
     SQLRETURN ret;
+    uint64_t cancel_hook = 0;
     
-    // Allocate statement handle
-    ret = SQLAllocHandle(SQL_HANDLE_STMT, hdbc_, &stmt);
-    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
-        spdlog::error("Failed to allocate statement handle");
-        return false;
-    }
+    // Literals go to the driver in the table's code page
+    std::string driver_sql = fromUtf8(sql, encoding);
     
-    // Execute SQL
-    ret = SQLExecDirectA(stmt, (SQLCHAR*)sql.c_str(), SQL_NTS);
-    if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
-        spdlog::error("SQL execution failed: {}", sql);
-        logError(stmt, SQL_HANDLE_STMT);
+    // INSERT, UPDATE and DELETE are not safe to repeat after a connection
+    // error: the first attempt may have been applied before the link dropped
+    bool idempotent = sql.rfind("SELECT", 0) == 0;
+    
+    auto cleanup = [&](bool reopen = false) {
+        if (context) {
+            context->removeCancelHook(cancel_hook);
+        }
         SQLFreeHandle(SQL_HANDLE_STMT, stmt);
-        return false;
+        // A dropped link is reopened before the handle goes back to the
+        // pool, so neither the retry nor the next request gets it dead
+        if (reopen) {
+            reopenConnection(hdbc);
+        }
+        releaseConnection(hdbc);
+    };
+    
+    // Lock conflicts, and transient failures of queries, are retried
+    // inside the deadline
+    for (int attempt = 0; ; ++attempt) {
+        TraceSpan acquire_span("pool.acquire");
+        hdbc = acquireConnection(deadline);
+        acquire_span.end();
+        if (hdbc == SQL_NULL_HDBC) {
+            spdlog::error("Timed out waiting for a pooled connection");
+            return false;
+        }
+        
+        // Allocate statement handle
+        ret = SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &stmt);
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            spdlog::error("Failed to allocate statement handle");
+            releaseConnection(hdbc);
+            return false;
+        }
+        
+        // Driver-side timeout, rounded up to whole seconds
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        SQLULEN timeout_seconds = static_cast<SQLULEN>(std::max<long long>(1, (remaining.count() + 999) / 1000));
+        SQLSetStmtAttr(stmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)timeout_seconds, 0);
+        
+        // Deadline expiry or client disconnect cancels the running statement
+        if (context) {
+            cancel_hook = context->addCancelHook([stmt] { SQLCancel(stmt); });
+        }
+        
+        // Execute SQL
+        TraceSpan execute_span("sql.execute");
+        auto execute_start = std::chrono::steady_clock::now();
+        ret = SQLExecDirect(stmt, (SQLCHAR*)driver_sql.c_str(), SQL_NTS);
+        execute_span.end();
+        Metrics::instance().recordOdbcExecute(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - execute_start));
+        if (ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO) {
+            break;
+        }
+        
+        if (context && context->cancelled()) {
+            spdlog::warn("SQL cancelled ({}): {}", context->cancelReason(), sql);
+            cleanup();
+            return false;
+        }
+        
+        SqlError error = readError(stmt, SQL_HANDLE_STMT);
+        cleanup(isConnectionError(error));
+        
+        if (error.kind == SqlErrorClass::FATAL ||
+            (error.kind == SqlErrorClass::TRANSIENT && !idempotent)) {
+            spdlog::error("SQL execution failed: {}", sql);
+            spdlog::error("ODBC Error: {} ({}) - {}", error.sql_state, error.native_error, error.message);
+            return false;
+        }
+        
+        if (error.kind == SqlErrorClass::LOCK_CONFLICT) {
+            ++lock_conflicts_;
+        }
+        
+        auto backoff = retryBackoff(attempt);
+        if (attempt >= max_retry_attempts_ || 
+            std::chrono::steady_clock::now() + backoff >= deadline) {
+            ++retries_exhausted_;
+            spdlog::error("SQL execution failed after {} attempt(s): {}", attempt + 1, sql);
+            spdlog::error("ODBC Error: {} ({}) - {}", error.sql_state, error.native_error, error.message);
+            return false;
+        }
+        
+        spdlog::warn("{} on attempt {} ({} - {}), retrying in {}ms: {}",
+                     error.kind == SqlErrorClass::LOCK_CONFLICT ? "Lock conflict" : "Transient error",
+                     attempt + 1, error.sql_state, error.message, backoff.count(), sql);
+        
+        ++retry_count_;
+        auto wait_start = std::chrono::steady_clock::now();
+        bool slept = true;
+        if (context) {
+            slept = context->sleepFor(backoff);
+        } else {
+            std::this_thread::sleep_for(backoff);
+        }
+        if (error.kind == SqlErrorClass::LOCK_CONFLICT) {
+            lock_wait_ms_ += std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - wait_start).count();
+        }
+        if (!slept) {
+            spdlog::warn("SQL retry abandoned ({}): {}", context->cancelReason(), sql);
+            return false;
+        }
     }
     
     // For SELECT queries, fetch results
     if (sql.find("SELECT") != std::string::npos) {
-        SQLSMALLINT column_count;
-        SQLNumResultCols(stmt, &column_count);
-        
-        result = nlohmann::json::array();
-        
-        while (SQLFetch(stmt) == SQL_SUCCESS) {
-            nlohmann::json row;
-            for (SQLSMALLINT i = 1; i <= column_count; ++i) {
-                char column_name[256];
-                SQLSMALLINT name_len;
-                SQLDescribeColA(stmt, i, (SQLCHAR*)column_name, sizeof(column_name), 
-                               &name_len, NULL, NULL, NULL, NULL);
-                
-                char value[1024];
-                SQLLEN indicator;
-                ret = SQLGetData(stmt, i, SQL_C_CHAR, value, sizeof(value), &indicator);
-                
-                if (ret == SQL_SUCCESS && indicator != SQL_NULL_DATA) {
-                    row[column_name] = value;
-                } else {
-                    row[column_name] = nullptr;
-                }
-            }
-            result.push_back(row);
+        TraceSpan fetch_span("sql.fetch");
+        auto fetch_start = std::chrono::steady_clock::now();
+        
+        fetchRows(stmt, result, bytes_fetched, encoding, memo, skip);
+        
+        Metrics::instance().recordOdbcFetch(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - fetch_start), result.size(), bytes_fetched);
+        fetch_span.end();
+        
+        // A cancelled fetch ends early - do not hand back a partial result
+        if (context && context->cancelled()) {
+            spdlog::warn("SQL fetch cancelled ({}): {}", context->cancelReason(), sql);
+            cleanup();
+            return false;
         }
     }
     
-    SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+    cleanup();
     return true;
 }
 
-QueryResult DatabaseManager::getIndexStatus(const std::string& filename) {
-    QueryResult result;
-    result.success = true;
-    result.message = "Index status retrieved";
-    result.index_status = checkIndexHealth(filename);
-    
-    result.data = {
-        {"file", filename},
-        {"status", result.index_status == IndexStatus::OK ? "ok" : 
-                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"}
-    };
+MemoPolicy DatabaseManager::memoPolicy(const std::string& table) {
+    // No table name means memos are inlined, as for tables without any
+    MemoPolicy memo;
+    if (tableHasMemo(table)) {
+        memo.table = table;
+        memo.inline_bytes = memoInlineBytes();
+    }
+    return memo;
+}
+
+std::string DatabaseManager::selectList(const MemoPolicy& memo) {
+    // Memo references name the record, so rows carry RECNO() alongside
+    return memo.table.empty() ? "*" : "RECNO() AS _recno, *";
+}
+
+// Reads one column of the current row in 1KB parts (SQLGetData returns
+// SQL_SUCCESS_WITH_INFO while more remains), stopping once `limit` bytes
+// are in. `total` is the full length the driver reports, or SQL_NO_TOTAL.
+// False for NULL and errors.
+static bool getColumnData(SQLHSTMT stmt, SQLUSMALLINT column, size_t limit,
+                          ArenaString& value, SQLLEN& total, bool& complete) {
+    char buffer[1024];
+    value.clear();
+    total = 0;
+    complete = false;
     
-    return result;
+    for (bool first = true; ; first = false) {
+        SQLLEN indicator = 0;
+        SQLRETURN ret = SQLGetData(stmt, column, SQL_C_CHAR, buffer, sizeof(buffer), &indicator);
+        if (ret == SQL_NO_DATA && !first) {
+            complete = true;
+            return true;
+        }
+        if ((ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) || indicator == SQL_NULL_DATA) {
+            return false;
+        }
+        if (first) {
+            total = indicator;
+        }
+        
+        bool more = ret == SQL_SUCCESS_WITH_INFO;
+        size_t part = more ? sizeof(buffer) - 1 :
+                      indicator == SQL_NO_TOTAL ? std::strlen(buffer) : static_cast<size_t>(indicator);
+        value.append(buffer, std::min(part, sizeof(buffer) - 1));
+        if (!more) {
+            complete = true;
+            return true;
+        }
+        if (value.size() > limit) {
+            return true;
+        }
+    }
+}
+
+// What a driver column type means for formats that keep types
+static ColumnType columnType(SQLSMALLINT data_type) {
+    switch (data_type) {
+        case SQL_CHAR:
+        case SQL_VARCHAR:
+        case SQL_WCHAR:
+        case SQL_WVARCHAR:
+            return ColumnType::TEXT;
+        case SQL_DECIMAL:
+        case SQL_NUMERIC:
+            return ColumnType::NUMERIC;
+        case SQL_INTEGER:
+        case SQL_SMALLINT:
+            return ColumnType::INTEGER;
+        case SQL_DOUBLE:
+        case SQL_FLOAT:
+        case SQL_REAL:
+            return ColumnType::DOUBLE;
+        case SQL_TYPE_DATE:
+        case SQL_DATE:
+            return ColumnType::DATE;
+        case SQL_TYPE_TIMESTAMP:
+        case SQL_TIMESTAMP:
+            return ColumnType::DATETIME;
+        case SQL_BIT:
+            return ColumnType::LOGICAL;
+        case SQL_LONGVARCHAR:
+        case SQL_WLONGVARCHAR:
+            return ColumnType::MEMO;
+        default:
+            return ColumnType::OTHER;
+    }
+}
+
+void DatabaseManager::fetchRows(SQLHSTMT stmt, RowSet& rows, size_t& bytes_fetched,
+                                TextEncoding encoding, const MemoPolicy& memo, size_t skip) {
+    SQLSMALLINT column_count = 0;
+    SQLNumResultCols(stmt, &column_count);
+    
+    // Names and types once per statement, shared by every row
+    auto schema = std::make_shared<RowSchema>();
+    ArenaVector<bool> memo_columns(RequestArena::resource());
+    int recno_column = -1;
+    for (SQLSMALLINT i = 1; i <= column_count; ++i) {
+        char column_name[256];
+        SQLSMALLINT name_len;
+        SQLSMALLINT data_type = 0;
+        SQLULEN column_size = 0;
+        SQLSMALLINT decimal_digits = 0;
+        SQLDescribeCol(stmt, i, (SQLCHAR*)column_name, sizeof(column_name), 
+                      &name_len, &data_type, &column_size, &decimal_digits, NULL);
+        bool is_memo = data_type == SQL_LONGVARCHAR || data_type == SQL_LONGVARBINARY;
+        memo_columns.push_back(is_memo && !memo.table.empty());
+        
+        RowColumn column{column_name, columnType(data_type),
+                         static_cast<uint32_t>(column_size), static_cast<uint8_t>(decimal_digits)};
+        if (column.name == "_recno") {
+            column.type = ColumnType::RECNO;
+            recno_column = i - 1;
+        }
+        schema->columns.push_back(std::move(column));
+    }
+    rows = RowSet(std::move(schema));
+    const auto& columns = rows.schema().columns;
+    
+    // Rows before the page only move the cursor; no column data is read
+    for (; skip > 0; --skip) {
+        if (SQLFetch(stmt) != SQL_SUCCESS) {
+            return;
+        }
+    }
+    
+    // The fetch buffer comes from the request arena
+    ArenaString value(RequestArena::resource());
+    value.reserve(1024);
+    while (SQLFetch(stmt) == SQL_SUCCESS) {
+        uint32_t recno = 0;
+        for (SQLSMALLINT i = 1; i <= column_count; ++i) {
+            const std::string& name = columns[i - 1].name;
+            bool is_memo = memo_columns[i - 1];
+            
+            // Reference mode: memo data never crosses the driver
+            if (is_memo && recno != 0 && memo.inline_bytes == 0) {
+                rows.addMemoRef(memo.table, recno, name);
+                continue;
+            }
+            
+            size_t limit = is_memo && recno != 0 ? memo.inline_bytes : SIZE_MAX;
+            SQLLEN total;
+            bool complete;
+            if (!getColumnData(stmt, i, limit, value, total, complete)) {
+                rows.addNull();
+                continue;
+            }
+            bytes_fetched += value.size();
+            
+            if (i - 1 == recno_column) {
+                recno = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                rows.addRecno(recno);
+            } else if (limit != SIZE_MAX && (!complete || value.size() > limit)) {
+                rows.addMemoRef(memo.table, recno, name,
+                                total == SQL_NO_TOTAL ? -1 : static_cast<int64_t>(total));
+            } else {
+                rows.addText(value, encoding);
+            }
+        }
+    }
 }
 
 QueryResult DatabaseManager::reindex(const std::string& filename) {
@@ -696,35 +1585,100 @@ QueryResult DatabaseManager::reindex(const std::string& filename) {
     return result;
 }
 
-IndexStatus DatabaseManager::checkIndexHealth(const std::string& filename) {
-    // Simplified health check - in production, check CDX file integrity
-    try {
-        std::string safe_filename = sanitizeFilename(filename);
-        
-        // Remove .dbf extension to get base name
-        std::string base_name = safe_filename.substr(0, safe_filename.length() - 4);
-        std::string cdx_path = db_folder_path_ + "\\" + base_name + ".CDX";
+void DatabaseManager::logError(SQLHANDLE handle, SQLSMALLINT type) {
+    SqlError error = readError(handle, type);
+    spdlog::error("ODBC Error: {} - {}", error.sql_state, error.message);
+}
+
+SqlError DatabaseManager::readError(SQLHANDLE handle, SQLSMALLINT type) {
+    SQLCHAR sql_state[6] = {0};
+    SQLCHAR message[SQL_MAX_MESSAGE_LENGTH] = {0};
+    SQLINTEGER native_error = 0;
+    SQLSMALLINT msg_len;
+    
+    SqlError error;
+    
+    // A lock conflict may be reported behind a generic first record
+    for (SQLSMALLINT record = 1; ; ++record) {
+        SQLRETURN ret = SQLGetDiagRec(type, handle, record, sql_state, &native_error, 
+                                      message, sizeof(message), &msg_len);
+        if (ret != SQL_SUCCESS && ret != SQL_SUCCESS_WITH_INFO) {
+            break;
+        }
         
-        if (std::filesystem::exists(cdx_path)) {
-            return IndexStatus::OK;
-        } else {
-            return IndexStatus::PENDING;
+        SqlErrorClass kind = classifyError(reinterpret_cast<const char*>(sql_state), native_error);
+        if (record == 1 || kind < error.kind) {
+            error.sql_state = reinterpret_cast<const char*>(sql_state);
+            error.native_error = native_error;
+            error.message = reinterpret_cast<const char*>(message);
+            error.kind = kind;
         }
-    } catch (...) {
-        return IndexStatus::FAILED;
     }
+    
+    return error;
 }
 
-void DatabaseManager::logError(SQLHANDLE handle, SQLSMALLINT type) {
-    SQLCHAR sql_state[6];
-    SQLCHAR message[SQL_MAX_MESSAGE_LENGTH];
-    SQLINTEGER native_error;
-    SQLSMALLINT msg_len;
+SqlErrorClass DatabaseManager::classifyError(const std::string& sql_state, SQLINTEGER native_error) {
+    // VFP native errors raised when ExpressD holds a lock:
+    //   3    File is in use
+    //   108  File is in use by another user
+    //   109  Record is in use by another user
+    //   1502 Record is in use by another
+    //   1503 File cannot be locked
+    switch (native_error) {
+        case 3:
+        case 108:
+        case 109:
+        case 1502:
+        case 1503:
+            return SqlErrorClass::LOCK_CONFLICT;
+        default:
+            break;
+    }
+    
+    // Serialization failure / deadlock
+    if (sql_state == "40001" || sql_state == "40P01") {
+        return SqlErrorClass::LOCK_CONFLICT;
+    }
     
-    SQLGetDiagRecA(type, handle, 1, sql_state, &native_error, 
-                   message, sizeof(message), &msg_len);
+    // Connection exceptions (08xxx) and driver out of resources
+    if (sql_state.rfind("08", 0) == 0 || sql_state == "HY001" || sql_state == "HY013") {
+        return SqlErrorClass::TRANSIENT;
+    }
     
-    spdlog::error("ODBC Error: {} - {}", reinterpret_cast<const char*>(sql_state), reinterpret_cast<const char*>(message));
+    // Everything else, including HYT00 (timeout) and HY008 (cancelled),
+    // would fail again inside the same deadline
+    return SqlErrorClass::FATAL;
+}
+
+bool DatabaseManager::isConnectionError(const SqlError& error) {
+    return error.kind == SqlErrorClass::TRANSIENT && error.sql_state.rfind("08", 0) == 0;
+}
+
+std::chrono::milliseconds DatabaseManager::retryBackoff(int attempt) {
+    thread_local std::mt19937 rng{std::random_device{}()};
+    
+    auto ceiling = RETRY_BACKOFF_BASE * (1LL << std::min(attempt, 16));
+    ceiling = std::min<std::chrono::milliseconds>(ceiling, RETRY_BACKOFF_CAP);
+    
+    // Equal jitter: half fixed, half random, so retries from concurrent
+    // writers spread out instead of hitting the file server together
+    std::uniform_int_distribution<long long> jitter(0, ceiling.count() / 2);
+    return std::chrono::milliseconds(ceiling.count() / 2 + jitter(rng));
+}
+
+nlohmann::json DatabaseManager::getStats() {
+    return {
+        {"backend", name()},
+        {"pool_size", poolSize()},
+        {"pool_in_use", poolInUse()},
+        {"max_retry_attempts", max_retry_attempts_},
+        {"retries", retry_count_.load()},
+        {"lock_conflicts", lock_conflicts_.load()},
+        {"lock_wait_ms", lock_wait_ms_.load()},
+        {"retries_exhausted", retries_exhausted_.load()},
+        {"reconnects", reconnects_.load()}
+    };
 }
 
 } // namespace FoxBridge
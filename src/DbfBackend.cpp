@@ -0,0 +1,628 @@
+#include "DbfBackend.h"
+#include "DbfTable.h"
+#include "RequestContext.h"
+#include "Tracer.h"
+#include "QueryStats.h"
+#include <spdlog/spdlog.h>
+#include <unordered_set>
+#include <algorithm>
+#include <queue>
+#include <cstdlib>
+
+namespace FoxBridge {
+
+// Records between deadline and cancellation checks during a scan
+static constexpr uint32_t CANCEL_CHECK_INTERVAL = 4096;
+
+// CHAR fields are blank-padded; lookups compare without the padding.
+// Document numbers are ASCII, so they match raw bytes in any code page.
+static std::string_view trimRight(std::string_view text) {
+    size_t end = text.find_last_not_of(' ');
+    return end == std::string_view::npos ? std::string_view() : text.substr(0, end + 1);
+}
+
+DbfBackend::DbfBackend(const std::string& db_folder_path, std::chrono::seconds lookup_timeout)
+    : StorageBackend(db_folder_path)
+    , lookup_timeout_(std::max(lookup_timeout, std::chrono::seconds(1))) {
+    spdlog::info("Reading DBF files directly from: {} (read-only)", db_folder_path_);
+}
+
+std::chrono::steady_clock::time_point DbfBackend::requestDeadline(std::chrono::milliseconds timeout) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto context = RequestContext::current();
+    return context ? std::min(deadline, context->deadline()) : deadline;
+}
+
+bool DbfBackend::scanTable(const std::filesystem::path& path, const std::string& statement,
+                           std::chrono::steady_clock::time_point deadline,
+                           const std::function<bool(DbfTable&, uint32_t, const char*, RowSet&)>& visit,
+                           RowSet& records, uint32_t first, uint32_t last) {
+    auto start = std::chrono::steady_clock::now();
+    auto context = RequestContext::current();
+    records = RowSet();
+    
+    bool success = true;
+    uint64_t bytes = 0;
+    uint64_t scanned = 0;
+    ++active_scans_;
+    
+    try {
+        TraceSpan span("dbf.scan", path.filename().string());
+        DbfTable table(path);
+        prepareTable(table, path);
+        records = RowSet(table.schema());
+        
+        bytes = table.scan([&](uint32_t recno, const char* record) {
+            if (recno % CANCEL_CHECK_INTERVAL == 0) {
+                if ((context && context->cancelled()) || std::chrono::steady_clock::now() >= deadline) {
+                    success = false;
+                    return false;
+                }
+            }
+            ++scanned;
+            if (DbfTable::isDeleted(record)) {
+                return true;
+            }
+            return visit(table, recno, record, records);
+        }, first, last);
+    } catch (const std::exception& e) {
+        spdlog::error("DBF scan failed ({}): {}", statement, e.what());
+        success = false;
+    }
+    
+    --active_scans_;
+    ++scans_;
+    records_scanned_ += scanned;
+    bytes_read_ += bytes;
+    
+    if (!success && context && context->cancelled()) {
+        spdlog::warn("DBF scan cancelled ({}): {}", context->cancelReason(), statement);
+    } else if (!success && std::chrono::steady_clock::now() >= deadline) {
+        spdlog::warn("DBF scan timed out: {}", statement);
+    }
+    
+    QueryStats::instance().record(statement,
+                                  std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now() - start),
+                                  success,
+                                  success ? records.size() : 0,
+                                  static_cast<size_t>(bytes),
+                                  context ? context->origin() : "",
+                                  context ? context->route() : "");
+    return success;
+}
+
+void DbfBackend::prepareTable(DbfTable& table, const std::filesystem::path& path) {
+    table.setEncoding(tableEncoding(path.filename().string(), table.codePage()));
+    table.setMemoPolicy({path.filename().string(), memoInlineBytes()});
+}
+
+namespace {
+
+// search() filters: LIKE '%value%' on each column, as a case-sensitive
+// substring match
+class RecordFilter {
+public:
+    explicit RecordFilter(const std::map<std::string, std::string>& filters)
+        : filters_(filters) {
+    }
+    
+    bool resolved() const { return resolved_; }
+    
+    // Looks the columns up in `table`; false, with a warning, when one is missing
+    bool resolve(DbfTable& table, std::vector<std::string>& warnings) {
+        for (auto& [key, value] : filters_) {
+            const DbfColumn* column = table.column(key);
+            if (!column) {
+                warnings.push_back("Unknown column: " + key);
+                return false;
+            }
+            // CHAR fields are matched on raw bytes, so in the table's code page
+            matchers_.emplace_back(column, column->type == 'C' ? fromUtf8(value, table.encoding()) : value);
+        }
+        resolved_ = true;
+        return true;
+    }
+    
+    bool matches(DbfTable& table, const char* record) const {
+        for (auto& [column, value] : matchers_) {
+            if (column->type == 'C') {
+                if (DbfTable::raw(record, *column).find(value) == std::string_view::npos) {
+                    return false;
+                }
+            } else {
+                nlohmann::json field = table.value(record, *column);
+                if (!field.is_string() || field.get_ref<const std::string&>().find(value) == std::string::npos) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    const std::map<std::string, std::string>& filters_;
+    std::vector<std::pair<const DbfColumn*, std::string>> matchers_;
+    bool resolved_ = false;
+};
+
+} // namespace
+
+QueryResult DbfBackend::exportJSON(const std::string& filename, const std::string& docnum) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        auto path = resolvePath(safe_filename);
+        if (path.empty()) {
+            result.message = "File not found: " + safe_filename;
+            return result;
+        }
+        
+        std::string statement = "SCAN " + safe_filename;
+        if (!docnum.empty()) {
+            statement += " WHERE docnum = '" + docnum + "'";
+        }
+        
+        auto visit = [&docnum](DbfTable& table, uint32_t recno, const char* record, RowSet& records) {
+            if (!docnum.empty()) {
+                const DbfColumn* column = table.column("docnum");
+                if (!column || trimRight(DbfTable::raw(record, *column)) != docnum) {
+                    return true;
+                }
+            }
+            table.appendRow(records, record, recno);
+            return true;
+        };
+        
+        if (scanTable(path, statement, requestDeadline(lookup_timeout_), visit, result.rows)) {
+            result.success = true;
+            result.message = docnum.empty() ? "All records exported" : "Record found";
+        } else {
+            result.message = "Failed to export records";
+            result.rows = RowSet();
+        }
+    
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DbfBackend::search(const std::string& filename,
+                               const std::map<std::string, std::string>& filters,
+                               int limit) {
+    return searchRecords(filename, filters, static_cast<size_t>(std::max(limit, 0)), 1, UINT32_MAX);
+}
+
+QueryResult DbfBackend::searchRange(const std::string& filename,
+                                    const std::map<std::string, std::string>& filters,
+                                    uint32_t first, uint32_t last) {
+    return searchRecords(filename, filters, SIZE_MAX, first, last);
+}
+
+QueryResult DbfBackend::searchRecords(const std::string& filename,
+                                      const std::map<std::string, std::string>& filters,
+                                      size_t limit, uint32_t first, uint32_t last) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        auto path = resolvePath(safe_filename);
+        if (path.empty()) {
+            result.message = "File not found: " + safe_filename;
+            return result;
+        }
+        
+        std::string statement = "SCAN " + safe_filename;
+        if (first != 1 || last != UINT32_MAX) {
+            statement += " WHERE RECNO() BETWEEN " + std::to_string(first) + " AND " + std::to_string(last);
+        }
+        for (auto& [key, value] : filters) {
+            statement += (statement.find(" WHERE ") == std::string::npos ? " WHERE " : " AND ");
+            statement += key + " LIKE '%" + value + "%'";
+        }
+        
+        RecordFilter filter(filters);
+        bool unknown_column = false;
+        
+        auto visit = [&](DbfTable& table, uint32_t recno, const char* record, RowSet& records) {
+            if (!filter.resolved() && !filter.resolve(table, result.warnings)) {
+                unknown_column = true;
+                return false;
+            }
+            if (records.size() >= limit) {
+                return false;
+            }
+            if (!filter.matches(table, record)) {
+                return true;
+            }
+            table.appendRow(records, record, recno);
+            return records.size() < limit;
+        };
+        
+        if (scanTable(path, statement, requestDeadline(lookup_timeout_), visit, result.rows, first, last) &&
+            !unknown_column) {
+            result.success = true;
+            result.message = "Search completed";
+        } else {
+            result.message = "Search failed";
+            result.rows = RowSet();
+        }
+    
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DbfBackend::searchPage(const std::string& filename, const PageRequest& request, size_t& matches) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        auto path = resolvePath(safe_filename);
+        if (path.empty()) {
+            result.message = "File not found: " + safe_filename;
+            return result;
+        }
+        
+        std::string statement = "SCAN " + safe_filename;
+        for (auto& [key, value] : request.filters) {
+            statement += (statement.find(" WHERE ") == std::string::npos ? " WHERE " : " AND ");
+            statement += key + " LIKE '%" + value + "%'";
+        }
+        if (!request.sort.empty()) {
+            statement += " ORDER BY " + request.sort + (request.descending ? " DESC" : "");
+        }
+        
+        // Sort keys of the first offset + limit matches in page order, kept
+        // in a bounded heap whose top is the one to drop next. Numbers
+        // compare as numbers, other fields as their text; nulls come first
+        // (last when descending) and ties stay in record order.
+        struct Entry {
+            uint32_t recno;
+            bool null;
+            double number;
+            std::string text;
+        };
+        const DbfColumn* sort_column = nullptr;
+        bool numeric = false;
+        auto before = [&](const Entry& a, const Entry& b) {
+            if (a.null != b.null) {
+                return a.null != request.descending;
+            }
+            if (sort_column && !a.null) {
+                if (numeric && a.number != b.number) {
+                    return request.descending ? a.number > b.number : a.number < b.number;
+                }
+                int order = numeric ? 0 : a.text.compare(b.text);
+                if (order != 0) {
+                    return request.descending ? order > 0 : order < 0;
+                }
+            }
+            return a.recno < b.recno;
+        };
+        std::priority_queue<Entry, std::vector<Entry>, decltype(before)> kept(before);
+        size_t wanted = request.offset + request.limit;
+        
+        RecordFilter filter(request.filters);
+        bool unknown_column = false;
+        matches = 0;
+        
+        auto visit = [&](DbfTable& table, uint32_t recno, const char* record, RowSet&) {
+            if (!filter.resolved()) {
+                if (!filter.resolve(table, result.warnings)) {
+                    unknown_column = true;
+                    return false;
+                }
+                if (!request.sort.empty()) {
+                    sort_column = table.column(request.sort);
+                    if (!sort_column) {
+                        result.warnings.push_back("Unknown column: " + request.sort);
+                        unknown_column = true;
+                        return false;
+                    }
+                    numeric = std::string_view("NFIBY").find(sort_column->type) != std::string_view::npos;
+                }
+            }
+            if (!filter.matches(table, record)) {
+                return true;
+            }
+            ++matches;
+            
+            Entry entry{recno, false, 0.0, {}};
+            if (sort_column) {
+                nlohmann::json value = table.value(record, *sort_column);
+                entry.null = !value.is_string();
+                if (!entry.null && numeric) {
+                    entry.number = std::strtod(value.get_ref<const std::string&>().c_str(), nullptr);
+                } else if (!entry.null) {
+                    entry.text = std::move(value.get_ref<std::string&>());
+                }
+            }
+            if (kept.size() < wanted) {
+                kept.push(std::move(entry));
+            } else if (wanted > 0 && before(entry, kept.top())) {
+                kept.pop();
+                kept.push(std::move(entry));
+            }
+            return true;
+        };
+        
+        RowSet unused;
+        if (!scanTable(path, statement, requestDeadline(lookup_timeout_), visit, unused) || unknown_column) {
+            result.message = "Search failed";
+            return result;
+        }
+        
+        std::vector<uint32_t> recnos;
+        recnos.reserve(kept.size());
+        for (; !kept.empty(); kept.pop()) {
+            recnos.push_back(kept.top().recno);
+        }
+        std::reverse(recnos.begin(), recnos.end());
+        
+        // Only the page's records are read again, in page order
+        TraceSpan span("dbf.page", safe_filename);
+        DbfTable table(path);
+        prepareTable(table, path);
+        result.rows = RowSet(table.schema());
+        std::vector<char> record;
+        for (size_t i = request.offset; i < recnos.size(); ++i) {
+            if (table.readRecord(recnos[i], record)) {
+                table.appendRow(result.rows, record.data(), recnos[i]);
+            }
+        }
+        result.success = true;
+        result.message = "Page retrieved";
+    
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DbfBackend::getAllRecords(const std::string& filename, int limit) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        auto path = resolvePath(safe_filename);
+        if (path.empty()) {
+            result.message = "File not found: " + safe_filename;
+            return result;
+        }
+        
+        size_t wanted = static_cast<size_t>(std::max(limit, 0));
+        auto visit = [wanted](DbfTable& table, uint32_t recno, const char* record, RowSet& records) {
+            if (records.size() >= wanted) {
+                return false;
+            }
+            table.appendRow(records, record, recno);
+            return records.size() < wanted;
+        };
+        
+        if (scanTable(path, "SCAN TOP " + std::to_string(limit) + " " + safe_filename,
+                      requestDeadline(lookup_timeout_), visit, result.rows)) {
+            result.success = true;
+            result.message = "Records retrieved";
+        } else {
+            result.message = "Failed to retrieve records";
+            result.rows = RowSet();
+        }
+    
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DbfBackend::findByDocnum(const std::string& docnum, bool first_only,
+                                     std::chrono::milliseconds timeout) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        result.data = nlohmann::json::array();
+        auto deadline = requestDeadline(timeout);
+        
+        auto visit = [&docnum](DbfTable& table, uint32_t recno, const char* record, RowSet& records) {
+            const DbfColumn* column = table.column("docnum");
+            if (!column) {
+                return false;
+            }
+            if (trimRight(DbfTable::raw(record, *column)) == docnum) {
+                table.appendRow(records, record, recno);
+            }
+            return true;
+        };
+        
+        // Tables are read one after another: sequential reads of one file at
+        // a time are what a file share serves fastest
+        for (const auto& table : docnumTables()) {
+            auto path = resolvePath(table);
+            if (path.empty()) {
+                continue;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                result.warnings.push_back("Lookup timed out in " + table);
+                continue;
+            }
+            
+            RowSet records;
+            if (!scanTable(path, "SCAN " + table + " WHERE docnum = '" + docnum + "'", deadline, visit, records)) {
+                result.warnings.push_back(std::chrono::steady_clock::now() >= deadline ?
+                                          "Lookup timed out in " + table : "Lookup failed in " + table);
+                continue;
+            }
+            for (size_t i = 0; i < records.size(); ++i) {
+                nlohmann::json record = records.rowJson(i);
+                record["_source_file"] = table;
+                result.data.push_back(std::move(record));
+            }
+            if (first_only && !result.data.empty()) {
+                break;
+            }
+        }
+        
+        if (!result.data.empty()) {
+            result.success = true;
+            result.message = "Document found in " + std::to_string(result.data.size()) + " table(s)";
+        } else {
+            result.message = "Document not found";
+        }
+    
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DbfBackend::findByDocnums(const std::vector<std::string>& docnums) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    try {
+        if (docnums.empty()) {
+            result.message = "No document numbers given";
+            return result;
+        }
+        if (docnums.size() > DOCNUM_BATCH_MAX) {
+            result.message = "Too many document numbers (max " + std::to_string(DOCNUM_BATCH_MAX) + ")";
+            return result;
+        }
+        
+        // Same validation as the ODBC backend so clients see one behaviour
+        std::vector<std::string> unique;
+        result.data = nlohmann::json::object();
+        for (const auto& docnum : docnums) {
+            if (docnum.empty() || docnum.find_first_of("'\"[]") != std::string::npos) {
+                result.message = "Invalid document number: " + docnum;
+                result.data = nullptr;
+                return result;
+            }
+            if (!result.data.contains(docnum)) {
+                result.data[docnum] = nlohmann::json::array();
+                unique.push_back(docnum);
+            }
+        }
+        std::unordered_set<std::string_view> wanted(unique.begin(), unique.end());
+        
+        // One pass per table resolves the whole batch
+        auto visit = [&wanted](DbfTable& table, uint32_t recno, const char* record, RowSet& records) {
+            const DbfColumn* column = table.column("docnum");
+            if (!column) {
+                return false;
+            }
+            if (wanted.count(trimRight(DbfTable::raw(record, *column)))) {
+                table.appendRow(records, record, recno);
+            }
+            return true;
+        };
+        
+        auto deadline = requestDeadline(lookup_timeout_);
+        size_t matched_records = 0;
+        for (const auto& table : docnumTables()) {
+            auto path = resolvePath(table);
+            if (path.empty()) {
+                continue;
+            }
+            
+            RowSet records;
+            if (!scanTable(path, "SCAN " + table + " WHERE docnum IN (?+)", deadline, visit, records)) {
+                result.warnings.push_back(std::chrono::steady_clock::now() >= deadline ?
+                                          "Lookup timed out in " + table : "Lookup failed in " + table);
+                continue;
+            }
+            for (size_t i = 0; i < records.size(); ++i) {
+                nlohmann::json record = records.rowJson(i);
+                std::string key = record["docnum"].get<std::string>();
+                key.erase(key.find_last_not_of(' ') + 1);
+                record["_source_file"] = table;
+                result.data[key].push_back(std::move(record));
+                ++matched_records;
+            }
+        }
+        
+        size_t resolved = 0;
+        for (auto& [key, records] : result.data.items()) {
+            if (!records.empty()) ++resolved;
+        }
+        
+        result.success = true;
+        result.message = "Resolved " + std::to_string(resolved) + " of " +
+                         std::to_string(unique.size()) + " document(s), " +
+                         std::to_string(matched_records) + " record(s)";
+    
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+    }
+    
+    return result;
+}
+
+QueryResult DbfBackend::readOnly(const std::string& operation) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    result.message = operation + " is not available: the dbf storage backend is read-only";
+    result.warnings.push_back("Set storage_backend to \"odbc\" to enable writes");
+    return result;
+}
+
+QueryResult DbfBackend::add(const std::string&, const nlohmann::json&) {
+    return readOnly("Add");
+}
+
+QueryResult DbfBackend::update(const std::string&, const nlohmann::json&, const nlohmann::json&) {
+    return readOnly("Update");
+}
+
+QueryResult DbfBackend::deleteRecords(const std::string&, const nlohmann::json&) {
+    return readOnly("Delete");
+}
+
+QueryResult DbfBackend::undeleteRecords(const std::string&, const nlohmann::json&) {
+    return readOnly("Undelete");
+}
+
+QueryResult DbfBackend::pack(const std::string&) {
+    return readOnly("Pack");
+}
+
+std::vector<QueryResult> DbfBackend::applyWriteBatch(const std::string&,
+                                                     const std::vector<WriteOperation>& operations) {
+    return std::vector<QueryResult>(operations.size(), readOnly("Write"));
+}
+
+QueryResult DbfBackend::reindex(const std::string&) {
+    return readOnly("Reindex");
+}
+
+nlohmann::json DbfBackend::getStats() {
+    return {
+        {"backend", name()},
+        {"scans", scans_.load()},
+        {"scans_in_progress", active_scans_.load()},
+        {"records_scanned", records_scanned_.load()},
+        {"bytes_read", bytes_read_.load()}
+    };
+}
+
+} // namespace FoxBridge
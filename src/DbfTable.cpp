@@ -0,0 +1,416 @@
+#include "DbfTable.h"
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace FoxBridge {
+
+// Records per read: about 1MB, so a scan costs few system calls even over SMB
+static constexpr size_t SCAN_BUFFER_BYTES = 1024 * 1024;
+
+// Largest memo returned in a row or matched by a search; bigger ones are
+// only served through the memo endpoint
+static constexpr uint32_t MEMO_MAX_LENGTH = 64 * 1024 * 1024;
+
+// Field flags in the descriptor (VFP)
+static constexpr uint8_t FIELD_SYSTEM = 0x01;
+static constexpr uint8_t FIELD_NULLABLE = 0x02;
+
+static uint16_t le16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static bool seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+static std::string trimmed(std::string_view text) {
+    size_t begin = text.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(' ');
+    return std::string(text.substr(begin, end - begin + 1));
+}
+
+// Julian day number to "YYYY-MM-DD"
+static std::string julianToDate(int64_t jd) {
+    int64_t a = jd + 32044;
+    int64_t b = (4 * a + 3) / 146097;
+    int64_t c = a - 146097 * b / 4;
+    int64_t d = (4 * c + 3) / 1461;
+    int64_t e = c - 1461 * d / 4;
+    int64_t m = (5 * e + 2) / 153;
+    int day = static_cast<int>(e - (153 * m + 2) / 5 + 1);
+    int month = static_cast<int>(m + 3 - 12 * (m / 10));
+    int year = static_cast<int>(100 * b + d - 4800 + m / 10);
+    
+    // Room for three full ints, so a corrupt day number cannot truncate
+    char text[3 * 11 + 3];
+    std::snprintf(text, sizeof(text), "%04d-%02d-%02d", year, month, day);
+    return text;
+}
+
+DbfTable::DbfTable(const std::filesystem::path& path)
+    : path_(path) {
+    file_ = std::fopen(path.string().c_str(), "rb");
+    if (!file_) {
+        throw std::runtime_error("Cannot open table: " + path.filename().string());
+    }
+    
+    unsigned char header[32];
+    if (std::fread(header, 1, sizeof(header), file_) != sizeof(header)) {
+        std::fclose(file_);
+        throw std::runtime_error("Truncated table header: " + path.filename().string());
+    }
+    record_count_ = le32(header + 4);
+    header_length_ = le16(header + 8);
+    record_length_ = le16(header + 10);
+    code_page_ = header[29];
+    
+    // Field descriptors run from byte 32 to the 0x0D terminator
+    uint32_t offset = 0;
+    int null_bit = 0;
+    unsigned char descriptor[32];
+    while (std::ftell(file_) + 1 < static_cast<long>(header_length_)) {
+        if (std::fread(descriptor, 1, 1, file_) != 1 || descriptor[0] == 0x0D) {
+            break;
+        }
+        if (std::fread(descriptor + 1, 1, 31, file_) != 31) {
+            break;
+        }
+        
+        DbfColumn column;
+        column.name.assign(reinterpret_cast<const char*>(descriptor),
+                           strnlen(reinterpret_cast<const char*>(descriptor), 11));
+        std::transform(column.name.begin(), column.name.end(), column.name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        column.type = static_cast<char>(std::toupper(descriptor[11]));
+        column.offset = offset;
+        column.length = descriptor[16];
+        column.decimals = descriptor[17];
+        offset += column.length;
+        
+        uint8_t flags = descriptor[18];
+        if (column.type == 'V' || column.type == 'Q') {
+            column.varlength_bit = null_bit++;  // Shares _NullFlags, ahead of the null bit
+        }
+        if (flags & FIELD_NULLABLE) {
+            column.null_bit = null_bit++;
+        }
+        
+        if (flags & FIELD_SYSTEM) {
+            if (column.name == "_nullflags") {
+                null_flags_ = column;
+            }
+            continue;
+        }
+        has_memo_ = has_memo_ || column.type == 'M';
+        columns_.push_back(std::move(column));
+    }
+    
+    if (record_length_ == 0 || offset + 1 > record_length_) {
+        std::fclose(file_);
+        throw std::runtime_error("Invalid table header: " + path.filename().string());
+    }
+}
+
+DbfTable::~DbfTable() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+const DbfColumn* DbfTable::column(const std::string& name) const {
+    for (const auto& column : columns_) {
+        if (column.name.size() == name.size() &&
+            std::equal(name.begin(), name.end(), column.name.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == b;
+            })) {
+            return &column;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t DbfTable::scan(const std::function<bool(uint32_t, const char*)>& visit,
+                        uint32_t first, uint32_t last) {
+    first = std::max<uint32_t>(first, 1);
+    last = std::min(last, record_count_);
+    if (first > last ||
+        !seekTo(file_, header_length_ + static_cast<uint64_t>(first - 1) * record_length_)) {
+        return 0;
+    }
+    
+    size_t batch = std::max<size_t>(1, SCAN_BUFFER_BYTES / record_length_);
+    std::vector<char> buffer(batch * record_length_);
+    uint64_t bytes_read = 0;
+    
+    uint32_t recno = first;
+    while (recno <= last) {
+        size_t wanted = std::min<size_t>(batch, last - recno + 1);
+        size_t got = std::fread(buffer.data(), record_length_, wanted, file_);
+        bytes_read += static_cast<uint64_t>(got) * record_length_;
+        
+        for (size_t i = 0; i < got; ++i, ++recno) {
+            if (!visit(recno, buffer.data() + i * record_length_)) {
+                return bytes_read;
+            }
+        }
+        if (got < wanted) {
+            break;      // Shorter than the header says: truncated or being packed
+        }
+    }
+    return bytes_read;
+}
+
+bool DbfTable::flagSet(const char* record, int bit) const {
+    if (bit < 0 || null_flags_.length == 0) {
+        return false;
+    }
+    size_t byte = static_cast<size_t>(bit) / 8;
+    if (byte >= null_flags_.length) {
+        return false;
+    }
+    unsigned char flags = static_cast<unsigned char>(record[1 + null_flags_.offset + byte]);
+    return (flags >> (bit % 8)) & 1;
+}
+
+bool DbfTable::isNull(const char* record, const DbfColumn& column) const {
+    return flagSet(record, column.null_bit);
+}
+
+bool DbfTable::text(const char* record, const DbfColumn& column, std::string& out) {
+    if (isNull(record, column)) {
+        return false;
+    }
+    
+    std::string_view field = raw(record, column);
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(field.data());
+    char text[64];
+    
+    switch (column.type) {
+        case 'C':
+            appendUtf8(out, field, encoding_);
+            return true;
+        
+        case 'V':
+            // A value shorter than the field keeps its length in the last byte
+            if (flagSet(record, column.varlength_bit) && !field.empty()) {
+                field = field.substr(0, std::min<size_t>(bytes[field.size() - 1], field.size() - 1));
+            }
+            appendUtf8(out, field, encoding_);
+            return true;
+        
+        case 'N':
+        case 'F': {
+            std::string number = trimmed(field);
+            out += number.empty() ? "0" : number;
+            return true;
+        }
+        
+        case 'D': {
+            if (trimmed(field).empty()) {
+                return false;
+            }
+            out.append(field.substr(0, 4));
+            out += '-';
+            out.append(field.substr(4, 2));
+            out += '-';
+            out.append(field.substr(6, 2));
+            return true;
+        }
+        
+        case 'L':
+            out += field[0] && std::strchr("TtYy", field[0]) ? '1' : '0';
+            return true;
+        
+        case 'I':
+            out += std::to_string(static_cast<int32_t>(le32(bytes)));
+            return true;
+        
+        case 'B': {
+            double number;
+            std::memcpy(&number, bytes, sizeof(number));
+            std::snprintf(text, sizeof(text), "%.*f", column.decimals, number);
+            out += text;
+            return true;
+        }
+        
+        case 'Y': {
+            int64_t scaled = static_cast<int64_t>(le32(bytes)) |
+                             (static_cast<int64_t>(le32(bytes + 4)) << 32);
+            std::snprintf(text, sizeof(text), "%s%lld.%04lld", scaled < 0 ? "-" : "",
+                          static_cast<long long>(std::abs(scaled / 10000)),
+                          static_cast<long long>(std::abs(scaled % 10000)));
+            out += text;
+            return true;
+        }
+        
+        case 'T': {
+            uint32_t day = le32(bytes);
+            if (day == 0) {
+                return false;
+            }
+            uint32_t millis = le32(bytes + 4);
+            std::snprintf(text, sizeof(text), " %02u:%02u:%02u", millis / 3600000,
+                          (millis / 60000) % 60, (millis / 1000) % 60);
+            out += julianToDate(day);
+            out += text;
+            return true;
+        }
+        
+        case 'M': {
+            std::string memo = readMemo(record, column);
+            appendUtf8(out, memo, encoding_);
+            return true;
+        }
+        
+        default:
+            // General, blob and varbinary fields have no text form
+            return false;
+    }
+}
+
+nlohmann::json DbfTable::value(const char* record, const DbfColumn& column) {
+    std::string out;
+    if (!text(record, column, out)) {
+        return nullptr;
+    }
+    return out;
+}
+
+static ColumnType columnType(char type) {
+    switch (type) {
+        case 'C': case 'V': return ColumnType::TEXT;
+        case 'N': case 'F': case 'Y': return ColumnType::NUMERIC;
+        case 'I': return ColumnType::INTEGER;
+        case 'B': return ColumnType::DOUBLE;
+        case 'D': return ColumnType::DATE;
+        case 'T': return ColumnType::DATETIME;
+        case 'L': return ColumnType::LOGICAL;
+        case 'M': return ColumnType::MEMO;
+        default: return ColumnType::OTHER;
+    }
+}
+
+const std::shared_ptr<const RowSchema>& DbfTable::schema() {
+    if (!schema_) {
+        auto schema = std::make_shared<RowSchema>();
+        
+        // _recno first, where the ODBC backend's RECNO() AS _recno puts it
+        if (!memo_policy_.table.empty() && has_memo_) {
+            schema->columns.push_back({"_recno", ColumnType::RECNO, 10, 0});
+        }
+        // Currency is stored as 8 binary bytes; describe it as the driver
+        // does, 19 digits with 4 decimals
+        for (const auto& column : columns_) {
+            bool currency = column.type == 'Y';
+            schema->columns.push_back({column.name, columnType(column.type),
+                                       currency ? static_cast<uint32_t>(19) : column.length,
+                                       static_cast<uint8_t>(currency ? 4 : column.decimals)});
+        }
+        schema_ = std::move(schema);
+    }
+    return schema_;
+}
+
+void DbfTable::appendRow(RowSet& rows, const char* record, uint32_t recno) {
+    bool policy = !memo_policy_.table.empty();
+    if (policy && has_memo_) {
+        rows.addRecno(recno);
+    }
+    for (const auto& column : columns_) {
+        if (column.type == 'M' && policy && !isNull(record, column)) {
+            appendMemo(rows, record, column, recno);
+        } else {
+            rows.addValue([&](std::string& out) { return text(record, column, out); });
+        }
+    }
+}
+
+bool DbfTable::readRecord(uint32_t recno, std::vector<char>& record) {
+    if (recno == 0 || recno > record_count_) {
+        return false;
+    }
+    record.resize(record_length_);
+    uint64_t position = header_length_ + static_cast<uint64_t>(recno - 1) * record_length_;
+    return seekTo(file_, position) &&
+           std::fread(record.data(), 1, record_length_, file_) == record_length_;
+}
+
+uint32_t DbfTable::memoBlock(const char* record, const DbfColumn& column) {
+    std::string_view field = raw(record, column);
+    
+    // VFP stores a 4-byte binary block number; FoxPro 2.x ten ASCII digits
+    if (column.length == 4) {
+        return le32(reinterpret_cast<const unsigned char*>(field.data()));
+    }
+    std::string digits = trimmed(field);
+    return digits.empty() ? 0 : static_cast<uint32_t>(std::strtoul(digits.c_str(), nullptr, 10));
+}
+
+MemoFile* DbfTable::memoFile() {
+    if (!memo_opened_) {
+        memo_opened_ = true;
+        std::filesystem::path memo_path = MemoFile::pathFor(path_);
+        if (!memo_path.empty()) {
+            try {
+                memo_ = std::make_unique<MemoFile>(memo_path);
+            } catch (const std::exception&) {
+                memo_.reset();      // Treated as a table without memos
+            }
+        }
+    }
+    return memo_.get();
+}
+
+std::string DbfTable::readMemo(const char* record, const DbfColumn& column) {
+    uint32_t block = memoBlock(record, column);
+    MemoFile* memo_file = block == 0 ? nullptr : memoFile();
+    MemoBlock memo;
+    if (!memo_file || !memo_file->locate(block, memo) || memo.length > MEMO_MAX_LENGTH) {
+        return "";
+    }
+    return memo_file->readAll(memo);
+}
+
+void DbfTable::appendMemo(RowSet& rows, const char* record, const DbfColumn& column, uint32_t recno) {
+    uint32_t block = memoBlock(record, column);
+    if (block == 0) {
+        rows.addText("");
+        return;
+    }
+    
+    // Reference mode: the .fpt is not touched at all
+    if (memo_policy_.inline_bytes == 0) {
+        rows.addMemoRef(memo_policy_.table, recno, column.name);
+        return;
+    }
+    
+    // Only the block header is read to learn the length
+    MemoFile* memo_file = memoFile();
+    MemoBlock memo;
+    if (!memo_file || !memo_file->locate(block, memo)) {
+        rows.addText("");
+        return;
+    }
+    if (memo.length > memo_policy_.inline_bytes) {
+        rows.addMemoRef(memo_policy_.table, recno, column.name, memo.length);
+        return;
+    }
+    rows.addText(memo_file->readAll(memo), encoding_);
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,328 @@
+#include "HtmlView.h"
+#include <array>
+#include <charconv>
+#include <algorithm>
+
+namespace FoxBridge {
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Form encoding: %XX escapes and '+' for space; bad escapes stay as they are
+static std::string urlDecode(std::string_view text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            decoded += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() && hexDigit(text[i + 1]) >= 0 &&
+                   hexDigit(text[i + 2]) >= 0) {
+            decoded += static_cast<char>(hexDigit(text[i + 1]) * 16 + hexDigit(text[i + 2]));
+            i += 2;
+        } else {
+            decoded += text[i];
+        }
+    }
+    return decoded;
+}
+
+static void appendUrlEncoded(std::string& out, std::string_view text) {
+    static const char HEX[] = "0123456789ABCDEF";
+    for (unsigned char c : text) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += HEX[c >> 4];
+            out += HEX[c & 0xF];
+        }
+    }
+}
+
+static size_t parseSize(const std::string& text, size_t fallback) {
+    size_t value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size() ? value : fallback;
+}
+
+ViewQuery parseViewQuery(const std::string& query) {
+    ViewQuery view;
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t amp = query.find('&', start);
+        std::string_view pair(query.data() + start, (amp == std::string::npos ? query.size() : amp) - start);
+        start = amp == std::string::npos ? query.size() + 1 : amp + 1;
+        
+        size_t eq = pair.find('=');
+        if (eq == std::string_view::npos) {
+            continue;
+        }
+        std::string key = urlDecode(pair.substr(0, eq));
+        std::string value = urlDecode(pair.substr(eq + 1));
+        if (key == "page") {
+            view.page = std::clamp<size_t>(parseSize(value, 1), 1, ViewQuery::MAX_PAGE);
+        } else if (key == "size") {
+            view.size = std::clamp<size_t>(parseSize(value, ViewQuery::DEFAULT_SIZE), 1, ViewQuery::MAX_SIZE);
+        } else if (key == "sort") {
+            view.request.sort = value;
+        } else if (key == "desc") {
+            view.request.descending = value == "1";
+        } else if (!key.empty() && !value.empty()) {
+            view.request.filters[key] = value;
+        }
+    }
+    
+    view.request.limit = view.size;
+    view.request.offset = (view.page - 1) * view.size;
+    return view;
+}
+
+void appendHtmlEscaped(std::string& out, std::string_view text) {
+    static constexpr auto SPECIAL = [] {
+        std::array<bool, 256> table{};
+        for (unsigned char c : std::string_view("&<>\"'")) {
+            table[c] = true;
+        }
+        return table;
+    }();
+    
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (!SPECIAL[c]) {
+            continue;
+        }
+        out.append(text.data() + run, i - run);
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += "&#39;"; break;
+        }
+        run = i + 1;
+    }
+    out.append(text.data() + run, text.size() - run);
+}
+
+HtmlViewWriter::HtmlViewWriter(const std::string& filename, const ViewQuery& query,
+                               std::function<void(const char*, size_t)> write)
+    : filename_(filename)
+    , query_(query)
+    , write_(std::move(write)) {
+    buffer_.reserve(CHUNK_BYTES + 4096);
+}
+
+void HtmlViewWriter::writePage(const RowSet& rows, size_t matches) {
+    size_t pages = (matches + query_.size - 1) / query_.size;
+    beginDocument(filename_);
+    
+    buffer_ += "<h1>";
+    appendHtmlEscaped(buffer_, filename_);
+    buffer_ += "</h1>\n<p>";
+    buffer_ += std::to_string(matches);
+    buffer_ += matches == 1 ? " record" : " records";
+    if (!query_.request.filters.empty()) {
+        buffer_ += " matching";
+    }
+    if (pages > 0) {
+        buffer_ += ", page " + std::to_string(query_.page) + " of " + std::to_string(pages);
+    }
+    buffer_ += "</p>\n";
+    
+    // Filters submit with GET, keeping the sort and page size and going
+    // back to page 1
+    buffer_ += "<form method='get'>\n<p><button type='submit'>Filter</button> <a href='";
+    appendLink(1, query_.request.sort, query_.request.descending);
+    buffer_ += "'>Clear filters</a></p>\n";
+    buffer_ += "<input type='hidden' name='size' value='" + std::to_string(query_.size) + "'>\n";
+    if (!query_.request.sort.empty()) {
+        buffer_ += "<input type='hidden' name='sort' value='";
+        appendHtmlEscaped(buffer_, query_.request.sort);
+        buffer_ += "'>\n";
+        if (query_.request.descending) {
+            buffer_ += "<input type='hidden' name='desc' value='1'>\n";
+        }
+    }
+    
+    buffer_ += "<table>\n<thead>\n";
+    writeHeader(rows);
+    writeFilterRow(rows);
+    buffer_ += "</thead>\n<tbody>\n";
+    
+    size_t columns = rows.columnCount();
+    for (size_t row = 0; row < rows.size(); ++row) {
+        buffer_ += "<tr>";
+        for (size_t column = 0; column < columns; ++column) {
+            RowSet::CellView value = rows.cell(row, column);
+            buffer_ += "<td>";
+            if (value.kind == RowSet::CellKind::MEMO_REF) {
+                buffer_ += "<a href='";
+                appendHtmlEscaped(buffer_, value.text);
+                buffer_ += "'>memo";
+                if (value.memo_length >= 0) {
+                    buffer_ += " (" + std::to_string(value.memo_length) + " bytes)";
+                }
+                buffer_ += "</a>";
+            } else {
+                appendHtmlEscaped(buffer_, value.text);
+            }
+            buffer_ += "</td>";
+        }
+        buffer_ += "</tr>\n";
+        flushIfFull();
+    }
+    
+    buffer_ += "</tbody>\n</table>\n</form>\n";
+    writePageLinks(pages);
+    endDocument();
+}
+
+void HtmlViewWriter::writeError(const std::string& message) {
+    beginDocument(filename_);
+    buffer_ += "<h1>Error</h1>\n<p>";
+    appendHtmlEscaped(buffer_, message);
+    buffer_ += "</p>\n";
+    endDocument();
+}
+
+void HtmlViewWriter::beginDocument(const std::string& title) {
+    buffer_ += "<!DOCTYPE html>\n<html>\n<head>\n"
+               "<meta charset='UTF-8'>\n"
+               "<title>";
+    appendHtmlEscaped(buffer_, title);
+    buffer_ += "</title>\n"
+               "<style>\n"
+               "body { font-family: Arial, sans-serif; margin: 20px; }\n"
+               "table { border-collapse: collapse; width: 100%; }\n"
+               "th, td { border: 1px solid #ddd; padding: 8px; text-align: left; }\n"
+               "th { background-color: #4CAF50; color: white; }\n"
+               "th a { color: white; }\n"
+               "th input { width: 100%; box-sizing: border-box; }\n"
+               "tr:nth-child(even) { background-color: #f2f2f2; }\n"
+               "nav a, nav strong { margin-right: 8px; }\n"
+               "</style>\n</head>\n<body>\n";
+}
+
+void HtmlViewWriter::endDocument() {
+    buffer_ += "</body>\n</html>";
+    flush();
+}
+
+void HtmlViewWriter::writeHeader(const RowSet& rows) {
+    // Clicking a column sorts by it; clicking the sorted column reverses it.
+    // _recno is not a table column, so it can be neither sorted nor filtered.
+    buffer_ += "<tr>";
+    for (const auto& column : rows.schema().columns) {
+        if (column.type == ColumnType::RECNO) {
+            buffer_ += "<th>";
+            appendHtmlEscaped(buffer_, column.name);
+            buffer_ += "</th>";
+            continue;
+        }
+        bool sorted = column.name == query_.request.sort;
+        buffer_ += "<th><a href='";
+        appendLink(1, column.name, sorted && !query_.request.descending);
+        buffer_ += "'>";
+        appendHtmlEscaped(buffer_, column.name);
+        buffer_ += "</a>";
+        if (sorted) {
+            buffer_ += query_.request.descending ? " &#9660;" : " &#9650;";
+        }
+        buffer_ += "</th>";
+    }
+    buffer_ += "</tr>\n";
+}
+
+void HtmlViewWriter::writeFilterRow(const RowSet& rows) {
+    buffer_ += "<tr>";
+    for (const auto& column : rows.schema().columns) {
+        if (column.type == ColumnType::RECNO) {
+            buffer_ += "<th></th>";
+            continue;
+        }
+        buffer_ += "<th><input type='text' name='";
+        appendHtmlEscaped(buffer_, column.name);
+        buffer_ += "' value='";
+        auto filter = query_.request.filters.find(column.name);
+        if (filter != query_.request.filters.end()) {
+            appendHtmlEscaped(buffer_, filter->second);
+        }
+        buffer_ += "'></th>";
+    }
+    buffer_ += "</tr>\n";
+}
+
+void HtmlViewWriter::writePageLinks(size_t pages) {
+    if (pages <= 1) {
+        return;
+    }
+    
+    // First, previous, up to three pages either side, next, last
+    const std::string& sort = query_.request.sort;
+    bool descending = query_.request.descending;
+    auto link = [&](size_t page, const std::string& label) {
+        buffer_ += "<a href='";
+        appendLink(page, sort, descending);
+        buffer_ += "'>" + label + "</a>";
+    };
+    
+    size_t current = query_.page;
+    buffer_ += "<nav>";
+    if (current > 1) {
+        link(1, "&laquo; First");
+        link(std::min(current - 1, pages), "&lsaquo; Prev");
+    }
+    size_t low = current > 3 ? current - 3 : 1;
+    size_t high = std::min(current + 3, pages);
+    for (size_t page = low; page <= high; ++page) {
+        if (page == current) {
+            buffer_ += "<strong>" + std::to_string(page) + "</strong>";
+        } else {
+            link(page, std::to_string(page));
+        }
+    }
+    if (current < pages) {
+        link(current + 1, "Next &rsaquo;");
+        link(pages, "Last &raquo;");
+    }
+    buffer_ += "</nav>\n";
+}
+
+void HtmlViewWriter::appendLink(size_t page, const std::string& sort, bool descending) {
+    std::string href = "?page=" + std::to_string(page) + "&size=" + std::to_string(query_.size);
+    if (!sort.empty()) {
+        href += "&sort=";
+        appendUrlEncoded(href, sort);
+        if (descending) {
+            href += "&desc=1";
+        }
+    }
+    for (const auto& [column, value] : query_.request.filters) {
+        href += '&';
+        appendUrlEncoded(href, column);
+        href += '=';
+        appendUrlEncoded(href, value);
+    }
+    appendHtmlEscaped(buffer_, href);
+}
+
+void HtmlViewWriter::flushIfFull() {
+    if (buffer_.size() >= CHUNK_BYTES) {
+        flush();
+    }
+}
+
+void HtmlViewWriter::flush() {
+    if (!buffer_.empty()) {
+        write_(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+}
+
+} // namespace FoxBridge
@@ -1,13 +1,182 @@
 #include "HttpServer.h"
+#include "HtmlView.h"
+#include "WorkerPool.h"
+#include "Metrics.h"
+#include "QueryStats.h"
+#include "RequestArena.h"
+#include "AllocationCounter.h"
 #include <spdlog/spdlog.h>
-#include <regex>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <optional>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <poll.h>
+#endif
 
 namespace FoxBridge {
 
-HttpServer::HttpServer(const Config& config, std::shared_ptr<DatabaseManager> db_manager)
+// Memo bytes written per socket write when streaming from the .fpt
+static constexpr size_t MEMO_CHUNK_BYTES = 64 * 1024;
+
+// Snapshot bytes per sendfile / TransmitFile call; the stream's idle
+// timeout is renewed between them
+static constexpr uint64_t SENDFILE_SLICE_BYTES = 4 * 1024 * 1024;
+
+// True when the client has closed its end of the connection. Only called
+// after the request has been read, so any readable byte means EOF or a
+// pipelined request we will never read anyway.
+static bool peerClosed(tcp::socket::native_handle_type handle) {
+    char byte;
+#ifdef _WIN32
+    fd_set read_set;
+    FD_ZERO(&read_set);
+    FD_SET(handle, &read_set);
+    timeval zero = {0, 0};
+    if (select(0, &read_set, nullptr, nullptr, &zero) != 1) {
+        return false;
+    }
+    return recv(handle, &byte, 1, MSG_PEEK) <= 0;
+#else
+    pollfd pfd{handle, POLLIN, 0};
+    if (poll(&pfd, 1, 0) != 1) {
+        return false;
+    }
+    if (pfd.revents & (POLLHUP | POLLERR)) {
+        return true;
+    }
+    return recv(handle, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+#endif
+}
+
+// Shuts both directions of a connection down from another thread, so a
+// write blocked on it returns with an error
+static void shutdownSocket(tcp::socket::native_handle_type handle) {
+#ifdef _WIN32
+    ::shutdown(handle, SD_BOTH);
+#else
+    ::shutdown(handle, SHUT_RDWR);
+#endif
+}
+
+// Held by a stream handler once its headers are out. A 504 can no longer be
+// sent, so the request deadline gives way to an idle timeout that every
+// write renews; a cancellation from then on shuts the socket down, so a
+// blocked write returns and handleConnection resets the connection.
+class StreamTimeout {
+public:
+    StreamTimeout(tcp::socket& socket, std::chrono::seconds idle)
+        : context_(RequestContext::current())
+        , idle_(idle) {
+        if (context_) {
+            renew();
+            auto handle = socket.native_handle();
+            hook_ = context_->addCancelHook([handle] { shutdownSocket(handle); });
+        }
+    }
+    
+    ~StreamTimeout() {
+        if (context_) {
+            context_->removeCancelHook(hook_);
+        }
+    }
+    
+    StreamTimeout(const StreamTimeout&) = delete;
+    StreamTimeout& operator=(const StreamTimeout&) = delete;
+    
+    void renew() {
+        if (context_) {
+            context_->setDeadline(RequestContext::Clock::now() + idle_);
+        }
+    }
+    
+    // Gives up on a stream that cannot be finished, so the connection is
+    // reset like any other that stops early
+    void abort(const std::string& reason) {
+        if (context_) {
+            context_->cancel(reason);
+        }
+    }
+
+private:
+    std::shared_ptr<RequestContext> context_;
+    std::chrono::seconds idle_;
+    uint64_t hook_ = 0;
+};
+
+HttpServer::HttpServer(const Config& config, std::shared_ptr<StorageBackend> db_manager)
     : config_(config)
     , db_manager_(db_manager)
     , running_(false) {
+    
+    std::array<RouteClassLimit, AdmissionController::CLASS_COUNT> limits;
+    for (size_t i = 0; i < limits.size(); ++i) {
+        auto route_class = static_cast<RouteClass>(i);
+        auto it = config_.route_class_limits.find(AdmissionController::className(route_class));
+        limits[i] = (it != config_.route_class_limits.end()) ? it->second : 
+                    RouteClassLimit{config_.max_concurrent_requests, 0};
+    }
+    
+    admission_ = std::make_unique<AdmissionController>(
+        config_.max_concurrent_requests,
+        config_.admission_queue_limit,
+        std::chrono::milliseconds(config_.admission_queue_timeout_ms),
+        limits);
+    
+    write_queue_ = std::make_unique<WriteBehindQueue>(
+        db_manager_,
+        static_cast<size_t>(config_.write_batch_size),
+        std::chrono::milliseconds(config_.write_batch_linger_ms),
+        static_cast<size_t>(config_.write_queue_limit));
+    
+    range_reader_ = createRangeReader(config_, db_manager_);
+    table_export_ = std::make_unique<TableExport>(
+        range_reader_,
+        static_cast<size_t>(config_.export_threads),
+        config_.parquet_compression);
+    
+    if (!config_.snapshot_tables.empty()) {
+        std::vector<SnapshotJob> jobs;
+        for (const auto& [table, formats] : config_.snapshot_tables) {
+            SnapshotJob job{table, {}};
+            for (const auto& name : formats) {
+                SnapshotFormat format;
+                if (SnapshotCache::parseFormat(name, format)) {
+                    job.formats.push_back(format);
+                }
+            }
+            jobs.push_back(std::move(job));
+        }
+        snapshots_ = std::make_unique<SnapshotCache>(
+            db_manager_,
+            config_.snapshot_path,
+            std::move(jobs),
+            std::chrono::seconds(config_.snapshot_check_seconds),
+            [this](const std::string& table, SnapshotFormat format, std::string& body, std::string& error) {
+                return buildSnapshot(table, format, body, error);
+            },
+            db_manager_->exportVariant());
+    }
+    
+    tracer_ = std::make_unique<Tracer>(
+        config_.trace_sample_rate,
+        (std::filesystem::path(config_.log_path) / "traces").string(),
+        config_.trace_format,
+        std::chrono::seconds(config_.trace_flush_interval_seconds),
+        static_cast<size_t>(config_.trace_buffer_size));
+    
+    if (config_.access_log) {
+        access_log_ = std::make_unique<AccessLog>(
+            (std::filesystem::path(config_.log_path) / "access.log").string(),
+            std::chrono::milliseconds(config_.access_log_flush_ms),
+            65536,                  // Pending entries before dropping
+            1024 * 1024 * 10,       // 10MB
+            5);                     // 5 files
+    }
 }
 
 HttpServer::~HttpServer() {
@@ -21,7 +190,17 @@ void HttpServer::start() {
     }
     
     running_ = true;
+    write_queue_->start();
+    tracer_->start();
+    if (access_log_) {
+        access_log_->start();
+    }
+    if (snapshots_) {
+        snapshots_->start();
+    }
+    registerMetrics();
     server_thread_ = std::make_unique<std::thread>(&HttpServer::run, this);
+    watchdog_thread_ = std::make_unique<std::thread>(&HttpServer::watchdogLoop, this);
     spdlog::info("HTTP server started on port {}", config_.port);
 }
 
@@ -34,35 +213,904 @@ void HttpServer::stop() {
     if (server_thread_ && server_thread_->joinable()) {
         server_thread_->join();
     }
+    if (watchdog_thread_ && watchdog_thread_->joinable()) {
+        watchdog_thread_->join();
+    }
+    
+    if (snapshots_) {
+        snapshots_->stop();
+    }
+    
+    // Applies writes that were already accepted
+    write_queue_->stop();
+    tracer_->stop();
+    if (access_log_) {
+        access_log_->stop();
+    }
+    unregisterMetrics();
     spdlog::info("HTTP server stopped");
 }
 
+// Names of the scrape-time values this server exposes on /metrics
+static const char* const SERVER_METRICS[] = {
+    "foxbridge_db_pool_size",
+    "foxbridge_db_pool_in_use",
+    "foxbridge_db_pool_utilization",
+    "foxbridge_db_retries_total",
+    "foxbridge_db_lock_conflicts_total",
+    "foxbridge_coalesce_executions_total",
+    "foxbridge_coalesce_hits_total",
+    "foxbridge_coalesce_hit_ratio",
+    "foxbridge_requests_in_flight",
+    "foxbridge_requests_queued",
+    "foxbridge_accept_shed_total",
+    "foxbridge_write_queue_depth",
+    "foxbridge_access_log_written_total",
+    "foxbridge_access_log_dropped_total"
+};
+
+void HttpServer::registerMetrics() {
+    using Type = Metrics::CallbackType;
+    auto& metrics = Metrics::instance();
+    auto db = db_manager_;
+    
+    metrics.registerCallback("foxbridge_db_pool_size", "ODBC connections in the pool",
+                             Type::GAUGE, [db] { return static_cast<double>(db->poolSize()); });
+    metrics.registerCallback("foxbridge_db_pool_in_use", "ODBC connections checked out",
+                             Type::GAUGE, [db] { return static_cast<double>(db->poolInUse()); });
+    metrics.registerCallback("foxbridge_db_pool_utilization", "Fraction of pooled connections in use",
+                             Type::GAUGE, [db] {
+                                 size_t size = db->poolSize();
+                                 return size ? static_cast<double>(db->poolInUse()) / size : 0.0;
+                             });
+    metrics.registerCallback("foxbridge_db_retries_total", "Statements retried after lock or transient errors",
+                             Type::COUNTER, [db] { return db->getStats().value("retries", 0.0); });
+    metrics.registerCallback("foxbridge_db_lock_conflicts_total", "Statements that hit a record or file lock",
+                             Type::COUNTER, [db] { return db->getStats().value("lock_conflicts", 0.0); });
+    
+    metrics.registerCallback("foxbridge_coalesce_executions_total", "GET requests that ran their handler",
+                             Type::COUNTER, [this] { return static_cast<double>(coalescer_.executions()); });
+    metrics.registerCallback("foxbridge_coalesce_hits_total", "GET requests served from an identical in-flight request",
+                             Type::COUNTER, [this] { return static_cast<double>(coalescer_.coalescedCount()); });
+    metrics.registerCallback("foxbridge_coalesce_hit_ratio", "Share of GET requests served without running the handler",
+                             Type::GAUGE, [this] {
+                                 double hits = static_cast<double>(coalescer_.coalescedCount());
+                                 double total = hits + static_cast<double>(coalescer_.executions());
+                                 return total > 0 ? hits / total : 0.0;
+                             });
+    
+    metrics.registerCallback("foxbridge_requests_in_flight", "Requests holding an admission slot",
+                             Type::GAUGE, [this] { return admission_->stats()["in_flight"].get<double>(); });
+    metrics.registerCallback("foxbridge_requests_queued", "Requests waiting for an admission slot",
+                             Type::GAUGE, [this] { return admission_->stats()["queued"].get<double>(); });
+    metrics.registerCallback("foxbridge_accept_shed_total", "Connections answered 503 because the worker queue was full",
+                             Type::COUNTER, [this] { return static_cast<double>(accept_shed_.load()); });
+    metrics.registerCallback("foxbridge_write_queue_depth", "Write-behind operations not yet applied",
+                             Type::GAUGE, [this] { return write_queue_->stats()["pending"].get<double>(); });
+    
+    if (access_log_) {
+        metrics.registerCallback("foxbridge_access_log_written_total", "Access log lines written",
+                                 Type::COUNTER, [this] { return static_cast<double>(access_log_->written()); });
+        metrics.registerCallback("foxbridge_access_log_dropped_total", "Access log lines dropped because the buffer was full",
+                                 Type::COUNTER, [this] { return static_cast<double>(access_log_->dropped()); });
+    }
+}
+
+void HttpServer::unregisterMetrics() {
+    for (const char* name : SERVER_METRICS) {
+        Metrics::instance().unregisterCallback(name);
+    }
+}
+
 void HttpServer::run() {
     try {
         net::io_context ioc{1};
         tcp::acceptor acceptor{ioc, {net::ip::make_address("127.0.0.1"), 
                                      static_cast<unsigned short>(config_.port)}};
         
+        // Declared after the io_context so connections finish before it goes away
+        WorkerPool workers(static_cast<size_t>(config_.http_worker_threads));
+        
         while (running_) {
-            tcp::socket socket{ioc};
-            acceptor.accept(socket);
+            auto socket = std::make_shared<tcp::socket>(ioc);
+            acceptor.accept(*socket);
             
-            beast::flat_buffer buffer;
-            http::request<http::string_body> req;
-            http::read(socket, buffer, req);
+            // Past the limit a connection would wait behind the others with
+            // no deadline running yet, so it is turned away at once
+            if (workers.queueDepth() >= static_cast<size_t>(config_.accept_queue_limit)) {
+                shedConnection(*socket);
+                continue;
+            }
             
-            http::response<http::string_body> res;
-            res.version(req.version());
-            res.keep_alive(false);
+            workers.submit([this, socket] {
+                handleConnection(*socket);
+            });
+        }
+        
+    } catch (const std::exception& e) {
+        spdlog::error("HTTP server error: {}", e.what());
+    }
+}
+
+void HttpServer::shedConnection(tcp::socket& socket) {
+    ++accept_shed_;
+    spdlog::warn("Shed connection: {} waiting for a worker", config_.accept_queue_limit);
+    
+    boost::system::error_code ec;
+    // Whatever of the request has arrived is read and dropped, so closing
+    // does not reset the connection before the client sees the 503
+    socket.non_blocking(true, ec);
+    char discard[4096];
+    while (socket.read_some(net::buffer(discard), ec) > 0) {
+    }
+    socket.non_blocking(false, ec);
+    
+    http::response<http::string_body> res;
+    res.version(11);
+    res.set(http::field::retry_after, "1");
+    res.keep_alive(false);
+    sendError(res, 503, "Service busy: too many connections, retry later");
+    http::write(socket, res, ec);
+    socket.shutdown(tcp::socket::shutdown_send, ec);
+}
+
+void HttpServer::watchdogLoop() {
+    while (running_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        
+        std::lock_guard<std::mutex> lock(watch_mutex_);
+        for (auto& [id, watched] : watched_requests_) {
+            if (watched.context->cancelled()) {
+                continue;
+            }
+            if (watched.context->expired()) {
+                watched.context->cancel("deadline exceeded");
+            } else if (peerClosed(watched.handle)) {
+                watched.context->cancel("client disconnected");
+            }
+        }
+    }
+}
+
+uint64_t HttpServer::watchRequest(std::shared_ptr<RequestContext> context, 
+                                  tcp::socket::native_handle_type handle) {
+    std::lock_guard<std::mutex> lock(watch_mutex_);
+    uint64_t id = next_watch_id_++;
+    watched_requests_.emplace(id, WatchedRequest{std::move(context), handle});
+    return id;
+}
+
+void HttpServer::unwatchRequest(uint64_t id) {
+    std::lock_guard<std::mutex> lock(watch_mutex_);
+    watched_requests_.erase(id);
+}
+
+void HttpServer::handleConnection(tcp::socket& socket) {
+    std::shared_ptr<RequestTrace> trace;
+    std::shared_ptr<RequestContext> context;
+    RequestLine line;
+    auto started = std::chrono::steady_clock::now();
+    size_t streamed_bytes = 0;
+    bool recorded = false;
+    
+    auto elapsed = [&started] {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started);
+    };
+    
+    try {
+        beast::flat_buffer buffer;
+        http::request<http::string_body> req;
+        auto read_start = std::chrono::steady_clock::now();
+        http::read(socket, buffer, req);
+        started = std::chrono::steady_clock::now();
+        
+        // Scratch memory for everything the request builds, released in one
+        // step when this function returns
+        RequestArena arena;
+        RequestArena::Scope arena_scope(arena);
+        uint64_t allocations_start = AllocationCounter::threadAllocations();
+        
+        http::response<http::string_body> res;
+        res.version(req.version());
+        res.keep_alive(false);
+        
+        line.method = std::string(req.method_string());
+        line.target = std::string(req.target());
+        size_t query_pos = line.target.find('?');
+        line.path = line.target.substr(0, query_pos);
+        line.query = (query_pos != std::string::npos) ? line.target.substr(query_pos + 1) : "";
+        
+        // Sampled requests (and authenticated debug requests) record their phases
+        line.debug_trace = req.find("X-Debug-Trace") != req.end() && authenticate(req);
+        auto accept = req.find(http::field::accept);
+        if (accept != req.end()) {
+            line.format = bodyFormatFromAccept(std::string_view(accept->value().data(), accept->value().size()));
+        }
+        trace = tracer_->begin(line.method + " " + line.path, read_start, line.debug_trace);
+        RequestTrace::Scope trace_scope(trace);
+        if (trace) {
+            trace->addSpan("http.read", read_start, started);
+        }
+        
+        {
+            TraceSpan span("route.match");
+            line.route = Router::match(line.method, line.path);
+        }
+        
+        // Every request carries a deadline; the watchdog cancels its running
+        // statements once it passes or the client goes away
+        context = std::make_shared<RequestContext>(
+            RequestContext::Clock::now() + std::chrono::seconds(config_.connection_timeout));
+        context->setOrigin(line.method + " " + line.target, Router::routeName(line.route.id));
+        
+        RequestCoalescer::SharedResponse shared;
+        bool streamed = false;
+        {
+            WatchGuard watch(*this, watchRequest(context, socket.native_handle()));
+            RequestContext::Scope scope(context);
+            if (line.route.id == RouteId::MEMO) {
+                streamed = streamMemo(socket, req, res, line, streamed_bytes);
+            } else if (line.route.id == RouteId::ARROW || line.route.id == RouteId::PARQUET) {
+                streamed = streamExport(socket, req, res, line, streamed_bytes);
+            } else if (line.route.id == RouteId::VIEW) {
+                streamed = streamView(socket, req, res, line, streamed_bytes);
+            } else if (!streamSnapshot(socket, req, res, line, streamed, streamed_bytes)) {
+                handleRequest(req, res, shared, line);
+            }
+        }
+        
+        if (context->cancelled() && context->cancelReason() == "client disconnected") {
+            spdlog::info("Client disconnected: {} {}", line.method, line.target);
+            recorded = true;
+            Metrics::instance().recordRequest(line.route.id, 499, elapsed(), 0);
+            logAccess(line, 499, elapsed(), 0, trace);
+        } else if (streamed) {
+            // Headers and body already went out from the stream handler; a
+            // cancelled stream stopped short of its end
+            bool cut_short = context->cancelled();
+            int status = !cut_short ? res.result_int() :
+                         context->cancelReason() == "deadline exceeded" ? 504 : 500;
+            recorded = true;
+            Metrics::instance().recordRequest(line.route.id, status, elapsed(), streamed_bytes);
+            logAccess(line, status, elapsed(), streamed_bytes, trace);
             
-            handleRequest(req, res);
+            // A short body is reset rather than closed, so the client
+            // cannot take it for a complete one
+            beast::error_code ec;
+            if (cut_short) {
+                spdlog::warn("Stream cut short ({}): {} {}", context->cancelReason(), line.method, line.target);
+                socket.set_option(net::socket_base::linger(true, 0), ec);
+                socket.close(ec);
+            } else {
+                socket.shutdown(tcp::socket::shutdown_send, ec);
+            }
+        } else {
+            // Debug requests are never coalesced, so they always own `res`
+            if (line.debug_trace && trace && !shared) {
+                res.set("Server-Timing", trace->serverTiming());
+                res.set("X-Trace-Id", trace->traceId());
+                res.set("X-Request-Memory", "arena=" + std::to_string(arena.bytes()) + "; allocations=" +
+                        (AllocationCounter::enabled() ?
+                         std::to_string(AllocationCounter::threadAllocations() - allocations_start) : "n/a"));
+            }
             
-            http::write(socket, res);
+            const auto& response = shared ? *shared : res;
+            {
+                TraceSpan span("http.write");
+                http::write(socket, response);
+            }
+            recorded = true;
+            Metrics::instance().recordRequest(line.route.id, response.result_int(), elapsed(),
+                                              response.body().size());
+            logAccess(line, response.result_int(), elapsed(), response.body().size(), trace);
+            
+            beast::error_code ec;
+            socket.shutdown(tcp::socket::shutdown_send, ec);
         }
+        Metrics::instance().recordRequestMemory(line.route.id,
+                                                AllocationCounter::threadAllocations() - allocations_start,
+                                                arena.bytes());
         
     } catch (const std::exception& e) {
-        spdlog::error("HTTP server error: {}", e.what());
+        spdlog::warn("Connection error: {}", e.what());
+        
+        // A request that was read but whose response did not make it out,
+        // typically a streamed body cut short by a reset or an idle timeout
+        if (context && !recorded) {
+            int status = context->cancelled() && context->cancelReason() == "deadline exceeded" ? 504 : 499;
+            Metrics::instance().recordRequest(line.route.id, status, elapsed(), streamed_bytes);
+            logAccess(line, status, elapsed(), streamed_bytes, trace);
+        }
+    }
+    
+    tracer_->finish(std::move(trace));
+}
+
+// Single "bytes=first-last", "bytes=first-" or "bytes=-suffix" range.
+// Multiple ranges and malformed values are ignored (the whole memo is sent).
+enum class ByteRange { NONE, OK, UNSATISFIABLE };
+
+static ByteRange parseByteRange(const std::string& value, uint64_t length,
+                                uint64_t& first, uint64_t& last) {
+    if (value.rfind("bytes=", 0) != 0 || value.find(',') != std::string::npos) {
+        return ByteRange::NONE;
+    }
+    std::string spec = value.substr(6);
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+        return ByteRange::NONE;
+    }
+    std::string from = spec.substr(0, dash);
+    std::string to = spec.substr(dash + 1);
+    auto digits = [](const std::string& text) {
+        return !text.empty() && text.size() <= 19 &&
+               std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); });
+    };
+    
+    if (from.empty()) {
+        if (!digits(to)) {
+            return ByteRange::NONE;
+        }
+        uint64_t suffix = std::stoull(to);
+        if (suffix == 0 || length == 0) {
+            return ByteRange::UNSATISFIABLE;
+        }
+        first = length - std::min(suffix, length);
+        last = length - 1;
+        return ByteRange::OK;
+    }
+    
+    if (!digits(from) || (!to.empty() && !digits(to))) {
+        return ByteRange::NONE;
+    }
+    first = std::stoull(from);
+    last = to.empty() ? length - 1 : std::min<uint64_t>(std::stoull(to), length - 1);
+    if (first >= length || (!to.empty() && std::stoull(to) < first)) {
+        return ByteRange::UNSATISFIABLE;
     }
+    return ByteRange::OK;
+}
+
+AdmissionController::Ticket HttpServer::admitRequest(http::response<http::string_body>& res,
+                                                     const RequestLine& line) {
+    RouteClass route_class = AdmissionController::classify(line.path);
+    TraceSpan admission_span("admission.wait");
+    auto ticket = admission_->admit(route_class);
+    admission_span.end();
+    if (!ticket) {
+        const char* class_name = AdmissionController::className(route_class);
+        spdlog::warn("Shed {} request: {} {}", class_name, line.method, line.target);
+        res.set(http::field::retry_after, std::to_string(admission_->retryAfterSeconds(route_class)));
+        sendError(res, 503, std::string("Service busy: too many ") + class_name + 
+                           " requests, retry later", line.format);
+    }
+    return ticket;
+}
+
+AdmissionController::Ticket HttpServer::admitStream(const http::request<http::string_body>& req,
+                                                    http::response<http::string_body>& res,
+                                                    const RequestLine& line) {
+    if (!authenticate(req)) {
+        sendError(res, 401, "Unauthorized: Invalid or missing X-API-Key", line.format);
+        return {};
+    }
+    return admitRequest(res, line);
+}
+
+bool HttpServer::streamMemo(tcp::socket& socket, const http::request<http::string_body>& req,
+                            http::response<http::string_body>& res, const RequestLine& line,
+                            size_t& bytes_sent) {
+    auto ticket = admitStream(req, res, line);
+    if (!ticket) {
+        return false;
+    }
+    
+    const auto& params = line.route.params;
+    MemoReader reader;
+    try {
+        TraceSpan span("memo.open");
+        unsigned long long recno = std::stoull(params[1]);
+        if (recno > UINT32_MAX) {
+            throw std::runtime_error("Record not found: " + params[1]);
+        }
+        reader = db_manager_->openMemo(params[0], static_cast<uint32_t>(recno), params[2]);
+    } catch (const std::exception& e) {
+        sendError(res, 404, std::string("Error: ") + e.what(), line.format);
+        return false;
+    }
+    
+    // Raw bytes in the table's code page, so range offsets match the .fpt
+    uint64_t length = reader.memo.length;
+    uint64_t first = 0;
+    uint64_t last = length == 0 ? 0 : length - 1;
+    ByteRange range = ByteRange::NONE;
+    auto range_header = req.find(http::field::range);
+    if (range_header != req.end()) {
+        range = parseByteRange(std::string(range_header->value()), length, first, last);
+    }
+    if (range == ByteRange::UNSATISFIABLE) {
+        res.set(http::field::content_range, "bytes */" + std::to_string(length));
+        sendError(res, 416, "Range not satisfiable", line.format);
+        return false;
+    }
+    uint64_t remaining = length == 0 ? 0 : last - first + 1;
+    
+    const char* charset = reader.encoding == TextEncoding::CP874 ? "windows-874" :
+                          reader.encoding == TextEncoding::CP1252 ? "windows-1252" : "utf-8";
+    http::response<http::buffer_body> stream;
+    stream.version(req.version());
+    stream.keep_alive(false);
+    stream.result(range == ByteRange::OK ? http::status::partial_content : http::status::ok);
+    stream.set(http::field::content_type, reader.memo.type == 0 ? std::string("application/octet-stream") :
+                                          std::string("text/plain; charset=") + charset);
+    stream.set(http::field::accept_ranges, "bytes");
+    if (range == ByteRange::OK) {
+        stream.set(http::field::content_range, "bytes " + std::to_string(first) + "-" +
+                                               std::to_string(last) + "/" + std::to_string(length));
+    }
+    stream.content_length(remaining);
+    stream.body().data = nullptr;
+    stream.body().more = remaining > 0;
+    
+    // The request deadline holds until the headers go out
+    auto context = RequestContext::current();
+    if (context && context->cancelled()) {
+        sendError(res, 504, "Request cancelled: " + context->cancelReason(), line.format);
+        return false;
+    }
+    res.result(stream.result());
+    
+    TraceSpan span("http.write");
+    http::response_serializer<http::buffer_body> serializer{stream};
+    http::write_header(socket, serializer);
+    StreamTimeout timeout(socket, std::chrono::seconds(config_.stream_idle_timeout));
+    
+    std::vector<char> chunk(MEMO_CHUNK_BYTES);
+    uint64_t offset = first;
+    while (remaining > 0) {
+        if (context && context->cancelled()) {
+            return true;    // Client gone or idle too long; the connection is reset
+        }
+        size_t wanted = static_cast<size_t>(std::min<uint64_t>(chunk.size(), remaining));
+        size_t got = reader.file->read(reader.memo, offset, chunk.data(), wanted);
+        if (got == 0) {
+            spdlog::warn("Memo shorter than its header: {}", line.target);
+            timeout.abort("memo shorter than its header");
+            return true;
+        }
+        stream.body().data = chunk.data();
+        stream.body().size = got;
+        stream.body().more = true;
+        
+        beast::error_code ec;
+        http::write(socket, serializer, ec);
+        if (ec == http::error::need_buffer) {
+            ec = {};
+        }
+        if (ec) {
+            throw beast::system_error{ec};
+        }
+        offset += got;
+        remaining -= got;
+        bytes_sent += got;
+        timeout.renew();
+    }
+    
+    stream.body().data = nullptr;
+    stream.body().more = false;
+    http::write(socket, serializer);
+    return true;
+}
+
+// One chunk of a chunked buffer_body response
+static void writeBodyChunk(tcp::socket& socket, http::response_serializer<http::buffer_body>& serializer,
+                           http::response<http::buffer_body>& stream, const char* data, size_t size) {
+    stream.body().data = const_cast<char*>(data);
+    stream.body().size = size;
+    stream.body().more = true;
+    
+    beast::error_code ec;
+    http::write(socket, serializer, ec);
+    if (ec == http::error::need_buffer) {
+        ec = {};
+    }
+    if (ec) {
+        throw beast::system_error{ec};
+    }
+}
+
+// Takes ?part=i&parts=n[&records=N] out of an export's query parameters,
+// leaving the filters; false with a reason in `error` when they are malformed
+static bool takeExportPart(std::map<std::string, std::string>& params, ExportPart& part, std::string& error) {
+    static constexpr uint32_t MAX_PARTS = 256;
+    auto index = params.find("part");
+    auto count = params.find("parts");
+    auto records = params.find("records");
+    if (index == params.end() && count == params.end() && records == params.end()) {
+        return true;
+    }
+    
+    auto number = [](const std::string& text, uint32_t& value) {
+        if (text.empty() || text.size() > 10 ||
+            !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        unsigned long long parsed = std::stoull(text);
+        if (parsed > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        value = static_cast<uint32_t>(parsed);
+        return true;
+    };
+    if (index == params.end() || count == params.end() || !number(index->second, part.index) ||
+        !number(count->second, part.count) || part.count < 1 || part.count > MAX_PARTS ||
+        part.index >= part.count) {
+        error = "part and parts must be given together, with 0 <= part < parts <= " + std::to_string(MAX_PARTS);
+        return false;
+    }
+    if (records != params.end()) {
+        uint32_t pinned = 0;
+        if (!number(records->second, pinned)) {
+            error = "records must be the record count from the first part's X-Export-Records header";
+            return false;
+        }
+        part.records = pinned;
+        params.erase(records);
+    }
+    params.erase(index);
+    params.erase(count);
+    return true;
+}
+
+bool HttpServer::streamExport(tcp::socket& socket, const http::request<http::string_body>& req,
+                              http::response<http::string_body>& res, const RequestLine& line,
+                              size_t& bytes_sent) {
+    auto ticket = admitStream(req, res, line);
+    if (!ticket) {
+        return false;
+    }
+    bool parquet = line.route.id == RouteId::PARQUET;
+    if (!TableExport::arrowAvailable()) {
+        sendError(res, 501, std::string(parquet ? "Parquet" : "Arrow") + " export is not available in this build",
+                  line.format);
+        return false;
+    }
+    auto filters = parseQueryString(line.query);
+    ExportPart part;
+    std::string error;
+    if (!takeExportPart(filters, part, error)) {
+        sendError(res, 400, error, line.format);
+        return false;
+    }
+    
+    const std::string& filename = line.route.params[0];
+    if (!pinExportPart(filename, part, res, line.format)) {
+        return false;
+    }
+    http::response<http::buffer_body> stream;
+    stream.version(req.version());
+    stream.keep_alive(false);
+    stream.result(http::status::ok);
+    if (parquet) {
+        // Each part is a file of its own
+        std::string name = part.count > 1 ? filename + ".part" + std::to_string(part.index) : filename;
+        stream.set(http::field::content_type, "application/vnd.apache.parquet");
+        stream.set(http::field::content_disposition, "attachment; filename=\"" + name + ".parquet\"");
+    } else {
+        stream.set(http::field::content_type, "application/vnd.apache.arrow.stream");
+        stream.set(http::field::content_disposition, "attachment; filename=\"" + filename + ".arrows\"");
+    }
+    if (part.records) {
+        stream.set("X-Export-Records", std::to_string(*part.records));
+    }
+    stream.chunked(true);
+    stream.body().data = nullptr;
+    stream.body().more = true;
+    http::response_serializer<http::buffer_body> serializer{stream};
+    
+    // Headers go out with the first record batch or row group, so a table
+    // that cannot be read still gets a JSON error
+    std::optional<StreamTimeout> timeout;
+    auto write = [&](const char* data, size_t size) {
+        if (!timeout) {
+            http::write_header(socket, serializer);
+            timeout.emplace(socket, std::chrono::seconds(config_.stream_idle_timeout));
+        }
+        writeBodyChunk(socket, serializer, stream, data, size);
+        bytes_sent += size;
+        timeout->renew();
+    };
+    
+    auto result = parquet ? table_export_->writeParquet(filename, filters, write, part) :
+                            table_export_->writeArrow(filename, filters, write, part);
+    if (!timeout) {
+        auto context = RequestContext::current();
+        if (context && context->cancelled()) {
+            sendError(res, 504, "Request cancelled: " + context->cancelReason(), line.format);
+            return false;
+        }
+        sendJsonResponse(res, 500, {
+            {"status", "error"},
+            {"msg", result.message},
+            {"data", nullptr},
+            {"index", "ok"},
+            {"warnings", result.warnings}
+        }, line.format);
+        return false;
+    }
+    res.result(stream.result());
+    if (!result.success) {
+        // Too late for a status; the reset, before the closing chunk, tells
+        // the client the stream is incomplete
+        spdlog::warn("{} export of {} failed mid-stream: {}", parquet ? "Parquet" : "Arrow", filename,
+                     result.message);
+        timeout->abort("export failed mid-stream");
+        return true;
+    }
+    
+    stream.body().data = nullptr;
+    stream.body().more = false;
+    http::write(socket, serializer);
+    return true;
+}
+
+// Whether an Accept-Encoding header allows gzip (gzip, x-gzip or *, q > 0)
+static bool acceptsGzip(std::string_view header) {
+    while (!header.empty()) {
+        size_t comma = header.find(',');
+        std::string_view coding = header.substr(0, comma);
+        header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+        
+        size_t semicolon = coding.find(';');
+        std::string_view params = semicolon == std::string_view::npos ? std::string_view() :
+                                  coding.substr(semicolon + 1);
+        std::string name;
+        for (char c : coding.substr(0, semicolon)) {
+            if (c != ' ') {
+                name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        if (name != "gzip" && name != "x-gzip" && name != "*") {
+            continue;
+        }
+        size_t q = params.find("q=");
+        return q == std::string_view::npos || std::strtod(std::string(params.substr(q + 2)).c_str(), nullptr) > 0;
+    }
+    return false;
+}
+
+// If-None-Match: "*" or a list of entity tags, compared weakly
+static bool etagMatches(std::string_view header, const std::string& etag) {
+    while (!header.empty()) {
+        size_t comma = header.find(',');
+        std::string_view tag = header.substr(0, comma);
+        header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+        while (!tag.empty() && tag.front() == ' ') tag.remove_prefix(1);
+        while (!tag.empty() && tag.back() == ' ') tag.remove_suffix(1);
+        if (tag.rfind("W/", 0) == 0) {
+            tag.remove_prefix(2);
+        }
+        if (tag == "*" || tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HttpServer::streamSnapshot(tcp::socket& socket, const http::request<http::string_body>& req,
+                                http::response<http::string_body>& res, const RequestLine& line,
+                                bool& streamed, size_t& bytes_sent) {
+    // Only plain whole-table exports, in JSON for the JSON route, to clients
+    // that take gzip; anything else is exported live
+    bool csv = line.route.id == RouteId::CSV_ALL;
+    if (!snapshots_ || (!csv && line.route.id != RouteId::JSON_ALL) || !line.query.empty() ||
+        (!csv && line.format != BodyFormat::JSON)) {
+        return false;
+    }
+    auto accept_encoding = req.find(http::field::accept_encoding);
+    if (accept_encoding == req.end() ||
+        !acceptsGzip(std::string_view(accept_encoding->value().data(), accept_encoding->value().size()))) {
+        return false;
+    }
+    if (!authenticate(req)) {
+        return false;       // handleRequest answers 401
+    }
+    
+    const std::string& filename = line.route.params[0];
+    SnapshotFile snapshot;
+    if (!snapshots_->find(filename, csv ? SnapshotFormat::CSV : SnapshotFormat::JSON, snapshot)) {
+        return false;
+    }
+    Platform::FileSender file(snapshot.path.string());
+    if (!file.isOpen()) {
+        return false;       // Replaced since find()
+    }
+    
+    http::response<http::empty_body> head;
+    head.version(req.version());
+    head.keep_alive(false);
+    if (csv) {
+        head.set(http::field::content_type, "text/csv; charset=utf-8");
+        head.set(http::field::content_disposition, "attachment; filename=\"" + filename + ".csv\"");
+    } else {
+        head.set(http::field::content_type, contentType(BodyFormat::JSON));
+    }
+    head.set(http::field::content_encoding, "gzip");
+    head.set(http::field::etag, snapshot.etag);
+    head.set(http::field::accept_ranges, "bytes");
+    head.set(http::field::vary, "Accept, Accept-Encoding");
+    
+    auto none_match = req.find(http::field::if_none_match);
+    if (none_match != req.end() &&
+        etagMatches(std::string_view(none_match->value().data(), none_match->value().size()), snapshot.etag)) {
+        head.result(http::status::not_modified);
+        res.result(head.result());
+        http::response_serializer<http::empty_body> serializer{head};
+        http::write_header(socket, serializer);
+        streamed = true;
+        return true;
+    }
+    
+    // Sending the file does no database work, but it holds an HTTP worker
+    // for the whole download, so it takes an export slot like a live export
+    auto ticket = admitStream(req, res, line);
+    if (!ticket) {
+        streamed = false;
+        return true;
+    }
+    
+    // A Range counts only while If-Range (when sent) still names this snapshot
+    uint64_t length = snapshot.size;
+    uint64_t first = 0;
+    uint64_t last = length == 0 ? 0 : length - 1;
+    ByteRange range = ByteRange::NONE;
+    auto range_header = req.find(http::field::range);
+    auto if_range = req.find(http::field::if_range);
+    if (range_header != req.end() && (if_range == req.end() || if_range->value() == snapshot.etag)) {
+        range = parseByteRange(std::string(range_header->value()), length, first, last);
+    }
+    if (range == ByteRange::UNSATISFIABLE) {
+        res.set(http::field::content_range, "bytes */" + std::to_string(length));
+        sendError(res, 416, "Range not satisfiable", line.format);
+        streamed = false;
+        return true;
+    }
+    uint64_t remaining = length == 0 ? 0 : last - first + 1;
+    
+    head.result(range == ByteRange::OK ? http::status::partial_content : http::status::ok);
+    if (range == ByteRange::OK) {
+        head.set(http::field::content_range, "bytes " + std::to_string(first) + "-" +
+                                             std::to_string(last) + "/" + std::to_string(length));
+    }
+    head.content_length(remaining);
+    res.result(head.result());
+    
+    TraceSpan span("http.sendfile");
+    http::response_serializer<http::empty_body> serializer{head};
+    http::write_header(socket, serializer);
+    StreamTimeout timeout(socket, std::chrono::seconds(config_.stream_idle_timeout));
+    streamed = true;
+    
+    // In slices, so the idle timeout is renewed while a large file goes out
+    while (remaining > 0) {
+        uint64_t slice = std::min<uint64_t>(remaining, SENDFILE_SLICE_BYTES);
+        uint64_t sent = 0;
+        bool ok = file.send(socket.native_handle(), first, slice, sent);
+        bytes_sent += static_cast<size_t>(sent);
+        if (!ok) {
+            // Nearly always the peer going away mid-download
+            spdlog::debug("Snapshot download cut short after {} bytes: {}", bytes_sent, line.target);
+            timeout.abort("client disconnected");
+            break;
+        }
+        first += slice;
+        remaining -= slice;
+        timeout.renew();
+    }
+    return true;
+}
+
+bool HttpServer::buildSnapshot(const std::string& table, SnapshotFormat format, std::string& body,
+                               std::string& error) {
+    if (format == SnapshotFormat::CSV) {
+        auto result = handleExportCSV(table);
+        if (result["status"] != "success") {
+            error = result["msg"].get<std::string>();
+            return false;
+        }
+        body = std::move(result["data"].get_ref<std::string&>());
+        return true;
+    }
+    
+    RowSet rows;
+    auto envelope = handleExportJSON(table, "", rows);
+    if (envelope["status"] != "success") {
+        error = envelope["msg"].get<std::string>();
+        return false;
+    }
+    http::response<http::string_body> res;
+    sendJsonResponse(res, 200, envelope, rows, BodyFormat::JSON);
+    body = std::move(res.body());
+    return true;
+}
+
+bool HttpServer::streamView(tcp::socket& socket, const http::request<http::string_body>& req,
+                            http::response<http::string_body>& res, const RequestLine& line,
+                            size_t& bytes_sent) {
+    auto ticket = admitStream(req, res, line);
+    if (!ticket) {
+        return false;
+    }
+    
+    const std::string& filename = line.route.params[0];
+    ViewQuery query = parseViewQuery(line.query);
+    size_t matches = 0;
+    // An unfiltered, unsorted page is a record-number range, which only the
+    // native reader can seek to instead of scanning the table through ODBC
+    bool range = query.request.filters.empty() && query.request.sort.empty();
+    auto result = (range ? range_reader_ : db_manager_)->page(filename, query.request, matches);
+    
+    http::response<http::buffer_body> stream;
+    stream.version(req.version());
+    stream.keep_alive(false);
+    stream.result(result.success ? http::status::ok :
+                  result.message.find("File not found") != std::string::npos ? http::status::not_found :
+                  result.message.rfind("Invalid ", 0) == 0 ? http::status::bad_request :
+                  http::status::internal_server_error);
+    stream.set(http::field::content_type, "text/html; charset=utf-8");
+    stream.chunked(true);
+    stream.body().data = nullptr;
+    stream.body().more = true;
+    
+    // The request deadline holds until the headers go out
+    auto context = RequestContext::current();
+    if (context && context->cancelled()) {
+        sendError(res, 504, "Request cancelled: " + context->cancelReason(), line.format);
+        return false;
+    }
+    res.result(stream.result());
+    
+    TraceSpan span("http.write");
+    http::response_serializer<http::buffer_body> serializer{stream};
+    http::write_header(socket, serializer);
+    StreamTimeout timeout(socket, std::chrono::seconds(config_.stream_idle_timeout));
+    
+    HtmlViewWriter writer(filename, query, [&](const char* data, size_t size) {
+        writeBodyChunk(socket, serializer, stream, data, size);
+        bytes_sent += size;
+        timeout.renew();
+    });
+    if (result.success) {
+        writer.writePage(result.rows, matches);
+    } else {
+        writer.writeError(result.message);
+    }
+    
+    stream.body().data = nullptr;
+    stream.body().more = false;
+    http::write(socket, serializer);
+    return true;
+}
+
+void HttpServer::logAccess(const RequestLine& line, int status, std::chrono::microseconds latency,
+                           size_t bytes, const std::shared_ptr<RequestTrace>& trace) {
+    if (!access_log_) {
+        return;
+    }
+    
+    AccessLogEntry entry;
+    entry.time = std::chrono::system_clock::now();
+    entry.method = line.method;
+    entry.route = Router::routeName(line.route.id);
+    entry.target = line.target;
+    entry.status = status;
+    entry.latency = latency;
+    entry.bytes = bytes;
+    if (trace) {
+        entry.trace_id = trace->traceId();
+    }
+    access_log_->record(std::move(entry));
 }
 
 bool HttpServer::authenticate(const http::request<http::string_body>& req) {
@@ -74,185 +1122,313 @@ bool HttpServer::authenticate(const http::request<http::string_body>& req) {
 }
 
 void HttpServer::handleRequest(http::request<http::string_body>& req, 
-                               http::response<http::string_body>& res) {
-    
-    std::string target = std::string(req.target());
-    std::string method = std::string(req.method_string());
+                               http::response<http::string_body>& res,
+                               RequestCoalescer::SharedResponse& shared,
+                               const RequestLine& line) {
     
-    spdlog::info("Request: {} {}", method, target);
+    // access.log already has every request; the main log repeats it only without one
+    if (access_log_) {
+        spdlog::debug("Request: {} {}", line.method, line.target);
+    } else {
+        spdlog::info("Request: {} {}", line.method, line.target);
+    }
     
     // Health check (no auth required)
-    if (target == "/health" && method == "GET") {
-        sendJsonResponse(res, 200, handleHealth());
+    if (line.route.id == RouteId::HEALTH) {
+        sendJsonResponse(res, 200, handleHealth(), line.format);
         return;
     }
     
     // Auth required for all other endpoints
     if (!authenticate(req)) {
-        sendError(res, 401, "Unauthorized: Invalid or missing X-API-Key");
+        sendError(res, 401, "Unauthorized: Invalid or missing X-API-Key", line.format);
+        return;
+    }
+    
+    // Followers of a coalesced request hold a ticket too, so a burst of
+    // identical GETs cannot tie up workers beyond the class's queue
+    auto ticket = admitRequest(res, line);
+    if (!ticket) {
         return;
     }
     
-    // Parse routes using regex
-    std::regex json_all_pattern(R"(^/api/dbf/json/([^/]+\.dbf)$)");
-    std::regex json_docnum_pattern(R"(^/api/dbf/json/([^/]+\.dbf)/([^/]+)$)");
-    std::regex csv_all_pattern(R"(^/api/dbf/csv/([^/]+\.dbf)$)");
-    std::regex csv_docnum_pattern(R"(^/api/dbf/csv/([^/]+\.dbf)/([^/]+)$)");
-    std::regex search_pattern(R"(^/api/dbf/search/([^/]+\.dbf))");
-    std::regex view_pattern(R"(^/view/([^/]+\.dbf)$)");
-    std::regex docnum_pattern(R"(^/docnum/([^/]+)$)");
-    std::regex direct_lookup_pattern(R"(^/([A-Z]{2}\d{7})$)");  // e.g., HP0000001
+    // Identical concurrent GETs share one backend execution and response buffer
+    if (line.method == "GET" && config_.coalesce_requests && !line.debug_trace) {
+        std::string key = RequestCoalescer::makeKey(line.method, line.path, 
+                                                    parseQueryString(line.query),
+                                                    std::string(req["X-API-Key"]), 
+                                                    req.version(),
+                                                    contentType(line.format));
+        // A response cut short by this request's own disconnect or deadline
+        // is not handed to the others; each waits only until its own deadline
+        auto context = RequestContext::current();
+        bool coalesced = false;
+        shared = coalescer_.run(key, [&](bool& shareable) {
+            auto produced = std::make_shared<http::response<http::string_body>>();
+            produced->version(req.version());
+            produced->keep_alive(false);
+            routeAdmitted(req, *produced, line);
+            shareable = !(context && context->cancelled());
+            return RequestCoalescer::SharedResponse(std::move(produced));
+        }, coalesced, context ? context->deadline() : RequestContext::Clock::time_point::max());
+        
+        if (coalesced) {
+            spdlog::debug("Coalesced request: {} {}", line.method, line.target);
+        }
+        if (!shared) {
+            sendError(res, 504, "Request cancelled: deadline exceeded waiting for an identical request",
+                      line.format);
+        }
+        return;
+    }
     
-    std::regex add_pattern(R"(^/api/dbf/add/([^/]+\.dbf)$)");
-    std::regex update_pattern(R"(^/api/dbf/update/([^/]+\.dbf)$)");
-    std::regex delete_pattern(R"(^/api/dbf/delete/([^/]+\.dbf)$)");
-    std::regex undelete_pattern(R"(^/api/dbf/undelete/([^/]+\.dbf)$)");
-    std::regex pack_pattern(R"(^/api/dbf/pack/([^/]+\.dbf)$)");
-    std::regex reindex_pattern(R"(^/api/dbf/maintenance/reindex/([^/]+\.dbf)$)");
-    std::regex status_pattern(R"(^/api/dbf/maintenance/status/([^/]+\.dbf)$)");
+    routeAdmitted(req, res, line);
+}
+
+void HttpServer::routeAdmitted(http::request<http::string_body>& req, 
+                               http::response<http::string_body>& res,
+                               const RequestLine& line) {
+    routeRequest(req, res, line);
     
-    std::smatch matches;
+    auto context = RequestContext::current();
+    if (context && context->cancelled()) {
+        sendError(res, 504, "Request cancelled: " + context->cancelReason(), line.format);
+    }
+}
+
+void HttpServer::routeRequest(http::request<http::string_body>& req, 
+                              http::response<http::string_body>& res,
+                              const RequestLine& line) {
+    const auto& params = line.route.params;
     
     try {
         nlohmann::json body;
         if (!req.body().empty()) {
+            TraceSpan span("body.parse");
             body = nlohmann::json::parse(req.body());
         }
         
-        // GET /api/dbf/json/filename.dbf - Export all as JSON
-        if (std::regex_match(target, matches, json_all_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleExportJSON(filename));
+        TraceSpan handler_span("handler", Router::routeName(line.route.id));
+        switch (line.route.id) {
+        // GET /metrics - Prometheus text exposition
+        case RouteId::METRICS:
+            sendMetricsResponse(res, handleMetrics());
             return;
-        }
         
-        // GET /api/dbf/json/filename.dbf/HP0000001 - Export filtered JSON
-        if (std::regex_match(target, matches, json_docnum_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            std::string docnum = matches[2];
-            sendJsonResponse(res, 200, handleExportJSON(filename, docnum));
+        // GET /api/dbf/json/filename.dbf[?part=0&parts=4] - Export all as JSON
+        case RouteId::JSON_ALL: {
+            auto query_params = parseQueryString(line.query);
+            ExportPart part;
+            std::string error;
+            if (!takeExportPart(query_params, part, error)) {
+                sendError(res, 400, error, line.format);
+                return;
+            }
+            if (!pinExportPart(params[0], part, res, line.format)) {
+                return;
+            }
+            RowSet rows;
+            auto result = part.count > 1 ? handleExportPart(params[0], part, rows) :
+                                           handleExportJSON(params[0], "", rows);
+            sendJsonResponse(res, 200, result, rows, line.format);
+            if (part.records) {
+                res.set("X-Export-Records", std::to_string(*part.records));
+            }
             return;
         }
         
-        // GET /api/dbf/csv/filename.dbf - Export all as CSV
-        if (std::regex_match(target, matches, csv_all_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            auto result = handleExportCSV(filename);
-            if (result["status"] == "success") {
-                sendCSVResponse(res, result["data"].dump(), filename);
-            } else {
-                sendJsonResponse(res, 500, result);
-            }
+        // GET /api/dbf/json/filename.dbf/HP0000001 - Export filtered JSON
+        case RouteId::JSON_DOCNUM: {
+            RowSet rows;
+            auto result = handleExportJSON(params[0], params[1], rows);
+            sendJsonResponse(res, 200, result, rows, line.format);
             return;
         }
         
+        // GET /api/dbf/csv/filename.dbf[?part=0&parts=4] - Export all as CSV
         // GET /api/dbf/csv/filename.dbf/HP0000001 - Export filtered CSV
-        if (std::regex_match(target, matches, csv_docnum_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            std::string docnum = matches[2];
-            auto result = handleExportCSV(filename, docnum);
+        case RouteId::CSV_ALL:
+        case RouteId::CSV_DOCNUM: {
+            const std::string& filename = params[0];
+            auto query_params = parseQueryString(line.query);
+            ExportPart part;
+            std::string error;
+            if (line.route.id == RouteId::CSV_ALL && !takeExportPart(query_params, part, error)) {
+                sendError(res, 400, error, line.format);
+                return;
+            }
+            // A pinned record count is checked even for a single part
+            if (part.count > 1 || part.records) {
+                if (!pinExportPart(filename, part, res, line.format)) {
+                    return;
+                }
+                // Only part 0 has the header, so the parts join with cat
+                RowSet rows;
+                auto result = handleExportPart(filename, part, rows);
+                if (result["status"] == "success") {
+                    std::string csv;
+                    CsvEncoder(db_manager_->csvDialect()).write(rows, csv, part.first());
+                    sendCSVResponse(res, csv, part.count > 1 ? filename + ".part" + std::to_string(part.index) :
+                                                               filename);
+                    res.set("X-Export-Records", std::to_string(*part.records));
+                } else {
+                    sendJsonResponse(res, 500, result, line.format);
+                }
+                return;
+            }
+            auto result = handleExportCSV(filename, params.size() > 1 ? params[1] : "");
             if (result["status"] == "success") {
-                sendCSVResponse(res, result["data"].dump(), filename);
+                sendCSVResponse(res, result["data"].get_ref<const std::string&>(), filename);
             } else {
-                sendJsonResponse(res, 500, result);
+                sendJsonResponse(res, 500, result, line.format);
             }
             return;
         }
         
         // GET /api/dbf/search/filename.dbf?field=value - Search
-        if (std::regex_match(target, matches, search_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            size_t query_pos = target.find('?');
-            std::string query_params = (query_pos != std::string::npos) ? 
-                                       target.substr(query_pos + 1) : "";
-            sendJsonResponse(res, 200, handleSearch(filename, query_params));
+        case RouteId::SEARCH: {
+            RowSet rows;
+            auto result = handleSearch(params[0], line.query, rows);
+            sendJsonResponse(res, 200, result, rows, line.format);
             return;
         }
         
-        // GET /view/filename.dbf - HTML view
-        if (std::regex_match(target, matches, view_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            sendHTMLResponse(res, handleViewHTML(filename));
+        // GET /docnum/HP0000001[?first=1] - Find by docnum
+        case RouteId::DOCNUM: {
+            auto query_params = parseQueryString(line.query);
+            bool first_only = query_params.count("first") && query_params["first"] != "0";
+            sendJsonResponse(res, 200, handleFindDocnum(params[0], first_only), line.format);
             return;
         }
         
-        // GET /docnum/HP0000001 - Find by docnum
-        if (std::regex_match(target, matches, docnum_pattern) && method == "GET") {
-            std::string docnum = matches[1];
-            sendJsonResponse(res, 200, handleFindDocnum(docnum));
+        // POST /api/docnum/batch - Resolve many docnums in one request
+        case RouteId::DOCNUM_BATCH: {
+            auto result = handleFindDocnumBatch(body);
+            sendJsonResponse(res, result["status"] == "success" ? 200 : 400, result, line.format);
             return;
         }
         
         // GET /HP0000001 - Direct lookup
-        if (std::regex_match(target, matches, direct_lookup_pattern) && method == "GET") {
-            std::string docnum = matches[1];
-            sendJsonResponse(res, 200, handleDirectLookup(docnum));
+        case RouteId::DIRECT_LOOKUP:
+            sendJsonResponse(res, 200, handleDirectLookup(params[0]), line.format);
             return;
-        }
         
-        // POST /api/dbf/add/filename.dbf - Add record
-        if (std::regex_match(target, matches, add_pattern) && method == "POST") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleAdd(filename, body));
+        // POST /api/dbf/add/filename.dbf[?async=1] - Add record
+        case RouteId::ADD:
+            if (useAsyncWrites(line.query)) {
+                enqueueWrite(res, params[0], {WriteOperation::Type::ADD, body, {}, {}}, line.format);
+            } else {
+                sendJsonResponse(res, 200, handleAdd(params[0], body), line.format);
+            }
+            return;
+        
+        // POST /api/dbf/update/filename.dbf[?async=1] - Update record
+        case RouteId::UPDATE:
+            if (useAsyncWrites(line.query)) {
+                enqueueWrite(res, params[0], {WriteOperation::Type::UPDATE, {}, 
+                                              body.value("where", nlohmann::json()),
+                                              body.value("update", nlohmann::json())}, line.format);
+            } else {
+                sendJsonResponse(res, 200, handleUpdate(params[0], body), line.format);
+            }
             return;
-        }
         
-        // POST /api/dbf/update/filename.dbf - Update record
-        if (std::regex_match(target, matches, update_pattern) && method == "POST") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleUpdate(filename, body));
+        // POST /api/dbf/delete/filename.dbf[?async=1] - Delete record
+        case RouteId::DELETE:
+            if (useAsyncWrites(line.query)) {
+                enqueueWrite(res, params[0], {WriteOperation::Type::DELETE, {},
+                                              body.value("where", nlohmann::json()), {}}, line.format);
+            } else {
+                sendJsonResponse(res, 200, handleDelete(params[0], body), line.format);
+            }
             return;
-        }
         
-        // POST /api/dbf/delete/filename.dbf - Delete record
-        if (std::regex_match(target, matches, delete_pattern) && method == "POST") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleDelete(filename, body));
+        // POST /api/dbf/undelete/filename.dbf[?async=1] - Undelete record
+        case RouteId::UNDELETE:
+            if (useAsyncWrites(line.query)) {
+                enqueueWrite(res, params[0], {WriteOperation::Type::UNDELETE, {},
+                                              body.value("where", nlohmann::json()), {}}, line.format);
+            } else {
+                sendJsonResponse(res, 200, handleUndelete(params[0], body), line.format);
+            }
             return;
-        }
         
-        // POST /api/dbf/undelete/filename.dbf - Undelete record
-        if (std::regex_match(target, matches, undelete_pattern) && method == "POST") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleUndelete(filename, body));
+        // GET /api/dbf/jobs/{job_id} - Write-behind job outcome
+        case RouteId::JOB_STATUS: {
+            int status = 200;
+            auto result = handleJobStatus(params[0], status);
+            sendJsonResponse(res, status, result, line.format);
             return;
         }
         
         // POST /api/dbf/pack/filename.dbf - Pack file
-        if (std::regex_match(target, matches, pack_pattern) && method == "POST") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handlePack(filename));
+        case RouteId::PACK:
+            sendJsonResponse(res, 200, handlePack(params[0]), line.format);
             return;
-        }
         
         // POST /api/dbf/maintenance/reindex/filename.dbf
-        if (std::regex_match(target, matches, reindex_pattern) && method == "POST") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleReindex(filename));
+        case RouteId::REINDEX:
+            sendJsonResponse(res, 200, handleReindex(params[0]), line.format);
             return;
-        }
         
         // GET /api/dbf/maintenance/status/filename.dbf
-        if (std::regex_match(target, matches, status_pattern) && method == "GET") {
-            std::string filename = matches[1];
-            sendJsonResponse(res, 200, handleIndexStatus(filename));
+        case RouteId::INDEX_STATUS:
+            sendJsonResponse(res, 200, handleIndexStatus(params[0]), line.format);
+            return;
+        
+        // GET /api/admin/admission - Admission queue depth and shed counts
+        case RouteId::ADMIN_ADMISSION:
+            sendJsonResponse(res, 200, handleAdmissionStats(), line.format);
+            return;
+        
+        // GET /api/admin/dbstats - Connection pool and lock-retry counters
+        case RouteId::ADMIN_DBSTATS:
+            sendJsonResponse(res, 200, handleDatabaseStats(), line.format);
+            return;
+        
+        // GET /api/admin/querystats[?sort=total_ms&limit=50] - Per-statement statistics
+        case RouteId::ADMIN_QUERYSTATS: {
+            int status = 200;
+            auto result = handleQueryStats(line.query, status);
+            sendJsonResponse(res, status, result, line.format);
+            return;
+        }
+        
+        // POST /api/admin/querystats/reset - Start a new measurement window
+        case RouteId::ADMIN_QUERYSTATS_RESET:
+            sendJsonResponse(res, 200, handleQueryStatsReset(), line.format);
             return;
+        
+        // GET /api/admin/traces/{trace_id} - One traced request as Chrome trace JSON
+        case RouteId::ADMIN_TRACE: {
+            int status = 200;
+            auto result = handleTrace(params[0], status);
+            sendJsonResponse(res, status, result, line.format);
+            return;
+        }
+        
+        default:
+            break;
         }
         
-        sendError(res, 404, "Not Found");
+        sendError(res, 404, "Not Found", line.format);
         
     } catch (const std::exception& e) {
-        sendError(res, 500, std::string("Internal Server Error: ") + e.what());
+        sendError(res, 500, std::string("Internal Server Error: ") + e.what(), line.format);
     }
 }
 
 nlohmann::json HttpServer::handleHealth() {
+    auto admission = admission_->stats();
+    
     return {
         {"status", "success"},
         {"msg", "FoxBridgeAgent is running"},
         {"data", {
             {"version", "1.0.0"},
             {"database_connected", db_manager_->isConnected()},
+            {"requests_in_flight", admission["in_flight"]},
+            {"requests_queued", admission["queued"]},
             {"timestamp", std::time(nullptr)}
         }},
         {"index", "ok"},
@@ -260,32 +1436,172 @@ nlohmann::json HttpServer::handleHealth() {
     };
 }
 
-nlohmann::json HttpServer::handleExportJSON(const std::string& filename, const std::string& docnum) {
+std::string HttpServer::handleMetrics() {
+    return Metrics::instance().renderPrometheus();
+}
+
+nlohmann::json HttpServer::handleAdmissionStats() {
+    auto stats = admission_->stats();
+    stats["accept_shed"] = accept_shed_.load();
+    
+    return {
+        {"status", "success"},
+        {"msg", "Admission statistics"},
+        {"data", stats},
+        {"index", "ok"},
+        {"warnings", nlohmann::json::array()}
+    };
+}
+
+nlohmann::json HttpServer::handleDatabaseStats() {
+    auto stats = db_manager_->getStats();
+    stats["write_behind"] = write_queue_->stats();
+    
+    return {
+        {"status", "success"},
+        {"msg", "Database statistics"},
+        {"data", stats},
+        {"index", "ok"},
+        {"warnings", nlohmann::json::array()}
+    };
+}
+
+nlohmann::json HttpServer::handleQueryStats(const std::string& query, int& status) {
+    static constexpr size_t MAX_LIMIT = 1000;
+    auto params = parseQueryString(query);
+    std::string sort = params.count("sort") ? params["sort"] : "total_ms";
+    size_t limit = 50;
+    if (params.count("limit")) {
+        const std::string& text = params["limit"];
+        unsigned long long parsed = 0;
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (text.empty() || ec != std::errc() || end != text.data() + text.size()) {
+            status = 400;
+            return {
+                {"status", "error"},
+                {"msg", "limit must be a positive number of fingerprints"},
+                {"data", nullptr},
+                {"index", "ok"},
+                {"warnings", nlohmann::json::array()}
+            };
+        }
+        limit = static_cast<size_t>(std::clamp<unsigned long long>(parsed, 1, MAX_LIMIT));
+    }
+    
+    return {
+        {"status", "success"},
+        {"msg", "Query statistics"},
+        {"data", QueryStats::instance().snapshot(sort, limit)},
+        {"index", "ok"},
+        {"warnings", nlohmann::json::array()}
+    };
+}
+
+nlohmann::json HttpServer::handleQueryStatsReset() {
+    QueryStats::instance().reset();
+    
+    return {
+        {"status", "success"},
+        {"msg", "Query statistics reset"},
+        {"data", nullptr},
+        {"index", "ok"},
+        {"warnings", nlohmann::json::array()}
+    };
+}
+
+nlohmann::json HttpServer::handleTrace(const std::string& trace_id, int& status) {
+    nlohmann::json trace;
+    if (!tracer_->find(trace_id, trace)) {
+        status = 404;
+        return {
+            {"status", "error"},
+            {"msg", "Trace not found (not traced, or no longer buffered)"},
+            {"data", nullptr},
+            {"index", "ok"},
+            {"warnings", nlohmann::json::array()}
+        };
+    }
+    
+    return {
+        {"status", "success"},
+        {"msg", "Request trace"},
+        {"data", trace},
+        {"index", "ok"},
+        {"warnings", nlohmann::json::array()}
+    };
+}
+
+nlohmann::json HttpServer::handleExportJSON(const std::string& filename, const std::string& docnum,
+                                            RowSet& rows) {
     auto result = db_manager_->exportJSON(filename, docnum);
+    rows = std::move(result.rows);
     
+    TraceSpan span("json.build");
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", result.warnings}
     };
 }
 
+nlohmann::json HttpServer::handleExportPart(const std::string& filename, const ExportPart& part, RowSet& rows) {
+    auto result = table_export_->readPart(filename, part);
+    rows = std::move(result.rows);
+    
+    TraceSpan span("json.build");
+    return {
+        {"status", result.success ? "success" : "error"},
+        {"msg", result.message},
+        {"index", "ok"},
+        {"part", part.index},
+        {"parts", part.count},
+        {"records", part.records.value_or(0)},
+        {"warnings", result.warnings}
+    };
+}
+
+bool HttpServer::pinExportPart(const std::string& filename, ExportPart& part,
+                               http::response<http::string_body>& res, BodyFormat format) {
+    // A whole-table export reads whatever the table holds as it goes
+    if (part.count == 1 && !part.records) {
+        return true;
+    }
+    
+    uint32_t count = 0;
+    try {
+        count = table_export_->recordCount(filename);
+    } catch (const std::exception& e) {
+        sendError(res, 500, std::string("Error: ") + e.what(), format);
+        return false;
+    }
+    
+    // Parts split over different counts would overlap or leave gaps
+    if (part.records && *part.records != count) {
+        sendError(res, 412, "Table has changed since the export was split: " + 
+                  std::to_string(*part.records) + " records then, " + std::to_string(count) + 
+                  " now; start the export again", format);
+        return false;
+    }
+    part.records = count;
+    return true;
+}
+
 nlohmann::json HttpServer::handleExportCSV(const std::string& filename, const std::string& docnum) {
     auto result = db_manager_->exportCSV(filename, docnum);
     
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", "ok"},
         {"warnings", result.warnings}
     };
 }
 
-nlohmann::json HttpServer::handleSearch(const std::string& filename, const std::string& queryParams) {
+nlohmann::json HttpServer::handleSearch(const std::string& filename, const std::string& queryParams,
+                                        RowSet& rows) {
     auto params = parseQueryString(queryParams);
     int limit = 100;
     
@@ -295,80 +1611,70 @@ nlohmann::json HttpServer::handleSearch(const std::string& filename, const std::
     }
     
     auto result = db_manager_->search(filename, params, limit);
+    rows = std::move(result.rows);
     
+    TraceSpan span("json.build");
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
         {"index", "ok"},
         {"warnings", result.warnings}
     };
 }
 
-std::string HttpServer::handleViewHTML(const std::string& filename) {
-    auto result = db_manager_->getAllRecords(filename, 500);
-    
-    std::ostringstream html;
-    html << "<!DOCTYPE html>\n<html>\n<head>\n"
-         << "<meta charset='UTF-8'>\n"
-         << "<title>" << filename << "</title>\n"
-         << "<style>\n"
-         << "body { font-family: Arial, sans-serif; margin: 20px; }\n"
-         << "table { border-collapse: collapse; width: 100%; }\n"
-         << "th, td { border: 1px solid #ddd; padding: 8px; text-align: left; }\n"
-         << "th { background-color: #4CAF50; color: white; }\n"
-         << "tr:nth-child(even) { background-color: #f2f2f2; }\n"
-         << "</style>\n</head>\n<body>\n";
-    
-    if (result.success && result.data.is_array() && !result.data.empty()) {
-        html << "<h1>" << filename << " - " << result.data.size() << " records</h1>\n";
-        html << "<table>\n<tr>";
-        
-        // Header row
-        for (auto& [key, value] : result.data[0].items()) {
-            html << "<th>" << key << "</th>";
-        }
-        html << "</tr>\n";
-        
-        // Data rows
-        for (auto& record : result.data) {
-            html << "<tr>";
-            for (auto& [key, value] : record.items()) {
-                html << "<td>";
-                if (value.is_string()) {
-                    html << value.get<std::string>();
-                } else if (value.is_null()) {
-                    html << "";
-                } else {
-                    html << value.dump();
-                }
-                html << "</td>";
-            }
-            html << "</tr>\n";
-        }
-        
-        html << "</table>\n";
-    } else {
-        html << "<h1>Error</h1>\n";
-        html << "<p>" << result.message << "</p>\n";
-    }
-    
-    html << "</body>\n</html>";
-    return html.str();
-}
-
-nlohmann::json HttpServer::handleFindDocnum(const std::string& docnum) {
-    auto result = db_manager_->findByDocnum(docnum);
+nlohmann::json HttpServer::handleFindDocnum(const std::string& docnum, bool first_only) {
+    auto result = db_manager_->findByDocnum(docnum, first_only, 
+                                            std::chrono::seconds(config_.connection_timeout));
     nlohmann::json json_result = {
         {"status", result.success ? "success" : "error"},
-        {"data", result.data}
+        {"data", std::move(result.data)}
     };
     if (!result.message.empty()) {
         json_result["message"] = result.message;
     }
+    if (!result.warnings.empty()) {
+        json_result["warnings"] = result.warnings;
+    }
     return json_result;
 }
 
+nlohmann::json HttpServer::handleFindDocnumBatch(const nlohmann::json& body) {
+    if (!body.contains("docnums") || !body["docnums"].is_array()) {
+        return {
+            {"status", "error"},
+            {"msg", "Missing 'docnums' array in request body"},
+            {"data", nullptr},
+            {"index", "ok"},
+            {"warnings", nlohmann::json::array()}
+        };
+    }
+    
+    std::vector<std::string> docnums;
+    docnums.reserve(body["docnums"].size());
+    for (const auto& docnum : body["docnums"]) {
+        if (!docnum.is_string()) {
+            return {
+                {"status", "error"},
+                {"msg", "'docnums' must contain only strings"},
+                {"data", nullptr},
+                {"index", "ok"},
+                {"warnings", nlohmann::json::array()}
+            };
+        }
+        docnums.push_back(docnum.get<std::string>());
+    }
+    
+    auto result = db_manager_->findByDocnums(docnums);
+    
+    return {
+        {"status", result.success ? "success" : "error"},
+        {"msg", result.message},
+        {"data", std::move(result.data)},
+        {"index", "ok"},
+        {"warnings", result.warnings}
+    };
+}
+
 void HttpServer::sendCSVResponse(http::response<http::string_body>& res, const std::string& csv,
                                 const std::string& filename) {
     res.result(200);
@@ -378,15 +1684,15 @@ void HttpServer::sendCSVResponse(http::response<http::string_body>& res, const s
     res.prepare_payload();
 }
 
-void HttpServer::sendHTMLResponse(http::response<http::string_body>& res, const std::string& html) {
+void HttpServer::sendMetricsResponse(http::response<http::string_body>& res, const std::string& text) {
     res.result(200);
-    res.set(http::field::content_type, "text/html; charset=utf-8");
-    res.body() = html;
+    res.set(http::field::content_type, "text/plain; version=0.0.4; charset=utf-8");
+    res.body() = text;
     res.prepare_payload();
 }
 
 void HttpServer::sendError(http::response<http::string_body>& res, int status, 
-                          const std::string& message) {
+                          const std::string& message, BodyFormat format) {
     nlohmann::json error_json = {
         {"status", "error"},
         {"msg", message},
@@ -394,7 +1700,7 @@ void HttpServer::sendError(http::response<http::string_body>& res, int status,
         {"index", "ok"},
         {"warnings", nlohmann::json::array()}
     };
-    sendJsonResponse(res, status, error_json);
+    sendJsonResponse(res, status, error_json, format);
 }
 
 std::string HttpServer::extractFilename(const std::string& path) {
@@ -446,7 +1752,7 @@ std::map<std::string, std::string> HttpServer::parseQueryString(const std::strin
 }
 
 nlohmann::json HttpServer::handleDirectLookup(const std::string& docnum) {
-    return handleFindDocnum(docnum);
+    return handleFindDocnum(docnum, true);
 }
 
 nlohmann::json HttpServer::handleAdd(const std::string& filename, const nlohmann::json& body) {
@@ -455,7 +1761,7 @@ nlohmann::json HttpServer::handleAdd(const std::string& filename, const nlohmann
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", result.warnings}
@@ -478,7 +1784,7 @@ nlohmann::json HttpServer::handleUpdate(const std::string& filename, const nlohm
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", result.warnings}
@@ -501,7 +1807,7 @@ nlohmann::json HttpServer::handleDelete(const std::string& filename, const nlohm
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", result.warnings}
@@ -524,7 +1830,7 @@ nlohmann::json HttpServer::handleUndelete(const std::string& filename, const nlo
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", "ok"},
         {"warnings", result.warnings}
     };
@@ -536,20 +1842,87 @@ nlohmann::json HttpServer::handlePack(const std::string& filename) {
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", result.warnings}
     };
 }
 
+bool HttpServer::useAsyncWrites(const std::string& query) {
+    auto params = parseQueryString(query);
+    auto it = params.find("async");
+    if (it != params.end()) {
+        return it->second == "1" || it->second == "true";
+    }
+    return config_.write_mode == "async";
+}
+
+void HttpServer::enqueueWrite(http::response<http::string_body>& res, const std::string& filename,
+                              WriteOperation operation, BodyFormat format) {
+    std::string safe_filename = sanitizeFilename(filename);
+    
+    bool needs_where = operation.type != WriteOperation::Type::ADD;
+    if ((operation.type == WriteOperation::Type::ADD && !operation.record.is_object()) ||
+        (needs_where && !operation.where.is_object()) ||
+        (operation.type == WriteOperation::Type::UPDATE && !operation.updates.is_object())) {
+        sendError(res, 400, operation.type == WriteOperation::Type::UPDATE ?
+                  "Missing 'where' or 'update' in request body" :
+                  operation.type == WriteOperation::Type::ADD ?
+                  "Request body must be a JSON object" :
+                  "Missing 'where' clause in request body", format);
+        return;
+    }
+    
+    std::string job_id = write_queue_->enqueue(safe_filename, std::move(operation));
+    if (job_id.empty()) {
+        res.set(http::field::retry_after, "2");
+        sendError(res, 503, "Write queue full, retry later", format);
+        return;
+    }
+    
+    sendJsonResponse(res, 202, {
+        {"status", "success"},
+        {"msg", "Write accepted"},
+        {"data", {
+            {"job_id", job_id},
+            {"status_url", "/api/dbf/jobs/" + job_id}
+        }},
+        {"index", "pending"},
+        {"warnings", nlohmann::json::array()}
+    }, format);
+}
+
+nlohmann::json HttpServer::handleJobStatus(const std::string& job_id, int& status) {
+    nlohmann::json job;
+    if (!write_queue_->getStatus(job_id, job)) {
+        status = 404;
+        return {
+            {"status", "error"},
+            {"msg", "Unknown job: " + job_id},
+            {"data", nullptr},
+            {"index", "ok"},
+            {"warnings", nlohmann::json::array()}
+        };
+    }
+    
+    std::string state = job["state"];
+    return {
+        {"status", state == "failed" ? "error" : "success"},
+        {"msg", job["message"]},
+        {"data", job},
+        {"index", state == "succeeded" ? "ok" : "pending"},
+        {"warnings", nlohmann::json::array()}
+    };
+}
+
 nlohmann::json HttpServer::handleReindex(const std::string& filename) {
     auto result = db_manager_->reindex(filename);
     
     return {
         {"status", result.success ? "success" : "error"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", result.warnings}
@@ -562,7 +1935,7 @@ nlohmann::json HttpServer::handleIndexStatus(const std::string& filename) {
     return {
         {"status", "success"},
         {"msg", result.message},
-        {"data", result.data},
+        {"data", std::move(result.data)},
         {"index", result.index_status == IndexStatus::OK ? "ok" : 
                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"},
         {"warnings", nlohmann::json::array()}
@@ -570,10 +1943,97 @@ nlohmann::json HttpServer::handleIndexStatus(const std::string& filename) {
 }
 
 void HttpServer::sendJsonResponse(http::response<http::string_body>& res, int status, 
-                                  const nlohmann::json& json) {
+                                  const nlohmann::json& json, BodyFormat format) {
     res.result(status);
-    res.set(http::field::content_type, "application/json");
-    res.body() = json.dump(2);
+    res.set(http::field::content_type, contentType(format));
+    res.set(http::field::vary, "Accept");
+    TraceSpan span("json.dump");
+    if (format == BodyFormat::JSON) {
+        res.body() = json.dump(2);
+    } else {
+        res.body().clear();
+        appendBinaryJson(res.body(), format, json);
+    }
+    res.prepare_payload();
+}
+
+void HttpServer::sendJsonResponse(http::response<http::string_body>& res, int status,
+                                  const nlohmann::json& envelope, const RowSet& rows,
+                                  BodyFormat format) {
+    res.result(status);
+    res.set(http::field::content_type, contentType(format));
+    res.set(http::field::vary, "Accept");
+    TraceSpan span("json.dump");
+    
+    // MessagePack / CBOR: the envelope's members in nlohmann::json order
+    // with "data" encoded straight from the rows
+    if (format != BodyFormat::JSON) {
+        std::string& body = res.body();
+        body.clear();
+        appendBinaryMap(body, format, envelope.size() + 1);
+        bool data_written = false;
+        auto data = [&] {
+            appendBinaryString(body, format, "data");
+            if (rows.columnCount() == 0) {
+                appendBinaryNull(body, format);
+            } else {
+                rows.writeBinary(body, format);
+            }
+            data_written = true;
+        };
+        for (auto& [key, value] : envelope.items()) {
+            if (!data_written && key > "data") {
+                data();
+            }
+            appendBinaryString(body, format, key);
+            appendBinaryJson(body, format, value);
+        }
+        if (!data_written) {
+            data();
+        }
+        res.prepare_payload();
+        return;
+    }
+    
+    // Laid out as envelope.dump(2) would with the rows under "data", but the
+    // rows go straight from the RowSet into the body
+    std::string& body = res.body();
+    body.clear();
+    body += "{\n";
+    bool first = true;
+    auto member = [&](const std::string& key) {
+        body += first ? "  " : ",\n  ";
+        first = false;
+        appendJsonString(body, key);
+        body += ": ";
+    };
+    // Failed reads have no columns and report null, as before
+    auto data = [&] {
+        member("data");
+        if (rows.columnCount() == 0) {
+            body += "null";
+        } else {
+            rows.writeJson(body, 2, 1);
+        }
+    };
+    bool data_written = false;
+    for (auto& [key, value] : envelope.items()) {
+        if (!data_written && key > "data") {
+            data();
+            data_written = true;
+        }
+        member(key);
+        for (char c : value.dump(2)) {
+            body += c;
+            if (c == '\n') {
+                body += "  ";
+            }
+        }
+    }
+    if (!data_written) {
+        data();
+    }
+    body += "\n}";
     res.prepare_payload();
 }
 
@@ -4,7 +4,7 @@
 
 namespace FoxBridge {
 
-IndexMaintenance::IndexMaintenance(std::shared_ptr<DatabaseManager> db_manager,
+IndexMaintenance::IndexMaintenance(std::shared_ptr<StorageBackend> db_manager,
                                    const std::string& maintenance_window)
     : db_manager_(db_manager)
     , maintenance_window_(maintenance_window)
@@ -40,6 +40,11 @@ void IndexMaintenance::stop() {
     spdlog::info("Index maintenance worker stopped");
 }
 
+size_t IndexMaintenance::queueDepth() {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return task_queue_.size();
+}
+
 void IndexMaintenance::queueReindex(const std::string& table) {
     std::lock_guard<std::mutex> lock(queue_mutex_);
     
@@ -0,0 +1,102 @@
+#include "MemoFile.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace FoxBridge {
+
+// Largest memo accepted; anything bigger is a damaged pointer or block header
+static constexpr uint32_t MEMO_MAX_LENGTH = 1024u * 1024 * 1024;
+
+static uint32_t be32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+static bool seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+std::filesystem::path MemoFile::pathFor(const std::filesystem::path& table_path) {
+    // Same base name; .fpt or .FPT depending on who created the table
+    std::filesystem::path memo_path = table_path;
+    std::error_code ec;
+    for (const char* extension : {".fpt", ".FPT"}) {
+        memo_path.replace_extension(extension);
+        if (std::filesystem::exists(memo_path, ec)) {
+            return memo_path;
+        }
+    }
+    return {};
+}
+
+MemoFile::MemoFile(const std::filesystem::path& path)
+    : path_(path) {
+    file_ = std::fopen(path.string().c_str(), "rb");
+    if (!file_) {
+        throw std::runtime_error("Cannot open memo file: " + path.filename().string());
+    }
+    
+    unsigned char header[8];
+    if (std::fread(header, 1, sizeof(header), file_) != sizeof(header)) {
+        std::fclose(file_);
+        throw std::runtime_error("Truncated memo header: " + path.filename().string());
+    }
+    block_size_ = (static_cast<uint32_t>(header[6]) << 8) | header[7];
+    if (block_size_ == 0) {
+        block_size_ = 512;      // FoxPro 2.x default
+    }
+    
+    std::error_code ec;
+    file_size_ = std::filesystem::file_size(path, ec);
+}
+
+MemoFile::~MemoFile() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool MemoFile::locate(uint32_t block, MemoBlock& memo) {
+    uint64_t position = static_cast<uint64_t>(block) * block_size_;
+    if (block == 0 || position + 8 > file_size_) {
+        return false;
+    }
+    
+    unsigned char header[8];
+    if (!seekTo(file_, position) || std::fread(header, 1, sizeof(header), file_) != sizeof(header)) {
+        return false;
+    }
+    memo.type = be32(header);
+    memo.offset = position + 8;
+    memo.length = be32(header + 4);
+    
+    // Clamp to the file; ExpressD may still be appending to it
+    if (memo.length > MEMO_MAX_LENGTH) {
+        return false;
+    }
+    memo.length = static_cast<uint32_t>(std::min<uint64_t>(memo.length, file_size_ - memo.offset));
+    return true;
+}
+
+size_t MemoFile::read(const MemoBlock& memo, uint64_t offset, char* buffer, size_t size) {
+    if (offset >= memo.length) {
+        return 0;
+    }
+    size = static_cast<size_t>(std::min<uint64_t>(size, memo.length - offset));
+    if (!seekTo(file_, memo.offset + offset)) {
+        return 0;
+    }
+    return std::fread(buffer, 1, size, file_);
+}
+
+std::string MemoFile::readAll(const MemoBlock& memo) {
+    std::string text(memo.length, '\0');
+    text.resize(read(memo, 0, text.data(), text.size()));
+    return text;
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,250 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+namespace FoxBridge {
+
+// Single-writer increment: only the owning thread touches a shard, so a
+// relaxed load/store pair is enough and avoids a locked read-modify-write
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static std::string formatDouble(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    return buffer;
+}
+
+static std::string formatSeconds(uint64_t micros) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6f", micros / 1e6);
+    return buffer;
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::Histogram::observe(std::chrono::microseconds elapsed) {
+    double seconds = elapsed.count() / 1e6;
+    size_t bucket = std::lower_bound(LATENCY_BUCKETS.begin(), LATENCY_BUCKETS.end(), seconds) -
+                    LATENCY_BUCKETS.begin();
+    
+    bump(buckets[bucket]);
+    bump(count);
+    bump(sum_us, elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0);
+}
+
+Metrics::Shard& Metrics::localShard() {
+    thread_local Shard* shard = nullptr;
+    
+    if (!shard) {
+        auto created = std::make_unique<Shard>();
+        shard = created.get();
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        shards_.push_back(std::move(created));
+    }
+    return *shard;
+}
+
+void Metrics::recordRequest(RouteId route, int status, std::chrono::microseconds latency,
+                            size_t response_bytes) {
+    Shard& shard = localShard();
+    size_t index = static_cast<size_t>(route);
+    size_t status_class = std::clamp(status / 100, 1, static_cast<int>(STATUS_CLASSES)) - 1;
+    
+    bump(shard.requests[index][status_class]);
+    bump(shard.response_bytes[index], response_bytes);
+    shard.request_latency[index].observe(latency);
+}
+
+void Metrics::recordRequestMemory(RouteId route, uint64_t heap_allocations, uint64_t arena_bytes) {
+    Shard& shard = localShard();
+    size_t index = static_cast<size_t>(route);
+    bump(shard.heap_allocations[index], heap_allocations);
+    bump(shard.arena_bytes[index], arena_bytes);
+}
+
+void Metrics::recordOdbcExecute(std::chrono::microseconds elapsed) {
+    localShard().odbc_execute.observe(elapsed);
+}
+
+void Metrics::recordOdbcFetch(std::chrono::microseconds elapsed, size_t rows, size_t bytes) {
+    Shard& shard = localShard();
+    shard.odbc_fetch.observe(elapsed);
+    bump(shard.rows_fetched, rows);
+    bump(shard.bytes_fetched, bytes);
+}
+
+void Metrics::registerCallback(const std::string& name, const std::string& help,
+                               CallbackType type, Callback callback) {
+    std::lock_guard<std::mutex> lock(callbacks_mutex_);
+    
+    for (auto& entry : callbacks_) {
+        if (entry.name == name) {
+            entry = {name, help, type, std::move(callback)};
+            return;
+        }
+    }
+    callbacks_.push_back({name, help, type, std::move(callback)});
+}
+
+void Metrics::unregisterCallback(const std::string& name) {
+    std::lock_guard<std::mutex> lock(callbacks_mutex_);
+    callbacks_.erase(std::remove_if(callbacks_.begin(), callbacks_.end(),
+                                    [&name](const CallbackEntry& entry) {
+                                        return entry.name == name;
+                                    }),
+                     callbacks_.end());
+}
+
+std::string Metrics::renderPrometheus() {
+    // Plain snapshot of a histogram summed across shards
+    struct HistogramTotals {
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+        uint64_t count = 0;
+        uint64_t sum_us = 0;
+        
+        void add(const Histogram& histogram) {
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+            }
+            count += histogram.count.load(std::memory_order_relaxed);
+            sum_us += histogram.sum_us.load(std::memory_order_relaxed);
+        }
+    };
+    
+    std::array<std::array<uint64_t, STATUS_CLASSES>, Router::ROUTE_COUNT> requests{};
+    std::array<uint64_t, Router::ROUTE_COUNT> response_bytes{};
+    std::array<uint64_t, Router::ROUTE_COUNT> heap_allocations{};
+    std::array<uint64_t, Router::ROUTE_COUNT> arena_bytes{};
+    std::array<HistogramTotals, Router::ROUTE_COUNT> request_latency;
+    HistogramTotals odbc_execute;
+    HistogramTotals odbc_fetch;
+    uint64_t rows_fetched = 0;
+    uint64_t bytes_fetched = 0;
+    
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        for (const auto& shard : shards_) {
+            for (size_t route = 0; route < Router::ROUTE_COUNT; ++route) {
+                for (size_t code = 0; code < STATUS_CLASSES; ++code) {
+                    requests[route][code] += shard->requests[route][code].load(std::memory_order_relaxed);
+                }
+                response_bytes[route] += shard->response_bytes[route].load(std::memory_order_relaxed);
+                heap_allocations[route] += shard->heap_allocations[route].load(std::memory_order_relaxed);
+                arena_bytes[route] += shard->arena_bytes[route].load(std::memory_order_relaxed);
+                request_latency[route].add(shard->request_latency[route]);
+            }
+            odbc_execute.add(shard->odbc_execute);
+            odbc_fetch.add(shard->odbc_fetch);
+            rows_fetched += shard->rows_fetched.load(std::memory_order_relaxed);
+            bytes_fetched += shard->bytes_fetched.load(std::memory_order_relaxed);
+        }
+    }
+    
+    std::ostringstream out;
+    
+    auto header = [&out](const char* name, const char* help, const char* type) {
+        out << "# HELP " << name << " " << help << "\n";
+        out << "# TYPE " << name << " " << type << "\n";
+    };
+    
+    // Buckets are stored per-interval; Prometheus wants them cumulative
+    auto histogram = [&out](const char* name, const std::string& labels, const HistogramTotals& totals) {
+        std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            cumulative += totals.buckets[i];
+            std::string le = i < LATENCY_BUCKETS.size() ? formatDouble(LATENCY_BUCKETS[i]) : "+Inf";
+            out << name << "_bucket" << prefix << "le=\"" << le << "\"} " << cumulative << "\n";
+        }
+        std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+        out << name << "_sum" << suffix << " " << formatSeconds(totals.sum_us) << "\n";
+        out << name << "_count" << suffix << " " << totals.count << "\n";
+    };
+    
+    // Routes that have never been hit are left out rather than exported as zeros
+    header("foxbridge_http_requests_total", "HTTP requests by route and status class", "counter");
+    for (size_t route = 0; route < Router::ROUTE_COUNT; ++route) {
+        for (size_t code = 0; code < STATUS_CLASSES; ++code) {
+            if (requests[route][code] == 0) {
+                continue;
+            }
+            out << "foxbridge_http_requests_total{route=\"" << Router::routeName(static_cast<RouteId>(route))
+                << "\",code=\"" << (code + 1) << "xx\"} " << requests[route][code] << "\n";
+        }
+    }
+    
+    header("foxbridge_http_request_duration_seconds",
+           "Time from request read to response written", "histogram");
+    for (size_t route = 0; route < Router::ROUTE_COUNT; ++route) {
+        if (request_latency[route].count == 0) {
+            continue;
+        }
+        histogram("foxbridge_http_request_duration_seconds",
+                  std::string("route=\"") + Router::routeName(static_cast<RouteId>(route)) + "\"",
+                  request_latency[route]);
+    }
+    
+    header("foxbridge_http_response_bytes_total", "Response bytes written by route", "counter");
+    for (size_t route = 0; route < Router::ROUTE_COUNT; ++route) {
+        if (request_latency[route].count == 0) {
+            continue;
+        }
+        out << "foxbridge_http_response_bytes_total{route=\""
+            << Router::routeName(static_cast<RouteId>(route)) << "\"} " << response_bytes[route] << "\n";
+    }
+    
+    // Divide by foxbridge_http_requests_total for a per-request figure
+    header("foxbridge_http_request_heap_allocations_total",
+           "Heap allocations on the request thread by route (allocation-counting builds only)", "counter");
+    for (size_t route = 0; route < Router::ROUTE_COUNT; ++route) {
+        if (request_latency[route].count == 0) {
+            continue;
+        }
+        out << "foxbridge_http_request_heap_allocations_total{route=\""
+            << Router::routeName(static_cast<RouteId>(route)) << "\"} " << heap_allocations[route] << "\n";
+    }
+    
+    header("foxbridge_http_request_arena_bytes_total", "Request arena bytes used by route", "counter");
+    for (size_t route = 0; route < Router::ROUTE_COUNT; ++route) {
+        if (request_latency[route].count == 0) {
+            continue;
+        }
+        out << "foxbridge_http_request_arena_bytes_total{route=\""
+            << Router::routeName(static_cast<RouteId>(route)) << "\"} " << arena_bytes[route] << "\n";
+    }
+    
+    header("foxbridge_odbc_execute_seconds", "Time spent in SQLExecDirect", "histogram");
+    histogram("foxbridge_odbc_execute_seconds", "", odbc_execute);
+    
+    header("foxbridge_odbc_fetch_seconds", "Time spent fetching and converting result rows", "histogram");
+    histogram("foxbridge_odbc_fetch_seconds", "", odbc_fetch);
+    
+    header("foxbridge_odbc_rows_fetched_total", "Result rows fetched from ODBC", "counter");
+    out << "foxbridge_odbc_rows_fetched_total " << rows_fetched << "\n";
+    
+    header("foxbridge_odbc_bytes_fetched_total", "Column data bytes fetched from ODBC", "counter");
+    out << "foxbridge_odbc_bytes_fetched_total " << bytes_fetched << "\n";
+    
+    // Evaluate callbacks outside the lock; they take their owners' locks
+    std::vector<CallbackEntry> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        callbacks = callbacks_;
+    }
+    
+    for (const auto& entry : callbacks) {
+        header(entry.name.c_str(), entry.help.c_str(),
+               entry.type == CallbackType::COUNTER ? "counter" : "gauge");
+        out << entry.name << " " << formatDouble(entry.callback()) << "\n";
+    }
+    
+    return out.str();
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,167 @@
+#include "Platform.h"
+#include <spdlog/spdlog.h>
+#include <csignal>
+#include <thread>
+#include <chrono>
+#include <climits>
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+namespace FoxBridge {
+namespace Platform {
+
+static volatile std::sig_atomic_t g_shutdown_requested = 0;
+
+static void shutdownSignalHandler(int) {
+    g_shutdown_requested = 1;
+}
+
+std::vector<std::string> configSearchPaths() {
+    return {
+        "./config.json",                    // Current directory
+        "/etc/foxbridge/config.json",       // System config
+        "./config/config.json"              // Config folder
+    };
+}
+
+std::string executablePath() {
+    char exe_path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", exe_path, sizeof(exe_path) - 1);
+    return length > 0 ? std::string(exe_path, static_cast<size_t>(length)) : std::string();
+}
+
+void waitForShutdown() {
+    struct sigaction action {};
+    action.sa_handler = shutdownSignalHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    
+    while (!g_shutdown_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+// systemd supervises the agent here: run it in the foreground with
+// Type=simple and it stops on SIGTERM through waitForShutdown
+static bool serviceUnsupported(const char* command) {
+    spdlog::error("{} is only supported on Windows; run the agent under systemd instead", command);
+    return false;
+}
+
+bool runService(const std::string&, std::function<void()>, std::function<void()>) {
+    return serviceUnsupported("--service");
+}
+
+bool installService(const std::string&, const std::string&, const std::string&) {
+    return serviceUnsupported("--install");
+}
+
+bool uninstallService(const std::string&) {
+    return serviceUnsupported("--uninstall");
+}
+
+bool startService(const std::string&) {
+    return serviceUnsupported("--start");
+}
+
+bool stopService(const std::string&) {
+    return serviceUnsupported("--stop");
+}
+
+FileSender::FileSender(const std::string& path) {
+    handle_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+FileSender::~FileSender() {
+    if (handle_ != -1) {
+        ::close(static_cast<int>(handle_));
+    }
+}
+
+// Waits until a socket that returned EAGAIN can take more
+static bool waitWritable(int socket) {
+    pollfd entry{socket, POLLOUT, 0};
+    int ready;
+    do {
+        ready = ::poll(&entry, 1, 30000);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0 && !(entry.revents & (POLLERR | POLLHUP));
+}
+
+bool FileSender::send(SocketHandle socket, uint64_t offset, uint64_t length, uint64_t& sent) {
+    sent = 0;
+    if (handle_ == -1) {
+        return false;
+    }
+    int fd = static_cast<int>(handle_);
+    
+    // sendfile has no MSG_NOSIGNAL: hold SIGPIPE back on this thread and
+    // discard the one a vanished peer raises
+    sigset_t pipe_set;
+    sigset_t old_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+    
+    bool ok = true;
+    while (sent < length) {
+        size_t wanted = static_cast<size_t>(std::min<uint64_t>(length - sent, 1u << 30));
+#ifdef __linux__
+        off_t position = static_cast<off_t>(offset + sent);
+        ssize_t written = ::sendfile(socket, fd, &position, wanted);
+#else
+        char buffer[64 * 1024];
+        ssize_t written = ::pread(fd, buffer, std::min(wanted, sizeof(buffer)),
+                                  static_cast<off_t>(offset + sent));
+        if (written > 0) {
+            ssize_t read = written;
+            for (written = 0; written < read; ) {
+                ssize_t part = ::send(socket, buffer + written, static_cast<size_t>(read - written), 0);
+                if (part < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (part < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(socket)) {
+                    continue;
+                }
+                if (part <= 0) {
+                    written = -1;
+                    break;
+                }
+                written += part;
+            }
+        }
+#endif
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(socket)) {
+            continue;
+        }
+        if (written <= 0) {
+            ok = false;     // Peer gone, or the file ended early
+            break;
+        }
+        sent += static_cast<uint64_t>(written);
+    }
+    
+    sigset_t pending;
+    sigpending(&pending);
+    if (sigismember(&pending, SIGPIPE)) {
+        timespec no_wait{0, 0};
+        sigtimedwait(&pipe_set, nullptr, &no_wait);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
+    return ok;
+}
+
+} // namespace Platform
+} // namespace FoxBridge
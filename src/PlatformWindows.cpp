@@ -0,0 +1,105 @@
+#include "Platform.h"
+#include <winsock2.h>
+#include <mswsock.h>
+#include "WindowsService.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+namespace FoxBridge {
+namespace Platform {
+
+static std::atomic<bool> g_shutdown_requested{false};
+
+static BOOL WINAPI consoleCtrlHandler(DWORD ctrl_type) {
+    if (ctrl_type == CTRL_C_EVENT || ctrl_type == CTRL_BREAK_EVENT || ctrl_type == CTRL_CLOSE_EVENT) {
+        g_shutdown_requested = true;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+std::vector<std::string> configSearchPaths() {
+    return {
+        ".\\config.json",                                    // Current directory
+        "C:\\ProgramData\\FoxBridgeAgent\\config.json",     // Program Data
+        ".\\config\\config.json"                            // Config folder
+    };
+}
+
+std::string executablePath() {
+    char exe_path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(nullptr, exe_path, MAX_PATH);
+    return std::string(exe_path, length);
+}
+
+void waitForShutdown() {
+    SetConsoleCtrlHandler(consoleCtrlHandler, TRUE);
+    while (!g_shutdown_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+bool runService(const std::string& service_name,
+                std::function<void()> start_callback,
+                std::function<void()> stop_callback) {
+    WindowsService service(service_name, start_callback, stop_callback);
+    service.run();
+    return true;
+}
+
+bool installService(const std::string& service_name,
+                    const std::string& display_name,
+                    const std::string& command_line) {
+    return WindowsService::install(service_name, display_name, command_line);
+}
+
+bool uninstallService(const std::string& service_name) {
+    return WindowsService::uninstall(service_name);
+}
+
+bool startService(const std::string& service_name) {
+    return WindowsService::start(service_name);
+}
+
+bool stopService(const std::string& service_name) {
+    return WindowsService::stop(service_name);
+}
+
+FileSender::FileSender(const std::string& path) {
+    // FILE_SHARE_DELETE lets the snapshot cache replace the file meanwhile
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    handle_ = file == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<intptr_t>(file);
+}
+
+FileSender::~FileSender() {
+    if (handle_ != -1) {
+        CloseHandle(reinterpret_cast<HANDLE>(handle_));
+    }
+}
+
+bool FileSender::send(SocketHandle socket, uint64_t offset, uint64_t length, uint64_t& sent) {
+    sent = 0;
+    if (handle_ == -1) {
+        return false;
+    }
+    HANDLE file = reinterpret_cast<HANDLE>(handle_);
+    
+    // TransmitFile sends from the file pointer, at most 2GB - 1 per call
+    while (sent < length) {
+        DWORD wanted = static_cast<DWORD>(std::min<uint64_t>(length - sent, 1u << 30));
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(offset + sent);
+        if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) ||
+            !TransmitFile(static_cast<SOCKET>(socket), file, wanted, 0, nullptr, nullptr, 0)) {
+            return false;
+        }
+        sent += wanted;
+    }
+    return true;
+}
+
+} // namespace Platform
+} // namespace FoxBridge
@@ -0,0 +1,244 @@
+#include "QueryStats.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <vector>
+#include <cctype>
+
+namespace FoxBridge {
+
+// Bucket for statements once a shard holds max_fingerprints_per_shard_ entries
+static const std::string OVERFLOW_FINGERPRINT = "<other>";
+
+QueryStats& QueryStats::instance() {
+    static QueryStats stats;
+    return stats;
+}
+
+void QueryStats::configure(std::chrono::milliseconds slow_threshold,
+                           std::shared_ptr<spdlog::logger> slow_log,
+                           size_t max_fingerprints) {
+    slow_threshold_ = slow_threshold;
+    slow_log_ = std::move(slow_log);
+    max_fingerprints_per_shard_ = std::max<size_t>(1, max_fingerprints / SHARD_COUNT);
+}
+
+std::string QueryStats::fingerprint(const std::string& sql) {
+    std::string out;
+    out.reserve(sql.size());
+    
+    auto is_word = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
+    
+    size_t i = 0;
+    while (i < sql.size()) {
+        char c = sql[i];
+        
+        // 'text', "text" and {^2024-01-31} date literals; '' escapes a quote
+        if (c == '\'' || c == '"' || c == '{') {
+            char close = (c == '{') ? '}' : c;
+            ++i;
+            while (i < sql.size()) {
+                if (sql[i] == close) {
+                    if (close != '}' && i + 1 < sql.size() && sql[i + 1] == close) {
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                ++i;
+            }
+            out += '?';
+            continue;
+        }
+        
+        // Numbers that start a token (not the 2 in "invoice2")
+        if (std::isdigit(static_cast<unsigned char>(c)) && (out.empty() || !is_word(out.back()))) {
+            while (i < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[i])) || sql[i] == '.')) {
+                ++i;
+            }
+            out += '?';
+            continue;
+        }
+        
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!out.empty() && out.back() != ' ') {
+                out += ' ';
+            }
+            ++i;
+            continue;
+        }
+        
+        out += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        ++i;
+    }
+    
+    if (!out.empty() && out.back() == ' ') {
+        out.pop_back();
+    }
+    
+    // IN (?, ?, ?) -> IN (?+) so batches of different sizes share a fingerprint
+    size_t pos = 0;
+    while ((pos = out.find("IN (", pos)) != std::string::npos) {
+        size_t start = pos + 4;
+        size_t end = start;
+        while (end < out.size() && (out[end] == '?' || out[end] == ',' || out[end] == ' ')) {
+            ++end;
+        }
+        if (end < out.size() && out[end] == ')' && end > start) {
+            out.replace(start, end - start, "?+");
+        }
+        pos = start;
+    }
+    
+    return out;
+}
+
+size_t QueryStats::latencyBucket(uint64_t micros) {
+    if (micros < SUB_BUCKETS) {
+        return static_cast<size_t>(micros);
+    }
+    
+    size_t exponent = 0;
+    for (uint64_t v = micros; v > 1; v >>= 1) {
+        ++exponent;
+    }
+    size_t sub = static_cast<size_t>((micros >> (exponent - 2)) & (SUB_BUCKETS - 1));
+    return std::min(LATENCY_BUCKETS - 1, (exponent - 1) * SUB_BUCKETS + sub);
+}
+
+uint64_t QueryStats::bucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket + 1;
+    }
+    
+    size_t exponent = bucket / SUB_BUCKETS + 1;
+    size_t sub = bucket % SUB_BUCKETS;
+    return static_cast<uint64_t>(SUB_BUCKETS + sub + 1) << (exponent - 2);
+}
+
+double QueryStats::percentile(const Entry& entry, double fraction) {
+    if (entry.count == 0) {
+        return 0.0;
+    }
+    
+    uint64_t rank = static_cast<uint64_t>(fraction * entry.count + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, entry.count);
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+        seen += entry.latency[i];
+        if (seen >= rank) {
+            // Never report more than the slowest statement actually seen
+            return std::min(bucketUpperBound(i), entry.max_us) / 1000.0;
+        }
+    }
+    return entry.max_us / 1000.0;
+}
+
+void QueryStats::record(const std::string& sql, std::chrono::microseconds elapsed,
+                        bool success, size_t rows, size_t bytes,
+                        const std::string& origin, const std::string& route) {
+    std::string key = fingerprint(sql);
+    uint64_t micros = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+    bool slow = slow_threshold_.count() > 0 && elapsed >= slow_threshold_;
+    
+    {
+        Shard& shard = shards_[std::hash<std::string>()(key) % SHARD_COUNT];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            if (shard.entries.size() >= max_fingerprints_per_shard_) {
+                it = shard.entries.try_emplace(OVERFLOW_FINGERPRINT).first;
+            } else {
+                it = shard.entries.try_emplace(key).first;
+                it->second.sample_sql = sql;
+            }
+        }
+        
+        Entry& entry = it->second;
+        ++entry.count;
+        entry.errors += success ? 0 : 1;
+        entry.total_us += micros;
+        entry.max_us = std::max(entry.max_us, micros);
+        entry.rows += rows;
+        entry.bytes += bytes;
+        entry.slow += slow ? 1 : 0;
+        ++entry.latency[latencyBucket(micros)];
+        
+        const std::string& route_key = route.empty() ? "internal" : route;
+        auto route_it = entry.routes.find(route_key);
+        if (route_it != entry.routes.end()) {
+            ++route_it->second;
+        } else if (entry.routes.size() < MAX_ROUTES_PER_FINGERPRINT) {
+            entry.routes.emplace(route_key, 1);
+        } else {
+            ++entry.routes["other"];
+        }
+    }
+    
+    if (slow && slow_log_) {
+        slow_log_->info("{:.1f}ms {} rows={} bytes={} request=\"{}\" sql={}",
+                        micros / 1000.0, success ? "ok" : "failed", rows, bytes,
+                        origin.empty() ? "-" : origin, sql);
+    }
+}
+
+nlohmann::json QueryStats::snapshot(const std::string& sort_by, size_t limit) {
+    std::vector<nlohmann::json> queries;
+    uint64_t total_statements = 0;
+    
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [key, entry] : shard.entries) {
+            total_statements += entry.count;
+            queries.push_back({
+                {"fingerprint", key},
+                {"sample_sql", entry.sample_sql},
+                {"count", entry.count},
+                {"errors", entry.errors},
+                {"slow", entry.slow},
+                {"total_ms", entry.total_us / 1000.0},
+                {"avg_ms", entry.count ? entry.total_us / 1000.0 / entry.count : 0.0},
+                {"p50_ms", percentile(entry, 0.50)},
+                {"p99_ms", percentile(entry, 0.99)},
+                {"max_ms", entry.max_us / 1000.0},
+                {"rows", entry.rows},
+                {"bytes", entry.bytes},
+                {"routes", entry.routes}
+            });
+        }
+    }
+    
+    std::string key = sort_by;
+    if (key != "count" && key != "p99_ms" && key != "rows" && key != "bytes") {
+        key = "total_ms";
+    }
+    std::sort(queries.begin(), queries.end(), [&key](const nlohmann::json& a, const nlohmann::json& b) {
+        return a[key].get<double>() > b[key].get<double>();
+    });
+    
+    size_t fingerprints = queries.size();
+    if (queries.size() > limit) {
+        queries.resize(limit);
+    }
+    
+    return {
+        {"fingerprints", fingerprints},
+        {"statements", total_statements},
+        {"slow_threshold_ms", slow_threshold_.count()},
+        {"sort", key},
+        {"queries", queries}
+    };
+}
+
+void QueryStats::reset() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+    }
+}
+
+} // namespace FoxBridge
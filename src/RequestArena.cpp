@@ -0,0 +1,37 @@
+#include "RequestArena.h"
+
+namespace FoxBridge {
+
+namespace {
+thread_local RequestArena* t_current_arena = nullptr;
+}
+
+RequestArena::RequestArena()
+    : buffer_(inline_, sizeof(inline_), std::pmr::new_delete_resource()) {
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t alignment) {
+    ++allocations_;
+    bytes_ += bytes;
+    return buffer_.allocate(bytes, alignment);
+}
+
+RequestArena* RequestArena::current() {
+    return t_current_arena;
+}
+
+std::pmr::memory_resource* RequestArena::resource() {
+    return t_current_arena ? static_cast<std::pmr::memory_resource*>(t_current_arena) :
+                             std::pmr::new_delete_resource();
+}
+
+RequestArena::Scope::Scope(RequestArena& arena)
+    : previous_(t_current_arena) {
+    t_current_arena = &arena;
+}
+
+RequestArena::Scope::~Scope() {
+    t_current_arena = previous_;
+}
+
+} // namespace FoxBridge
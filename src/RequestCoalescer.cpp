@@ -0,0 +1,86 @@
+#include "RequestCoalescer.h"
+#include <sstream>
+
+namespace FoxBridge {
+
+RequestCoalescer::SharedResponse RequestCoalescer::run(const std::string& key, 
+                                                        const Producer& producer, 
+                                                        bool& coalesced,
+                                                        Clock::time_point deadline) {
+    for (;;) {
+        std::promise<SharedResponse> promise;
+        std::shared_future<SharedResponse> future;
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = in_flight_.find(key);
+            if (it != in_flight_.end()) {
+                future = it->second;
+                coalesced = true;
+            } else {
+                future = promise.get_future().share();
+                in_flight_.emplace(key, future);
+                coalesced = false;
+            }
+        }
+        
+        if (coalesced) {
+            ++coalesced_;
+            if (future.wait_until(deadline) != std::future_status::ready) {
+                return nullptr;
+            }
+            SharedResponse response = future.get();
+            if (response) {
+                return response;
+            }
+            continue;       // The leader was cancelled; run it ourselves
+        }
+        
+        ++executions_;
+        
+        bool shareable = true;
+        SharedResponse response;
+        try {
+            response = producer(shareable);
+        } catch (...) {
+            // Later arrivals start a fresh execution - only concurrent requests share
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                in_flight_.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        
+        // The key goes first, so waiters sent back by a null response do not
+        // find this execution again
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.erase(key);
+        }
+        promise.set_value(shareable ? response : nullptr);
+        return response;
+    }
+}
+
+std::string RequestCoalescer::makeKey(const std::string& method, 
+                                      const std::string& path,
+                                      const std::map<std::string, std::string>& params,
+                                      const std::string& auth_scope,
+                                      unsigned http_version,
+                                      const std::string& content_type) {
+    std::ostringstream key;
+    key << method << ' ' << path.size() << ':' << path << '?';
+    
+    // std::map keeps parameters sorted, so ?b=1&a=2 and ?a=2&b=1 share a key.
+    // Names and values are decoded and may hold '&' or '=' themselves, so
+    // each is length-prefixed: ?a=1%262=3 and ?a=1&2=3 must not collide.
+    for (const auto& [name, value] : params) {
+        key << name.size() << ':' << name << value.size() << ':' << value;
+    }
+    
+    key << '|' << http_version << '|' << content_type << '|' << std::hash<std::string>{}(auth_scope);
+    return key.str();
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,76 @@
+#include "RequestContext.h"
+
+namespace FoxBridge {
+
+namespace {
+thread_local std::shared_ptr<RequestContext> t_current_context;
+}
+
+RequestContext::RequestContext(Clock::time_point deadline)
+    : deadline_(deadline)
+    , cancelled_(false)
+    , next_hook_id_(1) {
+}
+
+std::chrono::milliseconds RequestContext::remaining() const {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline_.load() - Clock::now());
+    return left.count() > 0 ? left : std::chrono::milliseconds(0);
+}
+
+std::string RequestContext::cancelReason() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancel_reason_;
+}
+
+void RequestContext::cancel(const std::string& reason) {
+    // Hooks run under the lock so removeCancelHook() returning means the
+    // hook is no longer running and its handle may be freed
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cancelled_) {
+        return;
+    }
+    
+    cancel_reason_ = reason;
+    cancelled_ = true;
+    
+    for (auto& [id, hook] : hooks_) {
+        hook();
+    }
+    cancel_cv_.notify_all();
+}
+
+bool RequestContext::sleepFor(std::chrono::milliseconds duration) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !cancel_cv_.wait_for(lock, duration, [this] { return cancelled_.load(); });
+}
+
+uint64_t RequestContext::addCancelHook(std::function<void()> hook) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cancelled_) {
+        hook();
+    }
+    
+    uint64_t id = next_hook_id_++;
+    hooks_.emplace(id, std::move(hook));
+    return id;
+}
+
+void RequestContext::removeCancelHook(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hooks_.erase(id);
+}
+
+std::shared_ptr<RequestContext> RequestContext::current() {
+    return t_current_context;
+}
+
+RequestContext::Scope::Scope(std::shared_ptr<RequestContext> context)
+    : previous_(std::move(t_current_context)) {
+    t_current_context = std::move(context);
+}
+
+RequestContext::Scope::~Scope() {
+    t_current_context = std::move(previous_);
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,79 @@
+#include "Router.h"
+#include <regex>
+
+namespace FoxBridge {
+
+namespace {
+
+struct RouteSpec {
+    RouteId id;
+    const char* method;
+    const char* name;
+    std::regex pattern;
+};
+
+// Order matters only where patterns overlap; the first match wins
+const std::vector<RouteSpec>& routeTable() {
+    static const std::vector<RouteSpec> table = {
+        {RouteId::HEALTH,                 "GET",  "health",                 std::regex(R"(^/health$)")},
+        {RouteId::METRICS,                "GET",  "metrics",                std::regex(R"(^/metrics$)")},
+        {RouteId::JSON_ALL,               "GET",  "json_all",               std::regex(R"(^/api/dbf/json/([^/]+\.dbf)$)")},
+        {RouteId::JSON_DOCNUM,            "GET",  "json_docnum",            std::regex(R"(^/api/dbf/json/([^/]+\.dbf)/([^/]+)$)")},
+        {RouteId::CSV_ALL,                "GET",  "csv_all",                std::regex(R"(^/api/dbf/csv/([^/]+\.dbf)$)")},
+        {RouteId::CSV_DOCNUM,             "GET",  "csv_docnum",             std::regex(R"(^/api/dbf/csv/([^/]+\.dbf)/([^/]+)$)")},
+        {RouteId::ARROW,                  "GET",  "arrow",                  std::regex(R"(^/api/dbf/arrow/([^/]+\.dbf)$)")},
+        {RouteId::PARQUET,                "GET",  "parquet",                std::regex(R"(^/api/dbf/parquet/([^/]+\.dbf)$)")},
+        {RouteId::SEARCH,                 "GET",  "search",                 std::regex(R"(^/api/dbf/search/([^/]+\.dbf)$)")},
+        {RouteId::VIEW,                   "GET",  "view",                   std::regex(R"(^/view/([^/]+\.dbf)$)")},
+        {RouteId::MEMO,                   "GET",  "memo",                   std::regex(R"(^/api/dbf/memo/([^/]+\.dbf)/(\d{1,10})/([A-Za-z0-9_]+)$)")},
+        {RouteId::DOCNUM,                 "GET",  "docnum",                 std::regex(R"(^/docnum/([^/]+)$)")},
+        {RouteId::DOCNUM_BATCH,           "POST", "docnum_batch",           std::regex(R"(^/api/docnum/batch$)")},
+        {RouteId::DIRECT_LOOKUP,          "GET",  "direct_lookup",          std::regex(R"(^/([A-Z]{2}\d{7})$)")},  // e.g., HP0000001
+        {RouteId::ADD,                    "POST", "add",                    std::regex(R"(^/api/dbf/add/([^/]+\.dbf)$)")},
+        {RouteId::UPDATE,                 "POST", "update",                 std::regex(R"(^/api/dbf/update/([^/]+\.dbf)$)")},
+        {RouteId::DELETE,                 "POST", "delete",                 std::regex(R"(^/api/dbf/delete/([^/]+\.dbf)$)")},
+        {RouteId::UNDELETE,               "POST", "undelete",               std::regex(R"(^/api/dbf/undelete/([^/]+\.dbf)$)")},
+        {RouteId::JOB_STATUS,             "GET",  "job_status",             std::regex(R"(^/api/dbf/jobs/([A-Za-z0-9-]+)$)")},
+        {RouteId::PACK,                   "POST", "pack",                   std::regex(R"(^/api/dbf/pack/([^/]+\.dbf)$)")},
+        {RouteId::REINDEX,                "POST", "reindex",                std::regex(R"(^/api/dbf/maintenance/reindex/([^/]+\.dbf)$)")},
+        {RouteId::INDEX_STATUS,           "GET",  "index_status",           std::regex(R"(^/api/dbf/maintenance/status/([^/]+\.dbf)$)")},
+        {RouteId::ADMIN_ADMISSION,        "GET",  "admin_admission",        std::regex(R"(^/api/admin/admission$)")},
+        {RouteId::ADMIN_DBSTATS,          "GET",  "admin_dbstats",          std::regex(R"(^/api/admin/dbstats$)")},
+        {RouteId::ADMIN_QUERYSTATS,       "GET",  "admin_querystats",       std::regex(R"(^/api/admin/querystats$)")},
+        {RouteId::ADMIN_QUERYSTATS_RESET, "POST", "admin_querystats_reset", std::regex(R"(^/api/admin/querystats/reset$)")},
+        {RouteId::ADMIN_TRACE,            "GET",  "admin_trace",            std::regex(R"(^/api/admin/traces/([0-9a-f]{32})$)")},
+    };
+    return table;
+}
+
+} // namespace
+
+RouteMatch Router::match(const std::string& method, const std::string& path) {
+    RouteMatch result;
+    std::smatch matches;
+    
+    for (const auto& spec : routeTable()) {
+        if (method != spec.method || !std::regex_match(path, matches, spec.pattern)) {
+            continue;
+        }
+        
+        result.id = spec.id;
+        for (size_t i = 1; i < matches.size(); ++i) {
+            result.params.push_back(matches[i]);
+        }
+        break;
+    }
+    
+    return result;
+}
+
+const char* Router::routeName(RouteId id) {
+    for (const auto& spec : routeTable()) {
+        if (spec.id == id) {
+            return spec.name;
+        }
+    }
+    return "not_found";
+}
+
+} // namespace FoxBridge
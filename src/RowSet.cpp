@@ -0,0 +1,322 @@
+#include "RowSet.h"
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+
+namespace FoxBridge {
+
+int RowSchema::find(std::string_view name) const {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+RowSet::RowSet(std::shared_ptr<const RowSchema> schema)
+    : schema_(std::move(schema)) {
+}
+
+const RowSchema& RowSet::schema() const {
+    static const RowSchema none;
+    return schema_ ? *schema_ : none;
+}
+
+void RowSet::pushCell(CellKind kind, size_t offset, size_t length, bool sized) {
+    size_t columns = columnCount();
+    if (columns == 0) {
+        throw std::logic_error("RowSet has no columns");
+    }
+    cells_.push_back({offset, static_cast<uint32_t>(length), kind, sized});
+    if (cells_.size() % columns == 0) {
+        ++row_count_;
+    }
+}
+
+void RowSet::addNull() {
+    pushCell(CellKind::NULL_VALUE, buffer_.size(), 0);
+}
+
+void RowSet::addText(std::string_view text) {
+    size_t offset = buffer_.size();
+    buffer_.append(text);
+    pushCell(CellKind::VALUE, offset, text.size());
+}
+
+void RowSet::addText(std::string_view text, TextEncoding encoding) {
+    size_t offset = buffer_.size();
+    appendUtf8(buffer_, text, encoding);
+    pushCell(CellKind::VALUE, offset, buffer_.size() - offset);
+}
+
+void RowSet::addRecno(uint32_t recno) {
+    char digits[16];
+    auto end = std::to_chars(digits, digits + sizeof(digits), recno).ptr;
+    addText(std::string_view(digits, static_cast<size_t>(end - digits)));
+}
+
+void RowSet::addMemoRef(std::string_view table, uint32_t recno, std::string_view field, int64_t length) {
+    char digits[16];
+    auto end = std::to_chars(digits, digits + sizeof(digits), recno).ptr;
+
+    size_t offset = buffer_.size();
+    buffer_ += "/api/dbf/memo/";
+    buffer_ += table;
+    buffer_ += '/';
+    buffer_.append(digits, end);
+    buffer_ += '/';
+    buffer_ += field;
+    size_t path_length = buffer_.size() - offset;
+
+    // The length, when known, rides in the buffer behind the path
+    if (length >= 0) {
+        buffer_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+    pushCell(CellKind::MEMO_REF, offset, path_length, length >= 0);
+}
+
+RowSet::CellView RowSet::cell(size_t row, size_t column) const {
+    const Cell& slot = cells_[row * columnCount() + column];
+    const char* text = buffer_.data() + slot.offset;
+    int64_t memo_length = -1;
+    if (slot.sized) {
+        std::memcpy(&memo_length, text + slot.length, sizeof(memo_length));
+    }
+    return {slot.kind, std::string_view(text, slot.length), memo_length};
+}
+
+void RowSet::append(const RowSet& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (!schema_) {
+        schema_ = other.schema_;
+    }
+    uint64_t base = buffer_.size();
+    buffer_ += other.buffer_;
+    cells_.reserve(cells_.size() + other.cells_.size());
+    for (const Cell& slot : other.cells_) {
+        cells_.push_back({slot.offset + base, slot.length, slot.kind, slot.sized});
+    }
+    row_count_ += other.row_count_;
+}
+
+void RowSet::append(const RowSet& other, size_t first, size_t count) {
+    if (!schema_) {
+        schema_ = other.schema_;
+    }
+    size_t end = std::min(other.row_count_, first + std::min(count, other.row_count_));
+    if (first >= end) {
+        return;
+    }
+    size_t columns = other.columnCount();
+    for (size_t i = first * columns; i < end * columns; ++i) {
+        const Cell& slot = other.cells_[i];
+        uint64_t offset = buffer_.size();
+        buffer_.append(other.buffer_, slot.offset, slot.length + (slot.sized ? sizeof(int64_t) : 0));
+        cells_.push_back({offset, slot.length, slot.kind, slot.sized});
+    }
+    row_count_ += end - first;
+}
+
+void RowSet::reserve(size_t rows, size_t text_bytes) {
+    cells_.reserve(rows * columnCount());
+    buffer_.reserve(text_bytes);
+}
+
+size_t RowSet::memoryBytes() const {
+    return buffer_.capacity() + cells_.capacity() * sizeof(Cell);
+}
+
+nlohmann::json RowSet::rowJson(size_t row) const {
+    const RowSchema& columns = schema();
+    nlohmann::json object = nlohmann::json::object();
+    for (size_t column = 0; column < columns.columns.size(); ++column) {
+        const RowColumn& info = columns.columns[column];
+        CellView value = cell(row, column);
+        switch (value.kind) {
+            case CellKind::NULL_VALUE:
+                object[info.name] = nullptr;
+                break;
+            case CellKind::MEMO_REF: {
+                nlohmann::json reference = {{"memo_ref", std::string(value.text)}};
+                if (value.memo_length >= 0) {
+                    reference["length"] = value.memo_length;
+                }
+                object[info.name] = std::move(reference);
+                break;
+            }
+            case CellKind::VALUE:
+                if (info.type == ColumnType::RECNO) {
+                    uint32_t recno = 0;
+                    std::from_chars(value.text.data(), value.text.data() + value.text.size(), recno);
+                    object[info.name] = recno;
+                } else {
+                    object[info.name] = std::string(value.text);
+                }
+                break;
+        }
+    }
+    return object;
+}
+
+nlohmann::json RowSet::toJson() const {
+    nlohmann::json rows = nlohmann::json::array();
+    for (size_t row = 0; row < row_count_; ++row) {
+        rows.push_back(rowJson(row));
+    }
+    return rows;
+}
+
+void appendJsonString(std::string& out, std::string_view text) {
+    static const char HEX[] = "0123456789abcdef";
+    out += '"';
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        // Copy the clean run before this character in one go
+        out.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                out.append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    out.append(text.data() + run, text.size() - run);
+    out += '"';
+}
+
+void RowSet::writeJson(std::string& out, int indent, int level) const {
+    if (row_count_ == 0) {
+        out += "[]";
+        return;
+    }
+
+    const RowSchema& columns = schema();
+    bool pretty = indent >= 0;
+    size_t row_indent = pretty ? static_cast<size_t>(indent) * (level + 1) : 0;
+    size_t field_indent = pretty ? static_cast<size_t>(indent) * (level + 2) : 0;
+    const char* separator = pretty ? ": " : ":";
+
+    out += pretty ? "[\n" : "[";
+    for (size_t row = 0; row < row_count_; ++row) {
+        if (row > 0) {
+            out += pretty ? ",\n" : ",";
+        }
+        out.append(row_indent, ' ');
+        if (columns.columns.empty()) {
+            out += "{}";
+            continue;
+        }
+
+        out += pretty ? "{\n" : "{";
+        for (size_t column = 0; column < columns.columns.size(); ++column) {
+            if (column > 0) {
+                out += pretty ? ",\n" : ",";
+            }
+            out.append(field_indent, ' ');
+            appendJsonString(out, columns.columns[column].name);
+            out += separator;
+
+            CellView value = cell(row, column);
+            switch (value.kind) {
+                case CellKind::NULL_VALUE:
+                    out += "null";
+                    break;
+                case CellKind::MEMO_REF:
+                    // Keys in nlohmann::json order so both paths print alike
+                    out += pretty ? "{\n" : "{";
+                    if (value.memo_length >= 0) {
+                        out.append(field_indent + (pretty ? indent : 0), ' ');
+                        out += "\"length\"";
+                        out += separator;
+                        out += std::to_string(value.memo_length);
+                        out += pretty ? ",\n" : ",";
+                    }
+                    out.append(field_indent + (pretty ? indent : 0), ' ');
+                    out += "\"memo_ref\"";
+                    out += separator;
+                    appendJsonString(out, value.text);
+                    if (pretty) {
+                        out += '\n';
+                        out.append(field_indent, ' ');
+                    }
+                    out += '}';
+                    break;
+                case CellKind::VALUE:
+                    if (columns.columns[column].type == ColumnType::RECNO) {
+                        out += value.text;
+                    } else {
+                        appendJsonString(out, value.text);
+                    }
+                    break;
+            }
+        }
+        if (pretty) {
+            out += '\n';
+            out.append(row_indent, ' ');
+        }
+        out += '}';
+    }
+    if (pretty) {
+        out += '\n';
+        out.append(static_cast<size_t>(indent) * level, ' ');
+    }
+    out += ']';
+}
+
+void RowSet::writeBinary(std::string& out, BodyFormat format) const {
+    const RowSchema& columns = schema();
+    appendBinaryArray(out, format, row_count_);
+    for (size_t row = 0; row < row_count_; ++row) {
+        appendBinaryMap(out, format, columns.columns.size());
+        for (size_t column = 0; column < columns.columns.size(); ++column) {
+            appendBinaryString(out, format, columns.columns[column].name);
+
+            CellView value = cell(row, column);
+            switch (value.kind) {
+                case CellKind::NULL_VALUE:
+                    appendBinaryNull(out, format);
+                    break;
+                case CellKind::MEMO_REF:
+                    appendBinaryMap(out, format, value.memo_length >= 0 ? 2 : 1);
+                    if (value.memo_length >= 0) {
+                        appendBinaryString(out, format, "length");
+                        appendBinaryUnsigned(out, format, static_cast<uint64_t>(value.memo_length));
+                    }
+                    appendBinaryString(out, format, "memo_ref");
+                    appendBinaryString(out, format, value.text);
+                    break;
+                case CellKind::VALUE: {
+                    uint64_t recno = 0;
+                    if (columns.columns[column].type == ColumnType::RECNO &&
+                        std::from_chars(value.text.data(), value.text.data() + value.text.size(), recno).ec ==
+                            std::errc()) {
+                        appendBinaryUnsigned(out, format, recno);
+                    } else {
+                        appendBinaryString(out, format, value.text);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+} // namespace FoxBridge
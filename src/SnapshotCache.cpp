@@ -0,0 +1,328 @@
+#include "SnapshotCache.h"
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+namespace FoxBridge {
+
+static std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// 64-bit FNV-1a of the export body, in hex
+static std::string contentHash(const std::string& body) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : body) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+static uint32_t crc32(const std::string& data) {
+    static const auto TABLE = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+    
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char c : data) {
+        crc = TABLE[(crc ^ c) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+SnapshotCache::SnapshotCache(std::shared_ptr<StorageBackend> backend, const std::string& cache_dir,
+                             std::vector<SnapshotJob> jobs, std::chrono::seconds check_interval,
+                             Builder build, std::string variant)
+    : backend_(backend)
+    , cache_dir_(cache_dir)
+    , jobs_(std::move(jobs))
+    , check_interval_(check_interval)
+    , build_(std::move(build))
+    , variant_(std::move(variant)) {
+    for (auto& job : jobs_) {
+        job.table = toLower(job.table);
+    }
+}
+
+SnapshotCache::~SnapshotCache() {
+    stop();
+}
+
+void SnapshotCache::start() {
+    if (running_) {
+        return;
+    }
+    
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_, ec);
+    if (ec) {
+        spdlog::error("Cannot create snapshot directory {}: {}", cache_dir_.string(), ec.message());
+        return;
+    }
+    
+    running_ = true;
+    worker_thread_ = std::make_unique<std::thread>(&SnapshotCache::workerLoop, this);
+    spdlog::info("Export snapshots: {} tables in {}, checked every {}s", jobs_.size(),
+                 cache_dir_.string(), check_interval_.count());
+}
+
+void SnapshotCache::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_cv_.notify_all();
+    
+    if (worker_thread_ && worker_thread_->joinable()) {
+        worker_thread_->join();
+    }
+}
+
+bool SnapshotCache::find(const std::string& table, SnapshotFormat format, SnapshotFile& file) {
+    std::string version = backend_->tableVersion(table);
+    if (version.empty()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(key(table, format));
+    if (it == snapshots_.end() || it->second.version != version) {
+        return false;
+    }
+    file = it->second.file;
+    return true;
+}
+
+bool SnapshotCache::parseFormat(const std::string& name, SnapshotFormat& format) {
+    if (name == "csv") {
+        format = SnapshotFormat::CSV;
+    } else if (name == "json") {
+        format = SnapshotFormat::JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* SnapshotCache::formatName(SnapshotFormat format) {
+    return format == SnapshotFormat::CSV ? "csv" : "json";
+}
+
+bool SnapshotCache::writeGzip(const std::filesystem::path& path, const std::string& body) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    
+    // No name and no mtime in the header, so a body always gives the same file
+    static const unsigned char HEADER[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+    out.write(reinterpret_cast<const char*>(HEADER), sizeof(HEADER));
+    
+    namespace zlib = boost::beast::zlib;
+    zlib::deflate_stream deflate;
+    deflate.reset(6, 15, 8, zlib::Strategy::normal);
+    zlib::z_params stream;
+    stream.next_in = body.data();
+    stream.avail_in = body.size();
+    
+    std::vector<char> chunk(256 * 1024);
+    for (;;) {
+        stream.next_out = chunk.data();
+        stream.avail_out = chunk.size();
+        boost::system::error_code ec;
+        deflate.write(stream, zlib::Flush::finish, ec);
+        out.write(chunk.data(), static_cast<std::streamsize>(chunk.size() - stream.avail_out));
+        if (ec == zlib::error::end_of_stream) {
+            break;
+        }
+        if (ec) {
+            return false;
+        }
+    }
+    
+    // Trailer: CRC-32 and length mod 2^32 of the uncompressed body, little-endian
+    uint32_t trailer[2] = {crc32(body), static_cast<uint32_t>(body.size())};
+    for (uint32_t value : trailer) {
+        char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8),
+                         static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+        out.write(bytes, sizeof(bytes));
+    }
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+void SnapshotCache::workerLoop() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    
+    while (running_) {
+        lock.unlock();
+        for (const auto& job : jobs_) {
+            for (SnapshotFormat format : job.formats) {
+                if (!running_) {
+                    break;
+                }
+                try {
+                    refresh(job.table, format);
+                } catch (const std::exception& e) {
+                    spdlog::error("Snapshot of {} as {} failed: {}", job.table, formatName(format), e.what());
+                }
+            }
+        }
+        lock.lock();
+        
+        wake_cv_.wait_for(lock, check_interval_, [this] { return !running_; });
+    }
+}
+
+void SnapshotCache::refresh(const std::string& table, SnapshotFormat format) {
+    std::string version = backend_->tableVersion(table);
+    if (version.empty()) {
+        spdlog::warn("Snapshot table not found: {}", table);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = snapshots_.find(key(table, format));
+        if (it != snapshots_.end() && it->second.version == version) {
+            return;
+        }
+    }
+    if (adopt(table, format, version)) {
+        return;
+    }
+    
+    auto started = std::chrono::steady_clock::now();
+    std::string body;
+    std::string error;
+    if (!build_(table, format, body, error)) {
+        spdlog::warn("Snapshot of {} as {} failed: {}", table, formatName(format), error);
+        return;
+    }
+    
+    // A write during the export leaves a body that may match neither
+    // version; the next check builds it again
+    if (backend_->tableVersion(table) != version) {
+        spdlog::info("{} changed while its {} snapshot was built; retrying on the next check",
+                     table, formatName(format));
+        return;
+    }
+    
+    std::string hash = contentHash(body);
+    auto path = cache_dir_ / (table + "." + fileVersion(version) + "." + hash + "." + formatName(format) + ".gz");
+    auto temp = path;
+    temp += ".tmp";
+    std::error_code ec;
+    if (!writeGzip(temp, body)) {
+        spdlog::error("Cannot write snapshot {}", temp.string());
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        spdlog::error("Cannot write snapshot {}: {}", path.string(), ec.message());
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    
+    Snapshot snapshot;
+    snapshot.version = version;
+    snapshot.file.path = path;
+    snapshot.file.size = std::filesystem::file_size(path, ec);
+    snapshot.file.etag = "\"" + std::string(formatName(format)) + "-" + hash + "\"";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshots_[key(table, format)] = snapshot;
+    }
+    removeStale(table, format, path);
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started);
+    spdlog::info("Snapshot {} as {}: {} bytes, {} gzipped, in {}ms", table, formatName(format),
+                 body.size(), snapshot.file.size, elapsed.count());
+}
+
+bool SnapshotCache::adopt(const std::string& table, SnapshotFormat format, const std::string& version) {
+    std::string prefix = table + "." + fileVersion(version) + ".";
+    std::string suffix = std::string(".") + formatName(format) + ".gz";
+    
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir_, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) != 0 || !endsWith(name, suffix) ||
+            name.size() != prefix.size() + 16 + suffix.size()) {
+            continue;
+        }
+        
+        Snapshot snapshot;
+        snapshot.version = version;
+        snapshot.file.path = entry.path();
+        snapshot.file.size = std::filesystem::file_size(entry.path(), ec);
+        snapshot.file.etag = "\"" + std::string(formatName(format)) + "-" + name.substr(prefix.size(), 16) + "\"";
+        if (ec) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            snapshots_[key(table, format)] = snapshot;
+        }
+        removeStale(table, format, entry.path());
+        spdlog::info("Snapshot {} as {}: kept from an earlier run", table, formatName(format));
+        return true;
+    }
+    return false;
+}
+
+void SnapshotCache::removeStale(const std::string& table, SnapshotFormat format,
+                                const std::filesystem::path& keep) {
+    // Downloads still sending an old file keep it open; POSIX and Windows
+    // (FILE_SHARE_DELETE) both let it go once they finish
+    std::string prefix = table + ".";
+    std::string suffix = std::string(".") + formatName(format) + ".gz";
+    
+    std::error_code ec;
+    std::vector<std::filesystem::path> stale;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir_, ec)) {
+        std::string name = entry.path().filename().string();
+        if (entry.path() != keep && name.rfind(prefix, 0) == 0 &&
+            (endsWith(name, suffix) || endsWith(name, suffix + ".tmp"))) {
+            stale.push_back(entry.path());
+        }
+    }
+    for (const auto& path : stale) {
+        std::filesystem::remove(path, ec);
+    }
+}
+
+std::string SnapshotCache::key(const std::string& table, SnapshotFormat format) {
+    return toLower(table) + "." + formatName(format);
+}
+
+std::string SnapshotCache::fileVersion(const std::string& version) const {
+    return variant_.empty() ? version : version + "-" + variant_;
+}
+
+} // namespace FoxBridge
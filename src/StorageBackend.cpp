@@ -0,0 +1,424 @@
+#include "StorageBackend.h"
+#include "DatabaseManager.h"
+#include "DbfBackend.h"
+#include "DbfTable.h"
+#include "MemoFile.h"
+#include "Config.h"
+#include "Tracer.h"
+#include "RequestArena.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+namespace FoxBridge {
+
+static std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+StorageBackend::StorageBackend(const std::string& db_folder_path)
+    : db_folder_path_(db_folder_path) {
+    if (!std::filesystem::exists(db_folder_path_)) {
+        throw std::runtime_error("Database folder does not exist: " + db_folder_path_);
+    }
+}
+
+const std::vector<std::string>& StorageBackend::docnumTables() {
+    static const std::vector<std::string> tables = {
+        "invoice.dbf", "receipt.dbf", "order.dbf",
+        "quotation.dbf", "payment.dbf", "delivery.dbf"
+    };
+    return tables;
+}
+
+std::string StorageBackend::sanitizeFilename(const std::string& filename) {
+    // Prevent path traversal and SQL injection
+    std::string sanitized = filename;
+    
+    // Remove dangerous characters but keep .dbf extension
+    if (sanitized.find("..") != std::string::npos ||
+        sanitized.find("/") != std::string::npos ||
+        sanitized.find("\\") != std::string::npos) {
+        throw std::runtime_error("Invalid filename - path traversal detected");
+    }
+    
+    // Ensure it's a .dbf file
+    if (sanitized.length() < 4 || sanitized.substr(sanitized.length() - 4) != ".dbf") {
+        throw std::runtime_error("Invalid filename - must be .dbf file");
+    }
+    
+    return sanitized;
+}
+
+std::filesystem::path StorageBackend::resolvePath(const std::string& filename) {
+    std::filesystem::path exact = std::filesystem::path(db_folder_path_) / filename;
+    std::error_code ec;
+    if (std::filesystem::exists(exact, ec)) {
+        return exact;
+    }
+    
+    std::string key = toLower(filename);
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    auto it = names_.find(key);
+    if (it != names_.end() && std::filesystem::exists(it->second, ec)) {
+        return it->second;
+    }
+    
+    // Rescan on a miss; files created since the last scan are picked up here
+    names_.clear();
+    for (const auto& entry : std::filesystem::directory_iterator(db_folder_path_, ec)) {
+        names_[toLower(entry.path().filename().string())] = entry.path();
+    }
+    it = names_.find(key);
+    return it != names_.end() ? it->second : std::filesystem::path();
+}
+
+std::string StorageBackend::jsonToCSV(const nlohmann::json& data) {
+    if (!data.is_array() || data.empty()) {
+        return "";
+    }
+    
+    // Built in the request arena; only the finished text is copied out
+    ArenaString csv(RequestArena::resource());
+    auto quoted = [&csv](const std::string& str) {
+        csv += '"';
+        for (size_t start = 0; ; ) {
+            size_t quote = str.find('"', start);
+            if (quote == std::string::npos) {
+                csv.append(str, start, std::string::npos);
+                break;
+            }
+            // Escape quotes
+            csv.append(str, start, quote + 1 - start);
+            csv += '"';
+            start = quote + 1;
+        }
+        csv += '"';
+    };
+    
+    // Header row
+    bool first = true;
+    for (auto& [key, value] : data[0].items()) {
+        if (!first) csv += ',';
+        quoted(key);
+        first = false;
+    }
+    csv += '\n';
+    
+    // Data rows
+    for (auto& record : data) {
+        first = true;
+        for (auto& [key, value] : record.items()) {
+            if (!first) csv += ',';
+            
+            if (value.is_string()) {
+                quoted(value.get_ref<const std::string&>());
+            } else if (value.is_null()) {
+                csv += "\"\"";
+            } else if (value.is_object() && value.contains("memo_ref")) {
+                // Memo left out of the row: the cell holds where to fetch it
+                quoted(value["memo_ref"].get_ref<const std::string&>());
+            } else {
+                csv += value.dump();
+            }
+            
+            first = false;
+        }
+        csv += '\n';
+    }
+    
+    return std::string(csv);
+}
+
+QueryResult StorageBackend::exportCSV(const std::string& filename, const std::string& docnum) {
+    QueryResult result = exportJSON(filename, docnum);
+    
+    if (result.success) {
+        TraceSpan span("csv.convert");
+        std::string csv;
+        CsvEncoder(csv_dialect_).write(result.rows, csv);
+        result.data = std::move(csv);
+        result.rows = RowSet();
+    }
+    
+    return result;
+}
+
+QueryResult StorageBackend::getIndexStatus(const std::string& filename) {
+    QueryResult result;
+    result.success = true;
+    result.message = "Index status retrieved";
+    result.index_status = checkIndexHealth(filename);
+    
+    result.data = {
+        {"file", filename},
+        {"status", result.index_status == IndexStatus::OK ? "ok" :
+                  result.index_status == IndexStatus::PENDING ? "pending" : "failed"}
+    };
+    
+    return result;
+}
+
+IndexStatus StorageBackend::checkIndexHealth(const std::string& filename) {
+    // Simplified health check - in production, check CDX file integrity
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        
+        // Remove .dbf extension to get base name
+        std::string base_name = safe_filename.substr(0, safe_filename.length() - 4);
+        
+        if (fileExists(base_name + ".cdx")) {
+            return IndexStatus::OK;
+        } else {
+            return IndexStatus::PENDING;
+        }
+    } catch (...) {
+        return IndexStatus::FAILED;
+    }
+}
+
+void StorageBackend::setTextEncodings(TextEncoding fallback, std::map<std::string, TextEncoding> overrides) {
+    std::lock_guard<std::mutex> lock(encodings_mutex_);
+    fallback_encoding_ = fallback;
+    encoding_overrides_.clear();
+    for (auto& [table, encoding] : overrides) {
+        encoding_overrides_[toLower(table)] = encoding;
+    }
+    tables_.clear();
+}
+
+TextEncoding StorageBackend::tableEncoding(const std::string& filename, uint8_t language_driver) {
+    std::string key = toLower(filename);
+    std::lock_guard<std::mutex> lock(encodings_mutex_);
+    auto it = encoding_overrides_.find(key);
+    if (it != encoding_overrides_.end()) {
+        return it->second;
+    }
+    TextEncoding encoding;
+    if (!encodingFromLanguageDriver(language_driver, encoding)) {
+        encoding = fallback_encoding_;
+    }
+    return encoding;
+}
+
+StorageBackend::TableInfo StorageBackend::tableInfo(const std::string& filename) {
+    std::string key = toLower(filename);
+    {
+        std::lock_guard<std::mutex> lock(encodings_mutex_);
+        auto it = tables_.find(key);
+        if (it != tables_.end()) {
+            return it->second;
+        }
+    }
+    
+    // The header never changes for a table, so one read per file
+    uint8_t language_driver = 0;
+    bool has_memo = false;
+    auto path = resolvePath(filename);
+    if (!path.empty()) {
+        try {
+            DbfTable table(path);
+            language_driver = table.codePage();
+            has_memo = table.hasMemo();
+        } catch (const std::exception&) {
+            path.clear();       // Unreadable now; try again next time
+        }
+    }
+    
+    TableInfo info{tableEncoding(filename, language_driver), has_memo};
+    if (!path.empty()) {
+        std::lock_guard<std::mutex> lock(encodings_mutex_);
+        tables_[key] = info;
+    }
+    return info;
+}
+
+TextEncoding StorageBackend::tableEncoding(const std::string& filename) {
+    return tableInfo(filename).encoding;
+}
+
+bool StorageBackend::tableHasMemo(const std::string& filename) {
+    return tableInfo(filename).has_memo;
+}
+
+MemoReader StorageBackend::openMemo(const std::string& filename, uint32_t recno, const std::string& field) {
+    std::string safe_filename = sanitizeFilename(filename);
+    auto path = resolvePath(safe_filename);
+    if (path.empty()) {
+        throw std::runtime_error("File not found: " + safe_filename);
+    }
+    
+    DbfTable table(path);
+    const DbfColumn* column = table.column(field);
+    if (!column || column->type != 'M') {
+        throw std::runtime_error("Not a memo field: " + field);
+    }
+    std::vector<char> record;
+    if (!table.readRecord(recno, record) || DbfTable::isDeleted(record.data())) {
+        throw std::runtime_error("Record not found: " + std::to_string(recno));
+    }
+    
+    MemoReader reader;
+    reader.encoding = tableEncoding(safe_filename, table.codePage());
+    uint32_t block = DbfTable::memoBlock(record.data(), *column);
+    if (block == 0) {
+        return reader;      // Empty memo
+    }
+    
+    std::filesystem::path memo_path = MemoFile::pathFor(path);
+    if (memo_path.empty()) {
+        throw std::runtime_error("Memo file not found for " + safe_filename);
+    }
+    reader.file = std::make_unique<MemoFile>(memo_path);
+    if (!reader.file->locate(block, reader.memo)) {
+        throw std::runtime_error("Damaged memo pointer in record " + std::to_string(recno));
+    }
+    return reader;
+}
+
+uint32_t StorageBackend::recordCount(const std::string& filename) {
+    std::string safe_filename = sanitizeFilename(filename);
+    auto path = resolvePath(safe_filename);
+    if (path.empty()) {
+        throw std::runtime_error("File not found: " + safe_filename);
+    }
+    return DbfTable(path).recordCount();
+}
+
+std::string StorageBackend::tableVersion(const std::string& filename) {
+    std::filesystem::path path;
+    std::filesystem::path index_path;
+    try {
+        std::string safe_filename = sanitizeFilename(filename);
+        path = resolvePath(safe_filename);
+        index_path = resolvePath(safe_filename.substr(0, safe_filename.size() - 4) + ".cdx");
+    } catch (const std::exception&) {
+        return "";
+    }
+    if (path.empty()) {
+        return "";
+    }
+    
+    // FNV-1a over size and modification time of each file, plus the header's
+    // last-update date and record count, which VFP rewrites on every change
+    // even through a handle that stays open and leaves the mtime behind
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            hash ^= (value >> shift) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const auto& file : {path, MemoFile::pathFor(path), index_path}) {
+        std::error_code ec;
+        if (file.empty()) {
+            continue;
+        }
+        mix(std::filesystem::file_size(file, ec));
+        mix(static_cast<uint64_t>(std::filesystem::last_write_time(file, ec).time_since_epoch().count()));
+        if (ec) {
+            return "";
+        }
+    }
+    
+    unsigned char header[8];
+    std::ifstream in(path, std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return "";
+    }
+    for (size_t i = 1; i < sizeof(header); ++i) {
+        mix(header[i]);
+    }
+    
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+std::string StorageBackend::exportVariant() {
+    std::lock_guard<std::mutex> lock(encodings_mutex_);
+    uint32_t overrides = 2166136261u;
+    for (const auto& [table, encoding] : encoding_overrides_) {
+        for (unsigned char c : table + "=" + textEncodingName(encoding) + ";") {
+            overrides ^= c;
+            overrides *= 16777619u;
+        }
+    }
+    
+    char variant[160];
+    std::snprintf(variant, sizeof(variant), "%s-%s-%08x-m%zu-%s", csv_dialect_.tag().c_str(),
+                  textEncodingName(fallback_encoding_), overrides, memo_inline_bytes_, name().c_str());
+    return variant;
+}
+
+QueryResult StorageBackend::page(const std::string& filename, const PageRequest& request, size_t& matches) {
+    if (!request.filters.empty() || !request.sort.empty()) {
+        return searchPage(filename, request, matches);
+    }
+    
+    try {
+        matches = recordCount(filename);
+    } catch (const std::exception& e) {
+        QueryResult result;
+        result.success = false;
+        result.message = std::string("Error: ") + e.what();
+        result.index_status = IndexStatus::OK;
+        return result;
+    }
+    
+    // Past the end still reads an (empty) range, so the page has columns
+    uint64_t first = std::min<uint64_t>(request.offset, matches) + 1;
+    uint64_t last = std::min<uint64_t>(request.offset + std::min<uint64_t>(request.limit, matches), matches);
+    return searchRange(filename, {}, static_cast<uint32_t>(first), static_cast<uint32_t>(last));
+}
+
+// Settings shared by both backends
+static void configureBackend(StorageBackend& backend, const Config& config) {
+    // Config::validate() has already rejected unknown names
+    TextEncoding fallback = TextEncoding::CP874;
+    parseTextEncoding(config.text_encoding, fallback);
+    std::map<std::string, TextEncoding> overrides;
+    for (const auto& [table, name] : config.table_encodings) {
+        parseTextEncoding(name, overrides[table]);
+    }
+    backend.setTextEncodings(fallback, std::move(overrides));
+    backend.setMemoInlineBytes(static_cast<size_t>(config.memo_inline_bytes));
+    
+    CsvDialect dialect;
+    dialect.delimiter = config.csv_delimiter[0];
+    parseCsvQuoting(config.csv_quoting, dialect.quoting);
+    dialect.crlf = config.csv_line_ending == "crlf";
+    dialect.bom = config.csv_bom;
+    backend.setCsvDialect(dialect);
+}
+
+std::shared_ptr<StorageBackend> createStorageBackend(const Config& config) {
+    std::shared_ptr<StorageBackend> backend;
+    if (config.storage_backend == "dbf") {
+        backend = std::make_shared<DbfBackend>(config.database_path,
+                                               std::chrono::seconds(config.connection_timeout));
+    } else {
+        backend = std::make_shared<DatabaseManager>(config.database_path,
+                                                    config.db_pool_size,
+                                                    config.connection_timeout,
+                                                    config.max_retry_attempts,
+                                                    config.odbc_driver);
+    }
+    configureBackend(*backend, config);
+    return backend;
+}
+
+std::shared_ptr<StorageBackend> createRangeReader(const Config& config, std::shared_ptr<StorageBackend> backend) {
+    if (std::dynamic_pointer_cast<DbfBackend>(backend)) {
+        return backend;
+    }
+    auto reader = std::make_shared<DbfBackend>(config.database_path,
+                                               std::chrono::seconds(config.connection_timeout));
+    configureBackend(*reader, config);
+    return reader;
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,561 @@
+#include "TableExport.h"
+#include "RequestContext.h"
+#include "Tracer.h"
+#include <future>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef FOXBRIDGE_WITH_ARROW
+#include <arrow/api.h>
+#include <arrow/io/interfaces.h>
+#include <arrow/ipc/writer.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+#endif
+
+namespace FoxBridge {
+
+// Records per range: one record batch or row group, and one unit of work
+// for an export thread
+static constexpr uint32_t RANGE_RECORDS = 65536;
+
+TableExport::TableExport(std::shared_ptr<StorageBackend> backend, size_t threads,
+                         const std::string& parquet_compression)
+    : backend_(std::move(backend))
+    , parquet_compression_(parquet_compression)
+    , workers_(threads) {
+}
+
+bool TableExport::arrowAvailable() {
+#ifdef FOXBRIDGE_WITH_ARROW
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<RecordRange> TableExport::splitRecords(RecordRange span, uint32_t range_records) {
+    std::vector<RecordRange> ranges;
+    range_records = std::max<uint32_t>(range_records, 1);
+    for (uint64_t first = span.first; first <= span.last; first += range_records) {
+        uint64_t last = std::min<uint64_t>(span.last, first + range_records - 1);
+        ranges.push_back({static_cast<uint32_t>(first), static_cast<uint32_t>(last)});
+    }
+    if (ranges.empty()) {
+        ranges.push_back({span.first, span.first - 1});
+    }
+    return ranges;
+}
+
+RecordRange TableExport::partRange(uint32_t count, const ExportPart& part) {
+    uint64_t first = static_cast<uint64_t>(count) * part.index / part.count + 1;
+    uint64_t last = static_cast<uint64_t>(count) * (part.index + 1) / part.count;
+    return {static_cast<uint32_t>(first), static_cast<uint32_t>(last)};
+}
+
+uint32_t TableExport::recordCount(const std::string& filename) {
+    return backend_->recordCount(filename);
+}
+
+RecordRange TableExport::partSpan(const std::string& filename, const ExportPart& part) {
+    return partRange(part.records ? *part.records : backend_->recordCount(filename), part);
+}
+
+QueryResult TableExport::readPart(const std::string& filename, const ExportPart& part) {
+    RecordRange range;
+    try {
+        range = partSpan(filename, part);
+    } catch (const std::exception& e) {
+        QueryResult result;
+        result.success = false;
+        result.message = std::string("Error: ") + e.what();
+        result.index_status = IndexStatus::OK;
+        return result;
+    }
+    
+    TraceSpan span("export.part", std::to_string(range.first) + "-" + std::to_string(range.last));
+    return backend_->searchRange(filename, {}, range.first, range.last);
+}
+
+template <typename Batch>
+QueryResult TableExport::scanRanges(const std::string& filename,
+                                    const std::map<std::string, std::string>& filters,
+                                    const ExportPart& part,
+                                    const std::function<Batch(RowSet&)>& convert,
+                                    const std::function<void(Batch&)>& consume) {
+    QueryResult result;
+    result.success = false;
+    result.index_status = IndexStatus::OK;
+    
+    std::vector<RecordRange> ranges;
+    try {
+        ranges = splitRecords(partSpan(filename, part), RANGE_RECORDS);
+    } catch (const std::exception& e) {
+        result.message = std::string("Error: ") + e.what();
+        return result;
+    }
+    
+    // Ranges are read under the caller's request context, so they stop
+    // with it, and their spans join the caller's trace
+    auto context = RequestContext::current();
+    auto trace = RequestTrace::current();
+    uint64_t parent_span = RequestTrace::currentSpanId();
+    
+    struct Part {
+        QueryResult result;
+        Batch batch;
+    };
+    std::vector<std::future<Part>> parts(ranges.size());
+    size_t submitted = 0;
+    size_t collected = 0;
+    
+    // Tasks refer to this frame, so it is never left with one still queued
+    auto drain = [&] {
+        for (size_t i = collected; i < submitted; ++i) {
+            if (parts[i].valid()) {
+                parts[i].wait();
+            }
+        }
+    };
+    
+    auto submit = [&](size_t index) {
+        auto promise = std::make_shared<std::promise<Part>>();
+        parts[index] = promise->get_future();
+        workers_.submit([&, promise, range = ranges[index]] {
+            RequestContext::Scope scope(context);
+            RequestTrace::Scope trace_scope(trace, parent_span);
+            TraceSpan span("export.range", std::to_string(range.first) + "-" + std::to_string(range.last));
+            try {
+                Part part{backend_->searchRange(filename, filters, range.first, range.last), Batch{}};
+                if (part.result.success) {
+                    part.batch = convert(part.result.rows);
+                    part.result.rows = RowSet();
+                }
+                promise->set_value(std::move(part));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    };
+    
+    try {
+        // One range per export thread in flight ahead of the consumer
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            while (submitted < ranges.size() && submitted < i + workers_.threadCount()) {
+                submit(submitted++);
+            }
+            
+            collected = i;
+            Part part = parts[i].get();
+            collected = i + 1;
+            for (auto& warning : part.result.warnings) {
+                result.warnings.push_back(std::move(warning));
+            }
+            if (!part.result.success) {
+                drain();
+                result.message = part.result.message;
+                return result;
+            }
+            consume(part.batch);
+        }
+    } catch (...) {
+        drain();
+        throw;
+    }
+    
+    result.success = true;
+    result.message = "All records exported";
+    return result;
+}
+
+#ifdef FOXBRIDGE_WITH_ARROW
+
+// Arrow calls report errors as Status; here they become exceptions
+static void check(const arrow::Status& status) {
+    if (!status.ok()) {
+        throw std::runtime_error(status.ToString());
+    }
+}
+
+template <typename T>
+static T check(arrow::Result<T> result) {
+    check(result.status());
+    return std::move(result).ValueOrDie();
+}
+
+// Arrow type of a column. Whole numbers that fit become int64, other
+// numerics decimal128 with the field's width and decimals; memo columns
+// are text (references as their path, as in CSV).
+static std::shared_ptr<arrow::DataType> arrowType(const RowColumn& column) {
+    switch (column.type) {
+        case ColumnType::NUMERIC: {
+            if (column.decimals == 0 && column.size > 0 && column.size <= 18) {
+                return arrow::int64();
+            }
+            int32_t precision = column.size == 0 ? 38 :
+                                std::clamp<int32_t>(static_cast<int32_t>(column.size), 1, 38);
+            return arrow::decimal128(precision, std::min<int32_t>(column.decimals, precision));
+        }
+        case ColumnType::INTEGER:
+            return arrow::int32();
+        case ColumnType::DOUBLE:
+            return arrow::float64();
+        case ColumnType::DATE:
+            return arrow::date32();
+        case ColumnType::DATETIME:
+            return arrow::timestamp(arrow::TimeUnit::SECOND);
+        case ColumnType::LOGICAL:
+            return arrow::boolean();
+        case ColumnType::RECNO:
+            return arrow::uint32();
+        case ColumnType::OTHER:
+            return arrow::null();
+        case ColumnType::TEXT:
+        case ColumnType::MEMO:
+        default:
+            return arrow::utf8();
+    }
+}
+
+static std::shared_ptr<arrow::Schema> arrowSchema(const RowSchema& schema) {
+    arrow::FieldVector fields;
+    fields.reserve(schema.columns.size());
+    for (const auto& column : schema.columns) {
+        fields.push_back(arrow::field(column.name, arrowType(column)));
+    }
+    return arrow::schema(std::move(fields));
+}
+
+static std::string_view trimmed(std::string_view text) {
+    size_t begin = text.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    size_t end = text.find_last_not_of(' ');
+    return text.substr(begin, end - begin + 1);
+}
+
+template <typename T>
+static bool parseInteger(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+static bool parseDouble(std::string_view text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    std::string copy(text);
+    char* end = nullptr;
+    value = std::strtod(copy.c_str(), &end);
+    return end == copy.c_str() + copy.size();
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static int32_t daysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t year_of_era = static_cast<uint32_t>(year - era * 400);
+    uint32_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<int32_t>(day_of_era) - 719468;
+}
+
+// "YYYY-MM-DD", as both backends return dates
+static bool parseDate(std::string_view text, int32_t& days) {
+    int32_t year = 0;
+    uint32_t month = 0;
+    uint32_t day = 0;
+    if (text.size() < 10 || text[4] != '-' || text[7] != '-' ||
+        !parseInteger(text.substr(0, 4), year) || !parseInteger(text.substr(5, 2), month) ||
+        !parseInteger(text.substr(8, 2), day) || month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    days = daysFromCivil(year, month, day);
+    return true;
+}
+
+// "YYYY-MM-DD hh:mm:ss", fractions ignored, as seconds since the epoch
+static bool parseTimestamp(std::string_view text, int64_t& seconds) {
+    int32_t days = 0;
+    uint32_t hour = 0;
+    uint32_t minute = 0;
+    uint32_t second = 0;
+    if (!parseDate(text, days)) {
+        return false;
+    }
+    if (text.size() > 10 && (text.size() < 19 || text[13] != ':' || text[16] != ':' ||
+                             !parseInteger(text.substr(11, 2), hour) ||
+                             !parseInteger(text.substr(14, 2), minute) ||
+                             !parseInteger(text.substr(17, 2), second))) {
+        return false;
+    }
+    seconds = static_cast<int64_t>(days) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+static bool parseLogical(std::string_view text, bool& value) {
+    if (text.empty()) {
+        return false;
+    }
+    value = std::string_view("1TtYy").find(text[0]) != std::string_view::npos;
+    return value || std::string_view("0FfNn").find(text[0]) != std::string_view::npos;
+}
+
+static bool parseDecimal(std::string_view text, const arrow::Decimal128Type& type, arrow::Decimal128& value) {
+    int32_t precision = 0;
+    int32_t scale = 0;
+    if (!arrow::Decimal128::FromString(text, &value, &precision, &scale).ok()) {
+        return false;
+    }
+    auto rescaled = value.Rescale(scale, type.scale());
+    if (!rescaled.ok()) {
+        return false;
+    }
+    value = *rescaled;
+    return value.FitsInPrecision(type.precision());
+}
+
+// Appends column `column` of `rows` through `parse`; nulls and text that
+// does not parse (overflowed "***" numbers, blank dates) become nulls
+template <typename Builder, typename Value, typename Parse>
+static void appendParsed(arrow::ArrayBuilder& builder, const RowSet& rows, size_t column, Parse parse) {
+    auto& typed = static_cast<Builder&>(builder);
+    check(typed.Reserve(static_cast<int64_t>(rows.size())));
+    for (size_t row = 0; row < rows.size(); ++row) {
+        RowSet::CellView cell = rows.cell(row, column);
+        Value value{};
+        if (cell.kind == RowSet::CellKind::VALUE && parse(trimmed(cell.text), value)) {
+            check(typed.Append(value));
+        } else {
+            check(typed.AppendNull());
+        }
+    }
+}
+
+static void appendColumn(arrow::ArrayBuilder& builder, const RowSet& rows, size_t column) {
+    switch (builder.type()->id()) {
+        case arrow::Type::STRING: {
+            auto& strings = static_cast<arrow::StringBuilder&>(builder);
+            check(strings.Reserve(static_cast<int64_t>(rows.size())));
+            for (size_t row = 0; row < rows.size(); ++row) {
+                RowSet::CellView cell = rows.cell(row, column);
+                if (cell.kind == RowSet::CellKind::NULL_VALUE) {
+                    check(strings.AppendNull());
+                } else {
+                    check(strings.Append(cell.text));
+                }
+            }
+            break;
+        }
+        case arrow::Type::INT32:
+            appendParsed<arrow::Int32Builder, int32_t>(builder, rows, column, parseInteger<int32_t>);
+            break;
+        case arrow::Type::INT64:
+            appendParsed<arrow::Int64Builder, int64_t>(builder, rows, column, parseInteger<int64_t>);
+            break;
+        case arrow::Type::UINT32:
+            appendParsed<arrow::UInt32Builder, uint32_t>(builder, rows, column, parseInteger<uint32_t>);
+            break;
+        case arrow::Type::DOUBLE:
+            appendParsed<arrow::DoubleBuilder, double>(builder, rows, column, parseDouble);
+            break;
+        case arrow::Type::DATE32:
+            appendParsed<arrow::Date32Builder, int32_t>(builder, rows, column, parseDate);
+            break;
+        case arrow::Type::TIMESTAMP:
+            appendParsed<arrow::TimestampBuilder, int64_t>(builder, rows, column, parseTimestamp);
+            break;
+        case arrow::Type::BOOL:
+            appendParsed<arrow::BooleanBuilder, bool>(builder, rows, column, parseLogical);
+            break;
+        case arrow::Type::DECIMAL128: {
+            const auto& type = static_cast<const arrow::Decimal128Type&>(*builder.type());
+            appendParsed<arrow::Decimal128Builder, arrow::Decimal128>(builder, rows, column,
+                [&type](std::string_view text, arrow::Decimal128& value) {
+                    return parseDecimal(text, type, value);
+                });
+            break;
+        }
+        default:
+            check(builder.AppendNulls(static_cast<int64_t>(rows.size())));
+            break;
+    }
+}
+
+static std::shared_ptr<arrow::RecordBatch> toRecordBatch(const RowSet& rows) {
+    auto schema = arrowSchema(rows.schema());
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    columns.reserve(static_cast<size_t>(schema->num_fields()));
+    for (int i = 0; i < schema->num_fields(); ++i) {
+        std::unique_ptr<arrow::ArrayBuilder> builder = check(arrow::MakeBuilder(schema->field(i)->type()));
+        appendColumn(*builder, rows, static_cast<size_t>(i));
+        columns.push_back(check(builder->Finish()));
+    }
+    return arrow::RecordBatch::Make(schema, static_cast<int64_t>(rows.size()), std::move(columns));
+}
+
+// Collects what the IPC writer emits and passes it on in one piece per
+// Flush(), so a record batch goes out in one write instead of dozens
+class CallbackOutputStream : public arrow::io::OutputStream {
+public:
+    explicit CallbackOutputStream(const std::function<void(const char*, size_t)>& write)
+        : write_(write) {
+    }
+    
+    // Drops the next `bytes` written (a schema message already sent)
+    void skip(int64_t bytes) {
+        skip_ = bytes;
+    }
+    
+    arrow::Status Close() override {
+        ARROW_RETURN_NOT_OK(Flush());
+        closed_ = true;
+        return arrow::Status::OK();
+    }
+    
+    bool closed() const override { return closed_; }
+    arrow::Result<int64_t> Tell() const override { return position_; }
+    
+    using arrow::io::OutputStream::Write;
+    arrow::Status Write(const void* data, int64_t nbytes) override {
+        position_ += nbytes;
+        int64_t skipped = std::min(skip_, nbytes);
+        skip_ -= skipped;
+        pending_.append(static_cast<const char*>(data) + skipped, static_cast<size_t>(nbytes - skipped));
+        return arrow::Status::OK();
+    }
+    
+    arrow::Status Flush() override {
+        if (pending_.empty()) {
+            return arrow::Status::OK();
+        }
+        try {
+            write_(pending_.data(), pending_.size());
+        } catch (const std::exception& e) {
+            return arrow::Status::IOError(e.what());
+        }
+        pending_.clear();
+        return arrow::Status::OK();
+    }
+
+private:
+    const std::function<void(const char*, size_t)>& write_;
+    std::string pending_;
+    int64_t position_ = 0;
+    int64_t skip_ = 0;
+    bool closed_ = false;
+};
+
+static parquet::Compression::type parquetCodec(const std::string& name) {
+    if (name == "snappy") {
+        return parquet::Compression::SNAPPY;
+    }
+    if (name == "gzip") {
+        return parquet::Compression::GZIP;
+    }
+    if (name == "none") {
+        return parquet::Compression::UNCOMPRESSED;
+    }
+    return parquet::Compression::ZSTD;
+}
+
+#else
+
+static QueryResult arrowUnavailable() {
+    QueryResult result;
+    result.success = false;
+    result.message = "Arrow and Parquet exports need a build with FOXBRIDGE_WITH_ARROW";
+    result.index_status = IndexStatus::OK;
+    return result;
+}
+
+#endif
+
+QueryResult TableExport::writeArrow(const std::string& filename, const std::map<std::string, std::string>& filters,
+                                    const std::function<void(const char*, size_t)>& write,
+                                    const ExportPart& part) {
+#ifdef FOXBRIDGE_WITH_ARROW
+    using Batch = std::shared_ptr<arrow::RecordBatch>;
+    QueryResult result;
+    try {
+        auto sink = std::make_shared<CallbackOutputStream>(write);
+        std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+        
+        result = scanRanges<Batch>(filename, filters, part, toRecordBatch, [&](Batch& batch) {
+            TraceSpan span("arrow.write");
+            if (!writer) {
+                // Later parts leave out the schema message the first one sent
+                if (!part.first()) {
+                    sink->skip(check(arrow::ipc::SerializeSchema(*batch->schema()))->size());
+                }
+                writer = check(arrow::ipc::MakeStreamWriter(sink, batch->schema()));
+            }
+            check(writer->WriteRecordBatch(*batch));
+            check(sink->Flush());
+        });
+        if (result.success && part.last()) {
+            check(writer->Close());
+        }
+        if (result.success) {
+            check(sink->Close());
+        }
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.message = std::string("Error: ") + e.what();
+    }
+    return result;
+#else
+    (void)filename;
+    (void)filters;
+    (void)write;
+    (void)part;
+    return arrowUnavailable();
+#endif
+}
+
+QueryResult TableExport::writeParquet(const std::string& filename, const std::map<std::string, std::string>& filters,
+                                      const std::function<void(const char*, size_t)>& write,
+                                      const ExportPart& part) {
+#ifdef FOXBRIDGE_WITH_ARROW
+    using Batch = std::shared_ptr<arrow::RecordBatch>;
+    QueryResult result;
+    try {
+        auto sink = std::make_shared<CallbackOutputStream>(write);
+        auto properties = parquet::WriterProperties::Builder()
+                              .compression(parquetCodec(parquet_compression_))
+                              ->build();
+        std::unique_ptr<parquet::arrow::FileWriter> writer;
+        
+        // One row group per range, written out as soon as it is encoded
+        result = scanRanges<Batch>(filename, filters, part, toRecordBatch, [&](Batch& batch) {
+            TraceSpan span("parquet.write");
+            if (!writer) {
+                writer = check(parquet::arrow::FileWriter::Open(*batch->schema(), arrow::default_memory_pool(),
+                                                                sink, properties));
+            }
+            auto table = check(arrow::Table::FromRecordBatches(batch->schema(), {batch}));
+            check(writer->WriteTable(*table, RANGE_RECORDS));
+            check(sink->Flush());
+        });
+        if (result.success) {
+            // The footer goes last; without it the file is unreadable
+            check(writer->Close());
+            check(sink->Close());
+        }
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.message = std::string("Error: ") + e.what();
+    }
+    return result;
+#else
+    (void)filename;
+    (void)filters;
+    (void)write;
+    (void)part;
+    return arrowUnavailable();
+#endif
+}
+
+} // namespace FoxBridge
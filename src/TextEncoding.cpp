@@ -0,0 +1,241 @@
+#include "TextEncoding.h"
+#include <array>
+#include <bit>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FOXBRIDGE_SSE2 1
+#endif
+
+namespace FoxBridge {
+
+// Upper halves (0x80-0xFF) of the code pages as Unicode; 0 = undefined
+static constexpr std::array<uint16_t, 128> CP874_HIGH = [] {
+    std::array<uint16_t, 128> map{};
+    map[0x80 - 0x80] = 0x20AC;
+    map[0x85 - 0x80] = 0x2026;
+    map[0x91 - 0x80] = 0x2018;
+    map[0x92 - 0x80] = 0x2019;
+    map[0x93 - 0x80] = 0x201C;
+    map[0x94 - 0x80] = 0x201D;
+    map[0x95 - 0x80] = 0x2022;
+    map[0x96 - 0x80] = 0x2013;
+    map[0x97 - 0x80] = 0x2014;
+    map[0xA0 - 0x80] = 0x00A0;
+    for (int b = 0xA1; b <= 0xDA; ++b) map[b - 0x80] = static_cast<uint16_t>(0x0E01 + (b - 0xA1));
+    for (int b = 0xDF; b <= 0xFB; ++b) map[b - 0x80] = static_cast<uint16_t>(0x0E3F + (b - 0xDF));
+    return map;
+}();
+
+static constexpr std::array<uint16_t, 128> CP1252_HIGH = [] {
+    std::array<uint16_t, 128> map{};
+    constexpr uint16_t c1[32] = {
+        0x20AC, 0,      0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+        0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0,      0x017D, 0,
+        0,      0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+        0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0,      0x017E, 0x0178
+    };
+    for (int b = 0; b < 32; ++b) map[b] = c1[b];
+    for (int b = 0xA0; b <= 0xFF; ++b) map[b - 0x80] = static_cast<uint16_t>(b);
+    return map;
+}();
+
+// One byte's UTF-8 form, at most three bytes for the BMP
+struct Utf8Sequence {
+    char bytes[3];
+    uint8_t length;
+};
+
+using DecodeTable = std::array<Utf8Sequence, 256>;
+
+static DecodeTable buildDecodeTable(const std::array<uint16_t, 128>& high) {
+    DecodeTable table{};
+    for (int b = 0; b < 256; ++b) {
+        uint32_t cp = b < 0x80 ? static_cast<uint32_t>(b) : high[b - 0x80];
+        if (b >= 0x80 && cp == 0) {
+            cp = 0xFFFD;
+        }
+        Utf8Sequence& seq = table[b];
+        if (cp < 0x80) {
+            seq = {{static_cast<char>(cp), 0, 0}, 1};
+        } else if (cp < 0x800) {
+            seq = {{static_cast<char>(0xC0 | (cp >> 6)), static_cast<char>(0x80 | (cp & 0x3F)), 0}, 2};
+        } else {
+            seq = {{static_cast<char>(0xE0 | (cp >> 12)), static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+                    static_cast<char>(0x80 | (cp & 0x3F))}, 3};
+        }
+    }
+    return table;
+}
+
+static const DecodeTable& decodeTable(TextEncoding encoding) {
+    static const DecodeTable cp874 = buildDecodeTable(CP874_HIGH);
+    static const DecodeTable cp1252 = buildDecodeTable(CP1252_HIGH);
+    return encoding == TextEncoding::CP874 ? cp874 : cp1252;
+}
+
+static const std::unordered_map<uint32_t, char>& encodeTable(TextEncoding encoding) {
+    auto build = [](const std::array<uint16_t, 128>& high) {
+        std::unordered_map<uint32_t, char> table;
+        for (int b = 0; b < 128; ++b) {
+            if (high[b] != 0) {
+                table.emplace(high[b], static_cast<char>(0x80 + b));
+            }
+        }
+        return table;
+    };
+    static const auto cp874 = build(CP874_HIGH);
+    static const auto cp1252 = build(CP1252_HIGH);
+    return encoding == TextEncoding::CP874 ? cp874 : cp1252;
+}
+
+// Length of the leading run of ASCII bytes
+static size_t asciiRun(const char* data, size_t size) {
+    size_t i = 0;
+#ifdef FOXBRIDGE_SSE2
+    for (; i + 32 <= size; i += 32) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) {
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(a)) |
+                            (static_cast<unsigned>(_mm_movemask_epi8(b)) << 16);
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    for (; i + 16 <= size; i += 16) {
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+    // Eight bytes per step where SSE2 is unavailable, and for the tail
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+    while (i < size && !(static_cast<unsigned char>(data[i]) & 0x80)) {
+        ++i;
+    }
+    return i;
+}
+
+bool encodingFromLanguageDriver(uint8_t language_driver, TextEncoding& encoding) {
+    switch (language_driver) {
+        case 0x50:      // Thai OEM
+        case 0x7C:      // Thai Windows
+            encoding = TextEncoding::CP874;
+            return true;
+        case 0x03:      // Windows ANSI
+        case 0x57:
+        case 0x58:
+            encoding = TextEncoding::CP1252;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool parseTextEncoding(const std::string& name, TextEncoding& encoding) {
+    std::string key = name;
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (key == "cp874" || key == "tis-620" || key == "tis620" || key == "windows-874") {
+        encoding = TextEncoding::CP874;
+    } else if (key == "cp1252" || key == "windows-1252") {
+        encoding = TextEncoding::CP1252;
+    } else if (key == "utf-8" || key == "utf8") {
+        encoding = TextEncoding::UTF8;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* textEncodingName(TextEncoding encoding) {
+    switch (encoding) {
+        case TextEncoding::CP874: return "cp874";
+        case TextEncoding::CP1252: return "cp1252";
+        default: return "utf-8";
+    }
+}
+
+void appendUtf8(std::string& out, std::string_view text, TextEncoding encoding) {
+    if (encoding == TextEncoding::UTF8) {
+        out.append(text);
+        return;
+    }
+    
+    const char* in = text.data();
+    size_t size = text.size();
+    size_t run = asciiRun(in, size);
+    if (run == size) {
+        out.append(text);
+        return;
+    }
+    
+    // Worst case three output bytes per input byte; trimmed afterwards
+    const DecodeTable& table = decodeTable(encoding);
+    size_t start = out.size();
+    out.resize(start + run + (size - run) * 3);
+    char* dst = out.data() + start;
+    std::memcpy(dst, in, run);
+    dst += run;
+    
+    // 16-byte blocks: all-ASCII blocks are copied whole, the rest go
+    // through the table a byte at a time (ASCII entries map to themselves)
+    size_t i = run;
+    while (i < size) {
+        size_t block = std::min<size_t>(16, size - i);
+        if (block == 16 && asciiRun(in + i, 16) == 16) {
+            std::memcpy(dst, in + i, 16);
+            dst += 16;
+            i += 16;
+            continue;
+        }
+        for (size_t end = i + block; i < end; ++i) {
+            const Utf8Sequence& seq = table[static_cast<unsigned char>(in[i])];
+            std::memcpy(dst, seq.bytes, 3);     // Over-copy is fine: capacity is there
+            dst += seq.length;
+        }
+    }
+    out.resize(static_cast<size_t>(dst - out.data()));
+}
+
+std::string fromUtf8(std::string_view text, TextEncoding encoding) {
+    if (encoding == TextEncoding::UTF8 || asciiRun(text.data(), text.size()) == text.size()) {
+        return std::string(text);
+    }
+    
+    const auto& table = encodeTable(encoding);
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        if (lead < 0x80) {
+            out.push_back(static_cast<char>(lead));
+            ++i;
+            continue;
+        }
+        
+        size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        uint32_t cp = length == 1 ? 0 : lead & (0x7F >> length);
+        for (size_t k = 1; k < length && i + k < text.size(); ++k) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        }
+        i += length;
+        
+        auto it = table.find(cp);
+        out.push_back(it != table.end() ? it->second : '?');
+    }
+    return out;
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,415 @@
+#include "Tracer.h"
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+namespace FoxBridge {
+
+namespace {
+
+thread_local std::shared_ptr<RequestTrace> t_current_trace;
+thread_local uint64_t t_current_span_id = 0;
+
+std::mt19937_64& threadRandom() {
+    thread_local std::mt19937_64 engine(std::random_device{}() ^
+                                        std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return engine;
+}
+
+// Small sequential ids read better than std::thread::id hashes in trace viewers
+uint64_t traceThreadId() {
+    static std::atomic<uint64_t> next_id{0};
+    thread_local uint64_t id = ++next_id;
+    return id;
+}
+
+// Span timestamps use the steady clock; files need wall-clock time
+int64_t toUnixMicros(std::chrono::steady_clock::time_point point) {
+    static const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch() -
+        std::chrono::steady_clock::now().time_since_epoch());
+    return (std::chrono::duration_cast<std::chrono::microseconds>(point.time_since_epoch()) + offset).count();
+}
+
+int64_t micros(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+std::string hex(uint64_t value, int digits) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%0*llx", digits, static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+} // namespace
+
+RequestTrace::RequestTrace(std::string name, Clock::time_point start)
+    : name_(std::move(name))
+    , trace_id_(hex(threadRandom()(), 16) + hex(threadRandom()(), 16)) {
+    
+    SpanRecord root;
+    root.name = name_;
+    root.span_id = ROOT_SPAN_ID;
+    root.start = start;
+    root.end = start;
+    root.thread_id = traceThreadId();
+    spans_.push_back(std::move(root));
+}
+
+void RequestTrace::addSpan(const std::string& name, Clock::time_point start, Clock::time_point end) {
+    SpanRecord span;
+    span.name = name;
+    span.span_id = nextSpanId();
+    span.parent_id = ROOT_SPAN_ID;
+    span.start = start;
+    span.end = end;
+    span.thread_id = traceThreadId();
+    addSpan(std::move(span));
+}
+
+void RequestTrace::addSpan(SpanRecord span) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.push_back(std::move(span));
+}
+
+void RequestTrace::finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.front().end = Clock::now();
+}
+
+std::vector<SpanRecord> RequestTrace::spans() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return spans_;
+}
+
+std::string RequestTrace::serverTiming() {
+    std::vector<std::pair<std::string, int64_t>> totals;
+    Clock::time_point start;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        start = spans_.front().start;
+        for (size_t i = 1; i < spans_.size(); ++i) {
+            const auto& span = spans_[i];
+            auto it = std::find_if(totals.begin(), totals.end(),
+                                   [&span](const auto& total) { return total.first == span.name; });
+            if (it == totals.end()) {
+                totals.emplace_back(span.name, micros(span.end - span.start));
+            } else {
+                it->second += micros(span.end - span.start);
+            }
+        }
+    }
+    totals.emplace_back("total", micros(Clock::now() - start));
+    
+    std::string header;
+    char duration[32];
+    for (const auto& [name, total_us] : totals) {
+        std::snprintf(duration, sizeof(duration), ";dur=%.3f", total_us / 1000.0);
+        if (!header.empty()) {
+            header += ", ";
+        }
+        header += name + duration;
+    }
+    return header;
+}
+
+std::shared_ptr<RequestTrace> RequestTrace::current() {
+    return t_current_trace;
+}
+
+uint64_t RequestTrace::currentSpanId() {
+    return t_current_span_id;
+}
+
+RequestTrace::Scope::Scope(std::shared_ptr<RequestTrace> trace, uint64_t parent_span_id)
+    : previous_(std::move(t_current_trace))
+    , previous_span_id_(t_current_span_id) {
+    t_current_trace = std::move(trace);
+    t_current_span_id = parent_span_id;
+}
+
+RequestTrace::Scope::~Scope() {
+    t_current_trace = std::move(previous_);
+    t_current_span_id = previous_span_id_;
+}
+
+TraceSpan::TraceSpan(const char* name, std::string detail)
+    : trace_(t_current_trace.get())
+    , name_(name) {
+    
+    if (!trace_) {
+        return;
+    }
+    
+    detail_ = std::move(detail);
+    span_id_ = trace_->nextSpanId();
+    parent_id_ = t_current_span_id;
+    t_current_span_id = span_id_;
+    start_ = RequestTrace::Clock::now();
+}
+
+void TraceSpan::end() {
+    if (!trace_) {
+        return;
+    }
+    
+    SpanRecord span;
+    span.name = name_;
+    span.detail = std::move(detail_);
+    span.span_id = span_id_;
+    span.parent_id = parent_id_;
+    span.start = start_;
+    span.end = RequestTrace::Clock::now();
+    span.thread_id = traceThreadId();
+    trace_->addSpan(std::move(span));
+    
+    t_current_span_id = parent_id_;
+    trace_ = nullptr;
+}
+
+Tracer::Tracer(double sample_rate, const std::string& output_dir, const std::string& format,
+               std::chrono::seconds flush_interval, size_t capacity)
+    : sample_rate_(sample_rate)
+    , output_dir_(output_dir)
+    , format_(format)
+    , flush_interval_(flush_interval)
+    , ring_(capacity > 0 ? capacity : 1)
+    , running_(false) {
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+void Tracer::start() {
+    if (running_) {
+        return;
+    }
+    
+    running_ = true;
+    flush_thread_ = std::make_unique<std::thread>(&Tracer::flushLoop, this);
+    spdlog::info("Request tracing: sample rate {}, {} files in {}", sample_rate_, format_, output_dir_);
+}
+
+void Tracer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    flush_cv_.notify_all();
+    
+    if (flush_thread_ && flush_thread_->joinable()) {
+        flush_thread_->join();
+    }
+    
+    // Write whatever finished since the last periodic flush
+    flush();
+}
+
+std::shared_ptr<RequestTrace> Tracer::begin(const std::string& name,
+                                            RequestTrace::Clock::time_point start, bool force) {
+    if (!force) {
+        if (sample_rate_ <= 0.0) {
+            return nullptr;
+        }
+        if (sample_rate_ < 1.0 &&
+            std::uniform_real_distribution<double>(0.0, 1.0)(threadRandom()) >= sample_rate_) {
+            return nullptr;
+        }
+    }
+    return std::make_shared<RequestTrace>(name, start);
+}
+
+void Tracer::finish(std::shared_ptr<RequestTrace> trace) {
+    if (!trace) {
+        return;
+    }
+    trace->finish();
+    
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    ring_[pushed_ % ring_.size()] = std::move(trace);
+    ++pushed_;
+}
+
+bool Tracer::find(const std::string& trace_id, nlohmann::json& chrome_trace) {
+    std::shared_ptr<RequestTrace> found;
+    {
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        for (const auto& trace : ring_) {
+            if (trace && trace->traceId() == trace_id) {
+                found = trace;
+                break;
+            }
+        }
+    }
+    
+    if (!found) {
+        return false;
+    }
+    chrome_trace = toChromeTrace({found});
+    return true;
+}
+
+nlohmann::json Tracer::stats() {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    return {
+        {"sample_rate", sample_rate_},
+        {"format", format_},
+        {"output_dir", output_dir_},
+        {"buffer_capacity", ring_.size()},
+        {"traces_finished", pushed_},
+        {"traces_dropped", dropped_},
+        {"files_written", files_written_}
+    };
+}
+
+nlohmann::json Tracer::toChromeTrace(const std::vector<std::shared_ptr<RequestTrace>>& traces) {
+    nlohmann::json events = nlohmann::json::array();
+    
+    for (const auto& trace : traces) {
+        for (const auto& span : trace->spans()) {
+            nlohmann::json args = {
+                {"trace_id", trace->traceId()},
+                {"span_id", span.span_id},
+                {"parent_id", span.parent_id}
+            };
+            if (!span.detail.empty()) {
+                args["detail"] = span.detail;
+            }
+            
+            events.push_back({
+                {"name", span.name},
+                {"cat", span.parent_id == 0 ? "request" : "phase"},
+                {"ph", "X"},
+                {"ts", toUnixMicros(span.start)},
+                {"dur", micros(span.end - span.start)},
+                {"pid", 1},
+                {"tid", span.thread_id},
+                {"args", args}
+            });
+        }
+    }
+    
+    return {
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"}
+    };
+}
+
+nlohmann::json Tracer::toOtlp(const std::vector<std::shared_ptr<RequestTrace>>& traces) {
+    nlohmann::json spans = nlohmann::json::array();
+    
+    // Span ids only need to be unique within a trace; prefix them with part
+    // of the trace id anyway so merged files stay unambiguous
+    for (const auto& trace : traces) {
+        std::string prefix = trace->traceId().substr(24);
+        
+        for (const auto& span : trace->spans()) {
+            nlohmann::json otlp_span = {
+                {"traceId", trace->traceId()},
+                {"spanId", prefix + hex(span.span_id, 8)},
+                {"name", span.name},
+                {"kind", span.parent_id == 0 ? 2 : 1},     // SERVER : INTERNAL
+                {"startTimeUnixNano", std::to_string(toUnixMicros(span.start) * 1000)},
+                {"endTimeUnixNano", std::to_string(toUnixMicros(span.end) * 1000)},
+                {"attributes", nlohmann::json::array()}
+            };
+            if (span.parent_id != 0) {
+                otlp_span["parentSpanId"] = prefix + hex(span.parent_id, 8);
+            }
+            if (!span.detail.empty()) {
+                otlp_span["attributes"].push_back({
+                    {"key", "foxbridge.detail"},
+                    {"value", {{"stringValue", span.detail}}}
+                });
+            }
+            spans.push_back(otlp_span);
+        }
+    }
+    
+    return {
+        {"resourceSpans", nlohmann::json::array({{
+            {"resource", {
+                {"attributes", nlohmann::json::array({{
+                    {"key", "service.name"},
+                    {"value", {{"stringValue", "FoxBridgeAgent"}}}
+                }})}
+            }},
+            {"scopeSpans", nlohmann::json::array({{
+                {"scope", {{"name", "foxbridge"}, {"version", "1.0.0"}}},
+                {"spans", spans}
+            }})}
+        }})}
+    };
+}
+
+void Tracer::flushLoop() {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    
+    while (running_) {
+        flush_cv_.wait_for(lock, flush_interval_, [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+        
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void Tracer::flush() {
+    std::vector<std::shared_ptr<RequestTrace>> batch;
+    {
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        
+        uint64_t oldest_kept = pushed_ > ring_.size() ? pushed_ - ring_.size() : 0;
+        if (flushed_ < oldest_kept) {
+            dropped_ += oldest_kept - flushed_;
+            flushed_ = oldest_kept;
+        }
+        
+        for (; flushed_ < pushed_; ++flushed_) {
+            batch.push_back(ring_[flushed_ % ring_.size()]);
+        }
+    }
+    
+    if (batch.empty()) {
+        return;
+    }
+    
+    try {
+        std::filesystem::create_directories(output_dir_);
+        
+        std::time_t now = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+        
+        uint64_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(ring_mutex_);
+            sequence = ++files_written_;
+        }
+        
+        std::filesystem::path path = std::filesystem::path(output_dir_) /
+            (std::string(format_ == "otlp" ? "otlp-" : "trace-") + stamp + "-" +
+             std::to_string(sequence) + ".json");
+        
+        std::ofstream file(path, std::ios::binary);
+        file << (format_ == "otlp" ? toOtlp(batch) : toChromeTrace(batch)).dump();
+        
+        spdlog::debug("Wrote {} request trace(s) to {}", batch.size(), path.string());
+    
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to write request traces: {}", e.what());
+    }
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,83 @@
+#include "WorkerPool.h"
+#include <spdlog/spdlog.h>
+
+namespace FoxBridge {
+
+WorkerPool::WorkerPool(size_t thread_count)
+    : running_(true) {
+    
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    
+    threads_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_) {
+            return;
+        }
+        task_queue_.push(std::move(task));
+    }
+    queue_cv_.notify_one();
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    queue_cv_.notify_all();
+    
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+size_t WorkerPool::queueDepth() {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return task_queue_.size();
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] {
+                return !task_queue_.empty() || !running_;
+            });
+            
+            // Drain remaining tasks before exiting so waiters are released
+            if (task_queue_.empty()) {
+                return;
+            }
+            
+            task = std::move(task_queue_.front());
+            task_queue_.pop();
+        }
+        
+        try {
+            task();
+        } catch (const std::exception& e) {
+            spdlog::error("Worker task failed: {}", e.what());
+        }
+    }
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,241 @@
+#include "WriteBehindQueue.h"
+#include <spdlog/spdlog.h>
+#include <sstream>
+#include <iomanip>
+
+namespace FoxBridge {
+
+// Finished job statuses kept for the status endpoint
+static constexpr size_t MAX_FINISHED_JOBS = 10000;
+
+WriteBehindQueue::WriteBehindQueue(std::shared_ptr<StorageBackend> db_manager,
+                                   size_t batch_size,
+                                   std::chrono::milliseconds linger,
+                                   size_t max_pending)
+    : db_manager_(db_manager)
+    , batch_size_(std::max<size_t>(batch_size, 1))
+    , linger_(linger)
+    , max_pending_(max_pending)
+    , running_(false) {
+}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    stop();
+}
+
+void WriteBehindQueue::start() {
+    if (running_) {
+        return;
+    }
+    
+    running_ = true;
+    worker_thread_ = std::make_unique<std::thread>(&WriteBehindQueue::workerLoop, this);
+    spdlog::info("Write-behind worker started (batch size {}, linger {}ms)", 
+                 batch_size_, linger_.count());
+}
+
+void WriteBehindQueue::stop() {
+    if (!running_) {
+        return;
+    }
+    
+    running_ = false;
+    queue_cv_.notify_all();
+    
+    if (worker_thread_ && worker_thread_->joinable()) {
+        worker_thread_->join();
+    }
+    
+    spdlog::info("Write-behind worker stopped");
+}
+
+std::string WriteBehindQueue::enqueue(const std::string& table, WriteOperation operation) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    
+    if (pending_count_ >= max_pending_) {
+        return "";
+    }
+    
+    uint64_t sequence = next_job_++;
+    std::ostringstream id;
+    id << "wb-" << std::hex << std::setw(8) << std::setfill('0') 
+       << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
+       << '-' << std::dec << sequence;
+    
+    WriteJobStatus status;
+    status.table = table;
+    status.operation = operationName(operation.type);
+    status.submitted_at = std::chrono::system_clock::now();
+    jobs_.emplace(id.str(), std::move(status));
+    
+    table_queues_[table].push_back(WriteJob{id.str(), table, std::move(operation), sequence});
+    ++pending_count_;
+    queue_cv_.notify_one();
+    
+    return id.str();
+}
+
+bool WriteBehindQueue::getStatus(const std::string& job_id, nlohmann::json& status) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    
+    const auto& job = it->second;
+    status = {
+        {"job_id", job_id},
+        {"table", job.table},
+        {"operation", job.operation},
+        {"state", stateName(job.state)},
+        {"message", job.message},
+        {"data", job.data},
+        {"batch_size", job.batch_size},
+        {"submitted_at", std::chrono::system_clock::to_time_t(job.submitted_at)},
+        {"finished_at", nullptr}
+    };
+    if (job.state == WriteJobState::SUCCEEDED || job.state == WriteJobState::FAILED) {
+        status["finished_at"] = std::chrono::system_clock::to_time_t(job.finished_at);
+    }
+    return true;
+}
+
+nlohmann::json WriteBehindQueue::stats() {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    
+    nlohmann::json tables = nlohmann::json::object();
+    for (const auto& [table, queue] : table_queues_) {
+        tables[table] = queue.size();
+    }
+    
+    return {
+        {"pending", pending_count_},
+        {"tables", tables},
+        {"batches_applied", batches_applied_},
+        {"jobs_succeeded", jobs_succeeded_},
+        {"jobs_failed", jobs_failed_}
+    };
+}
+
+void WriteBehindQueue::workerLoop() {
+    while (true) {
+        std::string table;
+        std::vector<WriteJob> batch;
+        
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] {
+                return pending_count_ > 0 || !running_;
+            });
+            
+            // Accepted writes are applied before shutting down
+            if (pending_count_ == 0) {
+                return;
+            }
+            
+            // Give concurrent writers a moment to join the batch
+            if (running_ && linger_.count() > 0) {
+                queue_cv_.wait_for(lock, linger_, [this] { return !running_.load(); });
+            }
+            
+            // The table whose next write has waited longest: a busy table
+            // that keeps refilling still lets a quiet one have its turn
+            auto oldest = table_queues_.begin();
+            for (auto it = table_queues_.begin(); it != table_queues_.end(); ++it) {
+                if (it->second.front().sequence < oldest->second.front().sequence) {
+                    oldest = it;
+                }
+            }
+            
+            table = oldest->first;
+            auto& queue = oldest->second;
+            while (!queue.empty() && batch.size() < batch_size_) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+                jobs_[batch.back().id].state = WriteJobState::RUNNING;
+            }
+            if (queue.empty()) {
+                table_queues_.erase(oldest);
+            }
+            pending_count_ -= batch.size();
+        }
+        
+        applyBatch(table, batch);
+    }
+}
+
+void WriteBehindQueue::applyBatch(const std::string& table, std::vector<WriteJob>& batch) {
+    std::vector<WriteOperation> operations;
+    operations.reserve(batch.size());
+    for (const auto& job : batch) {
+        operations.push_back(job.operation);
+    }
+    
+    std::vector<QueryResult> results;
+    try {
+        results = db_manager_->applyWriteBatch(table, operations);
+    } catch (const std::exception& e) {
+        spdlog::error("Write-behind batch on {} failed: {}", table, e.what());
+    }
+    
+    size_t failed = 0;
+    auto now = std::chrono::system_clock::now();
+    
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    ++batches_applied_;
+    
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto& status = jobs_[batch[i].id];
+        status.batch_size = batch.size();
+        status.finished_at = now;
+        
+        if (i < results.size() && results[i].success) {
+            status.state = WriteJobState::SUCCEEDED;
+            status.message = results[i].message;
+            status.data = results[i].data;
+            ++jobs_succeeded_;
+        } else {
+            status.state = WriteJobState::FAILED;
+            status.message = i < results.size() ? results[i].message : "Write batch failed";
+            ++jobs_failed_;
+            ++failed;
+        }
+        
+        finished_jobs_.push_back(batch[i].id);
+    }
+    
+    while (finished_jobs_.size() > MAX_FINISHED_JOBS) {
+        jobs_.erase(finished_jobs_.front());
+        finished_jobs_.pop_front();
+    }
+    
+    if (failed > 0) {
+        spdlog::warn("Write-behind batch on {}: {} of {} operation(s) failed", 
+                     table, failed, batch.size());
+    } else {
+        spdlog::debug("Write-behind batch on {}: {} operation(s) applied", table, batch.size());
+    }
+}
+
+const char* WriteBehindQueue::operationName(WriteOperation::Type type) {
+    switch (type) {
+        case WriteOperation::Type::ADD:      return "add";
+        case WriteOperation::Type::UPDATE:   return "update";
+        case WriteOperation::Type::DELETE:   return "delete";
+        case WriteOperation::Type::UNDELETE: return "undelete";
+        default:                             return "unknown";
+    }
+}
+
+const char* WriteBehindQueue::stateName(WriteJobState state) {
+    switch (state) {
+        case WriteJobState::QUEUED:    return "queued";
+        case WriteJobState::RUNNING:   return "running";
+        case WriteJobState::SUCCEEDED: return "succeeded";
+        case WriteJobState::FAILED:    return "failed";
+        default:                       return "unknown";
+    }
+}
+
+} // namespace FoxBridge
@@ -1,12 +1,15 @@
 #include "Config.h"
-#include "DatabaseManager.h"
+#include "StorageBackend.h"
 #include "HttpServer.h"
-#include "WindowsService.h"
+#include "Platform.h"
 #include "CloudflareTunnel.h"
 #include "IndexMaintenance.h"
+#include "Metrics.h"
+#include "QueryStats.h"
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/async.h>
 #include <memory>
 #include <iostream>
 #include <filesystem>
@@ -14,7 +17,7 @@
 using namespace FoxBridge;
 
 // Global instances
-std::shared_ptr<DatabaseManager> g_db_manager;
+std::shared_ptr<StorageBackend> g_storage;
 std::shared_ptr<HttpServer> g_http_server;
 std::shared_ptr<CloudflareTunnel> g_tunnel;
 std::shared_ptr<IndexMaintenance> g_maintenance;
@@ -23,11 +26,12 @@ Config g_config;
 void initializeLogging(const Config& config) {
     try {
         // Create logs directory
-        std::filesystem::create_directories(config.log_path);
+        std::filesystem::path log_path(config.log_path);
+        std::filesystem::create_directories(log_path);
         
         // Rotating file sink
         auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-            config.log_path + "\\foxbridge.log", 
+            (log_path / "foxbridge.log").string(),
             1024 * 1024 * 10,  // 10MB
             5                   // 5 files
         );
@@ -35,9 +39,24 @@ void initializeLogging(const Config& config) {
         // Console sink
         auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
         
-        // Create logger with both sinks
+        // Create logger with both sinks. In async mode request threads only
+        // enqueue; one background thread formats and writes to the sinks.
         std::vector<spdlog::sink_ptr> sinks = {file_sink, console_sink};
-        auto logger = std::make_shared<spdlog::logger>("foxbridge", sinks.begin(), sinks.end());
+        std::shared_ptr<spdlog::logger> logger;
+        if (config.log_async) {
+            spdlog::init_thread_pool(static_cast<size_t>(config.log_queue_size), 1);
+            auto policy = config.log_overflow_policy == "drop_oldest" ?
+                          spdlog::async_overflow_policy::overrun_oldest :
+                          spdlog::async_overflow_policy::block;
+            logger = std::make_shared<spdlog::async_logger>("foxbridge", sinks.begin(), sinks.end(),
+                                                            spdlog::thread_pool(), policy);
+            
+            // Warnings and errors still reach disk within a second
+            spdlog::flush_every(std::chrono::seconds(1));
+        } else {
+            logger = std::make_shared<spdlog::logger>("foxbridge", sinks.begin(), sinks.end());
+        }
+        logger->flush_on(spdlog::level::err);
         
         // Set as default logger
         spdlog::set_default_logger(logger);
@@ -53,6 +72,20 @@ void initializeLogging(const Config& config) {
             spdlog::set_level(spdlog::level::err);
         }
         
+        // Slow statements go to their own file so they are not lost in the
+        // request log; it keeps its own level regardless of log_level
+        auto slow_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            (log_path / "slow_query.log").string(),
+            1024 * 1024 * 10,  // 10MB
+            3                   // 3 files
+        );
+        auto slow_logger = std::make_shared<spdlog::logger>("slow_query", slow_sink);
+        slow_logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] %v");
+        slow_logger->set_level(spdlog::level::info);
+        QueryStats::instance().configure(std::chrono::milliseconds(config.slow_query_threshold_ms),
+                                         slow_logger,
+                                         static_cast<size_t>(config.query_stats_max_fingerprints));
+        
         spdlog::info("Logging initialized: {}", config.log_path);
         
     } catch (const std::exception& e) {
@@ -66,18 +99,19 @@ void startApplication() {
         spdlog::info("Version: 1.0.0");
         spdlog::info("Database Path: {}", g_config.database_path);
         spdlog::info("HTTP Port: {}", g_config.port);
+        spdlog::info("Storage Backend: {}", g_config.storage_backend);
         
-        // 1. Initialize Database Manager
-        spdlog::info("Initializing Database Manager...");
-        g_db_manager = std::make_shared<DatabaseManager>(g_config.database_path);
+        // 1. Initialize storage backend
+        spdlog::info("Initializing Storage Backend...");
+        g_storage = createStorageBackend(g_config);
         
-        if (!g_db_manager->isConnected()) {
+        if (!g_storage->isConnected()) {
             throw std::runtime_error("Failed to connect to database");
         }
         
         // 2. Initialize HTTP Server
         spdlog::info("Initializing HTTP Server...");
-        g_http_server = std::make_shared<HttpServer>(g_config, g_db_manager);
+        g_http_server = std::make_shared<HttpServer>(g_config, g_storage);
         g_http_server->start();
         
         // 3. Initialize Cloudflare Tunnel
@@ -96,10 +130,16 @@ void startApplication() {
         
         // 4. Initialize Index Maintenance
         spdlog::info("Initializing Index Maintenance...");
-        g_maintenance = std::make_shared<IndexMaintenance>(g_db_manager, 
+        g_maintenance = std::make_shared<IndexMaintenance>(g_storage, 
                                                            g_config.maintenance_window);
         g_maintenance->start();
         
+        auto maintenance = g_maintenance;
+        Metrics::instance().registerCallback("foxbridge_maintenance_queue_depth",
+                                             "Index maintenance tasks waiting to run",
+                                             Metrics::CallbackType::GAUGE,
+                                             [maintenance] { return static_cast<double>(maintenance->queueDepth()); });
+        
         spdlog::info("=== FoxBridgeAgent Started Successfully ===");
         
     } catch (const std::exception& e) {
@@ -114,6 +154,7 @@ void stopApplication() {
         
         // Graceful shutdown in reverse order
         if (g_maintenance) {
+            Metrics::instance().unregisterCallback("foxbridge_maintenance_queue_depth");
             g_maintenance->stop();
             g_maintenance.reset();
         }
@@ -128,10 +169,11 @@ void stopApplication() {
             g_http_server.reset();
         }
         
-        // Database manager will disconnect in destructor
-        g_db_manager.reset();
+        // Storage backend will disconnect in destructor
+        g_storage.reset();
         
         spdlog::info("=== FoxBridgeAgent Stopped ===");
+        spdlog::default_logger()->flush();
         
     } catch (const std::exception& e) {
         spdlog::error("Error during shutdown: {}", e.what());
@@ -144,10 +186,8 @@ int runAsConsole() {
         
         std::cout << "\nFoxBridgeAgent is running. Press Ctrl+C to stop...\n" << std::endl;
         
-        // Wait for Ctrl+C
-        while (true) {
-            Sleep(1000);
-        }
+        Platform::waitForShutdown();
+        stopApplication();
         
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
@@ -158,9 +198,7 @@ int runAsConsole() {
 }
 
 int runAsService() {
-    WindowsService service("FoxBridgeAgent", startApplication, stopApplication);
-    service.run();
-    return 0;
+    return Platform::runService("FoxBridgeAgent", startApplication, stopApplication) ? 0 : 1;
 }
 
 void printUsage() {
@@ -190,14 +228,7 @@ void printUsage() {
 }
 
 std::string findConfigFile() {
-    // List of possible config locations (in order of priority)
-    std::vector<std::string> search_paths = {
-        ".\\config.json",                                    // Current directory
-        "C:\\ProgramData\\FoxBridgeAgent\\config.json",     // Program Data
-        ".\\config\\config.json"                            // Config folder
-    };
-    
-    for (const auto& path : search_paths) {
+    for (const auto& path : Platform::configSearchPaths()) {
         if (std::filesystem::exists(path)) {
             return path;
         }
@@ -214,11 +245,14 @@ Config createDefaultConfig(const std::string& dbf_path, int port = 8080) {
     config.port = port;
     config.cloudflare_token = "";
     config.log_level = "info";
-    config.log_path = "C:\\ProgramData\\FoxBridgeAgent\\logs";
+    config.log_path = Platform::DEFAULT_LOG_PATH;
     config.index_policy = "auto";
     config.maintenance_window = "02:00-04:00";
     config.max_retry_attempts = 3;
     config.connection_timeout = 30;
+    config.db_pool_size = 4;
+    config.http_worker_threads = 16;
+    config.coalesce_requests = true;
     
     return config;
 }
@@ -271,12 +305,9 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--service") {
             mode = "service";
         } else if (arg == "--install") {
-            char exe_path[MAX_PATH];
-            GetModuleFileNameA(nullptr, exe_path, MAX_PATH);
-            
-            if (WindowsService::install("FoxBridgeAgent", 
-                                       "FoxBridge Agent - ExpressD API Server",
-                                       std::string(exe_path) + " --service")) {
+            if (Platform::installService("FoxBridgeAgent", 
+                                         "FoxBridge Agent - ExpressD API Server",
+                                         Platform::executablePath() + " --service")) {
                 std::cout << "Service installed successfully" << std::endl;
                 return 0;
             } else {
@@ -284,7 +315,7 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         } else if (arg == "--uninstall") {
-            if (WindowsService::uninstall("FoxBridgeAgent")) {
+            if (Platform::uninstallService("FoxBridgeAgent")) {
                 std::cout << "Service uninstalled successfully" << std::endl;
                 return 0;
             } else {
@@ -292,7 +323,7 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         } else if (arg == "--start") {
-            if (WindowsService::start("FoxBridgeAgent")) {
+            if (Platform::startService("FoxBridgeAgent")) {
                 std::cout << "Service started successfully" << std::endl;
                 return 0;
             } else {
@@ -300,7 +331,7 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         } else if (arg == "--stop") {
-            if (WindowsService::stop("FoxBridgeAgent")) {
+            if (Platform::stopService("FoxBridgeAgent")) {
                 std::cout << "Service stopped successfully" << std::endl;
                 return 0;
             } else {
@@ -405,7 +436,7 @@ int main(int argc, char* argv[]) {
         std::cerr << "=============================================================\n";
         std::cerr << "\nPossible causes:\n";
         std::cerr << "- Database path is incorrect\n";
-        std::cerr << "- VFP ODBC Driver not installed\n";
+        std::cerr << "- VFP ODBC Driver not installed (or set storage_backend to \"dbf\")\n";
         std::cerr << "- Port " << g_config.port << " is already in use\n";
         std::cerr << "- Insufficient permissions\n\n";
         std::cerr << "Press Enter to exit...";
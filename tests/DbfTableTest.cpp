@@ -0,0 +1,103 @@
+#include "DbfTable.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+
+using FoxBridge::DbfTable;
+
+namespace {
+
+// Visual FoxPro table with one V(10) field and the hidden _NullFlags field
+// that holds its varlength bit
+class VarcharTable : public ::testing::Test {
+protected:
+    static constexpr size_t FIELD_LENGTH = 10;
+    static constexpr size_t RECORD_LENGTH = 1 + FIELD_LENGTH + 1;
+
+    std::filesystem::path path_ = std::filesystem::temp_directory_path() / "foxbridge_varchar_test.dbf";
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    // `short_value` stores its length in the field's last byte and sets the bit
+    static std::string record(const std::string& value, bool short_value) {
+        std::string bytes(RECORD_LENGTH, '\0');
+        bytes[0] = ' ';
+        std::memcpy(&bytes[1], value.data(), value.size());
+        if (short_value) {
+            bytes[FIELD_LENGTH] = static_cast<char>(value.size());
+            bytes[1 + FIELD_LENGTH] = 0x01;
+        }
+        return bytes;
+    }
+
+    void write(const std::vector<std::string>& records) {
+        auto descriptor = [](const char* name, char type, size_t offset, size_t length, uint8_t flags) {
+            std::string field(32, '\0');
+            std::memcpy(&field[0], name, std::strlen(name));
+            field[11] = type;
+            field[12] = static_cast<char>(offset);
+            field[16] = static_cast<char>(length);
+            field[18] = static_cast<char>(flags);
+            return field;
+        };
+
+        // Header, two descriptors, terminator and the 263-byte backlink
+        size_t header_length = 32 + 2 * 32 + 1 + 263;
+        std::string header(32, '\0');
+        header[0] = 0x30;
+        header[4] = static_cast<char>(records.size());
+        header[8] = static_cast<char>(header_length & 0xFF);
+        header[9] = static_cast<char>(header_length >> 8);
+        header[10] = static_cast<char>(RECORD_LENGTH);
+        header += descriptor("NAME", 'V', 1, FIELD_LENGTH, 0x00);
+        header += descriptor("_NullFlags", '0', 1 + FIELD_LENGTH, 1, 0x05);
+        header += '\x0D';
+        header.append(263, '\0');
+
+        std::ofstream out(path_, std::ios::binary);
+        out << header;
+        for (const auto& bytes : records) {
+            out << bytes;
+        }
+        out << '\x1A';
+    }
+
+    std::vector<nlohmann::json> values() {
+        DbfTable table(path_);
+        const auto* column = table.column("name");
+        EXPECT_NE(column, nullptr);
+        std::vector<nlohmann::json> result;
+        table.scan([&](uint32_t, const char* bytes) {
+            result.push_back(table.value(bytes, *column));
+            return true;
+        });
+        return result;
+    }
+};
+
+TEST_F(VarcharTable, ShortValueIsTrimmedToItsStoredLength) {
+    write({record("ab", true)});
+    auto result = values();
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0], "ab");
+}
+
+TEST_F(VarcharTable, FullWidthValueIsReturnedWhole) {
+    write({record("0123456789", false)});
+    auto result = values();
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0], "0123456789");
+}
+
+TEST_F(VarcharTable, EmptyValueHasNoLengthByte) {
+    write({record("", true), record("xyz", true)});
+    auto result = values();
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0], "");
+    EXPECT_EQ(result[1], "xyz");
+}
+
+} // namespace
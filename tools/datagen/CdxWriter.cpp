@@ -0,0 +1,356 @@
+#include "CdxWriter.h"
+#include "DbfFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <stdexcept>
+
+namespace FoxBridge {
+
+static constexpr size_t NODE_SIZE = 512;
+static constexpr size_t HEADER_SIZE = 1024;         // Header page plus expression pool
+static constexpr size_t LEAF_DATA = NODE_SIZE - 24;
+static constexpr size_t INTERIOR_DATA = NODE_SIZE - 12;
+
+// Node attributes
+static constexpr uint16_t NODE_INTERIOR = 0;
+static constexpr uint16_t NODE_ROOT = 1;
+static constexpr uint16_t NODE_LEAF = 2;
+
+// Index options
+static constexpr uint8_t OPTION_COMPACT = 0x20;
+static constexpr uint8_t OPTION_COMPOUND = 0x40;
+static constexpr uint8_t OPTION_STRUCTURE = 0x80;
+
+static constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+
+static void putLE16(char* out, uint16_t value) {
+    out[0] = static_cast<char>(value & 0xFF);
+    out[1] = static_cast<char>(value >> 8);
+}
+
+static void putLE32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static void putBE32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>((value >> (8 * (3 - i))) & 0xFF);
+    }
+}
+
+static int bitsFor(uint64_t value) {
+    int bits = 1;
+    while (bits < 64 && (uint64_t{1} << bits) <= value) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Builds one tag: header at `header_offset`, nodes allocated sequentially
+// after it. Leaves are written as they fill; interior levels are built from
+// the leaf separators at finish().
+class CdxWriter::TreeBuilder {
+public:
+    TreeBuilder(std::FILE* file, uint64_t header_offset, std::string expression,
+                uint16_t key_length, bool binary, uint32_t max_recno, uint8_t options)
+        : file_(file)
+        , header_offset_(header_offset)
+        , next_offset_(header_offset + HEADER_SIZE)
+        , expression_(std::move(expression))
+        , key_length_(key_length)
+        , pad_(binary ? '\0' : ' ')
+        , options_(options)
+        , previous_(key_length, '\0') {
+        if (key_length_ == 0 || key_length_ > 240) {
+            throw std::runtime_error("CDX key length must be 1-240");
+        }
+        
+        // Duplicate and trailing counts each need to hold 0..key_length
+        count_bits_ = bitsFor(key_length_);
+        int record_bits = bitsFor(max_recno);
+        info_bytes_ = std::max(3, (record_bits + 2 * count_bits_ + 7) / 8);
+        record_bits_ = info_bytes_ * 8 - 2 * count_bits_;
+        
+        startLeaf();
+    }
+    
+    void add(const char* key, uint32_t recno) {
+        if (has_last_ && std::memcmp(key, last_key_.data(), key_length_) < 0) {
+            throw std::runtime_error("CDX keys must be added in ascending order");
+        }
+        
+        int trail = 0;
+        while (trail < key_length_ && key[key_length_ - 1 - trail] == pad_) {
+            ++trail;
+        }
+        int dup = 0;
+        if (leaf_keys_ > 0) {
+            while (dup < key_length_ - trail && key[dup] == previous_[dup]) {
+                ++dup;
+            }
+        }
+        size_t stored = static_cast<size_t>(key_length_ - dup - trail);
+        
+        if (leaf_used_ + info_bytes_ + stored > LEAF_DATA) {
+            flushLeaf(true);
+            add(key, recno);
+            return;
+        }
+        
+        // Record info packs upward from byte 24; key bytes pack downward from the end
+        uint64_t info = recno |
+                        (static_cast<uint64_t>(dup) << record_bits_) |
+                        (static_cast<uint64_t>(trail) << (record_bits_ + count_bits_));
+        char* entry = leaf_.data() + 24 + static_cast<size_t>(leaf_keys_) * info_bytes_;
+        for (int i = 0; i < info_bytes_; ++i) {
+            entry[i] = static_cast<char>((info >> (8 * i)) & 0xFF);
+        }
+        key_end_ -= stored;
+        std::memcpy(leaf_.data() + key_end_, key + dup, stored);
+        
+        leaf_used_ += info_bytes_ + stored;
+        ++leaf_keys_;
+        std::memcpy(previous_.data(), key, key_length_);
+        last_key_.assign(key, key_length_);
+        last_recno_ = recno;
+        has_last_ = true;
+    }
+    
+    // Writes the remaining nodes and the header; returns the offset after the tag
+    uint64_t finish() {
+        flushLeaf(false);
+        
+        uint32_t root;
+        if (level_.size() == 1) {
+            // A single leaf is also the root
+            root = level_[0].offset;
+            rewriteAttributes(root, NODE_ROOT | NODE_LEAF);
+        } else {
+            root = buildInterior();
+        }
+        
+        writeHeader(root);
+        return next_offset_;
+    }
+
+private:
+    struct Separator {
+        std::string key;        // Highest key in the node
+        uint32_t recno;
+        uint32_t offset;
+    };
+    
+    std::FILE* file_;
+    uint64_t header_offset_;
+    uint64_t next_offset_;
+    std::string expression_;
+    int key_length_;
+    char pad_;
+    uint8_t options_;
+    int count_bits_;
+    int record_bits_;
+    int info_bytes_;
+    
+    std::vector<char> leaf_;
+    uint32_t leaf_offset_ = 0;
+    uint32_t previous_leaf_ = NO_NODE;
+    int leaf_keys_ = 0;
+    size_t leaf_used_ = 0;
+    size_t key_end_ = NODE_SIZE;
+    std::string previous_;
+    
+    std::string last_key_;
+    uint32_t last_recno_ = 0;
+    bool has_last_ = false;
+    
+    std::vector<Separator> level_;
+    
+    uint32_t allocate() {
+        uint64_t offset = next_offset_;
+        next_offset_ += NODE_SIZE;
+        if (offset > UINT32_MAX - NODE_SIZE) {
+            throw std::runtime_error("CDX file exceeds 4GB");
+        }
+        return static_cast<uint32_t>(offset);
+    }
+    
+    void startLeaf() {
+        leaf_.assign(NODE_SIZE, '\0');
+        leaf_offset_ = allocate();
+        leaf_keys_ = 0;
+        leaf_used_ = 0;
+        key_end_ = NODE_SIZE;
+    }
+    
+    void flushLeaf(bool more) {
+        char* node = leaf_.data();
+        putLE16(node, NODE_LEAF);
+        putLE16(node + 2, static_cast<uint16_t>(leaf_keys_));
+        putLE32(node + 4, previous_leaf_);
+        putLE32(node + 8, more ? leaf_offset_ + static_cast<uint32_t>(NODE_SIZE) : NO_NODE);
+        putLE16(node + 12, static_cast<uint16_t>(LEAF_DATA - leaf_used_));
+        putLE32(node + 14, record_bits_ >= 32 ? 0xFFFFFFFF : (uint32_t{1} << record_bits_) - 1);
+        node[18] = static_cast<char>((1 << count_bits_) - 1);
+        node[19] = static_cast<char>((1 << count_bits_) - 1);
+        node[20] = static_cast<char>(record_bits_);
+        node[21] = static_cast<char>(count_bits_);
+        node[22] = static_cast<char>(count_bits_);
+        node[23] = static_cast<char>(info_bytes_);
+        writeAt(file_, leaf_offset_, node, NODE_SIZE);
+        
+        level_.push_back({has_last_ ? last_key_ : std::string(key_length_, pad_), last_recno_, leaf_offset_});
+        previous_leaf_ = leaf_offset_;
+        if (more) {
+            startLeaf();
+        }
+    }
+    
+    uint32_t buildInterior() {
+        size_t capacity = INTERIOR_DATA / (static_cast<size_t>(key_length_) + 8);
+        std::vector<char> node(NODE_SIZE);
+        
+        while (level_.size() > 1) {
+            std::vector<Separator> parents;
+            size_t node_count = (level_.size() + capacity - 1) / capacity;
+            uint32_t first = static_cast<uint32_t>(next_offset_);
+            bool root = node_count == 1;
+            
+            for (size_t n = 0; n < node_count; ++n) {
+                uint32_t offset = allocate();
+                size_t begin = n * capacity;
+                size_t end = std::min(level_.size(), begin + capacity);
+                
+                std::fill(node.begin(), node.end(), '\0');
+                putLE16(node.data(), root ? NODE_ROOT : NODE_INTERIOR);
+                putLE16(node.data() + 2, static_cast<uint16_t>(end - begin));
+                putLE32(node.data() + 4, n == 0 ? NO_NODE : offset - static_cast<uint32_t>(NODE_SIZE));
+                putLE32(node.data() + 8, n + 1 == node_count ? NO_NODE : offset + static_cast<uint32_t>(NODE_SIZE));
+                
+                char* entry = node.data() + 12;
+                for (size_t i = begin; i < end; ++i) {
+                    std::memcpy(entry, level_[i].key.data(), key_length_);
+                    putBE32(entry + key_length_, level_[i].recno);
+                    putBE32(entry + key_length_ + 4, level_[i].offset);
+                    entry += key_length_ + 8;
+                }
+                writeAt(file_, offset, node.data(), NODE_SIZE);
+                parents.push_back({level_[end - 1].key, level_[end - 1].recno, offset});
+            }
+            
+            level_ = std::move(parents);
+            if (root) {
+                return first;
+            }
+        }
+        return level_[0].offset;
+    }
+    
+    void rewriteAttributes(uint32_t offset, uint16_t attributes) {
+        char value[2];
+        putLE16(value, attributes);
+        writeAt(file_, offset, value, sizeof(value));
+    }
+    
+    void writeHeader(uint32_t root) {
+        std::vector<char> header(HEADER_SIZE, '\0');
+        putLE32(header.data(), root);
+        putLE32(header.data() + 4, NO_NODE);                // No free list
+        putLE16(header.data() + 12, static_cast<uint16_t>(key_length_));
+        header[14] = static_cast<char>(options_);
+        header[15] = 1;                                     // Signature
+        
+        // Expression pool: key expression then an empty FOR expression, NUL-terminated
+        uint16_t key_pool = static_cast<uint16_t>(expression_.size() + 1);
+        putLE16(header.data() + 502, 0);                    // Ascending
+        putLE16(header.data() + 504, key_pool);             // FOR expression position
+        putLE16(header.data() + 506, 1);                    // FOR expression length
+        putLE16(header.data() + 508, 0);                    // Key expression position
+        putLE16(header.data() + 510, key_pool);             // Key expression length
+        std::memcpy(header.data() + 512, expression_.data(), expression_.size());
+        
+        writeAt(file_, header_offset_, header.data(), HEADER_SIZE);
+    }
+};
+
+CdxWriter::CdxWriter(const std::string& path)
+    : path_(path)
+    , next_offset_(HEADER_SIZE + NODE_SIZE) {       // Tag directory: header and one leaf
+    file_ = std::fopen(path.c_str(), "w+b");
+    if (!file_) {
+        throw std::runtime_error("Cannot create index file: " + path);
+    }
+}
+
+CdxWriter::~CdxWriter() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+void CdxWriter::beginTag(const std::string& name, const std::string& expression,
+                         uint16_t key_length, bool binary, uint32_t max_recno) {
+    if (current_ || name.empty() || name.size() > 10) {
+        throw std::runtime_error("Invalid CDX tag: " + name);
+    }
+    
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) {
+        return static_cast<char>(std::toupper(c));
+    });
+    tags_.emplace_back(upper, static_cast<uint32_t>(next_offset_));
+    current_ = std::make_unique<TreeBuilder>(file_, next_offset_, expression, key_length, binary,
+                                             max_recno, OPTION_COMPACT | OPTION_COMPOUND);
+}
+
+void CdxWriter::addKey(const char* key, uint32_t recno) {
+    current_->add(key, recno);
+}
+
+void CdxWriter::endTag() {
+    next_offset_ = current_->finish();
+    current_.reset();
+}
+
+void CdxWriter::close() {
+    if (!file_) {
+        return;
+    }
+    
+    // The directory is itself a compact index: tag names as keys, each tag's
+    // header offset as its record number. It must fit the single reserved leaf.
+    std::sort(tags_.begin(), tags_.end());
+    TreeBuilder directory(file_, 0, "", 10, false, static_cast<uint32_t>(next_offset_),
+                          OPTION_COMPACT | OPTION_COMPOUND | OPTION_STRUCTURE);
+    for (const auto& [name, offset] : tags_) {
+        std::string key = name;
+        key.resize(10, ' ');
+        directory.add(key.data(), offset);
+    }
+    if (directory.finish() != HEADER_SIZE + NODE_SIZE) {
+        throw std::runtime_error("Too many CDX tags for the directory node");
+    }
+    
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void CdxWriter::dateKey(int year, int month, int day, char out[8]) {
+    // Julian day number (Fliegel & Van Flandern)
+    int a = (14 - month) / 12;
+    int y = year + 4800 - a;
+    int m = month + 12 * a - 3;
+    long jdn = day + (153 * m + 2) / 5 + 365L * y + y / 4 - y / 100 + y / 400 - 32045;
+    
+    double value = static_cast<double>(jdn);
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits ^= uint64_t{1} << 63;      // Positive: flip the sign bit so byte order sorts numerically
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<char>((bits >> (8 * (7 - i))) & 0xFF);
+    }
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+
+namespace FoxBridge {
+
+// Writes a Visual FoxPro structural compound index (.cdx): a tag directory
+// followed by one B-tree per tag, in 512-byte compact nodes (leaf keys are
+// prefix/trailing compressed, record numbers bit-packed). Keys must be added
+// in ascending MACHINE order, which lets each tag be written in one streaming
+// pass with only the per-leaf separators held in memory.
+class CdxWriter {
+public:
+    explicit CdxWriter(const std::string& path);
+    ~CdxWriter();
+    
+    // Disable copy
+    CdxWriter(const CdxWriter&) = delete;
+    CdxWriter& operator=(const CdxWriter&) = delete;
+    
+    // `binary` keys (dates, numbers) are padded with NUL instead of spaces
+    void beginTag(const std::string& name, const std::string& expression,
+                  uint16_t key_length, bool binary, uint32_t max_recno);
+    void addKey(const char* key, uint32_t recno);
+    void endTag();
+    
+    // Writes the tag directory; no further tags may be added
+    void close();
+    
+    // Sortable key for a date: the Julian day number as a big-endian double
+    // with the sign bit flipped, as VFP stores DTOS()-free date keys
+    static void dateKey(int year, int month, int day, char out[8]);
+
+private:
+    class TreeBuilder;
+    
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    uint64_t next_offset_;
+    std::unique_ptr<TreeBuilder> current_;
+    std::vector<std::pair<std::string, uint32_t>> tags_;     // Name, header offset
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,261 @@
+#include "DatasetGenerator.h"
+#include "CdxWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace FoxBridge {
+
+// Records per work item: large enough to amortize a seek and write, small
+// enough to spread 10^3-record tables over more than one thread
+static constexpr uint32_t CHUNK_RECORDS = 65536;
+
+struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+static FilePtr openFile(const std::string& path, const char* mode) {
+    FilePtr file(std::fopen(path.c_str(), mode));
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    return file;
+}
+
+DatasetGenerator::DatasetGenerator(DatagenOptions options)
+    : options_(std::move(options)) {
+    if (options_.threads == 0) {
+        options_.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+uint32_t DatasetGenerator::recordCount(const TableSpec& table) const {
+    if (table.name == "customer") {
+        return std::clamp<uint32_t>(options_.rows / 50, 100, 99999);
+    }
+    return std::max<uint32_t>(1, static_cast<uint32_t>(options_.rows * table.scale));
+}
+
+std::vector<TableStats> DatasetGenerator::run() {
+    std::filesystem::create_directories(options_.out_dir);
+    
+    std::vector<TableStats> stats;
+    for (const auto& table : expressDTables()) {
+        if (!options_.tables.empty() &&
+            std::find(options_.tables.begin(), options_.tables.end(), table.name) == options_.tables.end()) {
+            continue;
+        }
+        stats.push_back(generateTable(table));
+    }
+    return stats;
+}
+
+TableStats DatasetGenerator::generateTable(const TableSpec& source) {
+    auto started = std::chrono::steady_clock::now();
+    
+    TableSpec table = source;
+    if (!options_.memo) {
+        table.columns.erase(std::remove_if(table.columns.begin(), table.columns.end(),
+                                           [](const ColumnSpec& c) { return c.kind == ValueKind::REMARK; }),
+                            table.columns.end());
+    }
+    
+    uint32_t customers = 0;
+    uint32_t invoices = 0;
+    for (const auto& other : expressDTables()) {
+        if (other.name == "customer") {
+            customers = recordCount(other);
+        } else if (other.name == "invoice") {
+            invoices = recordCount(other);
+        }
+    }
+    
+    uint32_t count = recordCount(table);
+    RecordGenerator generator(table, options_.seed, count, customers, invoices);
+    const DbfLayout& layout = generator.layout();
+    bool has_memo = layout.hasMemo();
+    
+    std::string base = (std::filesystem::path(options_.out_dir) / table.name).string();
+    std::string dbf_path = base + ".dbf";
+    std::string fpt_path = base + ".fpt";
+    std::string cdx_path = base + ".cdx";
+    
+    // The index only depends on record numbers, so it is built alongside the data
+    std::thread index_thread;
+    std::exception_ptr index_error;
+    if (options_.cdx) {
+        index_thread = std::thread([&] {
+            try {
+                writeIndex(generator, table, cdx_path);
+            } catch (...) {
+                index_error = std::current_exception();
+            }
+        });
+    }
+    
+    uint32_t chunks = (count + CHUNK_RECORDS - 1) / CHUNK_RECORDS;
+    auto chunkRange = [count](uint32_t chunk) {
+        uint32_t first = chunk * CHUNK_RECORDS + 1;
+        return std::make_pair(first, std::min(count, first + CHUNK_RECORDS - 1));
+    };
+    
+    // Memo blocks are laid out in record order: count each chunk's blocks in
+    // parallel, then a prefix sum gives every chunk its first block
+    std::vector<uint64_t> first_block(chunks + 1, FPT_HEADER_SIZE / FPT_BLOCK_SIZE);
+    auto parallel = [this, chunks](auto&& work) {
+        std::atomic<uint32_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < std::min<unsigned>(options_.threads, chunks); ++t) {
+            workers.emplace_back([&] {
+                try {
+                    for (uint32_t chunk = next++; chunk < chunks; chunk = next++) {
+                        work(chunk);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    error = std::current_exception();
+                    next = chunks;
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    };
+    
+    if (has_memo) {
+        std::vector<uint64_t> blocks(chunks, 0);
+        parallel([&](uint32_t chunk) {
+            auto [first, last] = chunkRange(chunk);
+            for (uint32_t recno = first; recno <= last; ++recno) {
+                blocks[chunk] += generator.memoBlocks(recno);
+            }
+        });
+        for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+            first_block[chunk + 1] = first_block[chunk] + blocks[chunk];
+        }
+        if (first_block[chunks] > UINT32_MAX) {
+            throw std::runtime_error(table.name + ": memo file exceeds the 32-bit block limit");
+        }
+    }
+    
+    // Headers and the end-of-file mark go in first; the files are then sized
+    // so every chunk can be written in place
+    uint64_t dbf_size = layout.headerLength() + static_cast<uint64_t>(count) * layout.recordLength() + 1;
+    uint8_t flags = (options_.cdx ? DBF_FLAG_CDX : 0) | (has_memo ? DBF_FLAG_MEMO : 0);
+    {
+        FilePtr dbf = openFile(dbf_path, "wb");
+        std::string header = layout.header(count, flags, DBF_CODEPAGE_874);
+        writeAt(dbf.get(), 0, header.data(), header.size());
+        const char eof = 0x1A;
+        writeAt(dbf.get(), dbf_size - 1, &eof, 1);
+    }
+    uint64_t fpt_size = first_block[chunks] * FPT_BLOCK_SIZE;
+    if (has_memo) {
+        FilePtr fpt = openFile(fpt_path, "wb");
+        std::string header = fptHeader(static_cast<uint32_t>(first_block[chunks]));
+        writeAt(fpt.get(), 0, header.data(), header.size());
+        std::filesystem::resize_file(fpt_path, fpt_size);
+    }
+    
+    std::atomic<uint32_t> deleted{0};
+    thread_local std::vector<char> records;
+    thread_local std::vector<char> memo_blocks;
+    
+    parallel([&](uint32_t chunk) {
+        // One handle per chunk keeps the workers' file positions independent
+        FilePtr dbf = openFile(dbf_path, "r+b");
+        FilePtr fpt = has_memo ? openFile(fpt_path, "r+b") : nullptr;
+        
+        auto [first, last] = chunkRange(chunk);
+        size_t record_length = layout.recordLength();
+        records.assign(static_cast<size_t>(last - first + 1) * record_length, ' ');
+        
+        std::vector<std::string> memos;
+        std::vector<uint32_t> memo_starts;
+        uint32_t block = static_cast<uint32_t>(first_block[chunk]);
+        uint32_t chunk_deleted = 0;
+        
+        for (uint32_t recno = first; recno <= last; ++recno) {
+            char* record = records.data() + static_cast<size_t>(recno - first) * record_length;
+            size_t before = memos.size();
+            uint32_t used = generator.fillRecord(recno, record, block, memos);
+            
+            // fillRecord assigns consecutive blocks to the record's memos
+            uint32_t start = block;
+            for (size_t i = before; i < memos.size(); ++i) {
+                memo_starts.push_back(start);
+                start += memoBlockCount(memos[i].size());
+            }
+            block += used;
+            chunk_deleted += record[0] == '*' ? 1 : 0;
+        }
+        
+        uint64_t offset = layout.headerLength() + static_cast<uint64_t>(first - 1) * record_length;
+        writeAt(dbf.get(), offset, records.data(), records.size());
+        
+        if (has_memo && block > first_block[chunk]) {
+            memo_blocks.assign(static_cast<size_t>(block - first_block[chunk]) * FPT_BLOCK_SIZE, '\0');
+            for (size_t i = 0; i < memos.size(); ++i) {
+                putMemo(memo_blocks.data() + static_cast<size_t>(memo_starts[i] - first_block[chunk]) * FPT_BLOCK_SIZE,
+                        memos[i]);
+            }
+            writeAt(fpt.get(), first_block[chunk] * FPT_BLOCK_SIZE, memo_blocks.data(), memo_blocks.size());
+        }
+        deleted += chunk_deleted;
+    });
+    
+    if (index_thread.joinable()) {
+        index_thread.join();
+    }
+    if (index_error) {
+        std::rethrow_exception(index_error);
+    }
+    
+    TableStats stats;
+    stats.name = table.name;
+    stats.records = count;
+    stats.deleted = deleted;
+    stats.dbf_bytes = dbf_size;
+    stats.fpt_bytes = has_memo ? fpt_size : 0;
+    stats.cdx_bytes = options_.cdx ? std::filesystem::file_size(cdx_path) : 0;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
+
+void DatasetGenerator::writeIndex(const RecordGenerator& generator, const TableSpec& table, const std::string& path) {
+    CdxWriter writer(path);
+    std::vector<char> key;
+    
+    for (const auto& tag : table.tags) {
+        uint16_t key_length = generator.keyLength(tag.column);
+        key.assign(key_length, '\0');
+        
+        std::string expression = tag.column;
+        for (char& c : expression) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        
+        writer.beginTag(tag.name, expression, key_length, generator.binaryKey(tag.column), generator.recordCount());
+        for (uint32_t recno = 1; recno <= generator.recordCount(); ++recno) {
+            generator.indexKey(tag.column, recno, key.data());
+            writer.addKey(key.data(), recno);
+        }
+        writer.endTag();
+    }
+    writer.close();
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ExpressDSchema.h"
+
+namespace FoxBridge {
+
+struct DatagenOptions {
+    std::string out_dir;
+    uint32_t rows = 100000;             // Invoice rows; other tables scale from this
+    std::vector<std::string> tables;    // Empty: all tables
+    unsigned threads = 0;               // 0: one per hardware thread
+    uint64_t seed = 1;
+    bool memo = true;
+    bool cdx = true;
+};
+
+struct TableStats {
+    std::string name;
+    uint32_t records = 0;
+    uint32_t deleted = 0;
+    uint64_t dbf_bytes = 0;
+    uint64_t fpt_bytes = 0;
+    uint64_t cdx_bytes = 0;
+    double seconds = 0.0;
+};
+
+// Writes ExpressD-shaped tables (.dbf, .fpt, .cdx) to `out_dir`. Records are
+// generated in fixed-size chunks by a pool of threads, each writing its
+// chunk in place in pre-sized files; the index for a table is built on its
+// own thread at the same time, regenerating keys in record order.
+class DatasetGenerator {
+public:
+    explicit DatasetGenerator(DatagenOptions options);
+    
+    std::vector<TableStats> run();
+    
+    // Records for `table` at the configured scale
+    uint32_t recordCount(const TableSpec& table) const;
+
+private:
+    DatagenOptions options_;
+    
+    TableStats generateTable(const TableSpec& table);
+    void writeIndex(const RecordGenerator& generator, const TableSpec& table, const std::string& path);
+};
+
+} // namespace FoxBridge
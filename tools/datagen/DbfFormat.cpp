@@ -0,0 +1,174 @@
+#include "DbfFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace FoxBridge {
+
+static void putLE16(char* out, uint16_t value) {
+    out[0] = static_cast<char>(value & 0xFF);
+    out[1] = static_cast<char>(value >> 8);
+}
+
+static void putLE32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static void putBE32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>((value >> (8 * (3 - i))) & 0xFF);
+    }
+}
+
+DbfLayout::DbfLayout(std::vector<DbfField> fields)
+    : fields_(std::move(fields)) {
+    uint32_t offset = 1;    // Deletion flag
+    for (auto& field : fields_) {
+        if (field.name.empty() || field.name.size() > 10) {
+            throw std::runtime_error("Invalid DBF field name: " + field.name);
+        }
+        field.offset = offset;
+        offset += field.length;
+    }
+    record_length_ = offset;
+}
+
+const DbfField& DbfLayout::field(const std::string& name) const {
+    for (const auto& field : fields_) {
+        if (field.name == name) {
+            return field;
+        }
+    }
+    throw std::runtime_error("No such DBF field: " + name);
+}
+
+bool DbfLayout::hasMemo() const {
+    return std::any_of(fields_.begin(), fields_.end(), [](const DbfField& f) { return f.type == 'M'; });
+}
+
+std::string DbfLayout::header(uint32_t record_count, uint8_t flags, uint8_t code_page) const {
+    std::string out(headerLength(), '\0');
+    
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    
+    out[0] = 0x30;                                  // Visual FoxPro
+    out[1] = static_cast<char>(local.tm_year);      // Years since 1900
+    out[2] = static_cast<char>(local.tm_mon + 1);
+    out[3] = static_cast<char>(local.tm_mday);
+    putLE32(&out[4], record_count);
+    putLE16(&out[8], static_cast<uint16_t>(headerLength()));
+    putLE16(&out[10], static_cast<uint16_t>(record_length_));
+    out[28] = static_cast<char>(flags);
+    out[29] = static_cast<char>(code_page);
+    
+    size_t pos = 32;
+    for (const auto& field : fields_) {
+        std::memcpy(&out[pos], field.name.data(), field.name.size());
+        out[pos + 11] = field.type;
+        putLE32(&out[pos + 12], field.offset);
+        out[pos + 16] = static_cast<char>(field.length);
+        out[pos + 17] = static_cast<char>(field.decimals);
+        out[pos + 18] = field.type == 'M' ? 0x04 : 0x00;   // Memo pointers are binary
+        pos += 32;
+    }
+    out[pos] = 0x0D;
+    // Backlink area stays zero: a free table, not part of a database container
+    
+    return out;
+}
+
+void putCharacter(char* record, const DbfField& field, const std::string& value) {
+    char* dest = record + field.offset;
+    size_t n = std::min<size_t>(value.size(), field.length);
+    std::memcpy(dest, value.data(), n);
+    std::memset(dest + n, ' ', field.length - n);
+}
+
+void putNumeric(char* record, const DbfField& field, int64_t scaled) {
+    // Right-justified ASCII, e.g. "      1234.50" for N(13,2)
+    char digits[32];
+    bool negative = scaled < 0;
+    uint64_t magnitude = negative ? static_cast<uint64_t>(-scaled) : static_cast<uint64_t>(scaled);
+    
+    int pos = sizeof(digits);
+    for (int i = 0; i < field.decimals; ++i) {
+        digits[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    if (field.decimals > 0) {
+        digits[--pos] = '.';
+    }
+    do {
+        digits[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (negative) {
+        digits[--pos] = '-';
+    }
+    
+    size_t len = sizeof(digits) - pos;
+    char* dest = record + field.offset;
+    if (len > field.length) {
+        std::memset(dest, '*', field.length);       // Overflow, as VFP shows it
+        return;
+    }
+    std::memset(dest, ' ', field.length - len);
+    std::memcpy(dest + field.length - len, digits + pos, len);
+}
+
+void putDate(char* record, const DbfField& field, int year, int month, int day) {
+    char* dest = record + field.offset;
+    int values[] = {year / 1000, year / 100 % 10, year / 10 % 10, year % 10,
+                    month / 10, month % 10, day / 10, day % 10};
+    for (int i = 0; i < 8; ++i) {
+        dest[i] = static_cast<char>('0' + values[i]);
+    }
+}
+
+void putLogical(char* record, const DbfField& field, bool value) {
+    record[field.offset] = value ? 'T' : 'F';
+}
+
+void putMemoPointer(char* record, const DbfField& field, uint32_t block) {
+    putLE32(record + field.offset, block);
+}
+
+std::string fptHeader(uint32_t next_free_block) {
+    std::string out(FPT_HEADER_SIZE, '\0');
+    putBE32(&out[0], next_free_block);
+    out[6] = static_cast<char>(FPT_BLOCK_SIZE >> 8);
+    out[7] = static_cast<char>(FPT_BLOCK_SIZE & 0xFF);
+    return out;
+}
+
+uint32_t memoBlockCount(size_t length) {
+    return length == 0 ? 0 : static_cast<uint32_t>((8 + length + FPT_BLOCK_SIZE - 1) / FPT_BLOCK_SIZE);
+}
+
+void putMemo(char* block, const std::string& text) {
+    putBE32(block, 1);      // Text memo
+    putBE32(block + 4, static_cast<uint32_t>(text.size()));
+    std::memcpy(block + 8, text.data(), text.size());
+}
+
+void writeAt(std::FILE* file, uint64_t offset, const char* data, size_t length) {
+#ifdef _WIN32
+    int rc = _fseeki64(file, static_cast<long long>(offset), SEEK_SET);
+#else
+    int rc = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (rc != 0 || std::fwrite(data, 1, length, file) != length) {
+        throw std::runtime_error("Write failed at offset " + std::to_string(offset));
+    }
+}
+
+} // namespace FoxBridge
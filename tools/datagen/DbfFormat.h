@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+namespace FoxBridge {
+
+// Visual FoxPro table (.dbf) and memo (.fpt) layout, enough to write files
+// the VFP ODBC driver opens: 0x30 version byte, 263-byte backlink area,
+// binary 4-byte memo pointers into 64-byte FPT blocks.
+struct DbfField {
+    std::string name;           // Up to 10 characters
+    char type;                  // C, N, D, L or M
+    uint8_t length;
+    uint8_t decimals = 0;
+    uint32_t offset = 0;        // Within the record, after the deletion flag; set by DbfLayout
+};
+
+// Table flags (header byte 28) and code page marks (byte 29)
+constexpr uint8_t DBF_FLAG_CDX = 0x01;
+constexpr uint8_t DBF_FLAG_MEMO = 0x02;
+constexpr uint8_t DBF_CODEPAGE_874 = 0x7C;      // Thai Windows / TIS-620
+
+constexpr size_t FPT_HEADER_SIZE = 512;
+constexpr uint32_t FPT_BLOCK_SIZE = 64;
+
+class DbfLayout {
+public:
+    explicit DbfLayout(std::vector<DbfField> fields);
+    
+    const std::vector<DbfField>& fields() const { return fields_; }
+    const DbfField& field(const std::string& name) const;
+    bool hasMemo() const;
+    
+    size_t headerLength() const { return 32 + 32 * fields_.size() + 1 + 263; }
+    size_t recordLength() const { return record_length_; }
+    
+    // Header, field descriptors, terminator and backlink area
+    std::string header(uint32_t record_count, uint8_t flags, uint8_t code_page) const;
+
+private:
+    std::vector<DbfField> fields_;
+    size_t record_length_;
+};
+
+// Field writers. `record` points at the deletion flag of a record buffer.
+void putCharacter(char* record, const DbfField& field, const std::string& value);
+void putNumeric(char* record, const DbfField& field, int64_t scaled);   // value * 10^decimals
+void putDate(char* record, const DbfField& field, int year, int month, int day);
+void putLogical(char* record, const DbfField& field, bool value);
+void putMemoPointer(char* record, const DbfField& field, uint32_t block);
+
+// FPT header and memo blocks
+std::string fptHeader(uint32_t next_free_block);
+uint32_t memoBlockCount(size_t length);
+void putMemo(char* block, const std::string& text);     // Type, length and text; block is pre-zeroed
+
+// Positioned write for files written by several threads, each with its own handle
+void writeAt(std::FILE* file, uint64_t offset, const char* data, size_t length);
+
+} // namespace FoxBridge
@@ -0,0 +1,401 @@
+#include "ExpressDSchema.h"
+#include "CdxWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <functional>
+
+namespace FoxBridge {
+
+static DbfField C(const char* name, uint8_t length) { return {name, 'C', length, 0}; }
+static DbfField N(const char* name, uint8_t length, uint8_t decimals) { return {name, 'N', length, decimals}; }
+static DbfField D(const char* name) { return {name, 'D', 8, 0}; }
+static DbfField L(const char* name) { return {name, 'L', 1, 0}; }
+static DbfField M(const char* name) { return {name, 'M', 4, 0}; }
+
+// Shared by the document tables: number, dates, customer, amounts
+static std::vector<ColumnSpec> documentColumns(std::vector<ColumnSpec> extra) {
+    std::vector<ColumnSpec> columns = {
+        {C("docnum", 10), ValueKind::DOCNUM},
+        {D("docdate"), ValueKind::DOCDATE},
+        {C("cuscod", 8), ValueKind::CUSTOMER_CODE},
+        {C("cusnam", 60), ValueKind::CUSTOMER_NAME},
+        {N("amount", 14, 2), ValueKind::AMOUNT},
+        {N("vatamt", 14, 2), ValueKind::VAT},
+        {N("netamt", 14, 2), ValueKind::NET_AMOUNT},
+        {C("status", 1), ValueKind::STATUS}
+    };
+    columns.insert(columns.end(), extra.begin(), extra.end());
+    columns.push_back({M("remark"), ValueKind::REMARK});
+    return columns;
+}
+
+const std::vector<TableSpec>& expressDTables() {
+    static const std::vector<TableSpec> tables = {
+        {"invoice", "HP", 1.0, documentColumns({
+            {D("duedate"), ValueKind::DUE_DATE},
+            {N("qty", 10, 0), ValueKind::QUANTITY},
+            {L("posted"), ValueKind::FLAG}
+        }), {{"docnum", "docnum"}, {"docdate", "docdate"}}},
+        {"receipt", "RC", 0.8, documentColumns({
+            {C("invnum", 10), ValueKind::INVOICE_REF},
+            {C("paytyp", 2), ValueKind::PAY_TYPE}
+        }), {{"docnum", "docnum"}, {"docdate", "docdate"}}},
+        {"order", "SO", 0.6, documentColumns({
+            {D("duedate"), ValueKind::DUE_DATE},
+            {N("qty", 10, 0), ValueKind::QUANTITY}
+        }), {{"docnum", "docnum"}, {"docdate", "docdate"}}},
+        {"quotation", "QT", 0.3, documentColumns({
+            {D("duedate"), ValueKind::DUE_DATE}
+        }), {{"docnum", "docnum"}, {"docdate", "docdate"}}},
+        {"payment", "PV", 0.4, documentColumns({
+            {C("paytyp", 2), ValueKind::PAY_TYPE}
+        }), {{"docnum", "docnum"}, {"docdate", "docdate"}}},
+        {"delivery", "DO", 0.5, documentColumns({
+            {C("invnum", 10), ValueKind::INVOICE_REF},
+            {L("received"), ValueKind::FLAG}
+        }), {{"docnum", "docnum"}, {"docdate", "docdate"}}},
+        {"customer", "C", 0.0, {
+            {C("cuscod", 8), ValueKind::DOCNUM},
+            {C("cusnam", 60), ValueKind::CUSTOMER_NAME},
+            {C("addr1", 80), ValueKind::ADDRESS},
+            {C("telnum", 20), ValueKind::PHONE},
+            {C("taxid", 13), ValueKind::TAX_ID},
+            {N("crline", 12, 2), ValueKind::AMOUNT},
+            {D("opendate"), ValueKind::DOCDATE},
+            {M("remark"), ValueKind::REMARK}
+        }, {{"cuscod", "cuscod"}}}
+    };
+    return tables;
+}
+
+// Thai vocabulary, converted once from UTF-8 to TIS-620 (U+0E01..U+0E5B map
+// to 0xA1..0xFB; ASCII passes through)
+static std::string toTis620(const std::string& utf8) {
+    std::string out;
+    for (size_t i = 0; i < utf8.size(); ) {
+        unsigned char c = static_cast<unsigned char>(utf8[i]);
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+            ++i;
+        } else if ((c & 0xF0) == 0xE0 && i + 2 < utf8.size()) {
+            uint32_t cp = ((c & 0x0F) << 12) | ((utf8[i + 1] & 0x3F) << 6) | (utf8[i + 2] & 0x3F);
+            out += (cp >= 0x0E01 && cp <= 0x0E5B) ? static_cast<char>(cp - 0x0D60) : '?';
+            i += 3;
+        } else {
+            out += '?';
+            ++i;
+        }
+    }
+    return out;
+}
+
+static const std::vector<std::string>& thaiWords() {
+    static const std::vector<std::string> words = [] {
+        const char* utf8[] = {
+            "สยาม", "รุ่งเรือง", "เจริญ", "ทรัพย์", "มั่นคง", "พาณิชย์", "ก่อสร้าง", "วัสดุ",
+            "การค้า", "อุตสาหกรรม", "บริการ", "ขนส่ง", "อาหาร", "เกษตร", "ไทย", "สมบูรณ์",
+            "ศรี", "ทอง", "เพชร", "มงคล", "พัฒนา", "ยนต์", "เคมี", "ภัณฑ์"
+        };
+        std::vector<std::string> out;
+        for (const char* word : utf8) {
+            out.push_back(toTis620(word));
+        }
+        return out;
+    }();
+    return words;
+}
+
+static const std::vector<std::string>& thaiPhrases() {
+    static const std::vector<std::string> phrases = [] {
+        const char* utf8[] = {
+            "ส่งสินค้าภายใน 7 วัน", "ชำระเงินโดยโอนผ่านธนาคาร", "ลูกค้าขอใบกำกับภาษีเต็มรูป",
+            "ติดต่อคุณสมชาย ฝ่ายจัดซื้อ", "สินค้าบางรายการรอผลิต", "ราคานี้รวมภาษีมูลค่าเพิ่มแล้ว",
+            "Delivery to warehouse 2", "PO ref. attached", "ออกใบเสร็จแยกตามสาขา"
+        };
+        std::vector<std::string> out;
+        for (const char* phrase : utf8) {
+            out.push_back(toTis620(phrase));
+        }
+        return out;
+    }();
+    return phrases;
+}
+
+// splitmix64
+static uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Days since 1970-01-01 to a civil date (Howard Hinnant's algorithm)
+static void civilFromDays(int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+static constexpr int64_t FIRST_DAY = 16436;     // 2015-01-01
+static constexpr int64_t DAY_SPAN = 3650;
+
+// Seven digits like ExpressD (HP0000001), five for customer codes (C00001);
+// more only when the table holds that many records
+static int docnumDigits(const std::string& prefix, uint32_t record_count) {
+    int digits = prefix == "C" ? 5 : 7;
+    for (uint64_t limit = digits == 5 ? 100000 : 10000000; record_count >= limit; limit *= 10) {
+        ++digits;
+    }
+    return digits;
+}
+
+// Numbers past ExpressD's field widths widen their fields instead of being
+// cut short, which would give runs of records the same number
+static std::vector<DbfField> tableFields(const TableSpec& table, uint32_t record_count,
+                                         uint32_t customer_count, uint32_t invoice_count) {
+    std::vector<DbfField> fields;
+    for (const auto& column : table.columns) {
+        DbfField field = column.field;
+        size_t width = field.length;
+        if (column.kind == ValueKind::DOCNUM) {
+            width = table.prefix.size() + docnumDigits(table.prefix, record_count);
+        } else if (column.kind == ValueKind::CUSTOMER_CODE) {
+            width = 1 + docnumDigits("C", customer_count);
+        } else if (column.kind == ValueKind::INVOICE_REF) {
+            width = 2 + docnumDigits("HP", invoice_count);
+        }
+        field.length = static_cast<uint8_t>(std::max<size_t>(field.length, width));
+        fields.push_back(std::move(field));
+    }
+    return fields;
+}
+
+RecordGenerator::RecordGenerator(const TableSpec& table, uint64_t seed, uint32_t record_count,
+                                 uint32_t customer_count, uint32_t invoice_count)
+    : table_(table)
+    , layout_(tableFields(table, record_count, std::max<uint32_t>(1, customer_count),
+                          std::max<uint32_t>(1, invoice_count)))
+    , seed_(mix(seed ^ std::hash<std::string>()(table.name)))
+    , record_count_(record_count)
+    , customer_count_(std::max<uint32_t>(1, customer_count))
+    , invoice_count_(std::max<uint32_t>(1, invoice_count))
+    , docnum_digits_(docnumDigits(table.prefix, record_count))
+    , customer_digits_(docnumDigits("C", customer_count_))
+    , invoice_digits_(docnumDigits("HP", invoice_count_)) {}
+
+uint64_t RecordGenerator::hash(uint32_t recno, uint64_t salt) const {
+    return mix(seed_ ^ (static_cast<uint64_t>(recno) << 8) ^ salt);
+}
+
+std::string RecordGenerator::docnum(uint32_t recno) const {
+    char text[24];
+    std::snprintf(text, sizeof(text), "%s%0*u", table_.prefix.c_str(), docnum_digits_, recno);
+    return text;
+}
+
+int64_t RecordGenerator::dayNumber(uint32_t recno) const {
+    uint64_t offset = (static_cast<uint64_t>(recno - 1) * DAY_SPAN) / std::max<uint32_t>(1, record_count_);
+    return FIRST_DAY + static_cast<int64_t>(offset);
+}
+
+void RecordGenerator::docdate(uint32_t recno, int& year, int& month, int& day) const {
+    civilFromDays(dayNumber(recno), year, month, day);
+}
+
+int64_t RecordGenerator::amountCents(uint32_t recno) const {
+    // Mostly small documents with a long tail
+    uint64_t h = hash(recno, 1);
+    int64_t base = static_cast<int64_t>(h % 5000000);
+    return (h >> 40) % 20 == 0 ? base * 100 : base;
+}
+
+size_t RecordGenerator::memoLength(uint32_t recno) const {
+    uint64_t h = hash(recno, 2);
+    unsigned bucket = static_cast<unsigned>(h % 100);
+    if (bucket < 40) {
+        return 0;
+    }
+    if (bucket < 90) {
+        return 40 + (h >> 8) % 360;
+    }
+    if (bucket < 99) {
+        return 1024 + (h >> 8) % 3072;      // Past the driver's 1023-byte SQLGetData buffer
+    }
+    return 8192 + (h >> 8) % 57344;
+}
+
+std::string RecordGenerator::memoText(uint32_t recno, size_t length) const {
+    const auto& phrases = thaiPhrases();
+    std::string text;
+    text.reserve(length + 64);
+    
+    uint64_t h = hash(recno, 3);
+    while (text.size() < length) {
+        text += phrases[h % phrases.size()];
+        text += "\r\n";
+        h = mix(h);
+    }
+    text.resize(length);
+    return text;
+}
+
+uint32_t RecordGenerator::memoBlocks(uint32_t recno) const {
+    uint32_t blocks = 0;
+    for (const auto& column : table_.columns) {
+        if (column.kind == ValueKind::REMARK) {
+            blocks += memoBlockCount(memoLength(recno));
+        }
+    }
+    return blocks;
+}
+
+std::string RecordGenerator::value(const ColumnSpec& column, uint32_t recno) const {
+    static const std::string COMPANY = toTis620("บริษัท ");
+    static const std::string LIMITED = toTis620(" จำกัด");
+    static const std::string ROAD = toTis620("ถนน");
+    static const std::string DISTRICT = toTis620("แขวง");
+    static const std::string CITY = toTis620("กรุงเทพฯ 10110");
+    
+    char text[64];
+    const auto& words = thaiWords();
+    
+    switch (column.kind) {
+        case ValueKind::DOCNUM:
+            return docnum(recno);
+        case ValueKind::CUSTOMER_CODE:
+            std::snprintf(text, sizeof(text), "C%0*u", customer_digits_,
+                          static_cast<unsigned>(hash(recno, 4) % customer_count_ + 1));
+            return text;
+        case ValueKind::CUSTOMER_NAME: {
+            // Customers are named by their own code so documents agree with the customer table
+            uint64_t h = table_.prefix == "C" ? mix(recno) : mix(hash(recno, 4) % customer_count_ + 1);
+            return COMPANY + words[h % words.size()] + words[(h >> 16) % words.size()] + LIMITED;
+        }
+        case ValueKind::INVOICE_REF:
+            std::snprintf(text, sizeof(text), "HP%0*u", invoice_digits_,
+                          static_cast<unsigned>(hash(recno, 5) % invoice_count_ + 1));
+            return text;
+        case ValueKind::STATUS:
+            return std::string(1, "OOOOOOPCV"[hash(recno, 6) % 9]);
+        case ValueKind::PAY_TYPE: {
+            static const char* const TYPES[] = {"CA", "CQ", "TR", "CR"};
+            return TYPES[hash(recno, 7) % 4];
+        }
+        case ValueKind::ADDRESS: {
+            uint64_t h = hash(recno, 8);
+            std::snprintf(text, sizeof(text), "%u/%u ", static_cast<unsigned>(h % 999 + 1),
+                          static_cast<unsigned>((h >> 16) % 99 + 1));
+            return text + ROAD + words[(h >> 24) % words.size()] + " " +
+                   DISTRICT + words[(h >> 32) % words.size()] + " " + CITY;
+        }
+        case ValueKind::PHONE: {
+            uint64_t h = hash(recno, 9);
+            std::snprintf(text, sizeof(text), "0%u-%03u-%04u", static_cast<unsigned>(h % 9 + 1),
+                          static_cast<unsigned>((h >> 8) % 1000), static_cast<unsigned>((h >> 24) % 10000));
+            return text;
+        }
+        case ValueKind::TAX_ID:
+            std::snprintf(text, sizeof(text), "%013llu",
+                          static_cast<unsigned long long>(hash(recno, 10) % 10000000000000ULL));
+            return text;
+        default:
+            return "";
+    }
+}
+
+uint32_t RecordGenerator::fillRecord(uint32_t recno, char* record, uint32_t memo_block,
+                                     std::vector<std::string>& memos) const {
+    // About 1% of records are deleted - still present, still indexed
+    record[0] = hash(recno, 11) % 100 == 0 ? '*' : ' ';
+    
+    uint32_t blocks = 0;
+    int year, month, day;
+    int64_t amount = amountCents(recno);
+    
+    for (size_t i = 0; i < table_.columns.size(); ++i) {
+        const ColumnSpec& column = table_.columns[i];
+        const DbfField& field = layout_.fields()[i];
+        
+        switch (column.kind) {
+            case ValueKind::DOCDATE:
+                docdate(recno, year, month, day);
+                putDate(record, field, year, month, day);
+                break;
+            case ValueKind::DUE_DATE:
+                civilFromDays(dayNumber(recno) + 30, year, month, day);
+                putDate(record, field, year, month, day);
+                break;
+            case ValueKind::AMOUNT:
+                putNumeric(record, field, amount);
+                break;
+            case ValueKind::VAT:
+                putNumeric(record, field, amount * 7 / 100);
+                break;
+            case ValueKind::NET_AMOUNT:
+                putNumeric(record, field, amount + amount * 7 / 100);
+                break;
+            case ValueKind::QUANTITY:
+                putNumeric(record, field, static_cast<int64_t>(hash(recno, 12) % 500 + 1));
+                break;
+            case ValueKind::FLAG:
+                putLogical(record, field, hash(recno, 13) % 4 != 0);
+                break;
+            case ValueKind::REMARK: {
+                size_t length = memoLength(recno);
+                if (length == 0) {
+                    putMemoPointer(record, field, 0);
+                    break;
+                }
+                putMemoPointer(record, field, memo_block + blocks);
+                blocks += memoBlockCount(length);
+                memos.push_back(memoText(recno, length));
+                break;
+            }
+            default:
+                putCharacter(record, field, value(column, recno));
+                break;
+        }
+    }
+    return blocks;
+}
+
+uint16_t RecordGenerator::keyLength(const std::string& column) const {
+    const DbfField& field = layout_.field(column);
+    return field.type == 'D' ? 8 : field.length;
+}
+
+bool RecordGenerator::binaryKey(const std::string& column) const {
+    return layout_.field(column).type == 'D';
+}
+
+void RecordGenerator::indexKey(const std::string& column, uint32_t recno, char* key) const {
+    const DbfField& field = layout_.field(column);
+    for (size_t i = 0; i < table_.columns.size(); ++i) {
+        if (layout_.fields()[i].name != column) {
+            continue;
+        }
+        
+        const ColumnSpec& spec = table_.columns[i];
+        if (field.type == 'D') {
+            int year, month, day;
+            docdate(recno, year, month, day);
+            CdxWriter::dateKey(year, month, day, key);
+        } else if (spec.kind == ValueKind::DOCNUM) {
+            std::string value = docnum(recno);
+            value.resize(field.length, ' ');
+            std::copy(value.begin(), value.end(), key);
+        } else {
+            throw std::runtime_error("Column cannot be indexed in record order: " + column);
+        }
+        return;
+    }
+}
+
+} // namespace FoxBridge
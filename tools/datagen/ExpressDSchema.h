@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "DbfFormat.h"
+
+namespace FoxBridge {
+
+// What a column holds; values are a pure function of (seed, table, record
+// number), so any record can be generated independently and in any order
+enum class ValueKind {
+    DOCNUM,             // Prefix + zero-padded record number, ascending
+    DOCDATE,            // Spread over ten years, non-decreasing with the record number
+    DUE_DATE,           // DOCDATE + 30 days
+    CUSTOMER_CODE,      // Random existing customer
+    CUSTOMER_NAME,      // Thai company name (TIS-620)
+    INVOICE_REF,        // Random earlier invoice number
+    AMOUNT,
+    VAT,                // 7% of AMOUNT
+    NET_AMOUNT,         // AMOUNT + VAT
+    QUANTITY,
+    STATUS,
+    PAY_TYPE,
+    ADDRESS,            // Thai street address (TIS-620)
+    PHONE,
+    TAX_ID,
+    FLAG,
+    REMARK              // Memo: empty, short, medium or large Thai/ASCII text
+};
+
+struct ColumnSpec {
+    DbfField field;
+    ValueKind kind;
+};
+
+struct TagSpec {
+    std::string name;
+    std::string column;
+};
+
+struct TableSpec {
+    std::string name;           // File name without extension
+    std::string prefix;         // Document number prefix; customer codes use "C"
+    double scale;               // Row count relative to --rows
+    std::vector<ColumnSpec> columns;
+    std::vector<TagSpec> tags;
+};
+
+// invoice, receipt, order, quotation, payment, delivery and customer
+const std::vector<TableSpec>& expressDTables();
+
+// Per-table value generator
+class RecordGenerator {
+public:
+    RecordGenerator(const TableSpec& table, uint64_t seed, uint32_t record_count,
+                    uint32_t customer_count, uint32_t invoice_count);
+    
+    const DbfLayout& layout() const { return layout_; }
+    uint32_t recordCount() const { return record_count_; }
+    
+    // Fills one record (deletion flag included). Memo fields get block
+    // `memo_block` onward; returns the number of memo blocks used and
+    // appends the memo text to `memos` in block order.
+    uint32_t fillRecord(uint32_t recno, char* record, uint32_t memo_block, std::vector<std::string>& memos) const;
+    
+    // Memo blocks one record needs, without building the text
+    uint32_t memoBlocks(uint32_t recno) const;
+    
+    // Index key for `column` of record `recno`, key_length bytes
+    void indexKey(const std::string& column, uint32_t recno, char* key) const;
+    uint16_t keyLength(const std::string& column) const;
+    bool binaryKey(const std::string& column) const;
+
+private:
+    const TableSpec& table_;
+    DbfLayout layout_;
+    uint64_t seed_;
+    uint32_t record_count_;
+    uint32_t customer_count_;
+    uint32_t invoice_count_;
+    int docnum_digits_;
+    int customer_digits_;       // Of the customer codes documents refer to
+    int invoice_digits_;        // Of the invoice numbers receipts and deliveries refer to
+    
+    uint64_t hash(uint32_t recno, uint64_t salt) const;
+    std::string docnum(uint32_t recno) const;
+    int64_t dayNumber(uint32_t recno) const;     // Days since 1970-01-01
+    void docdate(uint32_t recno, int& year, int& month, int& day) const;
+    int64_t amountCents(uint32_t recno) const;
+    size_t memoLength(uint32_t recno) const;
+    std::string memoText(uint32_t recno, size_t length) const;
+    std::string value(const ColumnSpec& column, uint32_t recno) const;
+};
+
+} // namespace FoxBridge
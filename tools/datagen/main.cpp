@@ -0,0 +1,128 @@
+#include "DatasetGenerator.h"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+using namespace FoxBridge;
+
+// Visual FoxPro refuses tables and memo files past 2GB
+static constexpr uint64_t VFP_FILE_LIMIT = 2ULL * 1024 * 1024 * 1024;
+
+static void printUsage() {
+    std::cout << "Usage: foxbridge_datagen --out <dir> [options]\n\n"
+              << "Options:\n"
+              << "  --rows <n>             Invoice rows; other tables scale from this (default: 100000)\n"
+              << "  --tables <a,b,...>     Tables to write (default: all)\n"
+              << "  --threads <n>          Writer threads (default: hardware threads)\n"
+              << "  --seed <n>             Seed for generated values (default: 1)\n"
+              << "  --no-memo              Omit memo fields and .fpt files\n"
+              << "  --no-cdx               Omit .cdx indexes\n\n"
+              << "Tables:";
+    for (const auto& table : expressDTables()) {
+        std::cout << " " << table.name;
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    DatagenOptions options;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (arg == "--no-memo") {
+            options.memo = false;
+            continue;
+        }
+        if (arg == "--no-cdx") {
+            options.cdx = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        
+        try {
+            if (arg == "--out") {
+                options.out_dir = value;
+            } else if (arg == "--rows") {
+                unsigned long long rows = std::stoull(value);
+                if (rows == 0 || rows > 4000000000ULL) {
+                    throw std::out_of_range(value);
+                }
+                options.rows = static_cast<uint32_t>(rows);
+            } else if (arg == "--tables") {
+                std::stringstream list(value);
+                std::string name;
+                while (std::getline(list, name, ',')) {
+                    options.tables.push_back(name);
+                }
+            } else if (arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else if (arg == "--seed") {
+                options.seed = std::stoull(value);
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage();
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+            return 1;
+        }
+    }
+    
+    if (options.out_dir.empty()) {
+        printUsage();
+        return 1;
+    }
+    for (const auto& name : options.tables) {
+        bool known = false;
+        for (const auto& table : expressDTables()) {
+            known = known || table.name == name;
+        }
+        if (!known) {
+            std::cerr << "Unknown table: " << name << "\n";
+            return 1;
+        }
+    }
+    
+    try {
+        DatasetGenerator generator(options);
+        
+        std::printf("%-12s %12s %9s %12s %12s %12s %9s\n",
+                    "table", "records", "deleted", "dbf_mb", "fpt_mb", "cdx_mb", "seconds");
+        uint64_t total_bytes = 0;
+        double total_seconds = 0.0;
+        
+        for (const auto& stats : generator.run()) {
+            std::printf("%-12s %12u %9u %12.1f %12.1f %12.1f %9.2f\n",
+                        stats.name.c_str(), stats.records, stats.deleted,
+                        stats.dbf_bytes / 1048576.0, stats.fpt_bytes / 1048576.0,
+                        stats.cdx_bytes / 1048576.0, stats.seconds);
+            total_bytes += stats.dbf_bytes + stats.fpt_bytes + stats.cdx_bytes;
+            total_seconds += stats.seconds;
+            
+            if (stats.dbf_bytes > VFP_FILE_LIMIT || stats.fpt_bytes > VFP_FILE_LIMIT) {
+                std::fprintf(stderr, "Warning: %s exceeds the 2GB Visual FoxPro file limit; "
+                             "the VFP ODBC driver will not open it\n", stats.name.c_str());
+            }
+        }
+        
+        std::printf("Wrote %.1f MB in %.2fs (%.0f MB/s) to %s\n",
+                    total_bytes / 1048576.0, total_seconds,
+                    total_seconds > 0 ? total_bytes / 1048576.0 / total_seconds : 0.0,
+                    options.out_dir.c_str());
+    } catch (const std::exception& e) {
+        std::cerr << "Generation failed: " << e.what() << "\n";
+        return 1;
+    }
+    
+    return 0;
+}
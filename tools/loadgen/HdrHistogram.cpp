@@ -0,0 +1,98 @@
+#include "HdrHistogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace FoxBridge {
+
+HdrHistogram::HdrHistogram(int64_t highest_trackable, int significant_digits)
+    : highest_trackable_(std::max<int64_t>(2, highest_trackable)) {
+    significant_digits = std::clamp(significant_digits, 1, 5);
+    
+    // Enough sub-buckets that each one is at most 1 part in 10^digits wide
+    int64_t largest_single_unit = 2 * static_cast<int64_t>(std::pow(10, significant_digits));
+    int sub_bucket_count_magnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largest_single_unit))));
+    sub_bucket_half_count_magnitude_ = std::max(sub_bucket_count_magnitude, 1) - 1;
+    sub_bucket_count_ = int64_t{1} << (sub_bucket_half_count_magnitude_ + 1);
+    sub_bucket_half_count_ = sub_bucket_count_ / 2;
+    sub_bucket_mask_ = sub_bucket_count_ - 1;
+    
+    // Each further bucket doubles the covered range
+    int64_t smallest_untrackable = sub_bucket_count_;
+    int bucket_count = 1;
+    while (smallest_untrackable <= highest_trackable_) {
+        if (smallest_untrackable > INT64_MAX / 2) {
+            ++bucket_count;
+            break;
+        }
+        smallest_untrackable <<= 1;
+        ++bucket_count;
+    }
+    counts_.assign(static_cast<size_t>((bucket_count + 1) * sub_bucket_half_count_), 0);
+}
+
+size_t HdrHistogram::countsIndex(int64_t value) const {
+    int pow2_ceiling = 64 - std::countl_zero(static_cast<uint64_t>(value | sub_bucket_mask_));
+    int bucket = pow2_ceiling - (sub_bucket_half_count_magnitude_ + 1);
+    int64_t sub_bucket = value >> bucket;
+    
+    int64_t bucket_base = static_cast<int64_t>(bucket + 1) << sub_bucket_half_count_magnitude_;
+    return static_cast<size_t>(bucket_base + (sub_bucket - sub_bucket_half_count_));
+}
+
+int64_t HdrHistogram::highestEquivalentValue(size_t index) const {
+    int bucket = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+    int64_t sub_bucket = static_cast<int64_t>(index & (sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+    if (bucket < 0) {
+        sub_bucket -= sub_bucket_half_count_;
+        bucket = 0;
+    }
+    
+    int64_t lowest = sub_bucket << bucket;
+    return lowest + (int64_t{1} << bucket) - 1;
+}
+
+void HdrHistogram::record(int64_t value) {
+    value = std::clamp<int64_t>(value, 0, highest_trackable_);
+    
+    size_t index = std::min(countsIndex(value), counts_.size() - 1);
+    ++counts_[index];
+    ++total_count_;
+    sum_ += static_cast<uint64_t>(value);
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void HdrHistogram::merge(const HdrHistogram& other) {
+    size_t n = std::min(counts_.size(), other.counts_.size());
+    for (size_t i = 0; i < n; ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+    sum_ += other.sum_;
+    if (other.total_count_) {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+}
+
+int64_t HdrHistogram::valueAtPercentile(double percentile) const {
+    if (total_count_ == 0) {
+        return 0;
+    }
+    
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    uint64_t target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total_count_));
+    target = std::max<uint64_t>(target, 1);
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            return std::min(highestEquivalentValue(i), max_);
+        }
+    }
+    return max_;
+}
+
+} // namespace FoxBridge
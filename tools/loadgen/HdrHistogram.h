@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace FoxBridge {
+
+// High-dynamic-range histogram (after Gil Tene's HdrHistogram): values from 1
+// to `highest_trackable` are bucketed so every recorded value keeps
+// `significant_digits` decimal digits of precision, with a fixed footprint
+// (~200KB for 3 digits up to an hour in microseconds).
+class HdrHistogram {
+public:
+    explicit HdrHistogram(int64_t highest_trackable = 3600LL * 1000 * 1000,
+                          int significant_digits = 3);
+    
+    // Negative values record as 0; values above the range are clamped to it
+    void record(int64_t value);
+    
+    // `other` must have been built with the same range and precision
+    void merge(const HdrHistogram& other);
+    
+    // Highest value equivalent (within precision) to the given percentile (0-100)
+    int64_t valueAtPercentile(double percentile) const;
+    
+    uint64_t count() const { return total_count_; }
+    int64_t min() const { return total_count_ ? min_ : 0; }
+    int64_t max() const { return max_; }
+    double mean() const { return total_count_ ? static_cast<double>(sum_) / total_count_ : 0.0; }
+
+private:
+    int64_t highest_trackable_;
+    int sub_bucket_half_count_magnitude_;
+    int64_t sub_bucket_count_;
+    int64_t sub_bucket_half_count_;
+    int64_t sub_bucket_mask_;
+    
+    std::vector<uint64_t> counts_;
+    uint64_t total_count_ = 0;
+    int64_t min_ = INT64_MAX;
+    int64_t max_ = 0;
+    uint64_t sum_ = 0;
+    
+    size_t countsIndex(int64_t value) const;
+    int64_t highestEquivalentValue(size_t index) const;
+};
+
+} // namespace FoxBridge
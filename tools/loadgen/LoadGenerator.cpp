@@ -0,0 +1,358 @@
+#include "LoadGenerator.h"
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <iostream>
+#include <stdexcept>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+namespace FoxBridge {
+
+LoadConfig LoadConfig::fromJson(const nlohmann::json& j) {
+    LoadConfig config;
+    config.host = j.value("host", "127.0.0.1");
+    config.port = j.contains("port") && j["port"].is_number() ?
+                  std::to_string(j["port"].get<int>()) : j.value("port", "8787");
+    config.api_key = j.value("api_key", "");
+    config.rate = j.value("rate", 100.0);
+    config.duration = std::chrono::seconds(j.value("duration_seconds", 60));
+    config.warmup = std::chrono::seconds(j.value("warmup_seconds", 5));
+    config.connections = j.value("connections", 64);
+    config.timeout = std::chrono::milliseconds(j.value("timeout_ms", 30000));
+    config.seed = j.value("seed", uint64_t{1});
+    
+    for (const auto& item : j.value("requests", nlohmann::json::array())) {
+        MixEntry entry;
+        entry.name = item.value("name", "");
+        entry.method = item.value("method", "GET");
+        entry.target = item.value("target", "");
+        if (item.contains("body")) {
+            entry.body = item["body"].is_string() ? item["body"].get<std::string>() : item["body"].dump();
+        }
+        entry.weight = item.value("weight", 1.0);
+        entry.min = item.value("min", int64_t{1});
+        entry.max = item.value("max", entry.min);
+        entry.pad = item.value("pad", 0);
+        if (entry.name.empty()) {
+            entry.name = entry.method + " " + entry.target;
+        }
+        config.mix.push_back(std::move(entry));
+    }
+    
+    config.validate();
+    return config;
+}
+
+void LoadConfig::validate() const {
+    if (rate <= 0) {
+        throw std::runtime_error("rate must be positive");
+    }
+    if (duration.count() <= 0 || warmup >= duration) {
+        throw std::runtime_error("duration_seconds must be positive and longer than warmup_seconds");
+    }
+    if (connections < 1) {
+        throw std::runtime_error("connections must be at least 1");
+    }
+    if (timeout.count() <= 0) {
+        throw std::runtime_error("timeout_ms must be positive");
+    }
+    if (mix.empty()) {
+        throw std::runtime_error("requests must list at least one request");
+    }
+    for (const auto& entry : mix) {
+        if (entry.target.empty() || entry.target[0] != '/') {
+            throw std::runtime_error("request '" + entry.name + "' needs a target starting with '/'");
+        }
+        if (http::string_to_verb(entry.method) == http::verb::unknown) {
+            throw std::runtime_error("request '" + entry.name + "' has unknown method " + entry.method);
+        }
+        if (entry.weight <= 0 || entry.max < entry.min) {
+            throw std::runtime_error("request '" + entry.name + "' needs weight > 0 and max >= min");
+        }
+    }
+}
+
+// Replaces every "{n}" with `value`
+static std::string expand(const std::string& text, const std::string& value) {
+    std::string out = text;
+    size_t pos = 0;
+    while ((pos = out.find("{n}", pos)) != std::string::npos) {
+        out.replace(pos, 3, value);
+        pos += value.size();
+    }
+    return out;
+}
+
+// Runs one async operation to completion on the worker's own io_context. The
+// stream's expiry turns a hung server into an error instead of a stuck worker.
+template <typename Initiate>
+static beast::error_code runOp(net::io_context& ioc, Initiate initiate) {
+    beast::error_code result;
+    initiate([&result](beast::error_code ec, auto&&...) { result = ec; });
+    ioc.restart();
+    ioc.run();
+    return result;
+}
+
+struct Exchange {
+    beast::error_code ec;
+    int status = 0;
+    size_t bytes = 0;
+};
+
+// One request on a fresh connection - the agent closes after every response
+static Exchange exchange(net::io_context& ioc, const tcp::resolver::results_type& endpoints,
+                         const LoadConfig& config, const MixEntry& entry,
+                         const std::string& target, const std::string& body) {
+    Exchange result;
+    beast::tcp_stream stream(ioc);
+    stream.expires_after(config.timeout);
+    
+    result.ec = runOp(ioc, [&](auto handler) { stream.async_connect(endpoints, handler); });
+    if (result.ec) {
+        return result;
+    }
+    
+    http::request<http::string_body> req{http::string_to_verb(entry.method), target, 11};
+    req.set(http::field::host, config.host);
+    req.set(http::field::user_agent, "foxbridge_loadgen");
+    if (!config.api_key.empty()) {
+        req.set("X-API-Key", config.api_key);
+    }
+    if (!body.empty()) {
+        req.set(http::field::content_type, "application/json");
+        req.body() = body;
+    }
+    req.prepare_payload();
+    
+    result.ec = runOp(ioc, [&](auto handler) { http::async_write(stream, req, handler); });
+    if (result.ec) {
+        return result;
+    }
+    
+    // Exports can be large; the default 8MB body limit would turn them into
+    // errors. An explicit maximum rather than boost::none, which Boost 1.74
+    // mishandles for responses with a Content-Length.
+    beast::flat_buffer buffer;
+    http::response_parser<http::string_body> parser;
+    parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+    result.ec = runOp(ioc, [&](auto handler) { http::async_read(stream, buffer, parser, handler); });
+    if (result.ec) {
+        return result;
+    }
+    
+    result.status = parser.get().result_int();
+    result.bytes = parser.get().body().size();
+    
+    beast::error_code ignored;
+    stream.socket().shutdown(tcp::socket::shutdown_both, ignored);
+    return result;
+}
+
+LoadGenerator::LoadGenerator(LoadConfig config)
+    : config_(std::move(config)) {
+    config_.validate();
+}
+
+double LoadGenerator::measuredSeconds() const {
+    return static_cast<double>((config_.duration - config_.warmup).count());
+}
+
+std::vector<RouteReport> LoadGenerator::run() {
+    using clock = std::chrono::steady_clock;
+    
+    net::io_context resolver_ioc;
+    tcp::resolver resolver(resolver_ioc);
+    auto endpoints = resolver.resolve(config_.host, config_.port);
+    
+    std::vector<RouteReport> reports;
+    std::vector<double> weights;
+    for (const auto& entry : config_.mix) {
+        RouteReport report;
+        report.name = entry.name;
+        reports.push_back(std::move(report));
+        weights.push_back(entry.weight);
+    }
+    std::mutex reports_mutex;
+    
+    const auto interval = std::chrono::duration<double>(1.0 / config_.rate);
+    const auto start = clock::now() + std::chrono::milliseconds(100);
+    const auto record_from = start + config_.warmup;
+    const auto end = start + config_.duration;
+    
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> late{0};
+    
+    auto worker = [&](int id) {
+        std::mt19937_64 rng(config_.seed * 1000003 + static_cast<uint64_t>(id));
+        std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+        net::io_context ioc;
+        
+        while (true) {
+            uint64_t i = next.fetch_add(1);
+            auto scheduled = start + std::chrono::duration_cast<clock::duration>(interval * static_cast<double>(i));
+            if (scheduled >= end) {
+                break;
+            }
+            std::this_thread::sleep_until(scheduled);
+            
+            size_t k = pick(rng);
+            const MixEntry& entry = config_.mix[k];
+            std::string value = std::to_string(std::uniform_int_distribution<int64_t>(entry.min, entry.max)(rng));
+            if (static_cast<int>(value.size()) < entry.pad) {
+                value.insert(0, static_cast<size_t>(entry.pad) - value.size(), '0');
+            }
+            
+            auto sent = clock::now();
+            Exchange result = exchange(ioc, endpoints, config_, entry,
+                                       expand(entry.target, value), expand(entry.body, value));
+            auto done = clock::now();
+            ++completed;
+            
+            if (scheduled < record_from) {
+                continue;
+            }
+            if (sent - scheduled > std::chrono::milliseconds(10)) {
+                ++late;
+            }
+            
+            std::lock_guard<std::mutex> lock(reports_mutex);
+            RouteReport& report = reports[k];
+            if (result.ec) {
+                ++report.errors;
+                continue;
+            }
+            report.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(done - scheduled).count());
+            report.service.record(std::chrono::duration_cast<std::chrono::microseconds>(done - sent).count());
+            report.bytes += result.bytes;
+            ++report.statuses[result.status];
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (int i = 0; i < config_.connections; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    
+    // Progress every 5 seconds on stderr so stdout stays a clean report
+    for (auto tick = start + std::chrono::seconds(5); tick < end; tick += std::chrono::seconds(5)) {
+        std::this_thread::sleep_until(tick);
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(tick - start).count();
+        std::cerr << fmt::format("[{:>4}s] scheduled {} completed {}{}\n", elapsed,
+                                 std::min<uint64_t>(next.load(), static_cast<uint64_t>(config_.rate * elapsed)),
+                                 completed.load(), tick < record_from ? " (warmup)" : "");
+    }
+    
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    late_starts_ = late;
+    
+    RouteReport all;
+    all.name = "all";
+    for (const auto& report : reports) {
+        all.latency.merge(report.latency);
+        all.service.merge(report.service);
+        all.errors += report.errors;
+        all.bytes += report.bytes;
+        for (const auto& [status, count] : report.statuses) {
+            all.statuses[status] += count;
+        }
+    }
+    reports.push_back(std::move(all));
+    return reports;
+}
+
+void LoadGenerator::printReport(const std::vector<RouteReport>& reports, std::ostream& out) const {
+    double seconds = measuredSeconds();
+    
+    out << fmt::format("Offered {:.1f} req/s for {}s ({}s warmup), {} connections\n",
+                       config_.rate, config_.duration.count(), config_.warmup.count(), config_.connections);
+    out << "Latency is measured from the scheduled send time; svc p99 from the actual send.\n\n";
+    out << fmt::format("{:<24} {:>9} {:>7} {:>9} {:>9} {:>9} {:>9} {:>9} {:>10} {:>9}\n",
+                       "route", "count", "errors", "req/s", "p50 ms", "p99 ms", "p99.9 ms",
+                       "max ms", "svc p99 ms", "MB/s");
+    
+    for (const auto& report : reports) {
+        uint64_t count = report.latency.count();
+        out << fmt::format("{:<24} {:>9} {:>7} {:>9.1f} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>10.2f} {:>9.2f}\n",
+                           report.name, count, report.errors, count / seconds,
+                           report.latency.valueAtPercentile(50.0) / 1000.0,
+                           report.latency.valueAtPercentile(99.0) / 1000.0,
+                           report.latency.valueAtPercentile(99.9) / 1000.0,
+                           report.latency.max() / 1000.0,
+                           report.service.valueAtPercentile(99.0) / 1000.0,
+                           report.bytes / seconds / (1024.0 * 1024.0));
+    }
+    
+    out << "\nStatus codes:\n";
+    for (const auto& report : reports) {
+        std::string codes;
+        for (const auto& [status, count] : report.statuses) {
+            codes += fmt::format(" {}={}", status, count);
+        }
+        out << fmt::format("  {:<22}{}\n", report.name, codes.empty() ? " -" : codes);
+    }
+    
+    if (late_starts_ > 0) {
+        out << fmt::format("\nWarning: {} request(s) started more than 10ms behind schedule; "
+                           "raise --connections for an accurate open-loop run\n", late_starts_);
+    }
+}
+
+static nlohmann::json percentiles(const HdrHistogram& histogram) {
+    return {
+        {"p50", histogram.valueAtPercentile(50.0) / 1000.0},
+        {"p90", histogram.valueAtPercentile(90.0) / 1000.0},
+        {"p99", histogram.valueAtPercentile(99.0) / 1000.0},
+        {"p999", histogram.valueAtPercentile(99.9) / 1000.0},
+        {"max", histogram.max() / 1000.0},
+        {"mean", histogram.mean() / 1000.0}
+    };
+}
+
+nlohmann::json LoadGenerator::reportJson(const std::vector<RouteReport>& reports) const {
+    double seconds = measuredSeconds();
+    
+    nlohmann::json routes = nlohmann::json::array();
+    for (const auto& report : reports) {
+        nlohmann::json statuses = nlohmann::json::object();
+        for (const auto& [status, count] : report.statuses) {
+            statuses[std::to_string(status)] = count;
+        }
+        routes.push_back({
+            {"name", report.name},
+            {"count", report.latency.count()},
+            {"errors", report.errors},
+            {"throughput", report.latency.count() / seconds},
+            {"bytes", report.bytes},
+            {"statuses", statuses},
+            {"latency_ms", percentiles(report.latency)},
+            {"service_ms", percentiles(report.service)}
+        });
+    }
+    
+    return {
+        {"rate", config_.rate},
+        {"duration_seconds", config_.duration.count()},
+        {"warmup_seconds", config_.warmup.count()},
+        {"connections", config_.connections},
+        {"measured_seconds", seconds},
+        {"late_starts", late_starts_},
+        {"routes", routes}
+    };
+}
+
+} // namespace FoxBridge
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <nlohmann/json.hpp>
+#include "HdrHistogram.h"
+
+namespace FoxBridge {
+
+// One kind of request in the mix. "{n}" in the target or body is replaced by
+// a random integer from [min, max], zero-padded to `pad` digits, so lookups
+// spread over a range of document numbers.
+struct MixEntry {
+    std::string name;
+    std::string method = "GET";
+    std::string target;
+    std::string body;
+    double weight = 1.0;
+    int64_t min = 1;
+    int64_t max = 1;
+    int pad = 0;
+};
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    std::string port = "8787";
+    std::string api_key;
+    double rate = 100.0;                            // Requests per second, fixed arrival rate
+    std::chrono::seconds duration{60};              // Including warmup
+    std::chrono::seconds warmup{5};                 // Sent but not recorded
+    int connections = 64;                           // Upper bound on requests in flight
+    std::chrono::milliseconds timeout{30000};
+    uint64_t seed = 1;
+    std::vector<MixEntry> mix;
+    
+    // Mix file: {"host", "port", "api_key", "rate", ..., "requests": [MixEntry...]}
+    static LoadConfig fromJson(const nlohmann::json& j);
+    
+    void validate() const;
+};
+
+struct RouteReport {
+    std::string name;
+    HdrHistogram latency;           // Microseconds from the scheduled send time
+    HdrHistogram service;           // Microseconds from the actual send time
+    uint64_t errors = 0;            // Connect/read/write failures and timeouts
+    uint64_t bytes = 0;             // Response body bytes
+    std::map<int, uint64_t> statuses;
+};
+
+// Open-loop load generator. Request i is scheduled at start + i / rate no
+// matter how earlier requests fared, and its latency is measured from that
+// scheduled time. A stalled server therefore shows up as queueing delay in
+// the percentiles instead of silently lowering the offered load (coordinated
+// omission). Each worker thread holds one request in flight at a time.
+class LoadGenerator {
+public:
+    explicit LoadGenerator(LoadConfig config);
+    
+    // Blocks for the configured duration. Returns one report per mix entry,
+    // in mix order, followed by an "all" report that merges them.
+    std::vector<RouteReport> run();
+    
+    // Requests sent more than 10ms behind schedule - if this is not near zero,
+    // raise `connections`, the generator itself was the bottleneck
+    uint64_t lateStarts() const { return late_starts_; }
+    double measuredSeconds() const;
+    
+    void printReport(const std::vector<RouteReport>& reports, std::ostream& out) const;
+    nlohmann::json reportJson(const std::vector<RouteReport>& reports) const;
+
+private:
+    LoadConfig config_;
+    uint64_t late_starts_ = 0;
+};
+
+} // namespace FoxBridge
@@ -0,0 +1,121 @@
+#include "LoadGenerator.h"
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+
+using namespace FoxBridge;
+
+static void printUsage() {
+    std::cout << "Usage: foxbridge_loadgen --mix <mix.json> [options]\n\n"
+              << "Options (override the mix file):\n"
+              << "  --host <host>          Agent host (default: 127.0.0.1)\n"
+              << "  --port <port>          Agent port (default: 8787)\n"
+              << "  --api-key <key>        X-API-Key header (default: FOXBRIDGE_API_KEY)\n"
+              << "  --rate <req/s>         Fixed arrival rate (default: 100)\n"
+              << "  --duration <seconds>   Run time including warmup (default: 60)\n"
+              << "  --warmup <seconds>     Leading seconds not recorded (default: 5)\n"
+              << "  --connections <n>      Maximum requests in flight (default: 64)\n"
+              << "  --timeout <ms>         Per-request timeout (default: 30000)\n"
+              << "  --seed <n>             Random seed for the mix (default: 1)\n"
+              << "  --json <file>          Also write the report as JSON\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string mix_path;
+    std::string json_path;
+    nlohmann::json overrides = nlohmann::json::object();
+    
+    // Flag -> mix file key, and whether the value is numeric
+    static const std::pair<const char*, std::pair<const char*, bool>> FLAGS[] = {
+        {"--host",        {"host", false}},
+        {"--port",        {"port", false}},
+        {"--api-key",     {"api_key", false}},
+        {"--rate",        {"rate", true}},
+        {"--duration",    {"duration_seconds", true}},
+        {"--warmup",      {"warmup_seconds", true}},
+        {"--connections", {"connections", true}},
+        {"--timeout",     {"timeout_ms", true}},
+        {"--seed",        {"seed", true}}
+    };
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        
+        if (arg == "--mix") {
+            mix_path = value;
+            continue;
+        }
+        if (arg == "--json") {
+            json_path = value;
+            continue;
+        }
+        
+        bool known = false;
+        for (const auto& [flag, key] : FLAGS) {
+            if (arg == flag) {
+                try {
+                    overrides[key.first] = key.second ? nlohmann::json::parse(value) : nlohmann::json(value);
+                } catch (const std::exception&) {
+                    std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+                    return 1;
+                }
+                known = true;
+            }
+        }
+        if (!known) {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (mix_path.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    LoadConfig config;
+    try {
+        std::ifstream file(mix_path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open mix file: " + mix_path);
+        }
+        nlohmann::json j = nlohmann::json::parse(file);
+        if (!j.contains("api_key") && !overrides.contains("api_key")) {
+            if (const char* key = std::getenv("FOXBRIDGE_API_KEY")) {
+                j["api_key"] = key;
+            }
+        }
+        j.update(overrides);
+        config = LoadConfig::fromJson(j);
+    } catch (const std::exception& e) {
+        std::cerr << "Configuration error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    try {
+        LoadGenerator generator(config);
+        auto reports = generator.run();
+        generator.printReport(reports, std::cout);
+        
+        if (!json_path.empty()) {
+            std::ofstream out(json_path);
+            out << generator.reportJson(reports).dump(2) << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Load test failed: " << e.what() << "\n";
+        return 1;
+    }
+    
+    return 0;
+}